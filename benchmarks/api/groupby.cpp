@@ -42,13 +42,17 @@ int main(int argc, char* argv[]) {
     clp.AddParamString("input", input,
                        "input file pattern");
 
+    bool hash = false;
+    clp.AddFlag('H', "hash", hash,
+                "group by hashing instead of sorting");
+
     if (!clp.Process(argc, argv)) {
         return -1;
     }
 
     clp.PrintResult();
 
-    auto start_func = [&input](api::Context& ctx) {
+    auto start_func = [&input, hash](api::Context& ctx) {
 
                           auto modulo_keyfn = [](size_t in) { return (in % 100); };
 
@@ -66,7 +70,9 @@ int main(int argc, char* argv[]) {
 
                           // group by to compute median
                           thrill::common::StatsTimerStart timer;
-                          auto res2 = in.GroupByKey<size_t>(modulo_keyfn, median_fn).Size();
+                          auto res2 = hash ?
+                                      in.GroupByKey<size_t>(HashTag, modulo_keyfn, median_fn).Size() :
+                                      in.GroupByKey<size_t>(modulo_keyfn, median_fn).Size();
                           timer.Stop();
 
                           LOG1 // << "\n"
@@ -74,6 +80,7 @@ int main(int argc, char* argv[]) {
                               << " name=total"
                               << " time=" << timer.Milliseconds()
                               << " filename=" << input
+                              << " hash=" << hash
                               << " sanity1=" << res1
                               << " sanity2=" << res2;
                       };
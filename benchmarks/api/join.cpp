@@ -0,0 +1,128 @@
+/*******************************************************************************
+ * benchmarks/api/join.cpp
+ *
+ * Benchmark of InnerJoin() of two generated DIAs of integer pairs.
+ *
+ * Part of Project Thrill - http://project-thrill.org
+ *
+ * All rights reserved. Published under the BSD-2 license in the LICENSE file.
+ ******************************************************************************/
+
+#include <thrill/api/broadcast_join.hpp>
+#include <thrill/api/generate.hpp>
+#include <thrill/api/inner_join.hpp>
+#include <thrill/api/merge_join.hpp>
+#include <thrill/api/size.hpp>
+#include <thrill/api/sort.hpp>
+#include <thrill/common/cmdline_parser.hpp>
+#include <thrill/common/logger.hpp>
+#include <thrill/common/stats_timer.hpp>
+
+#include <string>
+#include <utility>
+
+using namespace thrill; // NOLINT
+
+using Pair = std::pair<size_t, size_t>;
+
+int main(int argc, char* argv[]) {
+
+    common::CmdlineParser clp;
+
+    int iterations = 1;
+    clp.AddInt('n', "iterations", iterations, "Iterations, default: 1");
+
+    size_t large_size = 16 * 1024 * 1024;
+    clp.AddSizeT('l', "large", large_size,
+                 "number of items in the larger (probe) DIA");
+
+    size_t small_size = 4 * 1024 * 1024;
+    clp.AddSizeT('s', "small", small_size,
+                 "number of items in the smaller (build) DIA. Set THRILL_RAM "
+                 "low to benchmark build sides larger than RAM.");
+
+    size_t key_range = 0;
+    clp.AddSizeT('k', "keys", key_range,
+                 "number of distinct keys, default: small DIA size");
+
+    bool broadcast = false;
+    clp.AddFlag('b', "broadcast", broadcast,
+                "broadcast the small DIA instead of shuffling both");
+
+    bool sorted = false;
+    clp.AddFlag('m', "merge", sorted,
+                "sort both DIAs before timing and use the sort-merge join");
+
+    if (!clp.Process(argc, argv)) {
+        return -1;
+    }
+
+    clp.PrintResult();
+
+    if (key_range == 0) key_range = small_size;
+
+    return api::Run(
+        [&](api::Context& ctx) {
+            auto large = Generate(
+                ctx, large_size,
+                [key_range](const size_t& index) {
+                    return Pair(index * 0x9E3779B97F4A7C15llu % key_range,
+                                index);
+                }).Cache();
+
+            auto small = Generate(
+                ctx, small_size,
+                [key_range](const size_t& index) {
+                    return Pair(index % key_range, index);
+                }).Cache();
+
+            auto by_key = [](const Pair& a, const Pair& b) {
+                              return a.first < b.first;
+                          };
+            if (sorted) {
+                large = large.Sort(by_key).Cache();
+                small = small.Sort(by_key).Cache();
+            }
+
+            large.Size(), small.Size();
+
+            for (int i = 0; i < iterations; ++i) {
+                common::StatsTimerStart timer;
+
+                auto key_fn = [](const Pair& p) { return p.first; };
+                auto join_fn = [](const Pair& a, const Pair& b) {
+                                   return a.second + b.second;
+                               };
+
+                size_t result_size;
+                if (broadcast) {
+                    result_size = large.Keep().InnerJoin(
+                        BroadcastTag, small.Keep(),
+                        key_fn, key_fn, join_fn).Size();
+                }
+                else if (sorted) {
+                    result_size = large.Keep().InnerJoin(
+                        SortedTag, small.Keep(),
+                        key_fn, key_fn, join_fn).Size();
+                }
+                else {
+                    result_size = large.Keep().InnerJoin(
+                        small.Keep(), key_fn, key_fn, join_fn).Size();
+                }
+
+                timer.Stop();
+
+                LOG1 << "RESULT" << " benchmark=join"
+                     << " large_size=" << large_size
+                     << " small_size=" << small_size
+                     << " key_range=" << key_range
+                     << " broadcast=" << broadcast
+                     << " sorted=" << sorted
+                     << " result_size=" << result_size
+                     << " time=" << timer.Milliseconds()
+                     << " workers=" << ctx.num_workers();
+            }
+        });
+}
+
+/******************************************************************************/
@@ -16,6 +16,7 @@
 #include <thrill/common/logger.hpp>
 #include <thrill/common/stats_timer.hpp>
 
+#include <cstdlib>
 #include <limits>
 #include <string>
 #include <utility>
@@ -34,14 +35,25 @@ int main(int argc, char* argv[]) {
     clp.AddParamBytes("size", size,
                       "Amount of data transfered between peers (example: 1 GiB).");
 
+    unsigned int max_helper_threads = 0;
+    clp.AddUInt('t', "max_helper_threads", max_helper_threads,
+                "Run with 0, 1, 2, 4, ... up to this number of helper "
+                "threads per host for sorting local runs, default: 0 = "
+                "use THRILL_HELPER_THREADS or idle cores.");
+
+    std::string input = "random";
+    clp.AddString('g', "input", input,
+                  "Input distribution: random, sorted, or runs (sorted runs "
+                  "of 1 Mi items), default: random.");
+
     if (!clp.Process(argc, argv)) {
         return -1;
     }
 
     clp.PrintResult();
 
-    api::Run(
-        [&iterations, &size](api::Context& ctx) {
+    auto job =
+        [&iterations, &size, &input](api::Context& ctx) {
             for (int i = 0; i < iterations; i++) {
                 std::default_random_engine generator(std::random_device { } ());
                 std::uniform_int_distribution<size_t> distribution(0, std::numeric_limits<size_t>::max());
@@ -49,16 +61,35 @@ int main(int argc, char* argv[]) {
                 common::StatsTimerStart timer;
                 api::Generate(
                     ctx, size / sizeof(size_t),
-                    [&distribution, &generator](size_t) -> size_t {
+                    [&](size_t index) -> size_t {
+                        if (input == "sorted")
+                            return index;
+                        if (input == "runs")
+                            return (index % (1024 * 1024)) * 4096 + index;
                         return distribution(generator);
                     })
                 .Sort().Size();
                 timer.Stop();
                 if (!ctx.my_rank()) {
-                    LOG1 << "ITERATION " << i << " RESULT" << " time=" << timer.Milliseconds();
+                    LOG1 << "ITERATION " << i << " RESULT"
+                         << " input=" << input
+                         << " time=" << timer.Milliseconds()
+                         << " local_parallelism=" << ctx.local_parallelism();
                 }
             }
-        });
+        };
+
+    if (max_helper_threads == 0)
+        return api::Run(job);
+
+    // scale the number of helper threads, which are picked up by each new
+    // HostContext.
+    for (unsigned int t = 0; t <= max_helper_threads; t = t ? 2 * t : 1) {
+        setenv("THRILL_HELPER_THREADS", std::to_string(t).c_str(), 1);
+        if (api::Run(job) != 0) return -1;
+    }
+
+    return 0;
 }
 
 /******************************************************************************/
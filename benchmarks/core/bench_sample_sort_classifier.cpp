@@ -0,0 +1,188 @@
+/*******************************************************************************
+ * benchmarks/core/bench_sample_sort_classifier.cpp
+ *
+ * Microbenchmark of item classification as done by SortNode::TransmitItems():
+ * the super scalar batch classifier versus descending the splitter tree with
+ * two items at once.
+ *
+ * Part of Project Thrill - http://project-thrill.org
+ *
+ * All rights reserved. Published under the BSD-2 license in the LICENSE file.
+ ******************************************************************************/
+
+#include <thrill/common/cmdline_parser.hpp>
+#include <thrill/common/logger.hpp>
+#include <thrill/common/math.hpp>
+#include <thrill/common/stats_timer.hpp>
+#include <thrill/core/sample_sort_classifier.hpp>
+
+#include <algorithm>
+#include <functional>
+#include <iostream>
+#include <random>
+#include <utility>
+#include <vector>
+
+using namespace thrill; // NOLINT
+
+using Key = uint64_t;
+using Compare = std::less<Key>;
+using SampleIndexPair = std::pair<Key, size_t>;
+
+//! previous classification: implicit splitter tree, descended with two items
+//! at once using branches.
+class TreeClassifier
+{
+public:
+    TreeClassifier(const SampleIndexPair* splitters, size_t log_k)
+        : log_k_(log_k), k_(size_t(1) << log_k),
+          splitters_(splitters), tree_(k_ + 1) {
+        if (k_ > 1) recurse(splitters, splitters + k_ - 1, 1);
+    }
+
+    void Classify(const Key* items, size_t n, size_t index,
+                  size_t* oracle) const {
+        size_t i = 0;
+        for ( ; i + 2 <= n; i += 2) {
+            size_t j0 = 1, j1 = 1;
+            const Key& el0 = items[i], & el1 = items[i + 1];
+            for (size_t l = 0; l < log_k_; l++) {
+                j0 = 2 * j0 + (compare_(el0, tree_[j0]) ? 0 : 1);
+                j1 = 2 * j1 + (compare_(el1, tree_[j1]) ? 0 : 1);
+            }
+            size_t b0 = j0 - k_, b1 = j1 - k_;
+            while (b0 && !compare_(splitters_[b0 - 1].first, el0) &&
+                   splitters_[b0 - 1].second >= index + i) b0--;
+            while (b1 && !compare_(splitters_[b1 - 1].first, el1) &&
+                   splitters_[b1 - 1].second >= index + i + 1) b1--;
+            oracle[i] = b0, oracle[i + 1] = b1;
+        }
+        for ( ; i < n; ++i) {
+            size_t j0 = 1;
+            for (size_t l = 0; l < log_k_; l++)
+                j0 = 2 * j0 + (compare_(items[i], tree_[j0]) ? 0 : 1);
+            size_t b0 = j0 - k_;
+            while (b0 && !compare_(splitters_[b0 - 1].first, items[i]) &&
+                   splitters_[b0 - 1].second >= index + i) b0--;
+            oracle[i] = b0;
+        }
+    }
+
+private:
+    size_t log_k_, k_;
+    const SampleIndexPair* splitters_;
+    std::vector<Key> tree_;
+    Compare compare_;
+
+    void recurse(const SampleIndexPair* lo, const SampleIndexPair* hi,
+                 size_t treeidx) {
+        const SampleIndexPair* mid = lo + (hi - lo) / 2;
+        tree_[treeidx] = mid->first;
+        if (2 * treeidx < k_ - 1) {
+            recurse(lo, mid, 2 * treeidx + 0);
+            recurse(mid + 1, hi, 2 * treeidx + 1);
+        }
+    }
+};
+
+//! classify items in batches like TransmitItems() and count bucket sizes.
+template <typename Classifier>
+void RunClassifier(const char* name, const Classifier& classifier,
+                   const std::vector<Key>& items, size_t workers,
+                   size_t batch_size, unsigned repeats) {
+
+    std::vector<size_t> oracle(batch_size);
+    std::vector<size_t> bucket_size(
+        size_t(1) << common::IntegerLog2Ceil(workers));
+
+    common::StatsTimerStart timer;
+
+    for (unsigned r = 0; r < repeats; ++r) {
+        for (size_t i = 0; i < items.size(); i += batch_size) {
+            size_t n = std::min(batch_size, items.size() - i);
+            classifier(items.data() + i, n, i, oracle.data());
+            for (size_t u = 0; u < n; ++u)
+                ++bucket_size[oracle[u]];
+        }
+    }
+
+    timer.Stop();
+
+    double items_per_sec =
+        static_cast<double>(items.size()) * repeats / timer.SecondsDouble();
+
+    std::cout
+        << "RESULT"
+        << " benchmark=sample_sort_classifier"
+        << " classifier=" << name
+        << " workers=" << workers
+        << " items=" << items.size()
+        << " repeats=" << repeats
+        << " time=" << timer.Milliseconds()
+        << " items_per_sec=" << items_per_sec
+        << " max_bucket=" << *std::max_element(
+        bucket_size.begin(), bucket_size.end())
+        << std::endl;
+}
+
+int main(int argc, char* argv[]) {
+
+    common::CmdlineParser clp;
+
+    uint64_t size = 16 * 1024 * 1024;
+    clp.AddBytes('n', "items", "N", size,
+                 "Number of 64-bit items to classify, default = 16 Mi");
+
+    unsigned repeats = 4;
+    clp.AddUInt('r', "repeats", "R", repeats,
+                "Repeat classification R times, default = 4");
+
+    unsigned min_workers = 2, max_workers = 1024;
+    clp.AddUInt('w', "min_workers", "W", min_workers,
+                "Smallest number of workers, default = 2");
+    clp.AddUInt('W', "max_workers", "W", max_workers,
+                "Largest number of workers, default = 1024");
+
+    if (!clp.Process(argc, argv)) return -1;
+
+    clp.PrintResult();
+
+    std::mt19937_64 rng(123456);
+    std::vector<Key> items(size);
+    for (Key& k : items) k = rng();
+
+    const size_t batch_size = 256;
+
+    for (size_t workers = min_workers; workers <= max_workers; workers *= 2)
+    {
+        size_t log_k = common::IntegerLog2Ceil(workers);
+
+        // pick splitters from a sample and add sentinels like SortNode.
+        std::vector<SampleIndexPair> splitters;
+        for (size_t i = 1; i < workers; ++i) {
+            size_t index = rng() % items.size();
+            splitters.emplace_back(items[index], index);
+        }
+        std::sort(splitters.begin(), splitters.end());
+        while (splitters.size() + 1 < (size_t(1) << log_k))
+            splitters.push_back(splitters.back());
+
+        TreeClassifier tree(splitters.data(), log_k);
+        RunClassifier(
+            "tree", [&tree](const Key* items, size_t n, size_t index,
+                            size_t* oracle) {
+                tree.Classify(items, n, index, oracle);
+            }, items, workers, batch_size, repeats);
+
+        core::SampleSortClassifier<Key, Compare> ssss(splitters.data(), log_k);
+        RunClassifier(
+            "super_scalar", [&ssss](const Key* items, size_t n, size_t index,
+                                    size_t* oracle) {
+                ssss.Classify(items, items + n, index, oracle);
+            }, items, workers, batch_size, repeats);
+    }
+
+    return 0;
+}
+
+/******************************************************************************/
@@ -16,7 +16,10 @@
 #include <thrill/common/matrix.hpp>
 #include <thrill/common/stats_timer.hpp>
 #include <thrill/common/thread_pool.hpp>
+#include <thrill/data/block_pool.hpp>
 #include <thrill/data/block_queue.hpp>
+#include <thrill/data/eviction_policy.hpp>
+#include <thrill/io/iostats.hpp>
 
 #include <algorithm>
 #include <iostream>
@@ -304,6 +307,191 @@ private:
     unsigned num_threads_ = 1;
 };
 
+/******************************************************************************/
+//! Stress test of the BlockPool: each thread repeatedly allocates a ByteBlock,
+//! copies its pin several times, and releases the ByteBlock again.
+
+class BlockPoolExperiment
+{
+public:
+    int Run(int argc, char* argv[]) {
+
+        common::CmdlineParser clp;
+
+        clp.SetDescription("thrill::data benchmark for BlockPool allocation");
+
+        clp.AddSizeT('s', "block_size", data::default_block_size,
+                     "block size (system default)");
+
+        clp.AddUInt('n', "iterations", iterations_, "Iterations (default: 1)");
+
+        clp.AddUInt('t', "threads", num_threads_,
+                    "Number of threads = workers (default: 1)");
+
+        clp.AddSizeT('b', "blocks", num_blocks_,
+                     "Number of blocks allocated per thread (default: 100000)");
+
+        clp.AddSizeT('p', "pins", num_pins_,
+                     "Number of pin copies per block (default: 8)");
+
+        if (!clp.Process(argc, argv)) return -1;
+
+        for (unsigned i = 0; i < iterations_; i++)
+            Test();
+
+        return 0;
+    }
+
+    void Test() {
+        data::BlockPool block_pool(num_threads_);
+        common::ThreadPool threads(num_threads_);
+
+        StatsTimerStart timer;
+
+        for (size_t t = 0; t < num_threads_; t++) {
+            threads.Enqueue(
+                [this, &block_pool, t]() {
+                    std::vector<data::PinnedByteBlockPtr> pins;
+                    pins.reserve(num_pins_);
+                    for (size_t i = 0; i < num_blocks_; ++i) {
+                        data::PinnedByteBlockPtr bb =
+                            block_pool.AllocateByteBlock(
+                                data::default_block_size, t);
+                        // touch the memory like a BlockWriter
+                        bb->data()[0] = static_cast<data::Byte>(i);
+                        for (size_t p = 0; p < num_pins_; ++p)
+                            pins.emplace_back(bb);
+                        pins.clear();
+                    }
+                });
+        }
+        threads.LoopUntilEmpty();
+        timer.Stop();
+
+        size_t ops = num_threads_ * num_blocks_;
+
+        LOG1 << "RESULT"
+             << " experiment=" << "block_pool"
+             << " threads=" << num_threads_
+             << " block_size=" << data::default_block_size
+             << " blocks=" << num_blocks_
+             << " pins=" << num_pins_
+             << " time=" << timer.SecondsDouble()
+             << " blocks_per_sec="
+             << static_cast<double>(ops) / timer.SecondsDouble()
+             << " pins_per_sec="
+             << static_cast<double>(ops * num_pins_) / timer.SecondsDouble();
+    }
+
+private:
+    //! number of iterations to run
+    unsigned iterations_ = 1;
+
+    //! number of threads used
+    unsigned num_threads_ = 1;
+
+    //! number of blocks allocated per thread
+    size_t num_blocks_ = 100000;
+
+    //! number of pin copies per block
+    size_t num_pins_ = 8;
+};
+
+/******************************************************************************/
+
+//! Iterative scans of a File larger than the BlockPool's RAM with a given
+//! replacement policy, measures time and I/O volume per scan.
+class EvictionScanExperiment
+{
+public:
+    int Run(int argc, char* argv[]) {
+
+        common::CmdlineParser clp;
+
+        clp.SetDescription(
+            "thrill::data benchmark for BlockPool replacement policies");
+
+        clp.AddBytes('m', "ram", ram_,
+                     "BlockPool memory limit (default: 64 MiB)");
+
+        clp.AddBytes('s', "size", size_,
+                     "size of File scanned (default: 128 MiB)");
+
+        clp.AddUInt('n', "scans", scans_,
+                    "number of scans of the File (default: 4)");
+
+        clp.AddFlag('c', "compress", compress_,
+                    "compress Blocks before swapping them out");
+
+        clp.AddParamString("policy", policy_,
+                           "replacement policy (lru, mru, clock, hint)");
+
+        if (!clp.Process(argc, argv)) return -1;
+
+        data::EvictionPolicyType policy;
+        if (!data::ParseEvictionPolicy(policy_, policy)) {
+            clp.PrintUsage();
+            return -1;
+        }
+
+        data::BlockPool block_pool(ram_ * 9 / 10, ram_, nullptr, nullptr, 1,
+                                   policy, compress_);
+        data::File file(block_pool, 0, /* dia_id */ 0);
+
+        size_t items = size_ / sizeof(size_t);
+        {
+            data::File::Writer writer = file.GetWriter();
+            for (size_t i = 0; i < items; ++i)
+                writer.Put<size_t>(i);
+        }
+
+        for (unsigned s = 0; s < scans_; ++s) {
+            io::StatsData io_before(*io::Stats::GetInstance());
+            StatsTimerStart timer;
+
+            size_t sum = 0;
+            data::File::KeepReader reader = file.GetKeepReader();
+            while (reader.HasNext())
+                sum += reader.Next<size_t>();
+            die_unequal(sum, items * (items - 1) / 2);
+
+            timer.Stop();
+            io::StatsData io_after(*io::Stats::GetInstance());
+
+            LOG1 << "RESULT"
+                 << " experiment=" << "eviction_scan"
+                 << " policy=" << data::EvictionPolicyName(policy)
+                 << " compress=" << compress_
+                 << " ram=" << ram_
+                 << " size=" << size_
+                 << " scan=" << s
+                 << " time=" << timer.SecondsDouble()
+                 << " read_volume="
+                 << io_after.read_volume() - io_before.read_volume()
+                 << " write_volume="
+                 << io_after.write_volume() - io_before.write_volume();
+        }
+
+        return 0;
+    }
+
+private:
+    //! BlockPool memory limit
+    uint64_t ram_ = 64 * 1024 * 1024;
+
+    //! size of the File
+    uint64_t size_ = 128 * 1024 * 1024;
+
+    //! number of scans
+    unsigned scans_ = 4;
+
+    //! compress swapped Blocks
+    bool compress_ = false;
+
+    //! replacement policy name
+    std::string policy_;
+};
+
 /******************************************************************************/
 
 template <typename Stream>
@@ -776,6 +964,8 @@ void Usage(const char* argv0) {
         << std::endl
         << "    file                - File and serialization speed" << std::endl
         << "    blockqueue          - BlockQueue test" << std::endl
+        << "    blockpool           - BlockPool allocation stress test" << std::endl
+        << "    eviction_scan       - iterative File scans with a replacement policy" << std::endl
         << "    cat_stream_1factor  - 1-factor bandwidth test using CatStream" << std::endl
         << "    mix_stream_1factor  - 1-factor bandwidth test using MixStream" << std::endl
         << "    cat_stream_all2all  - full bandwidth test using CatStream" << std::endl
@@ -801,6 +991,12 @@ int main(int argc, char* argv[]) {
     else if (benchmark == "blockqueue") {
         return BlockQueueExperiment().Run(argc - 1, argv + 1);
     }
+    else if (benchmark == "blockpool") {
+        return BlockPoolExperiment().Run(argc - 1, argv + 1);
+    }
+    else if (benchmark == "eviction_scan") {
+        return EvictionScanExperiment().Run(argc - 1, argv + 1);
+    }
     else if (benchmark == "cat_stream_1factor") {
         return StreamOneFactorExperiment<data::CatStream>().Run(
             argc - 1, argv + 1);
@@ -11,6 +11,7 @@
 
 #include <thrill/common/cmdline_parser.hpp>
 #include <thrill/common/stats_timer.hpp>
+#include <thrill/common/zipf_distribution.hpp>
 #include <thrill/core/reduce_by_hash_post_phase.hpp>
 #include <thrill/data/block_writer.hpp>
 #include <thrill/data/discard_sink.hpp>
@@ -38,6 +39,12 @@ unsigned int workers = 100;
 
 uint64_t item_range = std::numeric_limits<Key>::max();
 
+uint64_t limit_memory = 128 * 1024 * 1024;
+
+std::string hashtable = "probing";
+std::string distribution = "uniform";
+double zipf_exponent = 1.0;
+
 template <core::ReduceTableImpl table_impl>
 void RunBenchmark(api::Context& ctx, core::DefaultReduceConfig& base_config) {
 
@@ -53,7 +60,21 @@ void RunBenchmark(api::Context& ctx, core::DefaultReduceConfig& base_config) {
     uint64_t num_items = size / sizeof(KeyPair);
 
     std::default_random_engine rng(std::random_device { } ());
-    std::uniform_int_distribution<Key> dist(1, item_range);
+
+    // generate keys before measuring, as drawing from the Zipf distribution
+    // is much slower than inserting into the table.
+    std::vector<Key> keys(num_items);
+
+    if (distribution == "zipf") {
+        // skewed keys: few keys are very frequent
+        common::ZipfDistribution dist(
+            std::min<uint64_t>(item_range, num_items), zipf_exponent);
+        for (Key& k : keys) k = dist(rng);
+    }
+    else {
+        std::uniform_int_distribution<Key> dist(1, item_range);
+        for (Key& k : keys) k = dist(rng);
+    }
 
     core::DefaultReduceConfigSelect<table_impl> config;
     config.limit_partition_fill_rate_ = base_config.limit_partition_fill_rate_;
@@ -66,11 +87,12 @@ void RunBenchmark(api::Context& ctx, core::DefaultReduceConfig& base_config) {
         core::DefaultReduceConfigSelect<table_impl> >
     phase(ctx, 0, key_ex, red_fn, emit_fn,
           config);
+    phase.Initialize(limit_memory);
 
     common::StatsTimerStart timer;
 
-    for (uint64_t i = 0; i < num_items; i++)
-        phase.Insert(dist(rng));
+    for (const Key& k : keys)
+        phase.Insert(k);
 
     phase.PushData(/* consume */ true);
 
@@ -81,6 +103,8 @@ void RunBenchmark(api::Context& ctx, core::DefaultReduceConfig& base_config) {
         << " benchmark=" << title
         << " size=" << size
         << " workers=" << workers
+        << " hashtable=" << hashtable
+        << " distribution=" << distribution
         << " max_partition_fill_rate=" << config.limit_partition_fill_rate()
         << " bucket_rate=" << config.bucket_rate()
         << " time=" << timer.Milliseconds()
@@ -93,8 +117,6 @@ int main(int argc, char* argv[]) {
 
     core::DefaultReduceConfig config;
 
-    std::string hashtable;
-
     clp.AddBytes('s', "size", "S", size,
                  "Set amount of bytes to be inserted, default = 64 MiB");
 
@@ -102,7 +124,8 @@ int main(int argc, char* argv[]) {
                   "Load in byte to be inserted");
 
     clp.AddString('h', "hash-table", "H", hashtable,
-                  "Set hashtable: probing or bucket");
+                  "Set hashtable: probing, simd_probing, old_probing, "
+                  "or bucket");
 
     clp.AddUInt('w', "workers", "W", workers,
                 "Open hashtable with W workers, default = 1.");
@@ -119,6 +142,16 @@ int main(int argc, char* argv[]) {
                  item_range,
                  "set upper bound on item values, default = UINT_MAX.");
 
+    clp.AddBytes('m', "memory", "M",
+                 limit_memory,
+                 "set memory limit of the hash table, default = 128 MiB.");
+
+    clp.AddString('d', "distribution", "D", distribution,
+                  "Set key distribution: uniform or zipf, default = uniform.");
+
+    clp.AddDouble('z', "zipf", "Z", zipf_exponent,
+                  "set exponent of the zipf distribution, default = 1.0.");
+
     if (!clp.Process(argc, argv)) {
         return -1;
     }
@@ -127,6 +160,12 @@ int main(int argc, char* argv[]) {
         [&](api::Context& ctx) {
             if (hashtable == "bucket")
                 return RunBenchmark<core::ReduceTableImpl::BUCKET>(ctx, config);
+            else if (hashtable == "old_probing")
+                return RunBenchmark<core::ReduceTableImpl::OLD_PROBING>(
+                    ctx, config);
+            else if (hashtable == "simd_probing")
+                return RunBenchmark<core::ReduceTableImpl::SIMD_PROBING>(
+                    ctx, config);
             else
                 return RunBenchmark<core::ReduceTableImpl::PROBING>(ctx, config);
         });
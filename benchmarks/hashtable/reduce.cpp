@@ -10,6 +10,7 @@
  ******************************************************************************/
 
 #include <thrill/api/dia.hpp>
+#include <thrill/api/generate.hpp>
 #include <thrill/api/read_binary.hpp>
 #include <thrill/api/reduce_by_key.hpp>
 #include <thrill/api/size.hpp>
@@ -23,6 +24,34 @@
 
 using namespace thrill; // NOLINT
 
+//! ReduceConfig which re-reduces spilled partitions on a single thread.
+class SequentialReduceConfig : public core::DefaultReduceConfig
+{
+public:
+    static constexpr bool parallel_post_phase_ = false;
+};
+
+template <typename ReduceConfig, typename InputDIA>
+void RunReduce(InputDIA& in, int iterations) {
+    for (int i = 0; i < iterations; ++i) {
+        common::StatsTimerStart timer;
+        size_t result_size =
+            in.Keep().ReduceByKey([](const size_t& in) {
+                                      return in;
+                                  }, [](const size_t& in1, const size_t& in2) {
+                                      (void)in2;
+                                      return in1;
+                                  }, ReduceConfig()).Size();
+        timer.Stop();
+
+        LOG1 << "RESULT" << " benchmark=reduce"
+             << " parallel_post_phase="
+             << ReduceConfig::parallel_post_phase_
+             << " result_size=" << result_size
+             << " time=" << timer.Milliseconds();
+    }
+}
+
 int main(int argc, char* argv[]) {
 
     common::CmdlineParser clp;
@@ -31,8 +60,20 @@ int main(int argc, char* argv[]) {
     clp.AddParamInt("n", iterations, "Iterations");
 
     std::string input;
-    clp.AddParamString("input", input,
-                       "input file pattern");
+    clp.AddOptParamString("input", input,
+                          "input file pattern, if empty items are generated");
+
+    size_t size = 16 * 1024 * 1024;
+    clp.AddSizeT('s', "size", size, "number of items to generate");
+
+    size_t cardinality = 0;
+    clp.AddSizeT('k', "cardinality", cardinality,
+                 "number of distinct keys to generate, default: size. Set "
+                 "THRILL_RAM low to benchmark cardinalities larger than RAM.");
+
+    bool sequential = false;
+    clp.AddFlag('S', "sequential", sequential,
+                "re-reduce spilled partitions sequentially");
 
     if (!clp.Process(argc, argv)) {
         return -1;
@@ -40,21 +81,29 @@ int main(int argc, char* argv[]) {
 
     clp.PrintResult();
 
-    api::Run([&input, &iterations](api::Context& ctx) {
+    if (cardinality == 0) cardinality = size;
 
-                 auto in = api::ReadBinary<size_t>(ctx, input).Keep();
-                 in.Size();
+    api::Run([&](api::Context& ctx) {
 
-                 common::StatsTimerStart timer;
-                 in.ReduceByKey([](const size_t& in) {
-                                    return in;
-                                }, [](const size_t& in1, const size_t& in2) {
-                                    (void)in2;
-                                    return in1;
-                                }).Size();
-                 timer.Stop();
+                 api::DIA<size_t> in;
+                 if (input.size()) {
+                     in = api::ReadBinary<size_t>(ctx, input).Cache();
+                 }
+                 else {
+                     in = api::Generate(
+                         ctx, size,
+                         [cardinality](const size_t& index) -> size_t {
+                             // scatter keys over the whole range
+                             return (index % cardinality)
+                             * 0x9E3779B97F4A7C15llu;
+                         }).Cache();
+                 }
+                 in.Size();
 
-                 LOG1 << "RESULT" << " benchmark=reduce time=" << timer.Milliseconds();
+                 if (sequential)
+                     RunReduce<SequentialReduceConfig>(in, iterations);
+                 else
+                     RunReduce<core::DefaultReduceConfig>(in, iterations);
              });
 }
 
@@ -20,6 +20,7 @@
 #include <thrill/common/math.hpp>
 #include <thrill/common/stats_timer.hpp>
 #include <thrill/io/block_manager.hpp>
+#include <thrill/io/config_file.hpp>
 #include <thrill/io/request_operations.hpp>
 #include <thrill/io/typed_block.hpp>
 #include <thrill/mem/aligned_allocator.hpp>
@@ -28,6 +29,7 @@
 #include <iomanip>
 #include <iostream>
 #include <limits>
+#include <random>
 #include <string>
 #include <vector>
 
@@ -48,10 +50,14 @@ using namespace thrill; // NOLINT
 
 using Timer = common::StatsTimerStart;
 
+//! access blocks in order of allocation, or swap blocks in and out at random
+//! positions among all blocks allocated so far.
+enum class Pattern { Sequential, Random };
+
 template <size_t RawBlockSize, typename AllocStrategy>
 int BenchmarkDisksBlocksizeAlloc(
     uint64_t length, uint64_t start_offset, uint64_t batch_size,
-    std::string optrw) {
+    std::string optrw, Pattern pattern) {
 
     uint64_t endpos = start_offset + length;
 
@@ -94,7 +100,10 @@ int BenchmarkDisksBlocksizeAlloc(
               << num_blocks_per_batch << " blocks of "
               << common::FormatIecUnits(raw_block_size) << ")"
               << " using " << AllocStrategy().name()
-              << std::endl;
+              << (pattern == Pattern::Random ? " random" : " sequential")
+              << " pattern" << std::endl;
+
+    std::default_random_engine rng(std::random_device { } ());
 
     // touch data, so it is actually allcoated
     for (unsigned j = 0; j < num_blocks_per_batch; ++j)
@@ -126,13 +135,28 @@ int BenchmarkDisksBlocksizeAlloc(
 
             std::cout << "Offset    " << std::setw(7) << offset / MiB << " MiB: " << std::fixed;
 
+            // select the blocks to swap out and in
+            std::vector<size_t> write_pos(current_num_blocks_per_batch);
+            std::vector<size_t> read_pos(current_num_blocks_per_batch);
+            for (unsigned j = 0; j < current_num_blocks_per_batch; j++) {
+                if (pattern == Pattern::Random) {
+                    std::uniform_int_distribution<size_t> dist(
+                        0, bids.size() - 1);
+                    write_pos[j] = dist(rng);
+                    read_pos[j] = dist(rng);
+                }
+                else {
+                    write_pos[j] = read_pos[j] = num_total_blocks + j;
+                }
+            }
+
             double elapsed;
             Timer t_run;
 
             if (do_write)
             {
                 for (unsigned j = 0; j < current_num_blocks_per_batch; j++)
-                    reqs[j] = buffer[j].write(bids[num_total_blocks + j]);
+                    reqs[j] = buffer[j].write(bids[write_pos[j]]);
 
                 io::wait_all(reqs.begin(), reqs.end());
 
@@ -151,7 +175,7 @@ int BenchmarkDisksBlocksizeAlloc(
             if (do_read)
             {
                 for (unsigned j = 0; j < current_num_blocks_per_batch; j++)
-                    reqs[j] = buffer[j].read(bids[num_total_blocks + j]);
+                    reqs[j] = buffer[j].read(bids[read_pos[j]]);
 
                 io::wait_all(reqs.begin(), reqs.end());
 
@@ -203,9 +227,10 @@ int BenchmarkDisksBlocksizeAlloc(
 
 template <typename AllocStrategy>
 int BenchmarkDisksAlloc(uint64_t length, uint64_t offset, uint64_t batch_size,
-                        uint64_t block_size, std::string optrw) {
+                        uint64_t block_size, std::string optrw,
+                        Pattern pattern) {
 #define Run(bs) BenchmarkDisksBlocksizeAlloc<bs, AllocStrategy>( \
-        length, offset, batch_size, optrw)
+        length, offset, batch_size, optrw, pattern)
     if (block_size == 4 * KiB)
         Run(4 * KiB);
     else if (block_size == 8 * KiB)
@@ -256,6 +281,8 @@ int main(int argc, char* argv[]) {
     unsigned int batch_size = 0;
     uint64_t block_size = 8 * MiB;
     std::string optrw = "rw", allocstr;
+    std::vector<std::string> disks;
+    bool random = false;
 
     cp.AddParamBytes("size", length,
                      "Amount of data to write/read from disks (e.g. 10GiB)");
@@ -272,6 +299,15 @@ int main(int argc, char* argv[]) {
                 "Size of blocks written in one syscall. (default: B = 8MiB)");
     cp.AddBytes('o', "offset", offset,
                 "Starting offset of operation range. (default: 0)");
+    cp.AddStringlist('d', "disk", disks,
+                     "Use disk instead of the configuration file, in "
+                     "the same format, e.g. "
+                     "\"disk=/tmp/bench,4GiB,iouring unlink\". "
+                     "Compare I/O implementations by replacing "
+                     "iouring with linuxaio or syscall.");
+    cp.AddFlag('R', "random", random,
+               "Write and read blocks at random positions among all blocks "
+               "allocated so far, instead of sequentially.");
 
     cp.SetDescription(
         "This program will benchmark the disks configured by the standard "
@@ -285,20 +321,25 @@ int main(int argc, char* argv[]) {
     if (!cp.Process(argc, argv))
         return -1;
 
+    for (const std::string& d : disks)
+        io::Config::GetInstance()->add_disk(io::DiskConfig(d));
+
+    Pattern pattern = random ? Pattern::Random : Pattern::Sequential;
+
     if (allocstr.size())
     {
         if (allocstr == "RC")
             return BenchmarkDisksAlloc<io::RandomCyclic>(
-                length, offset, batch_size, block_size, optrw);
+                length, offset, batch_size, block_size, optrw, pattern);
         if (allocstr == "SR")
             return BenchmarkDisksAlloc<io::SimpleRandom>(
-                length, offset, batch_size, block_size, optrw);
+                length, offset, batch_size, block_size, optrw, pattern);
         if (allocstr == "FR")
             return BenchmarkDisksAlloc<io::FullyRandom>(
-                length, offset, batch_size, block_size, optrw);
+                length, offset, batch_size, block_size, optrw, pattern);
         if (allocstr == "S")
             return BenchmarkDisksAlloc<io::Striping>(
-                length, offset, batch_size, block_size, optrw);
+                length, offset, batch_size, block_size, optrw, pattern);
 
         std::cout << "Unknown allocation strategy '" << allocstr << "'" << std::endl;
         cp.PrintUsage();
@@ -306,7 +347,7 @@ int main(int argc, char* argv[]) {
     }
 
     return BenchmarkDisksAlloc<THRILL_DEFAULT_ALLOC_STRATEGY>(
-        length, offset, batch_size, block_size, optrw);
+        length, offset, batch_size, block_size, optrw, pattern);
 }
 
 /******************************************************************************/
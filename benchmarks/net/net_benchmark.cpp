@@ -6,6 +6,7 @@
  * - 1-factor full bandwidth test
  * - fcc Broadcast
  * - fcc PrefixSum
+ * - random block transmissions, also comparing select() and epoll()
  *
  * Part of Project Thrill - http://project-thrill.org
  *
@@ -23,6 +24,7 @@
 #include <thrill/common/stats_timer.hpp>
 #include <thrill/common/string.hpp>
 #include <thrill/net/dispatcher.hpp>
+#include <thrill/net/tcp/group.hpp>
 
 #include <iostream>
 #include <string>
@@ -646,6 +648,10 @@ public:
         clp.AddUInt('R', "outer_repeats", outer_repeats_,
                     "Repeat whole experiment a number of times.");
 
+        clp.AddString('d', "dispatcher", dispatcher_type_,
+                      "Dispatcher type for tcp: select or epoll, "
+                      "default: THRILL_NET_DISPATCHER");
+
         if (!clp.Process(argc, argv)) return -1;
 
         return api::Run(
@@ -667,7 +673,7 @@ public:
 
             group_ = &ctx.net.group();
             std::unique_ptr<net::Dispatcher> dispatcher =
-                group_->ConstructDispatcher(mem_manager);
+                ConstructDispatcher(mem_manager);
             dispatcher_ = dispatcher.get();
 
             t.Start();
@@ -703,6 +709,7 @@ public:
                 << "RESULT"
                 << " operation=" << "rblocks"
                 << " hosts=" << group_->num_hosts()
+                << " dispatcher=" << dispatcher_type_
                 << " requests=" << num_requests_
                 << " block_size=" << block_size_
                 << " limit_active=" << limit_active_
@@ -716,6 +723,28 @@ public:
         }
     }
 
+    //! construct a Dispatcher of the selected type for the group
+    std::unique_ptr<net::Dispatcher> ConstructDispatcher(
+        mem::Manager& mem_manager) {
+        if (dispatcher_type_.empty())
+            return group_->ConstructDispatcher(mem_manager);
+
+#if THRILL_HAVE_NET_TCP
+        if (dynamic_cast<net::tcp::Group*>(group_) == nullptr)
+            die("Selecting the dispatcher requires THRILL_NET=local or tcp");
+
+        if (dispatcher_type_ == "select") {
+            return net::tcp::Group::ConstructDispatcher(
+                mem_manager, net::tcp::Group::DispatcherType::Select);
+        }
+        else if (dispatcher_type_ == "epoll") {
+            return net::tcp::Group::ConstructDispatcher(
+                mem_manager, net::tcp::Group::DispatcherType::EPoll);
+        }
+#endif
+        die("Unknown dispatcher type " << dispatcher_type_);
+    }
+
     void OnComplete() {
         --active_;
 
@@ -793,6 +822,9 @@ protected:
     //! limit on the number of simultaneous active requests
     unsigned int limit_active_ = 16;
 
+    //! dispatcher type, empty for the group's default
+    std::string dispatcher_type_;
+
     //! communication group
     net::Group* group_;
 
@@ -882,6 +914,58 @@ protected:
 
 /******************************************************************************/
 
+class DispatcherSeries : public RandomBlocks
+{
+    static constexpr bool debug = false;
+
+public:
+    using Super = RandomBlocks;
+
+    int Run(int argc, char* argv[]) {
+
+        common::CmdlineParser clp;
+
+        clp.AddBytes('b', "block_size", block_size_,
+                     "Size of blocks transmitted, default: 64 KiB");
+
+        clp.AddUInt('l', "limit_active", limit_active_,
+                    "Number of simultaneous active requests, default: 64");
+
+        clp.AddUInt('r', "request", num_requests_,
+                    "Number of blocks transmitted across all hosts, "
+                    "default: 10000");
+
+        clp.AddUInt('R', "outer_repeats", outer_repeats_,
+                    "Repeat whole experiment a number of times.");
+
+        if (!clp.Process(argc, argv)) return -1;
+
+        return api::Run(
+            [=](api::Context& ctx) {
+                // make a copy of this for local workers
+                DispatcherSeries local = *this;
+                return local.Test(ctx);
+            });
+    }
+
+    void Test(api::Context& ctx) {
+        // run the same random block pattern with all dispatcher types. Many
+        // small blocks between many hosts stress the wakeup path.
+        for (const char* type : { "select", "epoll" }) {
+            Super::dispatcher_type_ = type;
+            Super::Test(ctx);
+        }
+    }
+
+    DispatcherSeries() {
+        Super::block_size_ = 64 * 1024;
+        Super::limit_active_ = 64;
+        Super::num_requests_ = 10000;
+    }
+};
+
+/******************************************************************************/
+
 void Usage(const char* argv0) {
     std::cout
         << "Usage: " << argv0 << " <benchmark>" << std::endl
@@ -893,6 +977,8 @@ void Usage(const char* argv0) {
         << "    allreduce  - FCC PrefixSum operation" << std::endl
         << "    rblocks    - random block transmissions" << std::endl
         << "    rblocks_series - series of rblocks experiments" << std::endl
+        << "    dispatchers - rblocks with select() and epoll() dispatchers"
+        << std::endl
         << std::endl;
 }
 
@@ -926,6 +1012,9 @@ int main(int argc, char** argv) {
     else if (benchmark == "rblocks_series") {
         return RandomBlocksSeries().Run(argc - 1, argv + 1);
     }
+    else if (benchmark == "dispatchers") {
+        return DispatcherSeries().Run(argc - 1, argv + 1);
+    }
     else {
         Usage(argv[0]);
         return -1;
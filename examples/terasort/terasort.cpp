@@ -17,6 +17,7 @@
 #include <thrill/common/string.hpp>
 
 #include <algorithm>
+#include <array>
 #include <random>
 #include <string>
 #include <utility>
@@ -31,6 +32,12 @@ struct Record {
     bool operator < (const Record& b) const {
         return std::lexicographical_compare(key, key + 10, b.key, b.key + 10);
     }
+    //! key as byte array for radix sorting with SortByKey()
+    std::array<uint8_t, 10> sort_key() const {
+        std::array<uint8_t, 10> k;
+        std::copy(key, key + 10, k.begin());
+        return k;
+    }
     friend std::ostream& operator << (std::ostream& os, const Record& c) {
         return os << common::Hexdump(c.key, 10);
     }
@@ -122,6 +129,11 @@ int main(int argc, char* argv[]) {
                 "compare with signed chars to compare with broken Java "
                 "implementations, default: false");
 
+    bool compare_sort = false;
+    clp.AddFlag('c', "compare_sort", compare_sort,
+                "sort records with comparisons instead of radix sorting "
+                "by key, default: false");
+
     bool generate = false;
     clp.AddFlag('g', "generate", generate,
                 "generate binary record on-the-fly for testing."
@@ -145,6 +157,12 @@ int main(int argc, char* argv[]) {
 
     clp.PrintResult();
 
+    //! sort unsigned records by radix sorting their keys, or by comparisons
+    auto sort_records = [&](const auto& dia) {
+                            return compare_sort ? dia.Sort() : dia.SortByKey(
+                                [](const Record& r) { return r.sort_key(); });
+                        };
+
     return api::Run(
         [&](api::Context& ctx) {
             ctx.enable_consume();
@@ -165,9 +183,8 @@ int main(int argc, char* argv[]) {
                 die_unless(common::ParseSiIecUnits(input[0].c_str(), size));
                 die_unless(!use_signed_char);
 
-                auto r =
-                    Generate(ctx, size / sizeof(Record), GenerateRecord())
-                    .Sort();
+                auto r = sort_records(
+                    Generate(ctx, size / sizeof(Record), GenerateRecord()));
 
                 if (output.size())
                     r.WriteBinary(output);
@@ -184,7 +201,7 @@ int main(int argc, char* argv[]) {
                         r.Execute();
                 }
                 else {
-                    auto r = ReadBinary<Record>(ctx, input).Sort();
+                    auto r = sort_records(ReadBinary<Record>(ctx, input));
 
                     if (output.size())
                         r.WriteBinary(output);
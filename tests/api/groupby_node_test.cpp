@@ -21,6 +21,7 @@
 #include <cstdlib>
 #include <limits>
 #include <string>
+#include <utility>
 #include <vector>
 
 using namespace thrill; // NOLINT
@@ -165,4 +166,104 @@ TEST(GroupByNode, GroupToIndexCorrectResults) {
     api::RunLocalTests(start_func);
 }
 
+TEST(GroupByNode, HashGroupByMedian) {
+
+    auto start_func =
+        [](Context& ctx) {
+            size_t n = 9999;
+            static constexpr size_t m = 4;
+
+            auto sizets = Generate(ctx, n);
+
+            auto modulo_keyfn = [](size_t in) { return (in % m); };
+
+            auto median_fn =
+                [](auto& r, size_t key) {
+                    std::vector<size_t> all;
+                    while (r.HasNext()) {
+                        all.push_back(r.Next());
+                    }
+                    std::sort(std::begin(all), std::end(all));
+                    return std::make_pair(key, all[all.size() / 2 - 1]);
+                };
+
+            // group by hashing to compute medians and gather results
+            auto reduced = sizets.GroupByKey<std::pair<size_t, size_t> >(
+                HashTag, modulo_keyfn, median_fn);
+            std::vector<std::pair<size_t, size_t> > out_vec =
+                reduced.AllGather();
+
+            // compute vector with expected results
+            std::vector<std::vector<size_t> > res_vecvec(m);
+            for (size_t t = 1; t < n; ++t) {
+                res_vecvec[t % m].push_back(t);
+            }
+
+            std::sort(out_vec.begin(), out_vec.end());
+
+            ASSERT_EQ(m, out_vec.size());
+            for (size_t i = 0; i < m; ++i) {
+                std::vector<size_t>& v = res_vecvec[i];
+                std::sort(v.begin(), v.end());
+                ASSERT_EQ(i, out_vec[i].first);
+                ASSERT_EQ(v[v.size() / 2 - 1], out_vec[i].second);
+            }
+        };
+
+    api::RunLocalTests(start_func);
+}
+
+TEST(GroupByNode, HashGroupByLargerThanMemory) {
+
+    static constexpr size_t test_size = 1000000;
+    static constexpr size_t m = test_size / 4;
+
+    auto start_func =
+        [](Context& ctx) {
+
+            // one heavy key 0, which cannot be split by partitioning.
+            auto keyfn = [](size_t in) {
+                             return in % 8 == 0 ? 0 : in % m;
+                         };
+
+            auto sum_fn =
+                [](auto& r, size_t key) {
+                    size_t res = 0;
+                    while (r.HasNext()) {
+                        res += r.Next();
+                    }
+                    return std::make_pair(key, res);
+                };
+
+            auto reduced = Generate(ctx, test_size)
+                           .GroupByKey<std::pair<size_t, size_t> >(
+                HashTag, keyfn, sum_fn);
+            std::vector<std::pair<size_t, size_t> > out_vec =
+                reduced.AllGather();
+
+            // compute vector with expected results
+            std::vector<size_t> res_vec(m, 0);
+            for (size_t t = 0; t < test_size; ++t) {
+                res_vec[keyfn(t)] += t;
+            }
+
+            std::sort(out_vec.begin(), out_vec.end());
+
+            // keys which are multiples of 8 only occur as the heavy key 0.
+            size_t j = 0;
+            for (size_t i = 0; i < m; ++i) {
+                if (i != 0 && i % 8 == 0) continue;
+                ASSERT_LT(j, out_vec.size());
+                ASSERT_EQ(i, out_vec[j].first);
+                ASSERT_EQ(res_vec[i], out_vec[j].second);
+                ++j;
+            }
+            ASSERT_EQ(j, out_vec.size());
+        };
+
+    api::MemoryConfig mem_config;
+    mem_config.setup(128 * 1024 * 1024llu);
+    api::RunLocalMock(mem_config, 2, 1, start_func);
+}
+
 /******************************************************************************/
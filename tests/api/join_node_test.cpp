@@ -0,0 +1,230 @@
+/*******************************************************************************
+ * tests/api/join_node_test.cpp
+ *
+ * Part of Project Thrill - http://project-thrill.org
+ *
+ * All rights reserved. Published under the BSD-2 license in the LICENSE file.
+ ******************************************************************************/
+
+#include <gtest/gtest.h>
+#include <thrill/api/all_gather.hpp>
+#include <thrill/api/all_reduce.hpp>
+#include <thrill/api/broadcast_join.hpp>
+#include <thrill/api/generate.hpp>
+#include <thrill/api/inner_join.hpp>
+#include <thrill/api/merge_join.hpp>
+#include <thrill/api/size.hpp>
+#include <thrill/api/sort.hpp>
+
+#include <algorithm>
+#include <string>
+#include <utility>
+#include <vector>
+
+using namespace thrill; // NOLINT
+
+TEST(JoinNode, InnerJoinIntegerPairs) {
+
+    auto start_func =
+        [](Context& ctx) {
+
+            // keys 0..999, each once
+            auto left = Generate(
+                ctx, 1000,
+                [](size_t index) {
+                    return std::make_pair(index, index * index);
+                });
+
+            // keys 0, 2, 4, ..., 2998, each three times
+            auto right = Generate(
+                ctx, 4500,
+                [](size_t index) {
+                    return std::make_pair(
+                        (index % 1500) * 2, std::to_string(index));
+                });
+
+            auto joined = left.InnerJoin(
+                right,
+                [](const std::pair<size_t, size_t>& p) { return p.first; },
+                [](const std::pair<size_t, std::string>& p) {
+                    return p.first;
+                },
+                [](const std::pair<size_t, size_t>& a,
+                   const std::pair<size_t, std::string>& b) {
+                    return std::make_pair(a.second, b.second);
+                });
+
+            std::vector<std::pair<size_t, std::string> > res =
+                joined.AllGather();
+            std::sort(res.begin(), res.end());
+
+            // even keys 0..998 match three times each
+            ASSERT_EQ(500u * 3u, res.size());
+
+            std::vector<std::pair<size_t, std::string> > check;
+            for (size_t index = 0; index < 4500; ++index) {
+                size_t key = (index % 1500) * 2;
+                if (key >= 1000) continue;
+                check.emplace_back(key * key, std::to_string(index));
+            }
+            std::sort(check.begin(), check.end());
+
+            ASSERT_EQ(check, res);
+        };
+
+    api::RunLocalTests(start_func);
+}
+
+TEST(JoinNode, InnerJoinLargerThanMemory) {
+
+    static constexpr size_t test_size = 600000;
+
+    auto start_func =
+        [](Context& ctx) {
+
+            // first input is larger, hence the second is the build side.
+            auto left = Generate(
+                ctx, 2 * test_size,
+                [](size_t index) {
+                    return std::make_pair(index % test_size, index);
+                });
+
+            // one heavy key 0, which cannot be split by partitioning.
+            auto right = Generate(
+                ctx, test_size,
+                [](size_t index) {
+                    return std::make_pair(index % 4 == 0 ? 0 : index, index);
+                });
+
+            auto joined = left.InnerJoin(
+                right,
+                [](const std::pair<size_t, size_t>& p) { return p.first; },
+                [](const std::pair<size_t, size_t>& p) { return p.first; },
+                [](const std::pair<size_t, size_t>& a,
+                   const std::pair<size_t, size_t>& b) {
+                    return a.second + b.second;
+                });
+
+            // every right item matches two left items, including the
+            // test_size / 4 items of key 0.
+            ASSERT_EQ(2 * test_size, joined.Keep().Size());
+
+            size_t sum = joined.AllReduce(
+                [](const size_t& a, const size_t& b) { return a + b; });
+
+            // each right item (key, index) matches the left items key and
+            // key + test_size.
+            size_t check = 0;
+            for (size_t index = 0; index < test_size; ++index) {
+                size_t key = index % 4 == 0 ? 0 : index;
+                check += 2 * key + 2 * index + test_size;
+            }
+            ASSERT_EQ(check, sum);
+        };
+
+    // set fixed amount of RAM to force grace hash partitioning
+    api::MemoryConfig mem_config;
+    mem_config.setup(128 * 1024 * 1024llu);
+
+    api::RunLocalMock(mem_config, 2, 1, start_func);
+}
+
+TEST(JoinNode, BroadcastJoinIntegerPairs) {
+
+    auto start_func =
+        [](Context& ctx) {
+
+            // keys 0..9999, each twice
+            auto large = Generate(
+                ctx, 20000,
+                [](size_t index) {
+                    return std::make_pair(index % 10000, index);
+                });
+
+            // keys 0, 7, 14, ..., each twice, with strings
+            auto small = Generate(
+                ctx, 400,
+                [](size_t index) {
+                    return std::make_pair(
+                        (index % 200) * 7, std::to_string(index));
+                });
+
+            auto joined = large.InnerJoin(
+                BroadcastTag, small,
+                [](const std::pair<size_t, size_t>& p) { return p.first; },
+                [](const std::pair<size_t, std::string>& p) {
+                    return p.first;
+                },
+                [](const std::pair<size_t, size_t>& a,
+                   const std::pair<size_t, std::string>& b) {
+                    return std::make_pair(a.second, b.second);
+                });
+
+            // every small item matches two large items
+            ASSERT_EQ(800u, joined.Keep().Size());
+
+            std::vector<std::pair<size_t, std::string> > res =
+                joined.AllGather();
+            std::sort(res.begin(), res.end());
+
+            std::vector<std::pair<size_t, std::string> > check;
+            for (size_t index = 0; index < 400; ++index) {
+                size_t key = (index % 200) * 7;
+                check.emplace_back(key, std::to_string(index));
+                check.emplace_back(key + 10000, std::to_string(index));
+            }
+            std::sort(check.begin(), check.end());
+
+            ASSERT_EQ(check, res);
+        };
+
+    api::RunLocalTests(start_func);
+}
+
+TEST(JoinNode, MergeJoinSortedPairs) {
+
+    auto start_func =
+        [](Context& ctx) {
+
+            using Pair = std::pair<size_t, size_t>;
+
+            auto by_key = [](const Pair& a, const Pair& b) {
+                              return a.first < b.first;
+                          };
+
+            // keys 0..99 with 50 items each, which must not be split.
+            auto left = Generate(
+                ctx, 5000,
+                [](size_t index) { return Pair(index % 100, index); })
+                        .Sort(by_key);
+
+            // keys 50..249, each once
+            auto right = Generate(
+                ctx, 200,
+                [](size_t index) { return Pair(index + 50, index); })
+                         .Sort(by_key);
+
+            auto joined = left.InnerJoin(
+                SortedTag, right,
+                [](const Pair& p) { return p.first; },
+                [](const Pair& p) { return p.first; },
+                [](const Pair& a, const Pair& b) {
+                    return Pair(a.second, b.second);
+                });
+
+            std::vector<Pair> res = joined.AllGather();
+            std::sort(res.begin(), res.end());
+
+            std::vector<Pair> check;
+            for (size_t index = 0; index < 5000; ++index) {
+                if (index % 100 >= 50)
+                    check.emplace_back(index, index % 100 - 50);
+            }
+
+            ASSERT_EQ(check, res);
+        };
+
+    api::RunLocalTests(start_func);
+}
+
+/******************************************************************************/
@@ -10,6 +10,7 @@
  ******************************************************************************/
 
 #include <thrill/api/all_gather.hpp>
+#include <thrill/api/approx_distinct.hpp>
 #include <thrill/api/bernoulli_sample.hpp>
 #include <thrill/api/cache.hpp>
 #include <thrill/api/collapse.hpp>
@@ -30,6 +31,7 @@
 #include <thrill/api/size.hpp>
 #include <thrill/api/sort.hpp>
 #include <thrill/api/sum.hpp>
+#include <thrill/api/top_k_frequent.hpp>
 #include <thrill/api/union.hpp>
 #include <thrill/api/window.hpp>
 
@@ -1022,6 +1024,73 @@ TEST(Operations, ActionFutures) {
     api::RunLocalTests(start_func);
 }
 
+TEST(Operations, ApproxDistinct) {
+
+    auto start_func =
+        [](Context& ctx) {
+
+            static constexpr size_t distinct = 20000;
+
+            auto integers = Generate(
+                ctx, 100000,
+                [](const size_t& index) {
+                    return index % distinct;
+                }).Cache();
+
+            Future<size_t> countf = integers.ApproxDistinctFuture();
+            ASSERT_FALSE(countf.valid());
+
+            size_t count = integers.ApproxDistinct();
+
+            // precision 14 has a standard error of less than one percent
+            ASSERT_GT(count, distinct * 95 / 100);
+            ASSERT_LT(count, distinct * 105 / 100);
+            ASSERT_EQ(count, countf());
+        };
+
+    api::RunLocalTests(start_func);
+}
+
+TEST(Operations, TopKFrequent) {
+
+    auto start_func =
+        [](Context& ctx) {
+
+            static constexpr size_t test_size = 100000;
+
+            // a quarter of all items is 0, an eighth is 1, a sixteenth is 2,
+            // and all others are unique.
+            auto integers = Generate(
+                ctx, test_size,
+                [](const size_t& index) -> size_t {
+                    if (index % 4 == 0) return 0;
+                    if (index % 8 == 1) return 1;
+                    if (index % 16 == 3) return 2;
+                    return index + 1000;
+                }).Cache();
+
+            Future<std::vector<std::pair<size_t, size_t> > > topf =
+                integers.TopKFrequentFuture(3);
+
+            std::vector<std::pair<size_t, size_t> > top =
+                integers.TopKFrequent(3);
+
+            ASSERT_EQ(3u, top.size());
+            ASSERT_EQ(0u, top[0].first);
+            ASSERT_EQ(1u, top[1].first);
+            ASSERT_EQ(2u, top[2].first);
+
+            // counts are overestimates
+            ASSERT_GE(top[0].second, test_size / 4);
+            ASSERT_GE(top[1].second, test_size / 8);
+            ASSERT_GE(top[2].second, test_size / 16);
+
+            ASSERT_EQ(top, topf());
+        };
+
+    api::RunLocalTests(start_func);
+}
+
 namespace thrill {
 namespace api {
 
@@ -10,6 +10,7 @@
  ******************************************************************************/
 
 #include <gtest/gtest.h>
+#include <thrill/api/aggregate_by_key.hpp>
 #include <thrill/api/all_gather.hpp>
 #include <thrill/api/generate.hpp>
 #include <thrill/api/reduce_by_key.hpp>
@@ -83,6 +84,8 @@ TEST(ReduceNode, ReduceModulo2CorrectResults) {
         TestReduceModulo2CorrectResults<ReduceTableImpl::BUCKET>());
     api::RunLocalTests(
         TestReduceModulo2CorrectResults<ReduceTableImpl::OLD_PROBING>());
+    api::RunLocalTests(
+        TestReduceModulo2CorrectResults<ReduceTableImpl::SIMD_PROBING>());
 }
 
 //! Test sums of integers 0..n-1 for n=100 in 1000 buckets in the reduce table
@@ -132,9 +135,68 @@ TEST(ReduceNode, ReduceModuloPairsCorrectResults) {
         TestReduceModuloPairsCorrectResults<ReduceTableImpl::BUCKET>());
     api::RunLocalTests(
         TestReduceModuloPairsCorrectResults<ReduceTableImpl::OLD_PROBING>());
+    api::RunLocalTests(
+        TestReduceModuloPairsCorrectResults<ReduceTableImpl::SIMD_PROBING>());
 }
 
+//! ReduceConfig enabling the heavy hitter cache in the pre phase
+template <ReduceTableImpl table_impl>
+class SkewReduceConfig : public core::DefaultReduceConfigSelect<table_impl>
+{
+public:
+    static constexpr bool skew_mode_ = true;
+};
+
+//! Count skewed keys: half of all items have key 0 and a quarter key 1, the
+//! remaining quarter is spread over 250 keys.
 template <ReduceTableImpl table_impl>
+class TestReduceSkewedPairsCorrectResults
+{
+public:
+    void operator () (Context& ctx) {
+        static constexpr size_t test_size = 1000000u;
+        static constexpr size_t mod_size = 1000u;
+
+        using IntPair = std::pair<size_t, size_t>;
+
+        auto integers = Generate(
+            ctx, test_size,
+            [](const size_t& index) {
+                size_t key = index % 2 == 0 ? 0
+                             : index % 4 == 1 ? 1 : index % mod_size;
+                return IntPair(key, 1);
+            });
+
+        auto add_function = [](const size_t& in1, const size_t& in2) {
+                                return in1 + in2;
+                            };
+
+        auto reduced = integers.ReducePair(
+            add_function, SkewReduceConfig<table_impl>());
+
+        std::vector<IntPair> out_vec = reduced.AllGather();
+
+        std::sort(out_vec.begin(), out_vec.end());
+
+        ASSERT_EQ(2u + mod_size / 4, out_vec.size());
+        ASSERT_EQ(IntPair(0, test_size / 2), out_vec[0]);
+        ASSERT_EQ(IntPair(1, test_size / 4), out_vec[1]);
+        for (size_t i = 2; i < out_vec.size(); ++i) {
+            ASSERT_EQ(3u, out_vec[i].first % 4);
+            ASSERT_EQ(test_size / mod_size, out_vec[i].second);
+        }
+    }
+};
+
+TEST(ReduceNode, ReduceSkewedPairsCorrectResults) {
+    api::RunLocalTests(
+        TestReduceSkewedPairsCorrectResults<ReduceTableImpl::PROBING>());
+    api::RunLocalTests(
+        TestReduceSkewedPairsCorrectResults<ReduceTableImpl::BUCKET>());
+}
+
+template <ReduceTableImpl table_impl,
+          typename ReduceConfig = core::DefaultReduceConfigSelect<table_impl> >
 class TestReduceToIndexCorrectResults
 {
 public:
@@ -158,8 +220,7 @@ public:
 
         auto reduced = integers.ReduceToIndex(
             VolatileKeyTag, key, add_function, result_size,
-            /* neutral_element */ size_t(),
-            core::DefaultReduceConfigSelect<table_impl>());
+            /* neutral_element */ size_t(), ReduceConfig());
 
         std::vector<size_t> out_vec = reduced.AllGather();
         ASSERT_EQ(9u, out_vec.size());
@@ -208,6 +269,105 @@ TEST(ReduceNode, ReduceToIndexCorrectResults) {
         TestReduceToIndexCorrectResults<ReduceTableImpl::BUCKET>());
     api::RunLocalTests(
         TestReduceToIndexCorrectResults<ReduceTableImpl::OLD_PROBING>());
+    api::RunLocalTests(
+        TestReduceToIndexCorrectResults<ReduceTableImpl::SIMD_PROBING>());
+    // dense array post phase
+    api::RunLocalTests(
+        TestReduceToIndexCorrectResults<
+            ReduceTableImpl::PROBING, core::DefaultReduceConfig>());
+}
+
+TEST(ReduceNode, AggregateByKeyMeanCorrectResults) {
+
+    auto start_func =
+        [](Context& ctx) {
+            const size_t test_size = 10000;
+            const size_t key_range = 17;
+
+            // accumulator of (sum, count) per key
+            using SumCount = std::pair<size_t, size_t>;
+            using KeyStats = std::pair<size_t, SumCount>;
+
+            auto integers = Generate(
+                ctx, test_size,
+                [](const size_t& index) { return index; });
+
+            auto stats = integers.AggregateByKey(
+                [](const size_t& in) { return in % key_range; },
+                SumCount(0, 0),
+                [](const SumCount& acc, const size_t& in) {
+                    return SumCount(acc.first + in, acc.second + 1);
+                },
+                [](const SumCount& a, const SumCount& b) {
+                    return SumCount(a.first + b.first, a.second + b.second);
+                },
+                [](const size_t& key, const SumCount& acc) {
+                    return KeyStats(key, acc);
+                });
+
+            std::vector<KeyStats> out_vec = stats.AllGather();
+
+            std::sort(out_vec.begin(), out_vec.end());
+
+            ASSERT_EQ(key_range, out_vec.size());
+            for (size_t k = 0; k < key_range; ++k) {
+                size_t sum = 0, count = 0;
+                for (size_t i = k; i < test_size; i += key_range)
+                    sum += i, ++count;
+                ASSERT_EQ(k, out_vec[k].first);
+                ASSERT_EQ(sum, out_vec[k].second.first);
+                ASSERT_EQ(count, out_vec[k].second.second);
+            }
+        };
+
+    api::RunLocalTests(start_func);
+}
+
+TEST(ReduceNode, AggregateByKeyFoldsElementsWithSeqOp) {
+
+    auto start_func =
+        [](Context& ctx) {
+            const size_t test_size = 10000;
+            const size_t key_range = 17;
+
+            // accumulator of (count, number of comb_op calls) per key
+            using CountCombs = std::pair<size_t, size_t>;
+
+            auto integers = Generate(
+                ctx, test_size,
+                [](const size_t& index) { return index; });
+
+            auto counts = integers.AggregateByKey(
+                [](const size_t& in) { return in % key_range; },
+                CountCombs(0, 0),
+                [](const CountCombs& acc, const size_t&) {
+                    return CountCombs(acc.first + 1, acc.second);
+                },
+                [](const CountCombs& a, const CountCombs& b) {
+                    return CountCombs(a.first + b.first,
+                                      a.second + b.second + 1);
+                },
+                [](const size_t& key, const CountCombs& acc) {
+                    return std::make_pair(key, acc);
+                });
+
+            auto out_vec = counts.AllGather();
+
+            std::sort(out_vec.begin(), out_vec.end());
+
+            ASSERT_EQ(key_range, out_vec.size());
+            for (size_t k = 0; k < key_range; ++k) {
+                ASSERT_EQ(k, out_vec[k].first);
+                ASSERT_EQ((test_size - k + key_range - 1) / key_range,
+                          out_vec[k].second.first);
+                // comb_op only merges partial accumulators of workers and
+                // spills, elements are folded in with seq_op.
+                ASSERT_LT(10 * out_vec[k].second.second,
+                          out_vec[k].second.first);
+            }
+        };
+
+    api::RunLocalTests(start_func);
 }
 
 /******************************************************************************/
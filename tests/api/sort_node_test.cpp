@@ -12,10 +12,13 @@
 #include <thrill/api/generate.hpp>
 #include <thrill/api/read_binary.hpp>
 #include <thrill/api/sort.hpp>
+#include <thrill/api/sum.hpp>
 
 #include <gtest/gtest.h>
 
 #include <algorithm>
+#include <array>
+#include <numeric>
 #include <string>
 #include <utility>
 #include <vector>
@@ -80,6 +83,42 @@ TEST(Sort, SortRandomIntegers) {
     api::RunLocalTests(start_func);
 }
 
+TEST(Sort, SortRandomIntegersHelperThreads) {
+
+    static constexpr size_t test_size = 2000000u;
+
+    auto start_func =
+        [](Context& ctx) {
+
+            ASSERT_EQ(1u + 4u, ctx.local_parallelism());
+
+            // pseudo-random integers with many duplicates, which must be
+            // regenerated identically for the Sum() and Sort().
+            auto integers = Generate(
+                ctx, test_size,
+                [](const size_t& index) -> size_t {
+                    return (index * 2654435761u) % 10007;
+                });
+
+            size_t sum = integers.Keep().Sum();
+
+            std::vector<size_t> out_vec = integers.Sort().AllGather();
+
+            ASSERT_EQ(test_size, out_vec.size());
+            ASSERT_TRUE(std::is_sorted(out_vec.begin(), out_vec.end()));
+            ASSERT_EQ(sum,
+                      std::accumulate(out_vec.begin(), out_vec.end(), size_t(0)));
+        };
+
+    // set fixed amount of RAM for testing, and run local sorts with four
+    // helper threads per worker
+    api::MemoryConfig mem_config;
+    mem_config.setup(1024 * 1024 * 1024llu);
+    mem_config.helper_threads_ = 4;
+
+    api::RunLocalMock(mem_config, 2, 1, start_func);
+}
+
 TEST(Sort, SortRandomIntegersCustomCompareFunction) {
 
     auto start_func =
@@ -209,6 +248,62 @@ TEST(Sort, SortZeroToThree) {
     api::RunLocalTests(start_func);
 }
 
+TEST(Sort, SortPresortedIntegers) {
+
+    static constexpr size_t test_size = 100000u;
+
+    auto start_func =
+        [](Context& ctx) {
+
+            // globally sorted input is only redistributed by rank
+            auto integers = Generate(
+                ctx, test_size,
+                [](const size_t& index) -> size_t {
+                    return index / 3;
+                });
+
+            auto sorted = integers.Sort();
+
+            std::vector<size_t> out_vec = sorted.AllGather();
+
+            ASSERT_EQ(test_size, out_vec.size());
+            for (size_t i = 0; i < out_vec.size(); i++) {
+                ASSERT_EQ(i / 3, out_vec[i]);
+            }
+        };
+
+    api::RunLocalTests(start_func);
+}
+
+TEST(Sort, SortNaturalRunsIntegers) {
+
+    static constexpr size_t test_size = 100000u;
+
+    auto start_func =
+        [](Context& ctx) {
+
+            // input consisting of few long ascending runs
+            auto integers = Generate(
+                ctx, test_size,
+                [](const size_t& index) -> size_t {
+                    return (index % 4000) * 32 + index / 4000;
+                });
+
+            auto sorted = integers.Sort();
+
+            std::vector<size_t> out_vec = sorted.AllGather();
+
+            std::vector<size_t> check(test_size);
+            for (size_t i = 0; i < test_size; i++)
+                check[i] = (i % 4000) * 32 + i / 4000;
+            std::sort(check.begin(), check.end());
+
+            ASSERT_EQ(check, out_vec);
+        };
+
+    api::RunLocalTests(start_func);
+}
+
 TEST(Sort, SortWithEmptyWorkers) {
 
     auto start_func =
@@ -257,6 +352,88 @@ TEST(Sort, SortOneInteger) {
     api::RunLocalTests(start_func);
 }
 
+TEST(Sort, SortByKeyIntegers) {
+
+    auto start_func =
+        [](Context& ctx) {
+
+            // deterministic pseudo-random keys with many duplicates
+            auto integers = Generate(
+                ctx, 100000,
+                [](const size_t& index) -> std::pair<uint32_t, size_t> {
+                    return std::make_pair(
+                        static_cast<uint32_t>(index * 2654435761u % 40009u),
+                        index);
+                });
+
+            auto sorted = integers.SortByKey(
+                [](const std::pair<uint32_t, size_t>& p) { return p.first; });
+
+            std::vector<std::pair<uint32_t, size_t> > out_vec =
+                sorted.AllGather();
+
+            ASSERT_EQ(100000u, out_vec.size());
+            for (size_t i = 0; i + 1 < out_vec.size(); i++) {
+                ASSERT_LE(out_vec[i].first, out_vec[i + 1].first);
+            }
+
+            // all items must be present once
+            std::vector<size_t> indexes;
+            for (const auto& p : out_vec) indexes.push_back(p.second);
+            std::sort(indexes.begin(), indexes.end());
+            for (size_t i = 0; i < indexes.size(); i++) {
+                ASSERT_EQ(i, indexes[i]);
+            }
+        };
+
+    api::RunLocalTests(start_func);
+}
+
+//! TeraSort-like record with 10-byte key
+struct KeyRecord {
+    std::array<uint8_t, 10> key;
+    uint32_t                value;
+};
+
+TEST(Sort, SortByKeyByteArrays) {
+
+    auto start_func =
+        [](Context& ctx) {
+
+            auto records = Generate(
+                ctx, 100000,
+                [](const size_t& index) {
+                    std::minstd_rand rng(static_cast<unsigned>(index + 1));
+                    KeyRecord r;
+                    // few distinct first bytes to exercise prefix ties
+                    r.key[0] = static_cast<uint8_t>(rng() % 4);
+                    for (size_t i = 1; i < 10; ++i)
+                        r.key[i] = static_cast<uint8_t>(rng() % 3);
+                    r.value = static_cast<uint32_t>(index);
+                    return r;
+                });
+
+            auto sorted = records.SortByKey(
+                [](const KeyRecord& r) { return r.key; });
+
+            std::vector<KeyRecord> out_vec = sorted.AllGather();
+
+            ASSERT_EQ(100000u, out_vec.size());
+            for (size_t i = 0; i + 1 < out_vec.size(); i++) {
+                ASSERT_FALSE(out_vec[i + 1].key < out_vec[i].key);
+            }
+
+            std::vector<uint32_t> values;
+            for (const KeyRecord& r : out_vec) values.push_back(r.value);
+            std::sort(values.begin(), values.end());
+            for (size_t i = 0; i < values.size(); i++) {
+                ASSERT_EQ(i, values[i]);
+            }
+        };
+
+    api::RunLocalTests(start_func);
+}
+
 TEST(Sort, SortZeroIntegers) {
 
     auto start_func =
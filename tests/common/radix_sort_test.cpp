@@ -13,7 +13,9 @@
 #include <gtest/gtest.h>
 
 #include <algorithm>
+#include <array>
 #include <random>
+#include <utility>
 #include <vector>
 
 using namespace thrill;
@@ -51,4 +53,49 @@ TEST(RadixSort, RandomStrings) {
     ASSERT_TRUE(std::is_sorted(vec.begin(), vec.end()));
 }
 
+TEST(RadixSort, ByKeyIntegersAndByteArrays) {
+
+    std::default_random_engine rng(std::random_device { } ());
+
+    // sort pairs by their 64-bit unsigned first component
+    std::vector<std::pair<uint64_t, size_t> > ints;
+    for (size_t i = 0; i < 100000; ++i)
+        ints.emplace_back(rng() % 100000 * 0x0101010101ull, i);
+
+    auto int_key = [](const std::pair<uint64_t, size_t>& p) { return p.first; };
+    common::RadixSortByKey<decltype(int_key)> int_sorter(int_key);
+    int_sorter(
+        ints.begin(), ints.end(),
+        [](const std::pair<uint64_t, size_t>& a,
+           const std::pair<uint64_t, size_t>& b) { return a.first < b.first; });
+
+    ASSERT_TRUE(std::is_sorted(
+                    ints.begin(), ints.end(),
+                    [](const std::pair<uint64_t, size_t>& a,
+                       const std::pair<uint64_t, size_t>& b) {
+                        return a.first < b.first;
+                    }));
+
+    // sort 10-byte keys and check the prefix comparator against std::array's
+    using Key = std::array<uint8_t, 10>;
+    using RadixKey = common::RadixKey<Key>;
+
+    std::vector<Key> keys(100000);
+    for (Key& k : keys) {
+        for (size_t j = 0; j < 10; ++j)
+            k[j] = static_cast<uint8_t>(rng() % (j < 8 ? 3 : 256));
+    }
+
+    auto key = [](const Key& k) { return k; };
+    common::RadixSortByKey<decltype(key)> key_sorter(key);
+    key_sorter(keys.begin(), keys.end(), &RadixKey::Less);
+
+    ASSERT_TRUE(std::is_sorted(keys.begin(), keys.end()));
+
+    for (size_t i = 0; i + 1 < keys.size(); ++i) {
+        ASSERT_EQ(keys[i] < keys[i + 1], RadixKey::Less(keys[i], keys[i + 1]));
+        ASSERT_EQ(keys[i + 1] < keys[i], RadixKey::Less(keys[i + 1], keys[i]));
+    }
+}
+
 /******************************************************************************/
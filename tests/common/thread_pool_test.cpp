@@ -55,6 +55,42 @@ TEST(ThreadPool1, LoopUntilEmpty) {
     }
 }
 
+TEST(ThreadPool1, RunBatchShared) {
+    size_t num_threads = 4, job_num = 1000;
+
+    ThreadPool pool(4);
+
+    // multiple threads run batches concurrently on the same pool.
+    std::vector<std::vector<size_t> > result(
+        num_threads, std::vector<size_t>(job_num, 0));
+    std::vector<std::thread> threads(num_threads);
+
+    for (size_t t = 0; t != num_threads; ++t) {
+        threads[t] = std::thread(
+            [t, job_num, &pool, &result]() {
+                for (size_t r = 0; r != 16; ++r) {
+                    pool.RunBatch(
+                        job_num, [t, &result](size_t i) { result[t][i] += i; });
+                }
+            });
+    }
+
+    for (size_t t = 0; t != num_threads; ++t)
+        threads[t].join();
+
+    for (size_t t = 0; t != num_threads; ++t) {
+        for (size_t i = 0; i != job_num; ++i)
+            ASSERT_EQ(16 * i, result[t][i]);
+    }
+
+    // batches of zero and one job
+    size_t count = 0;
+    pool.RunBatch(0, [&count](size_t) { ++count; });
+    ASSERT_EQ(0u, count);
+    pool.RunBatch(1, [&count](size_t) { ++count; });
+    ASSERT_EQ(1u, count);
+}
+
 // obfuscated gtest magic to run test with two parameters
 class ThreadPool2 : public ::testing::TestWithParam<int>
 { };
@@ -12,6 +12,7 @@
 #include <thrill/core/reduce_bucket_hash_table.hpp>
 #include <thrill/core/reduce_old_probing_hash_table.hpp>
 #include <thrill/core/reduce_probing_hash_table.hpp>
+#include <thrill/core/reduce_simd_probing_hash_table.hpp>
 
 #include <thrill/core/reduce_pre_phase.hpp>
 
@@ -143,4 +144,11 @@ TEST(ReduceHashTable, OldProbingAddIntegers) {
         });
 }
 
+TEST(ReduceHashTable, SimdProbingAddIntegers) {
+    api::RunLocalSameThread(
+        [](Context& ctx) {
+            TestAddMyStructModulo<core::ReduceSimdProbingHashTable>(ctx);
+        });
+}
+
 /******************************************************************************/
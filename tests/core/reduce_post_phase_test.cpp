@@ -110,6 +110,77 @@ TEST(ReduceHashPhase, ProbingAddMyStructByHash) {
         });
 }
 
+TEST(ReduceHashPhase, SimdProbingAddMyStructByHash) {
+    api::RunLocalSameThread(
+        [](Context& ctx) {
+            TestAddMyStructByHash<core::ReduceTableImpl::SIMD_PROBING>(ctx);
+        });
+}
+
+//! Reduce many keys in little RAM, such that many partitions are spilled and
+//! re-reduced by the helper threads.
+template <core::ReduceTableImpl table_impl>
+static void TestAddManyMyStructByHash(Context& ctx) {
+    static constexpr size_t mod_size = 6011;
+    static constexpr size_t test_size = mod_size * 10;
+    static constexpr size_t val_size = test_size / mod_size;
+
+    auto key_ex = [](const MyStruct& in) {
+                      return in.key % mod_size;
+                  };
+
+    auto red_fn = [](const MyStruct& in1, const MyStruct& in2) {
+                      return MyStruct {
+                                 in1.key, in1.value + in2.value
+                      };
+                  };
+
+    std::vector<MyStruct> result;
+
+    auto emit_fn = [&result](const MyStruct& in) {
+                       result.emplace_back(in);
+                   };
+
+    using Phase = core::ReduceByHashPostPhase<
+              MyStruct, size_t, MyStruct,
+              decltype(key_ex), decltype(red_fn), decltype(emit_fn),
+              /* VolatileKey */ false,
+              core::DefaultReduceConfigSelect<table_impl> >;
+
+    Phase phase(ctx, 0, key_ex, red_fn, emit_fn);
+    phase.Initialize(/* limit_memory_bytes */ 64 * 1024);
+
+    for (size_t i = 0; i < test_size; ++i) {
+        phase.Insert(MyStruct { i, i / mod_size });
+    }
+
+    phase.PushData(/* consume */ true);
+
+    std::sort(result.begin(), result.end());
+
+    ASSERT_EQ(mod_size, result.size());
+
+    for (size_t i = 0; i < result.size(); ++i) {
+        ASSERT_EQ(i, result[i].key);
+        ASSERT_EQ(val_size * (val_size - 1) / 2, result[i].value);
+    }
+}
+
+TEST(ReduceHashPhase, ParallelReReduceAddManyMyStructByHash) {
+    // run post phase with four helper threads
+    api::MemoryConfig mem_config;
+    mem_config.verbose_ = false;
+    mem_config.setup(4 * 1024 * 1024 * 1024llu);
+    mem_config.helper_threads_ = 4;
+
+    api::RunLocalSameThread(
+        mem_config,
+        [](Context& ctx) {
+            TestAddManyMyStructByHash<core::ReduceTableImpl::PROBING>(ctx);
+            TestAddManyMyStructByHash<core::ReduceTableImpl::BUCKET>(ctx);
+        });
+}
+
 /******************************************************************************/
 
 TEST(ReduceHashPhase, PostReduceByIndex) {
@@ -222,10 +293,19 @@ TEST(ReduceHashPhase, ProbingAddMyStructByIndex) {
         });
 }
 
+TEST(ReduceHashPhase, SimdProbingAddMyStructByIndex) {
+    api::RunLocalSameThread(
+        [](Context& ctx) {
+            TestAddMyStructByIndex<core::ReduceTableImpl::SIMD_PROBING>(ctx);
+        });
+}
+
 /******************************************************************************/
 
-template <core::ReduceTableImpl table_impl>
-static void TestAddMyStructByIndexWithHoles(Context& ctx) {
+template <core::ReduceTableImpl table_impl,
+          typename ReduceConfig = core::DefaultReduceConfigSelect<table_impl> >
+static void TestAddMyStructByIndexWithHoles(
+    Context& ctx, size_t limit_memory_bytes = 64 * 1024, bool dense = false) {
     static constexpr bool debug = false;
     static constexpr size_t mod_size = 600;
     static constexpr size_t test_size = mod_size * 100;
@@ -251,13 +331,14 @@ static void TestAddMyStructByIndexWithHoles(Context& ctx) {
     using Phase = core::ReduceByIndexPostPhase<
               MyStruct, size_t, MyStruct,
               decltype(key_ex), decltype(red_fn), decltype(emit_fn), false,
-              core::DefaultReduceConfigSelect<table_impl> >;
+              ReduceConfig>;
 
     Phase phase(ctx, 0, key_ex, red_fn, emit_fn,
                 typename Phase::ReduceConfig(),
                 core::ReduceByIndex<size_t>(0, mod_size),
                 /* neutral_element */ MyStruct { 0, 0 });
-    phase.Initialize(/* limit_memory_bytes */ 64 * 1024);
+    phase.Initialize(limit_memory_bytes);
+    ASSERT_EQ(dense, phase.dense());
 
     for (size_t i = 0; i < test_size; ++i) {
         phase.Insert(MyStruct { i, i / mod_size });
@@ -305,4 +386,31 @@ TEST(ReduceHashPhase, ProbingAddMyStructByIndexWithHoles) {
         });
 }
 
+TEST(ReduceHashPhase, SimdProbingAddMyStructByIndexWithHoles) {
+    api::RunLocalSameThread(
+        [](Context& ctx) {
+            TestAddMyStructByIndexWithHoles<core::ReduceTableImpl::SIMD_PROBING>(ctx);
+        });
+}
+
+TEST(ReduceHashPhase, DenseAddMyStructByIndexWithHoles) {
+    api::RunLocalSameThread(
+        [](Context& ctx) {
+            TestAddMyStructByIndexWithHoles<
+                core::ReduceTableImpl::PROBING, core::DefaultReduceConfig>(
+                ctx, /* limit_memory_bytes */ 64 * 1024, /* dense */ true);
+        });
+}
+
+TEST(ReduceHashPhase, DenseFallbackAddMyStructByIndexWithHoles) {
+    // the index range does not fit into the memory limit, hence the hash
+    // table is used.
+    api::RunLocalSameThread(
+        [](Context& ctx) {
+            TestAddMyStructByIndexWithHoles<
+                core::ReduceTableImpl::PROBING, core::DefaultReduceConfig>(
+                ctx, /* limit_memory_bytes */ 9 * 1024, /* dense */ false);
+        });
+}
+
 /******************************************************************************/
@@ -39,6 +39,12 @@ struct MyReduceConfig : public core::DefaultReduceConfig {
     static constexpr core::ReduceTableImpl table_impl_ = table_impl;
 };
 
+template <core::ReduceTableImpl table_impl>
+struct MySkewReduceConfig : public MyReduceConfig<table_impl> {
+    //! enable the heavy hitter cache
+    static constexpr bool skew_mode_ = true;
+};
+
 /******************************************************************************/
 
 template <core::ReduceTableImpl table_impl>
@@ -126,6 +132,13 @@ TEST(ReducePrePhase, ProbingAddMyStructByHash) {
         });
 }
 
+TEST(ReducePrePhase, SimdProbingAddMyStructByHash) {
+    api::RunLocalSameThread(
+        [](Context& ctx) {
+            TestAddMyStructByHash<core::ReduceTableImpl::SIMD_PROBING>(ctx);
+        });
+}
+
 /******************************************************************************/
 
 template <core::ReduceTableImpl table_impl>
@@ -216,4 +229,97 @@ TEST(ReducePrePhase, ProbingAddMyStructByIndex) {
         });
 }
 
+TEST(ReducePrePhase, SimdProbingAddMyStructByIndex) {
+    api::RunLocalSameThread(
+        [](Context& ctx) {
+            TestAddMyStructByIndex<core::ReduceTableImpl::SIMD_PROBING>(ctx);
+        });
+}
+
+/******************************************************************************/
+
+template <core::ReduceTableImpl table_impl>
+static void TestSkewedMyStructByHash(Context& ctx) {
+    static constexpr size_t mod_size = 601;
+    static constexpr size_t test_size = mod_size * 100;
+
+    auto key_ex = [](const MyStruct& in) {
+                      return in.key;
+                  };
+
+    auto red_fn = [](const MyStruct& in1, const MyStruct& in2) {
+                      return MyStruct {
+                                 in1.key, in1.value + in2.value
+                      };
+                  };
+
+    // collect all items
+    const size_t num_partitions = 13;
+
+    std::vector<data::File> files;
+    for (size_t i = 0; i < num_partitions; ++i)
+        files.emplace_back(ctx.GetFile(nullptr));
+
+    std::vector<data::DynBlockWriter> emitters;
+    for (size_t i = 0; i < num_partitions; ++i)
+        emitters.emplace_back(files[i].GetDynWriter());
+
+    // process items with phase
+    using Phase = core::ReducePrePhase<
+              MyStruct, size_t, MyStruct,
+              decltype(key_ex), decltype(red_fn),
+              /* VolatileKey */ false,
+              MySkewReduceConfig<table_impl> >;
+
+    Phase phase(ctx, 0, num_partitions, key_ex, red_fn, emitters);
+
+    phase.Initialize(/* limit_memory_bytes */ 1024 * 1024);
+
+    // two of three items have the heavy key 0
+    for (size_t i = 0; i < test_size; ++i) {
+        phase.Insert(MyStruct { i % 3 != 0 ? 0 : i % mod_size, 1 });
+    }
+
+    phase.FlushAll();
+
+    // most items of key 0 must have been reduced in the cache
+    ASSERT_GT(phase.num_heavy_hitter_hits(), test_size / 4);
+
+    phase.CloseAll();
+
+    // collect items and check result: key 0 may be emitted by both the cache
+    // and the table, and is reduced later by the post phase.
+    std::vector<size_t> result(mod_size);
+
+    for (size_t i = 0; i < num_partitions; ++i) {
+        data::File::Reader r = files[i].GetReader(/* consume */ true);
+        while (r.HasNext()) {
+            MyStruct s = r.Next<MyStruct>();
+            ASSERT_LT(s.key, mod_size);
+            ASSERT_TRUE(s.key == 0 || result[s.key] == 0);
+            result[s.key] += s.value;
+        }
+    }
+
+    std::vector<size_t> count(mod_size);
+    for (size_t i = 0; i < test_size; ++i)
+        ++count[i % 3 != 0 ? 0 : i % mod_size];
+
+    ASSERT_EQ(count, result);
+}
+
+TEST(ReducePrePhase, BucketSkewedMyStructByHash) {
+    api::RunLocalSameThread(
+        [](Context& ctx) {
+            TestSkewedMyStructByHash<core::ReduceTableImpl::BUCKET>(ctx);
+        });
+}
+
+TEST(ReducePrePhase, ProbingSkewedMyStructByHash) {
+    api::RunLocalSameThread(
+        [](Context& ctx) {
+            TestSkewedMyStructByHash<core::ReduceTableImpl::PROBING>(ctx);
+        });
+}
+
 /******************************************************************************/
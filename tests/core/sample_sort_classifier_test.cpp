@@ -0,0 +1,84 @@
+/*******************************************************************************
+ * tests/core/sample_sort_classifier_test.cpp
+ *
+ * Part of Project Thrill - http://project-thrill.org
+ *
+ * All rights reserved. Published under the BSD-2 license in the LICENSE file.
+ ******************************************************************************/
+
+#include <gtest/gtest.h>
+
+#include <thrill/core/sample_sort_classifier.hpp>
+
+#include <algorithm>
+#include <functional>
+#include <random>
+#include <utility>
+#include <vector>
+
+using namespace thrill; // NOLINT
+
+using Classifier = core::SampleSortClassifier<size_t, std::less<size_t> >;
+using SampleIndexPair = Classifier::SampleIndexPair;
+
+//! classify items with given splitters and compare the bucket ids against
+//! binary search over the (item, index) pairs.
+static void TestClassifier(size_t num_workers, size_t num_items,
+                           size_t max_value) {
+    std::mt19937 rng(num_workers);
+
+    std::vector<size_t> items(num_items);
+    for (size_t& i : items) i = rng() % max_value;
+
+    // sample splitters with global indexes from the items
+    std::vector<SampleIndexPair> splitters;
+    for (size_t i = 1; i < num_workers; ++i) {
+        size_t index = rng() % num_items;
+        splitters.emplace_back(items[index], index);
+    }
+    std::sort(splitters.begin(), splitters.end());
+
+    // add sentinels up to the next power of two
+    size_t log_k = common::IntegerLog2Ceil(num_workers);
+    while (splitters.size() + 1 < (size_t(1) << log_k))
+        splitters.push_back(splitters.back());
+
+    Classifier classifier(splitters.data(), log_k);
+    ASSERT_EQ(size_t(1) << log_k, classifier.num_buckets());
+
+    std::vector<size_t> oracle(num_items);
+    classifier.Classify(items.data(), items.data() + num_items, 0,
+                        oracle.data());
+
+    for (size_t i = 0; i < num_items; ++i) {
+        size_t b = std::lower_bound(
+            splitters.begin(), splitters.end(),
+            SampleIndexPair(items[i], i)) - splitters.begin();
+
+        ASSERT_EQ(b, oracle[i]) << "item " << i;
+        ASSERT_EQ(b, classifier.Classify(items[i], i)) << "item " << i;
+        // the sentinel buckets must stay empty
+        ASSERT_TRUE(b < num_workers - 1 || b == classifier.num_buckets() - 1);
+    }
+}
+
+TEST(SampleSortClassifier, OneBucket) {
+    TestClassifier(1, 1000, 1000);
+}
+
+TEST(SampleSortClassifier, PowerOfTwoBuckets) {
+    TestClassifier(16, 10000, 1000000);
+}
+
+TEST(SampleSortClassifier, SentinelBuckets) {
+    TestClassifier(5, 10001, 1000000);
+    TestClassifier(100, 10003, 1000000);
+}
+
+TEST(SampleSortClassifier, ManyEqualItems) {
+    TestClassifier(7, 10000, 3);
+    TestClassifier(64, 10005, 2);
+    TestClassifier(33, 10000, 1);
+}
+
+/******************************************************************************/
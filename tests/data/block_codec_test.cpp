@@ -0,0 +1,157 @@
+/*******************************************************************************
+ * tests/data/block_codec_test.cpp
+ *
+ * Part of Project Thrill - http://project-thrill.org
+ *
+ * All rights reserved. Published under the BSD-2 license in the LICENSE file.
+ ******************************************************************************/
+
+#include <gtest/gtest.h>
+#include <thrill/data/block.hpp>
+#include <thrill/data/block_codec.hpp>
+#include <thrill/data/block_pool.hpp>
+#include <thrill/data/file.hpp>
+
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace thrill;
+
+using data::BlockCodec;
+using data::Byte;
+
+//! compress and decompress data, returns the compressed size.
+static size_t RoundTrip(const std::vector<Byte>& data) {
+    std::vector<Byte> compressed(data.size() * 2 + 64);
+    size_t size = BlockCodec::Compress(
+        data.data(), data.size(), compressed.data(), compressed.size());
+    EXPECT_NE(0u, size);
+    EXPECT_EQ(size, BlockCodec::CompressedSize(compressed.data()));
+    EXPECT_EQ(data.size(), BlockCodec::DecompressedSize(compressed.data()));
+
+    std::vector<Byte> output(data.size());
+    EXPECT_TRUE(BlockCodec::Decompress(
+                    compressed.data(), compressed.size(),
+                    output.data(), output.size()));
+    EXPECT_EQ(data, output);
+    return size;
+}
+
+TEST(BlockCodec, SmallInputs) {
+    for (size_t n = 0; n < 40; ++n) {
+        std::vector<Byte> data(n);
+        for (size_t i = 0; i < n; ++i) data[i] = static_cast<Byte>(i % 3);
+        RoundTrip(data);
+    }
+}
+
+TEST(BlockCodec, Integers) {
+    std::vector<Byte> data(2 * 1024 * 1024);
+    for (size_t i = 0; i < data.size() / sizeof(size_t); ++i) {
+        size_t x = i;
+        std::memcpy(data.data() + i * sizeof(size_t), &x, sizeof(x));
+    }
+    size_t size = RoundTrip(data);
+    ASSERT_LT(size, data.size() * 3 / 5);
+}
+
+TEST(BlockCodec, Strings) {
+    std::string text;
+    for (size_t i = 0; text.size() < 1024 * 1024; ++i)
+        text += "key_" + std::to_string(i % 1000) + " value,";
+    std::vector<Byte> data(text.begin(), text.end());
+    size_t size = RoundTrip(data);
+    ASSERT_LT(size, data.size() / 3);
+
+    // long runs and overlapping matches
+    std::vector<Byte> run(100000, 'a');
+    ASSERT_LT(RoundTrip(run), 1000u);
+}
+
+TEST(BlockCodec, Incompressible) {
+    std::mt19937 rng(42);
+    std::vector<Byte> data(64 * 1024);
+    for (Byte& b : data) b = static_cast<Byte>(rng());
+    RoundTrip(data);
+
+    // aborts if the output does not fit
+    std::vector<Byte> compressed(data.size() - data.size() / 16);
+    ASSERT_EQ(0u, BlockCodec::Compress(data.data(), data.size(),
+                                       compressed.data(), compressed.size()));
+}
+
+TEST(BlockCodec, DetectsCorruption) {
+    std::vector<Byte> data(4096);
+    for (size_t i = 0; i < data.size(); ++i) data[i] = static_cast<Byte>(i / 7);
+    std::vector<Byte> compressed(8192);
+    size_t size = BlockCodec::Compress(
+        data.data(), data.size(), compressed.data(), compressed.size());
+    ASSERT_NE(0u, size);
+
+    std::vector<Byte> output(data.size());
+    // truncated
+    ASSERT_FALSE(BlockCodec::Decompress(
+                     compressed.data(), size - 1, output.data(), output.size()));
+    // wrong output size
+    ASSERT_FALSE(BlockCodec::Decompress(
+                     compressed.data(), size, output.data(), output.size() - 1));
+}
+
+TEST(BlockCodec, SwapCompressedBlocks) {
+    data::BlockPool block_pool(0, 0, nullptr, nullptr, 1,
+                               data::EvictionPolicyType::LRU,
+                               /* swap_compression */ true);
+    size_t block_size = 64 * 1024;
+
+    data::Block block;
+    {
+        data::PinnedByteBlockPtr bytes =
+            block_pool.AllocateByteBlock(block_size, 0);
+        for (size_t i = 0; i < block_size; ++i)
+            bytes->data()[i] = static_cast<Byte>(i / 100);
+        data::PinnedBlock pinned(std::move(bytes), 0, block_size, 0, 0, false);
+        block = pinned.ToBlock();
+    }
+
+    block_pool.EvictVictim()->wait();
+    ASSERT_FALSE(block.byte_block()->in_memory());
+    ASSERT_EQ(block_size, block_pool.compress_raw_bytes());
+    ASSERT_LT(block_pool.compress_bytes(), block_size / 4);
+
+    data::PinnedBlock pinned = block.PinWait(0);
+    for (size_t i = 0; i < block_size; ++i)
+        ASSERT_EQ(static_cast<Byte>(i / 100), pinned.data_begin()[i]);
+}
+
+TEST(BlockCodec, SwapCompressedFileWithRamLimit) {
+    // a File many times larger than the RAM limit, whose Blocks are
+    // compressed when evicted to make room for new ones.
+    size_t block_size = 64 * 1024;
+    data::BlockPool block_pool(8 * block_size, 16 * block_size, nullptr,
+                               nullptr, 1, data::EvictionPolicyType::LRU,
+                               /* swap_compression */ true);
+
+    size_t old_block_size = data::default_block_size;
+    data::default_block_size = block_size;
+
+    static constexpr size_t num_items = 1024 * 1024;
+    {
+        data::File file(block_pool, 0, /* dia_id */ 0);
+        {
+            data::File::Writer writer = file.GetWriter();
+            for (size_t i = 0; i < num_items; ++i)
+                writer.Put<size_t>(i / 16);
+        }
+        ASSERT_LT(0u, block_pool.compress_raw_bytes());
+
+        data::File::KeepReader reader = file.GetKeepReader();
+        for (size_t i = 0; i < num_items; ++i)
+            ASSERT_EQ(i / 16, reader.Next<size_t>());
+    }
+
+    data::default_block_size = old_block_size;
+}
+
+/******************************************************************************/
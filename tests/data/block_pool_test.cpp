@@ -11,8 +11,12 @@
 #include <gtest/gtest.h>
 #include <thrill/data/block.hpp>
 #include <thrill/data/block_pool.hpp>
+#include <thrill/data/eviction_policy.hpp>
 
+#include <memory>
 #include <string>
+#include <thread>
+#include <vector>
 
 using namespace thrill;
 
@@ -109,4 +113,125 @@ TEST_F(BlockPoolTest, EvictBlock) {
     ASSERT_EQ(0u, block_pool_.writing_blocks() + block_pool_.swapped_blocks());
 }
 
+TEST_F(BlockPoolTest, ConcurrentUnpinAllowsSwapOut) {
+    // threads of one worker copy and release pins concurrently, after which
+    // the block must be unpinned and swappable.
+    for (size_t round = 0; round < 100; ++round) {
+        data::Block unpinned_block;
+        {
+            data::PinnedByteBlockPtr block =
+                block_pool_.AllocateByteBlock(4096, 0);
+            data::PinnedBlock pinned_block(
+                std::move(block), 0, 4096, 0, 0, false);
+            unpinned_block = pinned_block.ToBlock();
+
+            std::vector<std::thread> threads;
+            for (size_t t = 0; t < 4; ++t) {
+                threads.emplace_back(
+                    [pin = pinned_block]() mutable {
+                        for (size_t i = 0; i < 1000; ++i) {
+                            data::PinnedBlock copy = pin;
+                        }
+                    });
+            }
+            pinned_block.Reset();
+            for (std::thread& t : threads) t.join();
+        }
+        ASSERT_EQ(0u, block_pool_.pinned_blocks());
+        ASSERT_EQ(1u, block_pool_.unpinned_blocks());
+        block_pool_.EvictBlock(unpinned_block.byte_block().get());
+    }
+}
+
+//! insert keys 0..9, then pop all and return the victim order.
+static std::vector<int> EvictionOrder(
+    data::EvictionPolicyType type,
+    const std::vector<data::EvictionHint>& hints = { }) {
+    std::unique_ptr<data::EvictionPolicy<int> > policy =
+        data::MakeEvictionPolicy<int>(type);
+    for (int i = 0; i < 10; ++i) {
+        policy->put(i, i < static_cast<int>(hints.size())
+                    ? hints[i] : data::EvictionHint::None);
+    }
+    EXPECT_EQ(10u, policy->size());
+
+    policy->erase(4);
+    EXPECT_FALSE(policy->exists(4));
+    EXPECT_TRUE(policy->exists(5));
+
+    std::vector<int> order;
+    while (policy->size())
+        order.push_back(policy->pop());
+    return order;
+}
+
+TEST(EvictionPolicy, LRU) {
+    ASSERT_EQ(std::vector<int>({ 0, 1, 2, 3, 5, 6, 7, 8, 9 }),
+              EvictionOrder(data::EvictionPolicyType::LRU));
+}
+
+TEST(EvictionPolicy, MRU) {
+    ASSERT_EQ(std::vector<int>({ 9, 8, 7, 6, 5, 3, 2, 1, 0 }),
+              EvictionOrder(data::EvictionPolicyType::MRU));
+}
+
+TEST(EvictionPolicy, CLOCK) {
+    // new keys have no reference bit and are evicted in insertion order.
+    ASSERT_EQ(std::vector<int>({ 0, 1, 2, 3, 5, 6, 7, 8, 9 }),
+              EvictionOrder(data::EvictionPolicyType::CLOCK));
+
+    // a re-pinned key gets a second chance, an erased and re-inserted one
+    // does not.
+    data::ClockEvictionPolicy<int> clock;
+    for (int i = 0; i < 6; ++i)
+        clock.put(i, data::EvictionHint::None);
+    clock.pin(1);
+    ASSERT_FALSE(clock.exists(1));
+    ASSERT_EQ(5u, clock.size());
+    clock.put(1, data::EvictionHint::None);
+    clock.erase(2);
+    clock.put(2, data::EvictionHint::None);
+    ASSERT_EQ(0, clock.pop());
+    ASSERT_EQ(2, clock.pop());
+    ASSERT_EQ(3, clock.pop());
+    ASSERT_EQ(4, clock.pop());
+    ASSERT_EQ(5, clock.pop());
+    ASSERT_EQ(1, clock.pop());
+    ASSERT_EQ(0u, clock.size());
+}
+
+TEST(EvictionPolicy, Hint) {
+    using data::EvictionHint;
+    std::vector<EvictionHint> hints(10, EvictionHint::None);
+    hints[1] = hints[8] = EvictionHint::ConsumedNext;
+    hints[3] = hints[6] = EvictionHint::DeadSoon;
+
+    ASSERT_EQ(std::vector<int>({ 6, 3, 0, 2, 5, 7, 9, 1, 8 }),
+              EvictionOrder(data::EvictionPolicyType::Hint, hints));
+}
+
+TEST(BlockPool, HintedBlocksAreEvictedFirst) {
+    data::BlockPool block_pool(0, 0, nullptr, nullptr, 1,
+                               data::EvictionPolicyType::Hint);
+    std::vector<data::Block> blocks;
+    for (size_t i = 0; i < 3; ++i) {
+        data::PinnedByteBlockPtr bb = block_pool.AllocateByteBlock(4096, 0);
+        data::PinnedBlock pinned(std::move(bb), 0, 4096, 0, 0, false);
+        blocks.emplace_back(pinned.ToBlock());
+    }
+    ASSERT_EQ(3u, block_pool.unpinned_blocks());
+
+    block_pool.HintBlock(blocks[2].byte_block().get(),
+                         data::EvictionHint::ConsumedNext);
+    block_pool.HintBlock(blocks[1].byte_block().get(),
+                         data::EvictionHint::DeadSoon);
+
+    block_pool.EvictVictim()->wait();
+    ASSERT_TRUE(blocks[0].byte_block()->in_memory());
+    ASSERT_FALSE(blocks[1].byte_block()->in_memory());
+    block_pool.EvictVictim()->wait();
+    ASSERT_FALSE(blocks[0].byte_block()->in_memory());
+    ASSERT_TRUE(blocks[2].byte_block()->in_memory());
+}
+
 /******************************************************************************/
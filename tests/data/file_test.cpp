@@ -10,11 +10,13 @@
 
 #include <gtest/gtest.h>
 #include <thrill/common/string.hpp>
+#include <thrill/core/multiway_merge.hpp>
 #include <thrill/data/block_queue.hpp>
 #include <thrill/data/file.hpp>
 
 #include <algorithm>
 #include <functional>
+#include <random>
 #include <string>
 #include <utility>
 #include <vector>
@@ -330,6 +332,105 @@ TEST_F(File, TieGetIndexOfWithDuplicates) {
     }
 }
 
+TEST_F(File, ForecastPrefetchMerge) {
+    static constexpr size_t num_files = 5;
+
+    std::minstd_rand0 rng(0);
+
+    // create sorted runs with small Blocks, items span Block boundaries.
+    std::vector<size_t> all;
+    std::vector<data::File> files;
+    std::vector<std::vector<size_t> > triggers;
+
+    for (size_t f = 0; f < num_files; ++f) {
+        std::vector<size_t> run(100 + rng() % 200);
+        for (size_t& x : run) x = rng() % 10000;
+        std::sort(run.begin(), run.end());
+        all.insert(all.end(), run.begin(), run.end());
+
+        files.emplace_back(block_pool_, 0, /* dia_id */ 0);
+        data::File::Writer fw = files.back().GetWriter(53);
+        for (const size_t& x : run) fw.Put(x);
+        fw.Close();
+
+        triggers.emplace_back(files.back().GetBlockTriggers<size_t>());
+        ASSERT_EQ(files.back().num_blocks(), triggers.back().size());
+
+        // check that the trigger of Block b+1 is the last item beginning in
+        // Blocks 0..b.
+        ASSERT_EQ(run[0], triggers.back()[0]);
+        size_t end = 0;
+        for (size_t b = 0; b + 1 < files.back().num_blocks(); ++b) {
+            end += files.back().ItemsStartIn(b);
+            ASSERT_EQ(run[end - 1], triggers.back()[b + 1]);
+        }
+    }
+    std::sort(all.begin(), all.end());
+
+    std::vector<size_t> schedule = data::ForecastSchedule(
+        triggers.begin(), triggers.end(), std::less<size_t>());
+
+    size_t num_blocks = 0;
+    for (const data::File& f : files) num_blocks += f.num_blocks();
+    ASSERT_EQ(num_blocks, schedule.size());
+
+    // merge runs with forecasting prefetch
+    std::vector<data::File::ConsumeReader> seq;
+    seq.reserve(num_files);
+    for (data::File& f : files)
+        seq.emplace_back(f.GetConsumeReader(0));
+
+    data::ForecastPrefetcher<data::File::ConsumeReader> prefetcher(
+        seq, std::move(schedule), 3);
+
+    auto puller = core::make_multiway_merge_tree<size_t>(
+        seq.begin(), seq.end(), std::less<size_t>());
+
+    std::vector<size_t> merged;
+    while (puller.HasNext())
+        merged.push_back(puller.Next());
+
+    ASSERT_EQ(all, merged);
+    ASSERT_EQ(num_blocks, prefetcher.num_issued() + prefetcher.num_missed());
+}
+
+TEST_F(File, ForecastScheduleAfterLastItemOfBlock) {
+    // determine the serialized size of an item to place two in each Block.
+    data::File probe(block_pool_, 0, /* dia_id */ 0);
+    {
+        data::File::Writer fw = probe.GetWriter();
+        fw.Put(size_t(0));
+    }
+    const size_t block_size = 2 * probe.size_bytes();
+
+    // run A = [1,2 | 100,101 | 102,103], run B = [3,4 | 5,6 | ... | 49,50]
+    std::vector<std::vector<size_t> > runs = {
+        { 1, 2, 100, 101, 102, 103 }, { }
+    };
+    for (size_t x = 3; x <= 50; ++x) runs[1].push_back(x);
+
+    std::vector<std::vector<size_t> > triggers;
+    for (const std::vector<size_t>& run : runs) {
+        data::File file(block_pool_, 0, /* dia_id */ 0);
+        data::File::Writer fw = file.GetWriter(block_size);
+        for (const size_t& x : run) fw.Put(x);
+        fw.Close();
+        ASSERT_EQ(run.size() / 2, file.num_blocks());
+        triggers.emplace_back(file.GetBlockTriggers<size_t>());
+    }
+
+    std::vector<size_t> schedule = data::ForecastSchedule(
+        triggers.begin(), triggers.end(), std::less<size_t>());
+
+    // the first Blocks come first, A's second Block is needed after 2 is
+    // output, hence before B's second Block, and A's third Block last.
+    std::vector<size_t> expected = { 0, 1, 0 };
+    for (size_t b = 1; b < runs[1].size() / 2; ++b) expected.push_back(1);
+    expected.push_back(0);
+
+    ASSERT_EQ(expected, schedule);
+}
+
 TEST_F(File, SeekReadSlicesOfFiles) {
     static constexpr bool debug = false;
 
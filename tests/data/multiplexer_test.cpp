@@ -19,6 +19,7 @@
 #include <thrill/net/mock/group.hpp>
 
 #include <algorithm>
+#include <atomic>
 #include <string>
 #include <vector>
 
@@ -62,6 +63,29 @@ TEST_F(MultiplexerHeaderTest, HeaderIsEnd) {
     ASSERT_TRUE(candidate.IsEnd());
 }
 
+TEST_F(MultiplexerHeaderTest, ParsesAndSerializesCreditHeader) {
+    data::StreamMultiplexerHeader credit =
+        data::StreamMultiplexerHeader::Credit(
+            data::MagicByte::CatStreamCredit, /* stream_id */ 2,
+            /* sender_worker */ 6, /* receiver_local_worker */ 1,
+            /* credits */ 8);
+
+    net::BufferBuilder bb;
+    credit.Serialize(bb);
+    net::Buffer b = bb.ToBuffer();
+
+    net::BufferReader br(b);
+    data::StreamMultiplexerHeader result =
+        data::StreamMultiplexerHeader::Parse(br);
+
+    ASSERT_EQ(data::MagicByte::CatStreamCredit, result.magic);
+    ASSERT_EQ(2u, result.stream_id);
+    ASSERT_EQ(6u, result.sender_worker);
+    ASSERT_EQ(1u, result.receiver_local_worker);
+    ASSERT_EQ(8u, result.credits());
+    ASSERT_FALSE(result.is_last_block);
+}
+
 /******************************************************************************/
 // Multiplexer StreamSet tests
 
@@ -120,11 +144,17 @@ struct Multiplexer : public ::testing::Test {
 
     using WorkerThread = std::function<void(data::Multiplexer&)>;
 
+    //! hard RAM limit of the BlockPools, zero for unlimited
+    static size_t ram_limit_;
+
+    void SetUp() final { ram_limit_ = 0; }
+
     static void FunctionSelect(
         net::Group* group, WorkerThread f1, WorkerThread f2, WorkerThread f3) {
         mem::Manager mem_manager(nullptr, "MultiplexerTest");
         std::string swap_file_suffix = std::to_string(group->my_host_rank());
-        data::BlockPool block_pool;
+        data::BlockPool block_pool(
+            ram_limit_, ram_limit_, nullptr, nullptr, 1);
         data::Multiplexer multiplexer(mem_manager, block_pool, 1, *group);
         switch (group->my_host_rank()) {
         case 0:
@@ -287,6 +317,78 @@ TEST_F(Multiplexer, ReadCompleteCatStream) {
     Execute(w0, w1, w2);
 }
 
+size_t Multiplexer::ram_limit_ = 0;
+
+TEST_F(Multiplexer, CompressedCatStream) {
+    data::default_block_size = 16 * test_block_size;
+    // a RAM limit makes the BlockPool check the compressed Blocks' sizes.
+    ram_limit_ = 64 * data::default_block_size;
+    static constexpr size_t num_items = 100000;
+    auto sender =
+        [](data::Multiplexer& multiplexer) {
+            auto id = multiplexer.AllocateCatStreamId(0);
+            auto c = multiplexer.GetOrCreateCatStream(id, 0, /* dia_id */ 0);
+            c->set_compression(true);
+            auto writers = c->GetWriters();
+            for (size_t i = 0; i < num_items; ++i)
+                writers[2].Put<size_t>(i);
+            for (auto& w : writers) w.Close();
+            ASSERT_LT(0u, c->tx_compress_raw_bytes_.load());
+            ASSERT_LT(c->tx_compress_bytes_, c->tx_compress_raw_bytes_);
+        };
+    auto receiver =
+        [](data::Multiplexer& multiplexer) {
+            auto id = multiplexer.AllocateCatStreamId(0);
+            auto c = multiplexer.GetOrCreateCatStream(id, 0, /* dia_id */ 0);
+            auto writers = c->GetWriters();
+            for (auto& w : writers) w.Close();
+
+            auto reader = c->GetCatReader(true);
+            for (size_t w = 0; w < 2; ++w) {
+                for (size_t i = 0; i < num_items; ++i) {
+                    ASSERT_TRUE(reader.HasNext());
+                    ASSERT_EQ(i, reader.Next<size_t>());
+                }
+            }
+            ASSERT_FALSE(reader.HasNext());
+        };
+    Execute(sender, sender, receiver);
+}
+
+TEST_F(Multiplexer, CatStreamCreditsCloseBeforeRead) {
+    // a RAM limit requires aligned Blocks, and makes the receivers spill.
+    data::default_block_size = 4 * test_block_size;
+    ram_limit_ = 64 * data::default_block_size;
+    // many more Blocks than the credit window to each worker.
+    static constexpr size_t num_items = 20000;
+    static std::atomic<size_t> spilled_blocks { 0 };
+    spilled_blocks = 0;
+    auto worker =
+        [](data::Multiplexer& multiplexer) {
+            auto id = multiplexer.AllocateCatStreamId(0);
+            auto c = multiplexer.GetOrCreateCatStream(id, 0, /* dia_id */ 0);
+            auto writers = c->GetWriters();
+            for (size_t i = 0; i < num_items; ++i) {
+                for (auto& w : writers) w.Put<size_t>(i);
+            }
+            // all workers close their writers before reading: this must not
+            // wait for credits granted by the readers.
+            for (auto& w : writers) w.Close();
+
+            auto reader = c->GetCatReader(true);
+            for (size_t w = 0; w < 3; ++w) {
+                for (size_t i = 0; i < num_items; ++i) {
+                    ASSERT_TRUE(reader.HasNext());
+                    ASSERT_EQ(i, reader.Next<size_t>());
+                }
+            }
+            ASSERT_FALSE(reader.HasNext());
+            spilled_blocks += c->rx_net_spilled_blocks_;
+        };
+    Execute(worker, worker, worker);
+    ASSERT_LT(0u, spilled_blocks.load());
+}
+
 TEST_F(Multiplexer, ReadCompleteCatStreamManyTimes) {
     data::default_block_size = test_block_size;
     auto w0 =
@@ -458,6 +560,40 @@ TEST_F(Multiplexer, ReadCompleteMixStreamManyTimes) {
     Execute(w0, w1, w2);
 }
 
+TEST_F(Multiplexer, MixStreamCreditsCloseBeforeRead) {
+    // a RAM limit requires aligned Blocks, and makes the receivers spill.
+    data::default_block_size = 4 * test_block_size;
+    ram_limit_ = 64 * data::default_block_size;
+    // many more Blocks than the credit window to each worker.
+    static constexpr size_t num_items = 20000;
+    static std::atomic<size_t> spilled_blocks { 0 };
+    spilled_blocks = 0;
+    auto worker =
+        [](data::Multiplexer& multiplexer) {
+            auto id = multiplexer.AllocateMixStreamId(0);
+            auto c = multiplexer.GetOrCreateMixStream(id, 0, /* dia_id */ 0);
+            auto writers = c->GetWriters();
+            for (size_t i = 0; i < num_items; ++i) {
+                for (auto& w : writers) w.Put<size_t>(i);
+            }
+            // all workers close their writers before reading: this must not
+            // wait for credits granted by the readers.
+            for (auto& w : writers) w.Close();
+
+            auto reader = c->GetMixReader(true);
+            size_t count = 0, sum = 0;
+            while (reader.HasNext()) {
+                sum += reader.Next<size_t>();
+                ++count;
+            }
+            ASSERT_EQ(3 * num_items, count);
+            ASSERT_EQ(3 * num_items * (num_items - 1) / 2, sum);
+            spilled_blocks += c->rx_net_spilled_blocks_;
+        };
+    Execute(worker, worker, worker);
+    ASSERT_LT(0u, spilled_blocks.load());
+}
+
 // open a Stream via data::Multiplexer, and send a short message to all workers,
 // receive and check the message.
 void TalkAllToAllViaMixStream(net::Group* net) {
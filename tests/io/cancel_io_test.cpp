@@ -15,11 +15,13 @@
 #include <thrill/common/cmdline_parser.hpp>
 #include <thrill/io/create_file.hpp>
 #include <thrill/io/file_base.hpp>
+#include <thrill/io/iouring_queue.hpp>
 #include <thrill/io/request_operations.hpp>
 #include <thrill/io/syscall_file.hpp>
 #include <thrill/mem/aligned_allocator.hpp>
 
 #include <cstring>
+#include <string>
 #include <vector>
 
 static constexpr bool debug = false;
@@ -39,6 +41,13 @@ int main(int argc, char** argv) {
         return -1;
     }
 
+#if THRILL_HAVE_IOURING_FILE
+    if (std::string(argv[1]) == "iouring" && !io::IoUringQueue::IsSupported()) {
+        LOG1 << "io_uring is not permitted by the kernel, skipping test.";
+        return 0;
+    }
+#endif
+
     const uint64_t size = 4 * 1024 * 1024, num_blocks = 16;
     char* buffer = static_cast<char*>(mem::aligned_alloc(size));
     memset(buffer, 0, size);
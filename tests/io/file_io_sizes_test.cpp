@@ -15,9 +15,12 @@
 #include <thrill/io/create_file.hpp>
 #include <thrill/io/file_base.hpp>
 #include <thrill/io/iostats.hpp>
+#include <thrill/io/iouring_queue.hpp>
 #include <thrill/io/request_operations.hpp>
 #include <thrill/mem/aligned_allocator.hpp>
 
+#include <string>
+
 static constexpr bool debug = false;
 
 using namespace thrill;
@@ -29,6 +32,13 @@ int main(int argc, char** argv) {
         return -1;
     }
 
+#if THRILL_HAVE_IOURING_FILE
+    if (std::string(argv[1]) == "iouring" && !io::IoUringQueue::IsSupported()) {
+        LOG1 << "io_uring is not permitted by the kernel, skipping test.";
+        return 0;
+    }
+#endif
+
     size_t max_size = atoi(argv[3]);
     uint64_t* buffer = reinterpret_cast<uint64_t*>(mem::aligned_alloc(max_size));
 
@@ -0,0 +1,198 @@
+/*******************************************************************************
+ * tests/net/hybrid_test.cpp
+ *
+ * Part of Project Thrill - http://project-thrill.org
+ *
+ * All rights reserved. Published under the BSD-2 license in the LICENSE file.
+ ******************************************************************************/
+
+#include <gtest/gtest.h>
+#include <thrill/mem/manager.hpp>
+#include <thrill/net/dispatcher_thread.hpp>
+#include <thrill/net/hybrid/construct.hpp>
+#include <thrill/net/hybrid/group.hpp>
+
+#include <algorithm>
+#include <functional>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "flow_control_test_base.hpp"
+#include "group_test_base.hpp"
+
+using namespace thrill;      // NOLINT
+
+//! three nodes with two processes each.
+static void HybridGroupTest(
+    const std::function<void(net::Group*)>& thread_function) {
+    net::ExecuteGroupThreads(
+        net::hybrid::Group::ConstructLoopbackMesh(6, 2),
+        thread_function);
+}
+
+//! two nodes with three processes each, and the smallest rings.
+static void SmallHybridGroupTest(
+    const std::function<void(net::Group*)>& thread_function) {
+    net::ExecuteGroupThreads(
+        net::hybrid::Group::ConstructLoopbackMesh(6, 3, 4096),
+        thread_function);
+}
+
+/*[[[perl
+  require("tests/net/test_gen.pm");
+  generate_group_tests("HybridGroup", "HybridGroupTest");
+  generate_flow_control_tests("HybridGroup", "HybridGroupTest");
+  ]]]*/
+TEST(HybridGroup, NoOperation) {
+    HybridGroupTest(TestNoOperation);
+}
+TEST(HybridGroup, SendRecvCyclic) {
+    HybridGroupTest(TestSendRecvCyclic);
+}
+TEST(HybridGroup, BroadcastIntegral) {
+    HybridGroupTest(TestBroadcastIntegral);
+}
+TEST(HybridGroup, SendReceiveAll2All) {
+    HybridGroupTest(TestSendReceiveAll2All);
+}
+TEST(HybridGroup, PrefixSumHypercube) {
+    HybridGroupTest(TestPrefixSumHypercube);
+}
+TEST(HybridGroup, PrefixSumHypercubeString) {
+    HybridGroupTest(TestPrefixSumHypercubeString);
+}
+TEST(HybridGroup, PrefixSum) {
+    HybridGroupTest(TestPrefixSum);
+}
+TEST(HybridGroup, Broadcast) {
+    HybridGroupTest(TestBroadcast);
+}
+TEST(HybridGroup, Reduce) {
+    HybridGroupTest(TestReduce);
+}
+TEST(HybridGroup, ReduceString) {
+    HybridGroupTest(TestReduceString);
+}
+TEST(HybridGroup, AllReduceString) {
+    HybridGroupTest(TestAllReduceString);
+}
+TEST(HybridGroup, AllReduceHypercubeString) {
+    HybridGroupTest(TestAllReduceHypercubeString);
+}
+TEST(HybridGroup, DispatcherSyncSendAsyncRead) {
+    HybridGroupTest(TestDispatcherSyncSendAsyncRead);
+}
+TEST(HybridGroup, DispatcherLaunchAndTerminate) {
+    HybridGroupTest(TestDispatcherLaunchAndTerminate);
+}
+TEST(HybridGroup, SingleThreadPrefixSum) {
+    HybridGroupTest(TestSingleThreadPrefixSum);
+}
+TEST(HybridGroup, SingleThreadVectorPrefixSum) {
+    HybridGroupTest(TestSingleThreadVectorPrefixSum);
+}
+TEST(HybridGroup, SingleThreadBroadcast) {
+    HybridGroupTest(TestSingleThreadBroadcast);
+}
+TEST(HybridGroup, MultiThreadBroadcast) {
+    HybridGroupTest(TestMultiThreadBroadcast);
+}
+TEST(HybridGroup, MultiThreadReduce) {
+    HybridGroupTest(TestMultiThreadReduce);
+}
+TEST(HybridGroup, SingleThreadAllReduce) {
+    HybridGroupTest(TestSingleThreadAllReduce);
+}
+TEST(HybridGroup, MultiThreadAllReduce) {
+    HybridGroupTest(TestMultiThreadAllReduce);
+}
+TEST(HybridGroup, MultiThreadPrefixSum) {
+    HybridGroupTest(TestMultiThreadPrefixSum);
+}
+TEST(HybridGroup, PredecessorManyItems) {
+    HybridGroupTest(TestPredecessorManyItems);
+}
+TEST(HybridGroup, PredecessorFewItems) {
+    HybridGroupTest(TestPredecessorFewItems);
+}
+TEST(HybridGroup, PredecessorOneItem) {
+    HybridGroupTest(TestPredecessorOneItem);
+}
+TEST(HybridGroup, HardcoreRaceConditionTest) {
+    HybridGroupTest(TestHardcoreRaceConditionTest);
+}
+// [[[end]]]
+
+//! exchange a series of large blocks between all hosts via both transports.
+static void TestDispatcherAsyncWriteRead(net::Group* net) {
+    static constexpr size_t num_blocks = 16;
+    static constexpr size_t block_size = 256 * 1024;
+
+    mem::Manager mem_manager(nullptr, "Dispatcher");
+    std::unique_ptr<net::Dispatcher> dispatcher =
+        net->ConstructDispatcher(mem_manager);
+
+    size_t written = 0, received = 0;
+    size_t my_rank = net->my_host_rank();
+
+    for (size_t i = 0; i != net->num_hosts(); ++i)
+    {
+        if (i == my_rank) continue;
+
+        for (size_t b = 0; b < num_blocks; ++b) {
+            net::Buffer buffer(block_size);
+            std::fill(buffer.begin(), buffer.end(),
+                      static_cast<net::Buffer::value_type>(my_rank + b));
+
+            dispatcher->AsyncWrite(
+                net->connection(i), std::move(buffer),
+                [&written](net::Connection&) { ++written; });
+
+            dispatcher->AsyncRead(
+                net->connection(i), block_size,
+                [i, b, &received](net::Connection&, net::Buffer&& buffer) {
+                    ASSERT_EQ(block_size, buffer.size());
+                    net::Buffer::value_type v =
+                        static_cast<net::Buffer::value_type>(i + b);
+                    for (const auto& x : buffer) ASSERT_EQ(v, x);
+                    ++received;
+                });
+        }
+    }
+
+    size_t expected = (net->num_hosts() - 1) * num_blocks;
+    while (written < expected || received < expected) {
+        dispatcher->Dispatch();
+    }
+}
+
+TEST(HybridGroup, DispatcherAsyncWriteRead) {
+    HybridGroupTest(TestDispatcherAsyncWriteRead);
+}
+TEST(SmallHybridGroup, DispatcherAsyncWriteRead) {
+    SmallHybridGroupTest(TestDispatcherAsyncWriteRead);
+}
+TEST(SmallHybridGroup, SendReceiveAll2All) {
+    SmallHybridGroupTest(TestSendReceiveAll2All);
+}
+TEST(SmallHybridGroup, AllReduceHypercubeString) {
+    SmallHybridGroupTest(TestAllReduceHypercubeString);
+}
+
+TEST(HybridGroup, SameHostPeers) {
+    std::vector<std::string> endpoints = {
+        "node1:10000", "node1:10001", "node2:10000", "node1:10002",
+        "node2:10001", "[::1]:10000", "[::1]:10001"
+    };
+
+    using Mask = std::vector<bool>;
+    ASSERT_EQ(Mask({ false, true, false, true, false, false, false }),
+              net::hybrid::SameHostPeers(0, endpoints));
+    ASSERT_EQ(Mask({ false, false, false, false, true, false, false }),
+              net::hybrid::SameHostPeers(2, endpoints));
+    ASSERT_EQ(Mask({ false, false, false, false, false, false, true }),
+              net::hybrid::SameHostPeers(5, endpoints));
+}
+
+/******************************************************************************/
@@ -0,0 +1,183 @@
+/*******************************************************************************
+ * tests/net/shm_test.cpp
+ *
+ * Part of Project Thrill - http://project-thrill.org
+ *
+ * All rights reserved. Published under the BSD-2 license in the LICENSE file.
+ ******************************************************************************/
+
+#include <gtest/gtest.h>
+#include <thrill/mem/manager.hpp>
+#include <thrill/net/dispatcher_thread.hpp>
+#include <thrill/net/shm/group.hpp>
+
+#include <algorithm>
+#include <functional>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "flow_control_test_base.hpp"
+#include "group_test_base.hpp"
+
+using namespace thrill;      // NOLINT
+
+static void ShmGroupTest(
+    const std::function<void(net::Group*)>& thread_function) {
+    // execute shared memory tests
+    net::ExecuteGroupThreads(
+        net::shm::Group::ConstructLoopbackMesh(6),
+        thread_function);
+}
+
+//! with the smallest rings, most messages wrap around and fill the Rings.
+static void SmallShmGroupTest(
+    const std::function<void(net::Group*)>& thread_function) {
+    net::ExecuteGroupThreads(
+        net::shm::Group::ConstructLoopbackMesh(4, 4096),
+        thread_function);
+}
+
+/*[[[perl
+  require("tests/net/test_gen.pm");
+  generate_group_tests("ShmGroup", "ShmGroupTest");
+  generate_flow_control_tests("ShmGroup", "ShmGroupTest");
+  ]]]*/
+TEST(ShmGroup, NoOperation) {
+    ShmGroupTest(TestNoOperation);
+}
+TEST(ShmGroup, SendRecvCyclic) {
+    ShmGroupTest(TestSendRecvCyclic);
+}
+TEST(ShmGroup, BroadcastIntegral) {
+    ShmGroupTest(TestBroadcastIntegral);
+}
+TEST(ShmGroup, SendReceiveAll2All) {
+    ShmGroupTest(TestSendReceiveAll2All);
+}
+TEST(ShmGroup, PrefixSumHypercube) {
+    ShmGroupTest(TestPrefixSumHypercube);
+}
+TEST(ShmGroup, PrefixSumHypercubeString) {
+    ShmGroupTest(TestPrefixSumHypercubeString);
+}
+TEST(ShmGroup, PrefixSum) {
+    ShmGroupTest(TestPrefixSum);
+}
+TEST(ShmGroup, Broadcast) {
+    ShmGroupTest(TestBroadcast);
+}
+TEST(ShmGroup, Reduce) {
+    ShmGroupTest(TestReduce);
+}
+TEST(ShmGroup, ReduceString) {
+    ShmGroupTest(TestReduceString);
+}
+TEST(ShmGroup, AllReduceString) {
+    ShmGroupTest(TestAllReduceString);
+}
+TEST(ShmGroup, AllReduceHypercubeString) {
+    ShmGroupTest(TestAllReduceHypercubeString);
+}
+TEST(ShmGroup, DispatcherSyncSendAsyncRead) {
+    ShmGroupTest(TestDispatcherSyncSendAsyncRead);
+}
+TEST(ShmGroup, DispatcherLaunchAndTerminate) {
+    ShmGroupTest(TestDispatcherLaunchAndTerminate);
+}
+TEST(ShmGroup, SingleThreadPrefixSum) {
+    ShmGroupTest(TestSingleThreadPrefixSum);
+}
+TEST(ShmGroup, SingleThreadVectorPrefixSum) {
+    ShmGroupTest(TestSingleThreadVectorPrefixSum);
+}
+TEST(ShmGroup, SingleThreadBroadcast) {
+    ShmGroupTest(TestSingleThreadBroadcast);
+}
+TEST(ShmGroup, MultiThreadBroadcast) {
+    ShmGroupTest(TestMultiThreadBroadcast);
+}
+TEST(ShmGroup, MultiThreadReduce) {
+    ShmGroupTest(TestMultiThreadReduce);
+}
+TEST(ShmGroup, SingleThreadAllReduce) {
+    ShmGroupTest(TestSingleThreadAllReduce);
+}
+TEST(ShmGroup, MultiThreadAllReduce) {
+    ShmGroupTest(TestMultiThreadAllReduce);
+}
+TEST(ShmGroup, MultiThreadPrefixSum) {
+    ShmGroupTest(TestMultiThreadPrefixSum);
+}
+TEST(ShmGroup, PredecessorManyItems) {
+    ShmGroupTest(TestPredecessorManyItems);
+}
+TEST(ShmGroup, PredecessorFewItems) {
+    ShmGroupTest(TestPredecessorFewItems);
+}
+TEST(ShmGroup, PredecessorOneItem) {
+    ShmGroupTest(TestPredecessorOneItem);
+}
+TEST(ShmGroup, HardcoreRaceConditionTest) {
+    ShmGroupTest(TestHardcoreRaceConditionTest);
+}
+// [[[end]]]
+
+//! exchange a series of large blocks between all hosts, which requires many
+//! eventfd wakeups per block.
+static void TestDispatcherAsyncWriteRead(net::Group* net) {
+    static constexpr size_t num_blocks = 16;
+    static constexpr size_t block_size = 256 * 1024;
+
+    mem::Manager mem_manager(nullptr, "Dispatcher");
+    std::unique_ptr<net::Dispatcher> dispatcher =
+        net->ConstructDispatcher(mem_manager);
+
+    size_t written = 0, received = 0;
+    size_t my_rank = net->my_host_rank();
+
+    for (size_t i = 0; i != net->num_hosts(); ++i)
+    {
+        if (i == my_rank) continue;
+
+        for (size_t b = 0; b < num_blocks; ++b) {
+            net::Buffer buffer(block_size);
+            std::fill(buffer.begin(), buffer.end(),
+                      static_cast<net::Buffer::value_type>(my_rank + b));
+
+            dispatcher->AsyncWrite(
+                net->connection(i), std::move(buffer),
+                [&written](net::Connection&) { ++written; });
+
+            dispatcher->AsyncRead(
+                net->connection(i), block_size,
+                [i, b, &received](net::Connection&, net::Buffer&& buffer) {
+                    ASSERT_EQ(block_size, buffer.size());
+                    net::Buffer::value_type v =
+                        static_cast<net::Buffer::value_type>(i + b);
+                    for (const auto& x : buffer) ASSERT_EQ(v, x);
+                    ++received;
+                });
+        }
+    }
+
+    size_t expected = (net->num_hosts() - 1) * num_blocks;
+    while (written < expected || received < expected) {
+        dispatcher->Dispatch();
+    }
+}
+
+TEST(ShmGroup, DispatcherAsyncWriteRead) {
+    ShmGroupTest(TestDispatcherAsyncWriteRead);
+}
+TEST(SmallShmGroup, DispatcherAsyncWriteRead) {
+    SmallShmGroupTest(TestDispatcherAsyncWriteRead);
+}
+TEST(SmallShmGroup, SendReceiveAll2All) {
+    SmallShmGroupTest(TestSendReceiveAll2All);
+}
+TEST(SmallShmGroup, AllReduceHypercubeString) {
+    SmallShmGroupTest(TestAllReduceHypercubeString);
+}
+
+/******************************************************************************/
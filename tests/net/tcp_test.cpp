@@ -11,9 +11,12 @@
 #include <gtest/gtest.h>
 #include <thrill/mem/manager.hpp>
 #include <thrill/net/dispatcher_thread.hpp>
+#include <thrill/net/tcp/epoll_dispatcher.hpp>
 #include <thrill/net/tcp/group.hpp>
 #include <thrill/net/tcp/select_dispatcher.hpp>
 
+#include <algorithm>
+#include <functional>
 #include <random>
 #include <string>
 #include <thread>
@@ -169,4 +172,141 @@ TEST(LocalTcpGroup, HardcoreRaceConditionTest) {
 }
 // [[[end]]]
 
+//! exchange many small messages between all hosts, which the tcp::Connection
+//! coalesces into few sendmsg() calls and serves from its read-ahead buffer.
+static void TestDispatcherSmallMessages(
+    net::Group* net, net::tcp::Group::DispatcherType type,
+    size_t zerocopy_min_size) {
+    static constexpr size_t num_msgs = 2000;
+
+    mem::Manager mem_manager(nullptr, "Dispatcher");
+    std::unique_ptr<net::Dispatcher> dispatcher =
+        net::tcp::Group::ConstructDispatcher(
+            mem_manager, type, zerocopy_min_size);
+
+    using value_type = net::Buffer::value_type;
+    auto msg_size = [](size_t m) { return m % 97 + 1; };
+
+    size_t written = 0, received = 0;
+    size_t my_rank = net->my_host_rank();
+
+    // reads are issued one at a time by the callbacks, like the Multiplexer
+    // does, hence many are completed from the read-ahead buffer.
+    std::function<void(size_t, size_t)> read_next =
+        [&](size_t peer, size_t m) {
+            dispatcher->AsyncRead(
+                net->connection(peer), msg_size(m),
+                [&, peer, m](net::Connection&, net::Buffer&& buffer) {
+                    ASSERT_EQ(msg_size(m), buffer.size());
+                    value_type v = static_cast<value_type>(peer + m);
+                    for (const auto& x : buffer) ASSERT_EQ(v, x);
+                    ++received;
+                    if (m + 1 < num_msgs) read_next(peer, m + 1);
+                });
+        };
+
+    for (size_t i = 0; i != net->num_hosts(); ++i)
+    {
+        if (i == my_rank) continue;
+
+        for (size_t m = 0; m < num_msgs; ++m) {
+            net::Buffer buffer(msg_size(m));
+            std::fill(buffer.begin(), buffer.end(),
+                      static_cast<value_type>(my_rank + m));
+
+            dispatcher->AsyncWrite(
+                net->connection(i), std::move(buffer),
+                [&written](net::Connection&) { ++written; });
+        }
+
+        read_next(i, 0);
+    }
+
+    size_t expected = (net->num_hosts() - 1) * num_msgs;
+    while (written < expected || received < expected) {
+        dispatcher->Dispatch();
+    }
+}
+
+TEST(LocalTcpGroup, SelectDispatcherSmallMessages) {
+    LocalGroupTest(
+        [](net::Group* net) {
+            TestDispatcherSmallMessages(
+                net, net::tcp::Group::DispatcherType::Select, 0);
+        });
+}
+
+#if THRILL_HAVE_NET_EPOLL
+
+TEST(LocalTcpGroup, EPollDispatcherSmallMessages) {
+    LocalGroupTest(
+        [](net::Group* net) {
+            TestDispatcherSmallMessages(
+                net, net::tcp::Group::DispatcherType::EPoll, 0);
+        });
+}
+
+//! MSG_ZEROCOPY is silently disabled if the kernel does not support it.
+TEST(RealTcpGroup, EPollDispatcherSmallMessagesZeroCopy) {
+    RealGroupTest(
+        [](net::Group* net) {
+            TestDispatcherSmallMessages(
+                net, net::tcp::Group::DispatcherType::EPoll, 64);
+        });
+}
+
+//! exchange a series of large blocks between all hosts using the
+//! EPollDispatcher, which requires many edge-triggered wakeups per block.
+static void TestEPollDispatcherAsyncWriteRead(net::Group* net) {
+    static constexpr size_t num_blocks = 16;
+    static constexpr size_t block_size = 1024 * 1024;
+
+    mem::Manager mem_manager(nullptr, "Dispatcher");
+    std::unique_ptr<net::Dispatcher> dispatcher =
+        net::tcp::Group::ConstructDispatcher(
+            mem_manager, net::tcp::Group::DispatcherType::EPoll);
+
+    size_t written = 0, received = 0;
+    size_t my_rank = net->my_host_rank();
+
+    for (size_t i = 0; i != net->num_hosts(); ++i)
+    {
+        if (i == my_rank) continue;
+
+        for (size_t b = 0; b < num_blocks; ++b) {
+            net::Buffer buffer(block_size);
+            std::fill(buffer.begin(), buffer.end(),
+                      static_cast<net::Buffer::value_type>(my_rank + b));
+
+            dispatcher->AsyncWrite(
+                net->connection(i), std::move(buffer),
+                [&written](net::Connection&) { ++written; });
+
+            dispatcher->AsyncRead(
+                net->connection(i), block_size,
+                [i, b, &received](net::Connection&, net::Buffer&& buffer) {
+                    ASSERT_EQ(block_size, buffer.size());
+                    net::Buffer::value_type v =
+                        static_cast<net::Buffer::value_type>(i + b);
+                    for (const auto& x : buffer) ASSERT_EQ(v, x);
+                    ++received;
+                });
+        }
+    }
+
+    size_t expected = (net->num_hosts() - 1) * num_blocks;
+    while (written < expected || received < expected) {
+        dispatcher->Dispatch();
+    }
+}
+
+TEST(RealTcpGroup, EPollDispatcherAsyncWriteRead) {
+    RealGroupTest(TestEPollDispatcherAsyncWriteRead);
+}
+TEST(LocalTcpGroup, EPollDispatcherAsyncWriteRead) {
+    LocalGroupTest(TestEPollDispatcherAsyncWriteRead);
+}
+
+#endif // THRILL_HAVE_NET_EPOLL
+
 /******************************************************************************/
@@ -0,0 +1,120 @@
+/*******************************************************************************
+ * thrill/api/aggregate_by_key.hpp
+ *
+ * AggregateByKey: combinable grouping with an accumulator type different from
+ * the input type, implemented on top of the ReduceNode.
+ *
+ * Part of Project Thrill - http://project-thrill.org
+ *
+ * All rights reserved. Published under the BSD-2 license in the LICENSE file.
+ ******************************************************************************/
+
+#pragma once
+#ifndef THRILL_API_AGGREGATE_BY_KEY_HEADER
+#define THRILL_API_AGGREGATE_BY_KEY_HEADER
+
+#include <thrill/api/dia.hpp>
+#include <thrill/api/reduce_by_key.hpp>
+#include <thrill/common/functional.hpp>
+
+#include <functional>
+#include <type_traits>
+#include <utility>
+
+namespace thrill {
+namespace api {
+
+/*!
+ * AggregateByKey is a ReduceNode on (key, accumulator) pairs with a custom
+ * PreOp: each element is folded with seq_op into the accumulator of its key in
+ * the pre phase table, starting from init for new keys. comb_op only merges
+ * partial accumulators, which are spilled or sent to the post phase. The final
+ * pairs are mapped with finalize as a LOp on the result.
+ */
+template <typename ValueType, typename Stack>
+template <typename KeyExtractor, typename Accumulator,
+          typename SeqFunction, typename CombFunction,
+          typename FinalizeFunction, typename ReduceConfig>
+auto DIA<ValueType, Stack>::AggregateByKey(
+    const KeyExtractor &key_extractor,
+    const Accumulator &init,
+    const SeqFunction &seq_op,
+    const CombFunction &comb_op,
+    const FinalizeFunction &finalize,
+    const ReduceConfig &reduce_config) const {
+    assert(IsValid());
+
+    using Key = typename common::FunctionTraits<KeyExtractor>::result_type;
+
+    static_assert(
+        std::is_convertible<
+            ValueType,
+            typename common::FunctionTraits<KeyExtractor>::template arg<0>
+            >::value,
+        "KeyExtractor has the wrong input type");
+
+    static_assert(
+        std::is_convertible<
+            ValueType,
+            typename common::FunctionTraits<SeqFunction>::template arg<1>
+            >::value,
+        "SeqFunction has the wrong element input type");
+
+    static_assert(
+        std::is_same<
+            typename common::FunctionTraits<SeqFunction>::result_type,
+            Accumulator>::value,
+        "SeqFunction must return the Accumulator type");
+
+    static_assert(
+        std::is_same<
+            typename common::FunctionTraits<CombFunction>::result_type,
+            Accumulator>::value,
+        "CombFunction must return the Accumulator type");
+
+    using KeyAccumulator = std::pair<Key, Accumulator>;
+
+    auto pair_key_extractor =
+        [](const KeyAccumulator& ka) { return ka.first; };
+
+    auto comb_pair_function =
+        [comb_op](const KeyAccumulator& a, const KeyAccumulator& b) {
+            return KeyAccumulator(a.first, comb_op(a.second, b.second));
+        };
+
+    auto pre_op =
+        [key_extractor, init, seq_op](auto& pre_phase, const ValueType& value) {
+            Key key = key_extractor(value);
+            pre_phase.InsertWith(
+                key,
+                [&]() { return KeyAccumulator(key, seq_op(init, value)); },
+                [&](KeyAccumulator& ka) {
+                    ka.second = seq_op(ka.second, value);
+                });
+        };
+
+    auto finalize_function =
+        [finalize](const KeyAccumulator& ka) {
+            return finalize(ka.first, ka.second);
+        };
+
+    using ReduceNode = api::ReduceNode<
+              KeyAccumulator,
+              decltype(pair_key_extractor), decltype(comb_pair_function),
+              ReduceConfig, std::hash<Key>, std::equal_to<Key>,
+              /* VolatileKey */ false>;
+
+    auto node = common::MakeCounting<ReduceNode>(
+        *this, "AggregateByKey",
+        pair_key_extractor, comb_pair_function, reduce_config,
+        std::hash<Key>(), std::equal_to<Key>(), pre_op);
+
+    return DIA<KeyAccumulator>(node).Map(finalize_function);
+}
+
+} // namespace api
+} // namespace thrill
+
+#endif // !THRILL_API_AGGREGATE_BY_KEY_HEADER
+
+/******************************************************************************/
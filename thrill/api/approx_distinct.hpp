@@ -0,0 +1,131 @@
+/*******************************************************************************
+ * thrill/api/approx_distinct.hpp
+ *
+ * Part of Project Thrill - http://project-thrill.org
+ *
+ * All rights reserved. Published under the BSD-2 license in the LICENSE file.
+ ******************************************************************************/
+
+#pragma once
+#ifndef THRILL_API_APPROX_DISTINCT_HEADER
+#define THRILL_API_APPROX_DISTINCT_HEADER
+
+#include <thrill/api/action_node.hpp>
+#include <thrill/api/dia.hpp>
+#include <thrill/core/hyperloglog.hpp>
+#include <thrill/core/reduce_functional.hpp>
+
+#include <cmath>
+#include <vector>
+
+namespace thrill {
+namespace api {
+
+/*!
+ * Estimates the number of distinct items with a HyperLogLog sketch on each
+ * worker, which are combined by an all-reduce of the registers. This avoids
+ * shuffling all items as with ReduceByKey().Size().
+ *
+ * \ingroup api_layer
+ */
+template <typename ValueType, typename HashFunction>
+class ApproxDistinctNode final : public ActionResultNode<size_t>
+{
+    static constexpr bool debug = false;
+
+    using Super = ActionResultNode<size_t>;
+    using Super::context_;
+
+    //! salt for mixing the hash values, which may be the identity.
+    static constexpr uint64_t salt_ = 0x9E3779B97F4A7C15ull;
+
+public:
+    template <typename ParentDIA>
+    ApproxDistinctNode(const ParentDIA& parent, size_t precision,
+                       const HashFunction& hash_function)
+        : Super(parent.ctx(), "ApproxDistinct",
+                { parent.id() }, { parent.node() }),
+          hash_function_(hash_function),
+          sketch_(precision) {
+        // Hook PreOp(s)
+        auto pre_op_fn = [this](const ValueType& input) {
+                             PreOp(input);
+                         };
+
+        auto lop_chain = parent.stack().push(pre_op_fn).fold();
+        parent.node()->AddChild(this, lop_chain);
+    }
+
+    void PreOp(const ValueType& input) {
+        sketch_.InsertHash(core::Hash128to64(salt_, hash_function_(input)));
+    }
+
+    //! Combines the sketches of all workers and estimates the result.
+    void Execute() final {
+        core::HyperLogLog::Registers registers = context_.net.AllReduce(
+            sketch_.registers(),
+            [](const core::HyperLogLog::Registers& a,
+               const core::HyperLogLog::Registers& b) {
+                core::HyperLogLog::Registers out = a;
+                core::HyperLogLog::MergeRegisters(out, b);
+                return out;
+            });
+
+        result_ = static_cast<size_t>(
+            std::llround(core::HyperLogLog::Estimate(registers)));
+
+        LOG << "ApproxDistinct estimate " << result_;
+    }
+
+    //! Returns the estimated number of distinct items.
+    const size_t& result() const final {
+        return result_;
+    }
+
+private:
+    //! hash function for items
+    HashFunction hash_function_;
+    //! local sketch
+    core::HyperLogLog sketch_;
+    //! global estimate
+    size_t result_ = 0;
+};
+
+template <typename ValueType, typename Stack>
+template <typename HashFunction>
+size_t DIA<ValueType, Stack>::ApproxDistinct(
+    size_t precision, const HashFunction& hash_function) const {
+    assert(IsValid());
+
+    using ApproxDistinctNode =
+              api::ApproxDistinctNode<ValueType, HashFunction>;
+
+    auto node = common::MakeCounting<ApproxDistinctNode>(
+        *this, precision, hash_function);
+
+    node->RunScope();
+
+    return node->result();
+}
+
+template <typename ValueType, typename Stack>
+template <typename HashFunction>
+Future<size_t> DIA<ValueType, Stack>::ApproxDistinctFuture(
+    size_t precision, const HashFunction& hash_function) const {
+    assert(IsValid());
+
+    using ApproxDistinctNode =
+              api::ApproxDistinctNode<ValueType, HashFunction>;
+
+    auto node = common::MakeCounting<ApproxDistinctNode>(
+        *this, precision, hash_function);
+
+    return Future<size_t>(node);
+}
+
+} // namespace api
+} // namespace thrill
+
+#endif // !THRILL_API_APPROX_DISTINCT_HEADER
+
+/******************************************************************************/
@@ -0,0 +1,279 @@
+/*******************************************************************************
+ * thrill/api/broadcast_join.hpp
+ *
+ * DIANode for an inner join which broadcasts the smaller DIA into a hash table
+ * shared by the workers of each host, and streams the larger DIA locally.
+ *
+ * Part of Project Thrill - http://project-thrill.org
+ *
+ * All rights reserved. Published under the BSD-2 license in the LICENSE file.
+ ******************************************************************************/
+
+#pragma once
+#ifndef THRILL_API_BROADCAST_JOIN_HEADER
+#define THRILL_API_BROADCAST_JOIN_HEADER
+
+#include <thrill/api/dia.hpp>
+#include <thrill/api/dop_node.hpp>
+#include <thrill/common/functional.hpp>
+#include <thrill/common/logger.hpp>
+#include <thrill/common/stats_timer.hpp>
+#include <thrill/data/file.hpp>
+
+#include <functional>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace thrill {
+namespace api {
+
+/*!
+ * A DIANode which performs an inner join of a large DIA with a small DIA by
+ * key, without shuffling the large DIA.
+ *
+ * The items of the small (second) DIA are sent to the first worker of every
+ * host, which builds a hash table of them in the main op. The table is shared
+ * by pointer with the other workers of the host, hence it exists once per host
+ * and not once per worker. The items of the large (first) DIA are kept in a
+ * local File and streamed past the shared table in PushData().
+ *
+ * The whole small DIA must fit into the RAM of a host.
+ *
+ * \ingroup api_layer
+ */
+template <typename ValueType,
+          typename FirstDIA, typename SecondDIA,
+          typename KeyExtractor1, typename KeyExtractor2,
+          typename JoinFunction, typename HashFunction>
+class BroadcastJoinNode final : public DOpNode<ValueType>
+{
+    static constexpr bool debug = false;
+
+    using Super = DOpNode<ValueType>;
+    using Super::context_;
+
+    using InputTypeFirst = typename FirstDIA::ValueType;
+    using InputTypeSecond = typename SecondDIA::ValueType;
+
+    using Key = typename common::FunctionTraits<KeyExtractor1>::result_type;
+
+    static_assert(
+        std::is_same<
+            Key, typename common::FunctionTraits<KeyExtractor2>::result_type
+            >::value,
+        "Both KeyExtractors must return the same key type");
+
+    //! hash table of the broadcast DIA
+    using Table = std::unordered_multimap<Key, InputTypeSecond, HashFunction>;
+
+public:
+    BroadcastJoinNode(const FirstDIA& first_dia, const SecondDIA& second_dia,
+                      const KeyExtractor1& key_extractor1,
+                      const KeyExtractor2& key_extractor2,
+                      const JoinFunction& join_function,
+                      const HashFunction& hash_function)
+        : Super(first_dia.ctx(), "BroadcastJoin",
+                { first_dia.id(), second_dia.id() },
+                { first_dia.node(), second_dia.node() }),
+          key_extractor1_(key_extractor1),
+          key_extractor2_(key_extractor2),
+          join_function_(join_function),
+          table_(0, hash_function),
+          parent_stack_empty_ {
+              FirstDIA::stack_empty, SecondDIA::stack_empty
+          }
+    {
+        data::File::Writer* writer = &writer_;
+        auto pre_op_fn1 = [writer](const InputTypeFirst& input) {
+                              writer->Put(input);
+                          };
+        auto pre_op_fn2 = [this](const InputTypeSecond& input) {
+                              PreOpBroadcast(input);
+                          };
+
+        // close the function stacks with our pre ops and register it at
+        // parent nodes for output
+        auto lop_chain1 = first_dia.stack().push(pre_op_fn1).fold();
+        first_dia.node()->AddChild(this, lop_chain1, 0);
+
+        auto lop_chain2 = second_dia.stack().push(pre_op_fn2).fold();
+        second_dia.node()->AddChild(this, lop_chain2, 1);
+    }
+
+    void StartPreOp(size_t parent_index) final {
+        if (parent_index == 0)
+            writer_ = file_.GetWriter();
+        else
+            emitters_ = stream_->GetWriters();
+    }
+
+    //! Send item to the first worker of every host.
+    void PreOpBroadcast(const InputTypeSecond& input) {
+        const size_t workers_per_host = context_.workers_per_host();
+        for (size_t i = 0; i < emitters_.size(); i += workers_per_host)
+            emitters_[i].Put(input);
+    }
+
+    //! Receive a whole data::File, but only if the parent's stack is empty.
+    bool OnPreOpFile(const data::File& file, size_t parent_index) final {
+        if (!parent_stack_empty_[parent_index]) return false;
+
+        if (parent_index == 0) {
+            assert(file_.num_items() == 0);
+            file_ = file.Copy();
+        }
+        else {
+            const size_t workers_per_host = context_.workers_per_host();
+            for (size_t i = 0; i < emitters_.size(); i += workers_per_host)
+                emitters_[i].AppendBlocks(file.blocks());
+        }
+        return true;
+    }
+
+    void StopPreOp(size_t parent_index) final {
+        LOG << *this << " StopPreOp() parent_index=" << parent_index;
+        if (parent_index == 0) {
+            writer_.Close();
+        }
+        else {
+            for (size_t i = 0; i < emitters_.size(); ++i)
+                emitters_[i].Close();
+        }
+    }
+
+    DIAMemUse ExecuteMemUse() final {
+        // request maximum RAM limit, the value is calculated by StageBuilder,
+        // and set as DIABase::mem_limit_.
+        return DIAMemUse::Max();
+    }
+
+    //! Build the hash table on the first worker of each host and share it.
+    void Execute() final {
+        common::StatsTimerStart timer;
+
+        auto reader = stream_->GetCatReader(/* consume */ true);
+        while (reader.HasNext()) {
+            InputTypeSecond item = reader.template Next<InputTypeSecond>();
+            Key key = key_extractor2_(item);
+            table_.emplace(std::move(key), std::move(item));
+        }
+        stream_->Close();
+
+        // only the first worker of a host received items.
+        shared_table_ = context_.net.LocalBroadcastPointer(&table_);
+
+        timer.Stop();
+        LOG << "RESULT"
+            << " name=broadcastjoin_build"
+            << " time=" << timer.Milliseconds()
+            << " table_size=" << shared_table_->size();
+    }
+
+    void PushData(bool consume) final {
+        assert(shared_table_);
+
+        auto reader = file_.GetReader(consume);
+        while (reader.HasNext()) {
+            InputTypeFirst item = reader.template Next<InputTypeFirst>();
+            auto range = shared_table_->equal_range(key_extractor1_(item));
+            for (auto it = range.first; it != range.second; ++it)
+                this->PushItem(join_function_(item, it->second));
+        }
+
+        // the table may only be released after all local workers are done.
+        context_.net.LocalBarrier();
+    }
+
+    void Dispose() final {
+        file_.Clear();
+        Table().swap(table_);
+        shared_table_ = nullptr;
+    }
+
+private:
+    KeyExtractor1 key_extractor1_;
+    KeyExtractor2 key_extractor2_;
+    JoinFunction join_function_;
+
+    //! local items of the first DIA
+    data::File file_ { context_.GetFile(this) };
+    data::File::Writer writer_;
+
+    //! stream for broadcasting the second DIA to the hosts
+    data::CatStreamPtr stream_ { context_.GetNewCatStream(this) };
+    std::vector<data::CatStream::Writer> emitters_;
+
+    //! hash table of the second DIA, filled only on the first local worker
+    Table table_;
+
+    //! pointer to the hash table of the first local worker
+    const Table* shared_table_ = nullptr;
+
+    //! whether the parent stacks are empty
+    const bool parent_stack_empty_[2];
+};
+
+/******************************************************************************/
+
+template <typename ValueType, typename Stack>
+template <typename JoinFunction, typename KeyExtractor1,
+          typename KeyExtractor2, typename SecondDIA, typename HashFunction>
+auto DIA<ValueType, Stack>::InnerJoin(
+    struct BroadcastTag const &, const SecondDIA &second_dia,
+    const KeyExtractor1 &key_extractor1, const KeyExtractor2 &key_extractor2,
+    const JoinFunction &join_function,
+    const HashFunction &hash_function) const {
+
+    AssertValid();
+    second_dia.AssertValid();
+
+    static_assert(
+        std::is_convertible<
+            ValueType,
+            typename common::FunctionTraits<KeyExtractor1>::template arg<0>
+            >::value,
+        "KeyExtractor1 has the wrong input type");
+
+    static_assert(
+        std::is_convertible<
+            typename SecondDIA::ValueType,
+            typename common::FunctionTraits<KeyExtractor2>::template arg<0>
+            >::value,
+        "KeyExtractor2 has the wrong input type");
+
+    static_assert(
+        std::is_convertible<
+            ValueType,
+            typename common::FunctionTraits<JoinFunction>::template arg<0>
+            >::value,
+        "JoinFunction has the wrong first input type");
+
+    static_assert(
+        std::is_convertible<
+            typename SecondDIA::ValueType,
+            typename common::FunctionTraits<JoinFunction>::template arg<1>
+            >::value,
+        "JoinFunction has the wrong second input type");
+
+    using JoinResult =
+              typename common::FunctionTraits<JoinFunction>::result_type;
+
+    using BroadcastJoinNode = api::BroadcastJoinNode<
+              JoinResult, DIA, SecondDIA, KeyExtractor1, KeyExtractor2,
+              JoinFunction, HashFunction>;
+
+    auto node = common::MakeCounting<BroadcastJoinNode>(
+        *this, second_dia, key_extractor1, key_extractor2, join_function,
+        hash_function);
+
+    return DIA<JoinResult>(node);
+}
+
+} // namespace api
+} // namespace thrill
+
+#endif // !THRILL_API_BROADCAST_JOIN_HEADER
+
+/******************************************************************************/
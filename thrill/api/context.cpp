@@ -30,6 +30,11 @@
 #include <thrill/net/tcp/construct.hpp>
 #endif
 
+#if THRILL_HAVE_NET_SHM
+#include <thrill/net/hybrid/construct.hpp>
+#include <thrill/net/shm/construct.hpp>
+#endif
+
 #if THRILL_HAVE_NET_MPI
 #include <thrill/net/mpi/group.hpp>
 #endif
@@ -270,15 +275,22 @@ void RunLocalTests(
 
 void RunLocalSameThread(const std::function<void(Context&)>& job_startpoint) {
 
+    // set fixed amount of RAM for testing
+    MemoryConfig mem_config;
+    mem_config.verbose_ = false;
+    mem_config.setup(4 * 1024 * 1024 * 1024llu);
+
+    RunLocalSameThread(mem_config, job_startpoint);
+}
+
+void RunLocalSameThread(const MemoryConfig& mem_config,
+                        const std::function<void(Context&)>& job_startpoint) {
+
     size_t my_host_rank = 0;
     size_t workers_per_host = 1;
     size_t num_hosts = 1;
     static constexpr size_t kGroupCount = net::Manager::kGroupCount;
 
-    // set fixed amount of RAM for testing
-    MemoryConfig mem_config;
-    mem_config.verbose_ = false;
-    mem_config.setup(4 * 1024 * 1024 * 1024llu);
     mem_config.print(workers_per_host);
 
     // construct three full mesh connection cliques, deliver net::tcp::Groups.
@@ -373,8 +385,16 @@ int RunBackendLoopback(
 }
 
 #if THRILL_HAVE_NET_TCP
+/*!
+ * Run() implementation for backends configured by THRILL_RANK and
+ * THRILL_HOSTLIST ("tcp", "shm", or "hybrid"), which call construct(my_host_rank,
+ * hostlist, host_groups) to establish the network groups.
+ */
+template <typename ConstructGroups>
 static inline
-int RunBackendTcp(const std::function<void(Context&)>& job_startpoint) {
+int RunBackendHostlist(
+    const char* backend, const ConstructGroups& construct,
+    const std::function<void(Context&)>& job_startpoint) {
 
     char* endptr;
 
@@ -400,7 +420,7 @@ int RunBackendTcp(const std::function<void(Context&)>& job_startpoint) {
     }
     else {
         std::cerr << "Thrill: environment variable THRILL_RANK"
-                  << " is required for tcp network backend."
+                  << " is required for " << backend << " network backend."
                   << std::endl;
         return -1;
     }
@@ -438,7 +458,7 @@ int RunBackendTcp(const std::function<void(Context&)>& job_startpoint) {
     }
     else {
         std::cerr << "Thrill: environment variable THRILL_HOSTLIST"
-                  << " is required for tcp network backend."
+                  << " is required for " << backend << " network backend."
                   << std::endl;
         return -1;
     }
@@ -467,7 +487,8 @@ int RunBackendTcp(const std::function<void(Context&)>& job_startpoint) {
 
     // okay, configuration is good.
 
-    std::cerr << "Thrill: running in tcp network with " << hostlist.size()
+    std::cerr << "Thrill: running in " << backend << " network with "
+              << hostlist.size()
               << " hosts and " << workers_per_host << " workers per host"
               << " with " << common::GetHostname()
               << " as rank " << my_host_rank << " and endpoints";
@@ -479,14 +500,8 @@ int RunBackendTcp(const std::function<void(Context&)>& job_startpoint) {
 
     static constexpr size_t kGroupCount = net::Manager::kGroupCount;
 
-    // construct three TCP network groups
-    std::array<std::unique_ptr<net::tcp::Group>, kGroupCount> groups;
-    net::tcp::Construct(
-        my_host_rank, hostlist, groups.data(), net::Manager::kGroupCount);
-
-    std::array<net::GroupPtr, kGroupCount> host_groups = {
-        { std::move(groups[0]), std::move(groups[1]) }
-    };
+    std::array<net::GroupPtr, kGroupCount> host_groups;
+    construct(my_host_rank, hostlist, host_groups);
 
     // construct HostContext
     HostContext host_context(
@@ -516,6 +531,58 @@ int RunBackendTcp(const std::function<void(Context&)>& job_startpoint) {
 
     return global_result;
 }
+
+static inline
+int RunBackendTcp(const std::function<void(Context&)>& job_startpoint) {
+    return RunBackendHostlist(
+        "tcp",
+        [](size_t my_host_rank, const std::vector<std::string>& hostlist,
+           std::array<net::GroupPtr, net::Manager::kGroupCount>& host_groups) {
+            // construct TCP network groups
+            std::array<std::unique_ptr<net::tcp::Group>,
+                       net::Manager::kGroupCount> groups;
+            net::tcp::Construct(my_host_rank, hostlist,
+                                groups.data(), net::Manager::kGroupCount);
+            std::move(groups.begin(), groups.end(), host_groups.begin());
+        },
+        job_startpoint);
+}
+
+#if THRILL_HAVE_NET_SHM
+static inline
+int RunBackendShm(const std::function<void(Context&)>& job_startpoint) {
+    return RunBackendHostlist(
+        "shm",
+        [](size_t my_host_rank, const std::vector<std::string>& hostlist,
+           std::array<net::GroupPtr, net::Manager::kGroupCount>& host_groups) {
+            // construct shared memory network groups, all processes must run
+            // on this host.
+            std::array<std::unique_ptr<net::shm::Group>,
+                       net::Manager::kGroupCount> groups;
+            net::shm::Construct(my_host_rank, hostlist,
+                                groups.data(), net::Manager::kGroupCount);
+            std::move(groups.begin(), groups.end(), host_groups.begin());
+        },
+        job_startpoint);
+}
+
+static inline
+int RunBackendHybrid(const std::function<void(Context&)>& job_startpoint) {
+    return RunBackendHostlist(
+        "hybrid",
+        [](size_t my_host_rank, const std::vector<std::string>& hostlist,
+           std::array<net::GroupPtr, net::Manager::kGroupCount>& host_groups) {
+            // construct network groups with shared memory to processes on
+            // the same host and TCP to all others.
+            std::array<std::unique_ptr<net::hybrid::Group>,
+                       net::Manager::kGroupCount> groups;
+            net::hybrid::Construct(my_host_rank, hostlist,
+                                   groups.data(), net::Manager::kGroupCount);
+            std::move(groups.begin(), groups.end(), host_groups.begin());
+        },
+        job_startpoint);
+}
+#endif
 #endif
 
 #if THRILL_HAVE_NET_MPI
@@ -811,6 +878,24 @@ int Run(const std::function<void(Context&)>& job_startpoint) {
 #endif
     }
 
+    if (strcmp(env_net, "shm") == 0) {
+#if THRILL_HAVE_NET_TCP && THRILL_HAVE_NET_SHM
+        // shared memory network backend for processes on one host
+        return RunBackendShm(job_startpoint);
+#else
+        return RunNotSupported(env_net);
+#endif
+    }
+
+    if (strcmp(env_net, "hybrid") == 0) {
+#if THRILL_HAVE_NET_TCP && THRILL_HAVE_NET_SHM
+        // shared memory within a host, TCP across hosts
+        return RunBackendHybrid(job_startpoint);
+#else
+        return RunNotSupported(env_net);
+#endif
+    }
+
     if (strcmp(env_net, "mpi") == 0) {
 #if THRILL_HAVE_NET_MPI
         // mpi network backend
@@ -896,6 +981,42 @@ int MemoryConfig::setup_detect() {
 #endif
     }
 
+    // select replacement policy of the BlockPool
+
+    const char* env_eviction = getenv("THRILL_EVICTION");
+
+    if (env_eviction && *env_eviction) {
+        if (!data::ParseEvictionPolicy(env_eviction, eviction_policy_)) {
+            std::cerr << "Thrill: environment variable"
+                      << " THRILL_EVICTION=" << env_eviction
+                      << " is not a valid eviction policy"
+                      << " (lru, mru, clock, or hint)."
+                      << std::endl;
+            return -1;
+        }
+    }
+
+    const char* env_swap_compression = getenv("THRILL_SWAP_COMPRESSION");
+
+    if (env_swap_compression && *env_swap_compression)
+        swap_compression_ = (strcmp(env_swap_compression, "0") != 0);
+
+    // number of helper threads per host
+
+    const char* env_helper_threads = getenv("THRILL_HELPER_THREADS");
+
+    if (env_helper_threads && *env_helper_threads) {
+        char* endptr;
+        helper_threads_ = std::strtoul(env_helper_threads, &endptr, 10);
+        if (!endptr || *endptr != 0) {
+            std::cerr << "Thrill: environment variable"
+                      << " THRILL_HELPER_THREADS=" << env_helper_threads
+                      << " is not a valid number of helper threads."
+                      << std::endl;
+            return -1;
+        }
+    }
+
     apply();
 
     return 0;
@@ -935,7 +1056,9 @@ void MemoryConfig::print(size_t workers_per_host) const {
         << " BlockPool=" << common::FormatIecUnits(ram_block_pool_hard_) << "B,"
         << " workers="
         << common::FormatIecUnits(ram_workers_ / workers_per_host) << "B,"
-        << " floating=" << common::FormatIecUnits(ram_floating_) << "B."
+        << " floating=" << common::FormatIecUnits(ram_floating_) << "B,"
+        << " eviction=" << data::EvictionPolicyName(eviction_policy_)
+        << (swap_compression_ ? " compressed." : ".")
         << std::endl;
 }
 
@@ -965,6 +1088,23 @@ HostContext::HostContext(
     // run memory profiler only on local host 0 (especially for test runs)
     if (local_host_id == 0)
         mem::StartMemProfiler(*profiler_, logger_);
+
+    // use idle cores as helper threads, unless configured.
+    size_t num_cores = std::thread::hardware_concurrency();
+    helper_threads_ =
+        num_cores > workers_per_host ? num_cores - workers_per_host : 0;
+
+    if (mem_config.helper_threads_ != size_t(-1))
+        helper_threads_ = mem_config.helper_threads_;
+}
+
+common::ThreadPool& HostContext::helper_pool() {
+    std::unique_lock<std::mutex> lock(helper_pool_mutex_);
+    if (!helper_pool_) {
+        helper_pool_ = std::make_unique<common::ThreadPool>(
+            std::max<size_t>(helper_threads_, 1));
+    }
+    return *helper_pool_;
 }
 
 std::string HostContext::MakeHostLogPath(size_t host_rank) {
@@ -18,6 +18,7 @@
 #include <thrill/common/defines.hpp>
 #include <thrill/common/json_logger.hpp>
 #include <thrill/common/profile_task.hpp>
+#include <thrill/common/thread_pool.hpp>
 #include <thrill/data/block_pool.hpp>
 #include <thrill/data/cat_stream.hpp>
 #include <thrill/data/file.hpp>
@@ -30,6 +31,8 @@
 #include <algorithm>
 #include <cassert>
 #include <functional>
+#include <memory>
+#include <mutex>
 #include <numeric>
 #include <string>
 #include <tuple>
@@ -74,6 +77,17 @@ public:
     //! remaining free-floating RAM used for user and Thrill data structures.
     size_t ram_floating_;
 
+    //! replacement policy of the data::BlockPool, set by THRILL_EVICTION
+    data::EvictionPolicyType eviction_policy_ = data::EvictionPolicyType::LRU;
+
+    //! compress blocks swapped out by the data::BlockPool, set by
+    //! THRILL_SWAP_COMPRESSION
+    bool swap_compression_ = false;
+
+    //! number of helper threads per host, set by THRILL_HELPER_THREADS. The
+    //! default size_t(-1) uses the cores not occupied by workers.
+    size_t helper_threads_ = size_t(-1);
+
     //! StageBuilder verbosity flag
     bool verbose_ = true;
 };
@@ -133,6 +147,14 @@ public:
     //! data multiplexer transmits large amounts of data asynchronously.
     data::Multiplexer& data_multiplexer() { return data_multiplexer_; }
 
+    //! number of helper threads which workers may use to parallelize local
+    //! computations like sorting of runs. By default these are all cores not
+    //! occupied by workers, or as set in the MemoryConfig.
+    size_t helper_threads() const { return helper_threads_; }
+
+    //! host-global pool of helper threads, constructed on first use.
+    common::ThreadPool& helper_pool();
+
 private:
     //! memory configuration
     MemoryConfig mem_config_;
@@ -182,7 +204,8 @@ private:
     //! data block pool
     data::BlockPool block_pool_ {
         mem_config_.ram_block_pool_soft_, mem_config_.ram_block_pool_hard_,
-        &logger_, &mem_manager_, workers_per_host_
+        &logger_, &mem_manager_, workers_per_host_,
+        mem_config_.eviction_policy_, mem_config_.swap_compression_
     };
 
 #if !THRILL_HAVE_THREAD_SANITIZER
@@ -197,6 +220,15 @@ private:
         mem_manager_, block_pool_, workers_per_host_,
         net_manager_.GetDataGroup()
     };
+
+    //! number of helper threads in helper_pool_
+    size_t helper_threads_;
+
+    //! mutex protecting lazy construction of helper_pool_
+    std::mutex helper_pool_mutex_;
+
+    //! thread pool for helper jobs of all workers on this host
+    std::unique_ptr<common::ThreadPool> helper_pool_;
 };
 
 /*!
@@ -221,6 +253,7 @@ public:
           flow_manager_(host_context.flow_manager()),
           block_pool_(host_context.block_pool()),
           multiplexer_(host_context.data_multiplexer()),
+          host_context_(host_context),
           base_logger_(&host_context.base_logger_) {
         assert(local_worker_id < workers_per_host());
     }
@@ -333,6 +366,16 @@ public:
     //! returns the host-global memory manager
     mem::Manager& mem_manager() { return mem_manager_; }
 
+    //! number of threads this worker may use for parallel local computations,
+    //! including itself: its share of the host's helper threads plus one.
+    size_t local_parallelism() const {
+        return 1 + host_context_.helper_threads() / workers_per_host_;
+    }
+
+    //! returns the host-global pool of helper threads, which is shared by all
+    //! workers on the host. Only use it if local_parallelism() > 1.
+    common::ThreadPool& helper_pool() { return host_context_.helper_pool(); }
+
     //! given a global range [0,global_size) and p PEs to split the range, calculate
     //! the [local_begin,local_end) index range assigned to the PE i. Takes the
     //! information from the Context.
@@ -421,6 +464,9 @@ private:
     //! data::Multiplexer instance that is shared among workers
     data::Multiplexer& multiplexer_;
 
+    //! HostContext for lazily constructed shared facilities
+    HostContext& host_context_;
+
     //! flag to set which enables selective consumption of DIA contents!
     bool consume_ = false;
 
@@ -489,6 +535,13 @@ void RunLocalTests(
  */
 void RunLocalSameThread(const std::function<void(Context&)>& job_startpoint);
 
+/*!
+ * Runs the given job_startpoint within the same thread with a test network and
+ * the given memory configuration, e.g. to set the number of helper threads.
+ */
+void RunLocalSameThread(const MemoryConfig& mem_config,
+                        const std::function<void(Context&)>& job_startpoint);
+
 /*!
  * Check environment variable THRILL_DIE_WITH_PARENT and enable process flag:
  * this is useful for ssh/invoke.sh: it kills spawned processes when the ssh
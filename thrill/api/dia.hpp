@@ -77,6 +77,30 @@ struct NoRebalanceTag {
 //! global const NoRebalanceTag instance
 const struct NoRebalanceTag NoRebalanceTag;
 
+//! tag structure for InnerJoin()
+struct BroadcastTag {
+    BroadcastTag() { }
+};
+
+//! global const BroadcastTag instance
+const struct BroadcastTag BroadcastTag;
+
+//! tag structure for InnerJoin()
+struct SortedTag {
+    SortedTag() { }
+};
+
+//! global const SortedTag instance
+const struct SortedTag SortedTag;
+
+//! tag structure for GroupByKey()
+struct HashTag {
+    HashTag() { }
+};
+
+//! global const HashTag instance
+const struct HashTag HashTag;
+
 //! tag structure for Read()
 struct LocalStorageTag {
     LocalStorageTag() { }
@@ -615,6 +639,69 @@ public:
     Future<ValueType> MaxFuture(
         const ValueType& initial_value = ValueType()) const;
 
+    /*!
+     * ApproxDistinct is an Action, which estimates the number of distinct
+     * items globally using a HyperLogLog sketch per worker. The sketches are
+     * combined by a single all-reduce of 2^precision bytes, the relative
+     * standard error is about 1.04 / sqrt(2^precision).
+     *
+     * \param precision Number of bits selecting a sketch register.
+     *
+     * \param hash_function Hash function for items.
+     *
+     * \ingroup dia_actions
+     */
+    template <typename HashFunction = std::hash<ValueType> >
+    size_t ApproxDistinct(
+        size_t precision = 14,
+        const HashFunction& hash_function = HashFunction()) const;
+
+    /*!
+     * ApproxDistinct is an ActionFuture, which estimates the number of
+     * distinct items globally using a HyperLogLog sketch per worker.
+     *
+     * \param precision Number of bits selecting a sketch register.
+     *
+     * \param hash_function Hash function for items.
+     *
+     * \ingroup dia_actions
+     */
+    template <typename HashFunction = std::hash<ValueType> >
+    Future<size_t> ApproxDistinctFuture(
+        size_t precision = 14,
+        const HashFunction& hash_function = HashFunction()) const;
+
+    /*!
+     * TopKFrequent is an Action, which approximately finds the k most
+     * frequent items globally and their counts using a SpaceSaving sketch per
+     * worker. The sketches are merged by a single all-reduce. Counts are
+     * overestimates, and items are returned in descending order of count.
+     *
+     * \param k Number of items to return.
+     *
+     * \param hash_function Hash function for items.
+     *
+     * \ingroup dia_actions
+     */
+    template <typename HashFunction = std::hash<ValueType> >
+    std::vector<std::pair<ValueType, size_t> > TopKFrequent(
+        size_t k, const HashFunction& hash_function = HashFunction()) const;
+
+    /*!
+     * TopKFrequent is an ActionFuture, which approximately finds the k most
+     * frequent items globally and their counts using a SpaceSaving sketch per
+     * worker.
+     *
+     * \param k Number of items to return.
+     *
+     * \param hash_function Hash function for items.
+     *
+     * \ingroup dia_actions
+     */
+    template <typename HashFunction = std::hash<ValueType> >
+    Future<std::vector<std::pair<ValueType, size_t> > > TopKFrequentFuture(
+        size_t k, const HashFunction& hash_function = HashFunction()) const;
+
     /*!
      * WriteLinesOne is an Action, which writes std::strings to a single output
      * file.
@@ -1043,6 +1130,48 @@ public:
         const KeyHashFunction &key_hash_function,
         const KeyEqualFunction &key_equal_function) const;
 
+    /*!
+     * AggregateByKey is a DOp, which groups elements of the DIA by their key
+     * and aggregates each key-bucket into an accumulator of a possibly
+     * different type, which is then transformed into an output element.
+     *
+     * Each element is folded with seq_op into the accumulator of its key in the
+     * reduce pre phase table, which starts as a copy of init. Hence usually
+     * only one accumulator per key and worker is sent in the shuffle. Partial
+     * accumulators of equal keys are combined with the associative comb_op.
+     * Finally, finalize(key, accumulator) is applied to the one remaining
+     * accumulator of each key.
+     *
+     * \param key_extractor Key extractor function, which maps each element to
+     * a key of possibly different type.
+     *
+     * \param init Initial value of each accumulator.
+     *
+     * \param seq_op Function folding an element into an accumulator:
+     * Accumulator(const Accumulator&, const ValueType&).
+     *
+     * \param comb_op Associative function combining two accumulators:
+     * Accumulator(const Accumulator&, const Accumulator&).
+     *
+     * \param finalize Function creating the output element of a key:
+     * Output(const Key&, const Accumulator&).
+     *
+     * \param reduce_config Reduce configuration.
+     *
+     * \ingroup dia_dops
+     */
+    template <typename KeyExtractor, typename Accumulator,
+              typename SeqFunction, typename CombFunction,
+              typename FinalizeFunction,
+              typename ReduceConfig = class DefaultReduceConfig>
+    auto AggregateByKey(
+        const KeyExtractor &key_extractor,
+        const Accumulator &init,
+        const SeqFunction &seq_op,
+        const CombFunction &comb_op,
+        const FinalizeFunction &finalize,
+        const ReduceConfig& reduce_config = ReduceConfig()) const;
+
     /*!
      * ReduceToIndex is a DOp, which groups elements of the DIA with the
      * key_extractor returning an unsigned integers and reduces each key-bucket
@@ -1171,6 +1300,29 @@ public:
     auto GroupByKey(const KeyExtractor &key_extractor,
                     const GroupByFunction &groupby_function) const;
 
+    /*!
+     * GroupByKey is a DOp, which groups elements of the DIA by its key. This
+     * variant groups the elements with hash tables instead of sorting them,
+     * which takes linear time, but the groups are not processed in key order.
+     * Elements which do not fit into RAM are partitioned by hash into Files,
+     * which are grouped recursively.
+     *
+     * \param key_extractor Key extractor function, which maps each element to a
+     * key of possibly different type.
+     *
+     * \param groupby_function Group function, which is called once per key
+     * with an iterator over all elements of the key and the key.
+     *      input param: api::GroupByReader with functions HasNext() and Next()
+     *
+     * \ingroup dia_dops
+     */
+    template <typename ValueOut, typename KeyExtractor,
+              typename GroupByFunction, typename HashFunction =
+                  std::hash<typename FunctionTraits<KeyExtractor>::result_type> >
+    auto GroupByKey(struct HashTag const &,
+                    const KeyExtractor &key_extractor,
+                    const GroupByFunction &groupby_function) const;
+
     /*!
      * GroupBy is a DOp, which groups elements of the DIA by its key.
      * After having grouped all elements of one key, all elements of one key
@@ -1216,6 +1368,93 @@ public:
                       const size_t size,
                       const ValueOut& neutral_element = ValueOut()) const;
 
+    /*!
+     * InnerJoin is a DOp, which joins the elements of this DIA with the
+     * elements of second_dia which have an equal key. For each pair of
+     * elements with equal keys, join_function is applied to form an element
+     * of the output DIA, whose type can be inferred from the join_function.
+     *
+     * Both DIAs are hash partitioned by key to the workers. Each worker loads
+     * its smaller side into a hash table and probes it with the larger side,
+     * both sides are partitioned into Files and joined recursively if the
+     * hash table exceeds the memory limit (grace hash join).
+     *
+     * \tparam KeyExtractor1 Type of the key_extractor1 function, mapping
+     * elements of this DIA to a key.
+     *
+     * \tparam KeyExtractor2 Type of the key_extractor2 function, mapping
+     * elements of second_dia to a key of the same type.
+     *
+     * \tparam JoinFunction Type of the join_function. This is a function with
+     * two input elements, one of this DIA and one of second_dia, and one output
+     * element, which is the type of the InnerJoin node.
+     *
+     * \param second_dia DIA, which is joined with this DIA.
+     *
+     * \param key_extractor1 Key extractor function for this DIA.
+     *
+     * \param key_extractor2 Key extractor function for second_dia.
+     *
+     * \param join_function Join function, which combines two elements with
+     * equal key.
+     *
+     * \param hash_function Hash function for the key type.
+     *
+     * \ingroup dia_dops
+     */
+    template <typename JoinFunction, typename KeyExtractor1,
+              typename KeyExtractor2, typename SecondDIA,
+              typename HashFunction =
+                  std::hash<typename FunctionTraits<KeyExtractor1>::result_type> >
+    auto InnerJoin(const SecondDIA &second_dia,
+                   const KeyExtractor1 &key_extractor1,
+                   const KeyExtractor2 &key_extractor2,
+                   const JoinFunction &join_function,
+                   const HashFunction& hash_function = HashFunction()) const;
+
+    /*!
+     * InnerJoin with broadcast of the second DIA, which must be small enough
+     * to fit into the RAM of each host. The second DIA is gathered on every
+     * host into a single hash table shared by all workers of the host, and
+     * the elements of this DIA are joined locally without a shuffle.
+     *
+     * See InnerJoin() for the parameters.
+     *
+     * \ingroup dia_dops
+     */
+    template <typename JoinFunction, typename KeyExtractor1,
+              typename KeyExtractor2, typename SecondDIA,
+              typename HashFunction =
+                  std::hash<typename FunctionTraits<KeyExtractor1>::result_type> >
+    auto InnerJoin(struct BroadcastTag const &, const SecondDIA &second_dia,
+                   const KeyExtractor1 &key_extractor1,
+                   const KeyExtractor2 &key_extractor2,
+                   const JoinFunction &join_function,
+                   const HashFunction& hash_function = HashFunction()) const;
+
+    /*!
+     * InnerJoin of two DIAs which are both sorted by key with key_comparator,
+     * e.g. the outputs of Sort(). Both DIAs are split at identical key
+     * boundaries, balancing the total number of items, and joined by merging
+     * locally without hashing. Hence, no second shuffle of sorted data is
+     * needed.
+     *
+     * See InnerJoin() for the other parameters.
+     *
+     * \param key_comparator Comparator by which both DIAs are sorted by key.
+     *
+     * \ingroup dia_dops
+     */
+    template <typename JoinFunction, typename KeyExtractor1,
+              typename KeyExtractor2, typename SecondDIA,
+              typename KeyComparator =
+                  std::less<typename FunctionTraits<KeyExtractor1>::result_type> >
+    auto InnerJoin(struct SortedTag const &, const SecondDIA &second_dia,
+                   const KeyExtractor1 &key_extractor1,
+                   const KeyExtractor2 &key_extractor2,
+                   const JoinFunction &join_function,
+                   const KeyComparator& key_comparator = KeyComparator()) const;
+
     /*!
      * Zips two DIAs of equal size in style of functional programming by
      * applying zip_function to the i-th elements of both input DIAs to form the
@@ -1351,7 +1590,9 @@ public:
      * true, if first element is smaller than second. False otherwise.
      *
      * \param sort_algorithm Algorithm class used to sort items. Merging is
-     * always done using a tournament tree with compare_function.
+     * always done using a tournament tree with compare_function. With helper
+     * threads, local runs are sorted concurrently by copies of sort_algorithm,
+     * hence compare_function must be safe to call concurrently.
      *
      * \ingroup dia_dops
      */
@@ -1359,6 +1600,24 @@ public:
     auto Sort(const CompareFunction &compare_function,
               const SortFunction &sort_algorithm) const;
 
+    /*!
+     * SortByKey is a DOp, which sorts a given DIA by the keys returned by
+     * key_extractor. Keys must be unsigned integers or fixed-size byte arrays
+     * std::array<uint8_t, N>, which are compared lexicographically. Local runs
+     * are sorted with an MSD radix sort on the key bytes, and keys are compared
+     * via their big-endian 8-byte prefix.
+     *
+     * \tparam KeyExtractor Type of the key_extractor function.
+     *  Should be ValueType->Key
+     *
+     * \param key_extractor Key extractor function, which returns the sort key
+     * of an element.
+     *
+     * \ingroup dia_dops
+     */
+    template <typename KeyExtractor>
+    auto SortByKey(const KeyExtractor &key_extractor) const;
+
     /*!
      * Merge is a DOp, which merges two sorted DIAs to a single sorted DIA.
      * Both input DIAs must be used sorted conforming to the given comparator.
@@ -1575,6 +1834,15 @@ using api::PadTag;
 //! imported from api namespace
 using api::NoRebalanceTag;
 
+//! imported from api namespace
+using api::BroadcastTag;
+
+//! imported from api namespace
+using api::SortedTag;
+
+//! imported from api namespace
+using api::HashTag;
+
 } // namespace thrill
 
 #endif // !THRILL_API_DIA_HEADER
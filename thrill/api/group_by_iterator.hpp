@@ -34,7 +34,8 @@ namespace api {
 
 // forward declarations for friend classes
 template <typename ValueType,
-          typename KeyExtractor, typename GroupFunction, typename HashFunction>
+          typename KeyExtractor, typename GroupFunction, typename HashFunction,
+          bool UseHashGrouping>
 class GroupByNode;
 
 template <typename ValueType,
@@ -49,7 +50,8 @@ class GroupByIterator
     template <typename T1,
               typename T2,
               typename T3,
-              typename T4>
+              typename T4,
+              bool T5>
     friend class GroupByNode;
 
     template <typename T1,
@@ -131,7 +133,8 @@ class GroupByMultiwayMergeIterator
     template <typename T1,
               typename T2,
               typename T3,
-              typename T4>
+              typename T4,
+              bool T5>
     friend class GroupByNode;
 
     template <typename T1,
@@ -206,6 +209,35 @@ private:
     }
 };
 
+////////////////////////////////////////////////////////////////////////////////
+
+//! Iterator over the items of one group in a vector of items, which are
+//! addressed by a range of indices. Used by hash grouping.
+template <typename ValueType>
+class GroupByIndexIterator
+{
+public:
+    using ValueIn = ValueType;
+
+    GroupByIndexIterator(const std::vector<ValueIn>& items,
+                         const size_t* begin, const size_t* end)
+        : items_(items), pos_(begin), end_(end) { }
+
+    bool HasNext() {
+        return pos_ != end_;
+    }
+
+    ValueIn Next() {
+        assert(pos_ != end_);
+        return items_[*pos_++];
+    }
+
+private:
+    const std::vector<ValueIn>& items_;
+    const size_t* pos_;
+    const size_t* end_;
+};
+
 //! \}
 
 } // namespace api
@@ -19,11 +19,13 @@
 #include <thrill/api/group_by_iterator.hpp>
 #include <thrill/common/functional.hpp>
 #include <thrill/common/logger.hpp>
+#include <thrill/core/reduce_functional.hpp>
 
 #include <algorithm>
 #include <functional>
 #include <type_traits>
 #include <typeinfo>
+#include <unordered_map>
 #include <utility>
 #include <vector>
 
@@ -31,14 +33,33 @@ namespace thrill {
 namespace api {
 
 /*!
+ * A DIANode which groups the items by key and calls the group function once
+ * per key with an iterator over all items of the key.
+ *
+ * By default, received items are sorted into runs, which are merged by key in
+ * PushData(). With UseHashGrouping the received items are instead grouped with
+ * an in-memory hash table, which takes linear time but does not deliver the
+ * groups in key order. If the received items do not fit into the memory limit,
+ * they are partitioned with a salted hash into sub-Files, each of which is
+ * grouped recursively.
+ *
  * \ingroup api_layer
  */
 template <typename ValueType,
-          typename KeyExtractor, typename GroupFunction, typename HashFunction>
+          typename KeyExtractor, typename GroupFunction, typename HashFunction,
+          bool UseHashGrouping = false>
 class GroupByNode final : public DOpNode<ValueType>
 {
     static constexpr bool debug = false;
 
+    //! maximum number of hash partitioning levels
+    static constexpr size_t max_levels_ = 4;
+
+    //! estimated memory overhead of a distinct key in the hash table
+    static constexpr size_t entry_overhead_ = 4 * sizeof(void*);
+
+    using HashGroupingTag = std::integral_constant<bool, UseHashGrouping>;
+
     using Super = DOpNode<ValueType>;
     using Super::context_;
 
@@ -102,10 +123,42 @@ public:
     }
 
     void Execute() override {
-        MainOp();
+        MainOp(HashGroupingTag());
+    }
+
+    DIAMemUse PushDataMemUse() final {
+        // hash grouping requests the maximum RAM limit, the value is
+        // calculated by StageBuilder, and set as DIABase::mem_limit_.
+        if (UseHashGrouping) return DIAMemUse::Max();
+        return 0;
     }
 
     void PushData(bool consume) final {
+        PushData(consume, HashGroupingTag());
+    }
+
+    void Dispose() override {
+        file_.Clear();
+    }
+
+private:
+    KeyExtractor key_extractor_;
+    GroupFunction groupby_function_;
+    HashFunction hash_function_;
+
+    data::CatStreamPtr stream_ { context_.GetNewCatStream(this) };
+    std::vector<data::Stream::Writer> emitter_;
+    std::vector<data::File> files_;
+    //! Block triggers of files_ for forecasting prefetch during merging
+    std::vector<std::vector<ValueIn> > run_triggers_;
+    data::File sorted_elems_ { context_.GetFile(this) };
+    size_t totalsize_ = 0;
+
+    //! File of received items for hash grouping
+    data::File file_ { context_.GetFile(this) };
+
+    //! Merge sorted runs and call the user function on each group.
+    void PushData(bool consume, std::false_type) {
         LOG << "sort data";
         common::StatsTimerStart timer;
         const size_t num_runs = files_.size();
@@ -123,7 +176,14 @@ public:
             seq.reserve(num_runs);
 
             for (size_t t = 0; t < num_runs; ++t)
-                seq.emplace_back(files_[t].GetConsumeReader());
+                seq.emplace_back(files_[t].GetConsumeReader(0));
+
+            // prefetch Blocks in the order the merge needs them
+            data::ForecastPrefetcher<data::File::ConsumeReader> prefetcher(
+                seq, data::ForecastSchedule(
+                    run_triggers_.begin(), run_triggers_.end(),
+                    ValueComparator(*this)),
+                num_runs * data::File::default_prefetch);
 
             LOG << "start multiwaymerge for real";
             auto puller = core::make_multiway_merge_tree<ValueIn>(
@@ -152,18 +212,136 @@ public:
             << " multiwaymerge=" << (num_runs > 1);
     }
 
-    void Dispose() override { }
+    //! Group the received items by hashing and call the user function on each
+    //! group.
+    void PushData(bool consume, std::true_type) {
+        common::StatsTimerStart timer;
+        num_partitioned_ = 0;
 
-private:
-    KeyExtractor key_extractor_;
-    GroupFunction groupby_function_;
-    HashFunction hash_function_;
+        HashGroup(file_, consume, 0);
 
-    data::CatStreamPtr stream_ { context_.GetNewCatStream(this) };
-    std::vector<data::Stream::Writer> emitter_;
-    std::vector<data::File> files_;
-    data::File sorted_elems_ { context_.GetFile(this) };
-    size_t totalsize_ = 0;
+        timer.Stop();
+        LOG << "RESULT"
+            << " name=hashgroup"
+            << " time=" << timer.Milliseconds()
+            << " partitioned=" << num_partitioned_;
+    }
+
+    //! Estimated memory needed to group a File in memory.
+    size_t EstimateMemory(const data::File& file) const {
+        return file.size_bytes()
+               + file.num_items()
+               * (sizeof(ValueIn) + 2 * sizeof(size_t) + sizeof(Key)
+                  + entry_overhead_);
+    }
+
+    //! Group the items of a File in memory if they fit into the memory limit,
+    //! otherwise partition them by salted hash and recurse on the sub-Files.
+    void HashGroup(data::File& file, bool consume, size_t level) {
+        const size_t limit = DIABase::mem_limit_;
+        const size_t memory = EstimateMemory(file);
+
+        if (memory <= limit || level >= max_levels_) {
+            GroupInMemory(file, consume);
+            return;
+        }
+
+        const size_t max_fanout = std::max<size_t>(
+            2, limit / 2 / data::default_block_size);
+        const size_t fanout = std::min(
+            max_fanout, 2 * memory / std::max<size_t>(limit, 1) + 1);
+
+        sLOG << "GroupByKey: hash partitioning level" << level
+             << "memory" << memory << "limit" << limit << "fanout" << fanout;
+        ++num_partitioned_;
+
+        const size_t num_items = file.num_items();
+
+        std::vector<data::File> parts;
+        std::vector<data::File::Writer> writers;
+        parts.reserve(fanout), writers.reserve(fanout);
+        for (size_t p = 0; p < fanout; ++p) {
+            parts.emplace_back(context_.GetFile(this));
+            writers.emplace_back(parts.back().GetWriter());
+        }
+
+        auto reader = file.GetReader(consume);
+        while (reader.HasNext()) {
+            ValueIn item = reader.template Next<ValueIn>();
+            size_t p = core::Hash128to64(
+                level + 1, hash_function_(key_extractor_(item))) % fanout;
+            writers[p].Put(item);
+        }
+        for (size_t p = 0; p < fanout; ++p)
+            writers[p].Close();
+
+        for (size_t p = 0; p < fanout; ++p) {
+            if (parts[p].num_items() == num_items) {
+                // partitioning did not shrink the File: all items share a
+                // hash value, which is most likely a single heavy key.
+                GroupInMemory(parts[p], true);
+            }
+            else {
+                HashGroup(parts[p], true, level + 1);
+            }
+        }
+    }
+
+    //! Load the items of a File, arrange their indices by group with a hash
+    //! table and a counting pass, and call the user function on each group.
+    void GroupInMemory(data::File& file, bool consume) {
+        std::vector<ValueIn> items;
+        items.reserve(file.num_items());
+        {
+            auto reader = file.GetReader(consume);
+            while (reader.HasNext())
+                items.emplace_back(reader.template Next<ValueIn>());
+        }
+
+        // assign group ids to the keys and count the items of each group
+        std::vector<size_t> group_of(items.size());
+        std::vector<size_t> bucket;
+        {
+            std::unordered_map<Key, size_t, HashFunction> group_id(
+                items.size(), hash_function_);
+            for (size_t i = 0; i < items.size(); ++i) {
+                auto it = group_id.emplace(
+                    key_extractor_(items[i]), bucket.size());
+                if (it.second) bucket.push_back(0);
+                group_of[i] = it.first->second;
+                ++bucket[group_of[i]];
+            }
+        }
+
+        // exclusive prefix sum into group begin offsets
+        size_t sum = 0;
+        for (size_t g = 0; g < bucket.size(); ++g) {
+            size_t count = bucket[g];
+            bucket[g] = sum;
+            sum += count;
+        }
+        bucket.push_back(sum);
+
+        // scatter the item indices into their groups, reusing group_of
+        std::vector<size_t> order(items.size());
+        for (size_t i = 0; i < items.size(); ++i)
+            order[bucket[group_of[i]]++] = i;
+        std::vector<size_t>().swap(group_of);
+
+        // bucket[g] is now the end of group g and the begin of group g + 1
+        const size_t* begin = order.data();
+        for (size_t g = 0; g + 1 < bucket.size(); ++g) {
+            const size_t* end = order.data() + bucket[g];
+            GroupByIndexIterator<ValueIn> user_iterator(items, begin, end);
+            const ValueOut res = groupby_function_(
+                user_iterator, key_extractor_(items[*begin]));
+            this->PushItem(res);
+            begin = end;
+        }
+    }
+
+    //! number of hash partitioning steps in the last PushData()
+    size_t num_partitioned_ = 0;
 
     void RunUserFunc(data::File& f, bool consume) {
         auto r = f.GetReader(consume);
@@ -197,11 +375,35 @@ private:
         }
         w.Close();
 
+        // record Block triggers for the forecasting merge while the run's
+        // Blocks are still in memory.
+        run_triggers_.emplace_back(
+            f.template GetBlockTriggers<ValueIn>());
         files_.emplace_back(std::move(f));
     }
 
+    //! Receive elements from other workers into a File for hash grouping.
+    void MainOp(std::true_type) {
+        LOG << "running group by main op with hash grouping";
+
+        common::StatsTimerStart timer;
+        data::File::Writer writer = file_.GetWriter();
+        auto reader = stream_->GetCatReader(/* consume */ true);
+        while (reader.HasNext())
+            writer.Put(reader.template Next<ValueIn>());
+        writer.Close();
+        stream_->Close();
+
+        timer.Stop();
+
+        LOG << "RESULT"
+            << " name=mainop"
+            << " time=" << timer
+            << " items=" << file_.num_items();
+    }
+
     //! Receive elements from other workers.
-    void MainOp() {
+    void MainOp(std::false_type) {
         LOG << "running group by main op";
 
         std::vector<ValueIn> incoming;
@@ -259,6 +461,33 @@ auto DIA<ValueType, Stack>::GroupByKey(
     return DIA<DOpResult>(node);
 }
 
+template <typename ValueType, typename Stack>
+template <typename ValueOut, typename KeyExtractor,
+          typename GroupFunction, typename HashFunction>
+auto DIA<ValueType, Stack>::GroupByKey(
+    struct HashTag const &,
+    const KeyExtractor &key_extractor,
+    const GroupFunction &groupby_function) const {
+
+    using DOpResult = ValueOut;
+
+    static_assert(
+        std::is_same<
+            typename std::decay<typename common::FunctionTraits<KeyExtractor>
+                                ::template arg<0> >::type,
+            ValueType>::value,
+        "KeyExtractor has the wrong input type");
+
+    using GroupByNode = api::GroupByNode<
+              DOpResult, KeyExtractor, GroupFunction, HashFunction,
+              /* UseHashGrouping */ true>;
+
+    auto node = common::MakeCounting<GroupByNode>(
+        *this, key_extractor, groupby_function);
+
+    return DIA<DOpResult>(node);
+}
+
 } // namespace api
 } // namespace thrill
 
@@ -0,0 +1,435 @@
+/*******************************************************************************
+ * thrill/api/inner_join.hpp
+ *
+ * DIANode for an inner hash join of two DIAs by key, with grace hash
+ * partitioning of the build side if it exceeds the memory limit.
+ *
+ * Part of Project Thrill - http://project-thrill.org
+ *
+ * All rights reserved. Published under the BSD-2 license in the LICENSE file.
+ ******************************************************************************/
+
+#pragma once
+#ifndef THRILL_API_INNER_JOIN_HEADER
+#define THRILL_API_INNER_JOIN_HEADER
+
+#include <thrill/api/dia.hpp>
+#include <thrill/api/dop_node.hpp>
+#include <thrill/common/functional.hpp>
+#include <thrill/common/logger.hpp>
+#include <thrill/common/stats_timer.hpp>
+#include <thrill/core/reduce_functional.hpp>
+#include <thrill/data/file.hpp>
+
+#include <algorithm>
+#include <functional>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace thrill {
+namespace api {
+
+/*!
+ * A DIANode which performs an inner join of two DIAs by key. In the PreOp
+ * items of both parents are hash partitioned by their key to the workers via
+ * two CatStreams, and received into local Files in the main op.
+ *
+ * In PushData() the smaller local side is loaded into an in-memory hash table
+ * (the build side) and the larger side is streamed past it (the probe side).
+ * If the build side does not fit into the memory limit of the node, both sides
+ * are partitioned with a salted hash into sub-Files (grace hash join) and each
+ * pair of sub-Files is joined recursively. If partitioning does not shrink the
+ * build side, e.g. due to a single heavy key, the build side is loaded in
+ * chunks and the probe side is scanned once per chunk.
+ *
+ * \ingroup api_layer
+ */
+template <typename ValueType,
+          typename FirstDIA, typename SecondDIA,
+          typename KeyExtractor1, typename KeyExtractor2,
+          typename JoinFunction, typename HashFunction>
+class InnerJoinNode final : public DOpNode<ValueType>
+{
+    static constexpr bool debug = false;
+
+    //! maximum number of grace hash partitioning levels
+    static constexpr size_t max_levels_ = 4;
+
+    //! estimated memory overhead of a hash table entry besides key and item
+    static constexpr size_t entry_overhead_ = 4 * sizeof(void*);
+
+    using Super = DOpNode<ValueType>;
+    using Super::context_;
+
+    using InputTypeFirst = typename FirstDIA::ValueType;
+    using InputTypeSecond = typename SecondDIA::ValueType;
+
+    using Key = typename common::FunctionTraits<KeyExtractor1>::result_type;
+
+    static_assert(
+        std::is_same<
+            Key, typename common::FunctionTraits<KeyExtractor2>::result_type
+            >::value,
+        "Both KeyExtractors must return the same key type");
+
+    //! tag types selecting the first or second input as build side
+    using FirstTag = std::true_type;
+    using SecondTag = std::false_type;
+
+public:
+    InnerJoinNode(const FirstDIA& first_dia, const SecondDIA& second_dia,
+                  const KeyExtractor1& key_extractor1,
+                  const KeyExtractor2& key_extractor2,
+                  const JoinFunction& join_function,
+                  const HashFunction& hash_function)
+        : Super(first_dia.ctx(), "InnerJoin",
+                { first_dia.id(), second_dia.id() },
+                { first_dia.node(), second_dia.node() }),
+          key_extractor1_(key_extractor1),
+          key_extractor2_(key_extractor2),
+          join_function_(join_function),
+          hash_function_(hash_function)
+    {
+        auto pre_op_fn1 = [this](const InputTypeFirst& input) {
+                              PreOp(input, FirstTag());
+                          };
+        auto pre_op_fn2 = [this](const InputTypeSecond& input) {
+                              PreOp(input, SecondTag());
+                          };
+
+        // close the function stacks with our pre ops and register it at
+        // parent nodes for output
+        auto lop_chain1 = first_dia.stack().push(pre_op_fn1).fold();
+        first_dia.node()->AddChild(this, lop_chain1, 0);
+
+        auto lop_chain2 = second_dia.stack().push(pre_op_fn2).fold();
+        second_dia.node()->AddChild(this, lop_chain2, 1);
+    }
+
+    void StartPreOp(size_t parent_index) final {
+        writers_[parent_index] = streams_[parent_index]->GetWriters();
+    }
+
+    //! Send item to the worker owning the hash of its key.
+    template <typename Input, typename Tag>
+    void PreOp(const Input& input, const Tag& tag) {
+        const size_t index = Tag::value ? 0 : 1;
+        const size_t recipient =
+            hash_function_(GetKey(input, tag)) % writers_[index].size();
+        writers_[index][recipient].Put(input);
+    }
+
+    void StopPreOp(size_t parent_index) final {
+        LOG << *this << " StopPreOp() parent_index=" << parent_index;
+        for (size_t i = 0; i < writers_[parent_index].size(); ++i)
+            writers_[parent_index][i].Close();
+    }
+
+    void Execute() final {
+        MainOp();
+    }
+
+    DIAMemUse PushDataMemUse() final {
+        // request maximum RAM limit, the value is calculated by StageBuilder,
+        // and set as DIABase::mem_limit_.
+        return DIAMemUse::Max();
+    }
+
+    void PushData(bool consume) final {
+        common::StatsTimerStart timer;
+
+        LOG << "InnerJoin: first " << files_[0].num_items()
+            << " items " << files_[0].size_bytes() << " bytes, second "
+            << files_[1].num_items()
+            << " items " << files_[1].size_bytes() << " bytes";
+
+        num_partitioned_ = num_chunked_ = 0;
+        Join(files_[0], files_[1], consume, /* level */ 0);
+
+        timer.Stop();
+        LOG << "RESULT"
+            << " name=innerjoin"
+            << " time=" << timer.Milliseconds()
+            << " partitioned=" << num_partitioned_
+            << " chunked=" << num_chunked_;
+    }
+
+    void Dispose() final {
+        files_[0].Clear();
+        files_[1].Clear();
+    }
+
+private:
+    KeyExtractor1 key_extractor1_;
+    KeyExtractor2 key_extractor2_;
+    JoinFunction join_function_;
+    HashFunction hash_function_;
+
+    //! streams for hash partitioning the two inputs
+    data::CatStreamPtr streams_[2] = {
+        context_.GetNewCatStream(this), context_.GetNewCatStream(this)
+    };
+
+    //! writers of the two streams
+    std::vector<data::Stream::Writer> writers_[2];
+
+    //! received local items of the two inputs
+    data::File files_[2] = {
+        context_.GetFile(this), context_.GetFile(this)
+    };
+
+    //! statistics: number of grace partitionings and chunked joins
+    size_t num_partitioned_ = 0, num_chunked_ = 0;
+
+    //! \name Accessors selected by tag type
+    //! \{
+
+    Key GetKey(const InputTypeFirst& input, const FirstTag&) const {
+        return key_extractor1_(input);
+    }
+
+    Key GetKey(const InputTypeSecond& input, const SecondTag&) const {
+        return key_extractor2_(input);
+    }
+
+    ValueType Apply(const InputTypeFirst& build, const InputTypeSecond& probe,
+                    const FirstTag&) const {
+        return join_function_(build, probe);
+    }
+
+    ValueType Apply(const InputTypeSecond& build, const InputTypeFirst& probe,
+                    const SecondTag&) const {
+        return join_function_(probe, build);
+    }
+
+    //! \}
+
+    //! Receive elements from other workers.
+    void MainOp() {
+        ReceiveFile<InputTypeFirst>(0);
+        ReceiveFile<InputTypeSecond>(1);
+    }
+
+    //! Receive the items of stream index into the File index.
+    template <typename Input>
+    void ReceiveFile(size_t index) {
+        data::File::Writer writer = files_[index].GetWriter();
+        auto reader = streams_[index]->GetCatReader(/* consume */ true);
+        while (reader.HasNext()) {
+            writer.Put(reader.template Next<Input>());
+        }
+        writer.Close();
+        streams_[index]->Close();
+    }
+
+    //! Estimated memory of a hash table containing the items of a File.
+    template <typename BuildType>
+    size_t EstimateMemory(const data::File& build) const {
+        return build.size_bytes()
+               + build.num_items()
+               * (sizeof(Key) + sizeof(BuildType) + entry_overhead_);
+    }
+
+    //! Join two Files, selecting the smaller one as build side.
+    void Join(data::File& first, data::File& second, bool consume,
+              size_t level) {
+        if (first.size_bytes() <= second.size_bytes())
+            HashJoin(first, second, consume, level, FirstTag());
+        else
+            HashJoin(second, first, consume, level, SecondTag());
+    }
+
+    //! Join with the build side selected by BuildTag, partitioning both sides
+    //! if the build side exceeds the memory limit.
+    template <typename BuildTag>
+    void HashJoin(data::File& build, data::File& probe, bool consume,
+                  size_t level, const BuildTag& tag) {
+        using BuildType = typename std::conditional<
+                  BuildTag::value, InputTypeFirst, InputTypeSecond>::type;
+        using ProbeType = typename std::conditional<
+                  BuildTag::value, InputTypeSecond, InputTypeFirst>::type;
+
+        if (build.num_items() == 0 || probe.num_items() == 0) {
+            if (consume) build.Clear(), probe.Clear();
+            return;
+        }
+
+        const size_t limit = DIABase::mem_limit_;
+        const size_t build_memory = EstimateMemory<BuildType>(build);
+
+        if (build_memory <= limit || level >= max_levels_) {
+            ChunkedJoin(build, probe, consume, tag);
+            return;
+        }
+
+        // each partition's Writer holds one Block, use at most half of the
+        // memory for them.
+        const size_t max_fanout = std::max<size_t>(
+            2, limit / 2 / data::default_block_size);
+        const size_t fanout = std::min(
+            max_fanout, 2 * build_memory / std::max<size_t>(limit, 1) + 1);
+
+        sLOG << "InnerJoin: grace partitioning level" << level
+             << "build_memory" << build_memory << "limit" << limit
+             << "fanout" << fanout;
+        ++num_partitioned_;
+
+        const size_t build_items = build.num_items();
+
+        std::vector<data::File> build_parts, probe_parts;
+        Partition<BuildType>(build, build_parts, fanout, consume, level, tag);
+        Partition<ProbeType>(
+            probe, probe_parts, fanout, consume, level,
+            std::integral_constant<bool, !BuildTag::value>());
+
+        for (size_t p = 0; p < fanout; ++p) {
+            if (build_parts[p].num_items() == build_items) {
+                // partitioning did not shrink the build side: all items share
+                // a hash value, do not recurse further.
+                ChunkedJoin(build_parts[p], probe_parts[p], true, tag);
+            }
+            else if (BuildTag::value) {
+                Join(build_parts[p], probe_parts[p], true, level + 1);
+            }
+            else {
+                Join(probe_parts[p], build_parts[p], true, level + 1);
+            }
+        }
+    }
+
+    //! Distribute the items of a File by salted hash of their key into fanout
+    //! sub-Files.
+    template <typename Input, typename Tag>
+    void Partition(data::File& file, std::vector<data::File>& parts,
+                   size_t fanout, bool consume, size_t level, const Tag& tag) {
+        std::vector<data::File::Writer> writers;
+        parts.reserve(fanout), writers.reserve(fanout);
+        for (size_t p = 0; p < fanout; ++p) {
+            parts.emplace_back(context_.GetFile(this));
+            writers.emplace_back(parts.back().GetWriter());
+        }
+
+        auto reader = file.GetReader(consume);
+        while (reader.HasNext()) {
+            Input item = reader.template Next<Input>();
+            // salt the hash with the level: the partition must be independent
+            // of the worker and of previous levels' partition.
+            size_t p = core::Hash128to64(
+                level + 1, hash_function_(GetKey(item, tag))) % fanout;
+            writers[p].Put(item);
+        }
+
+        for (size_t p = 0; p < fanout; ++p)
+            writers[p].Close();
+    }
+
+    //! Load the build side in chunks fitting into the memory limit into a hash
+    //! table, and scan the probe side once per chunk.
+    template <typename BuildTag>
+    void ChunkedJoin(data::File& build, data::File& probe, bool consume,
+                     const BuildTag& tag) {
+        using BuildType = typename std::conditional<
+                  BuildTag::value, InputTypeFirst, InputTypeSecond>::type;
+        using ProbeType = typename std::conditional<
+                  BuildTag::value, InputTypeSecond, InputTypeFirst>::type;
+        using ProbeTag = std::integral_constant<bool, !BuildTag::value>;
+
+        using Table = std::unordered_multimap<Key, BuildType, HashFunction>;
+
+        const size_t limit = DIABase::mem_limit_;
+        const size_t avg_bytes =
+            build.size_bytes() / std::max<size_t>(build.num_items(), 1);
+        const size_t item_memory =
+            avg_bytes + sizeof(Key) + sizeof(BuildType) + entry_overhead_;
+        const size_t max_items =
+            std::max<size_t>(1, limit / item_memory);
+
+        Table table(std::min(max_items, build.num_items()), hash_function_);
+
+        auto build_reader = build.GetReader(consume);
+        while (build_reader.HasNext()) {
+            table.clear();
+            while (build_reader.HasNext() && table.size() < max_items) {
+                BuildType item = build_reader.template Next<BuildType>();
+                Key key = GetKey(item, tag);
+                table.emplace(std::move(key), std::move(item));
+            }
+            ++num_chunked_;
+
+            // the probe side is consumed during the last scan.
+            auto probe_reader = probe.GetReader(
+                consume && !build_reader.HasNext());
+            while (probe_reader.HasNext()) {
+                ProbeType item = probe_reader.template Next<ProbeType>();
+                auto range = table.equal_range(GetKey(item, ProbeTag()));
+                for (auto it = range.first; it != range.second; ++it)
+                    this->PushItem(Apply(it->second, item, tag));
+            }
+        }
+    }
+};
+
+/******************************************************************************/
+
+template <typename ValueType, typename Stack>
+template <typename JoinFunction, typename KeyExtractor1,
+          typename KeyExtractor2, typename SecondDIA, typename HashFunction>
+auto DIA<ValueType, Stack>::InnerJoin(
+    const SecondDIA &second_dia,
+    const KeyExtractor1 &key_extractor1, const KeyExtractor2 &key_extractor2,
+    const JoinFunction &join_function,
+    const HashFunction &hash_function) const {
+
+    AssertValid();
+    second_dia.AssertValid();
+
+    static_assert(
+        std::is_convertible<
+            ValueType,
+            typename common::FunctionTraits<KeyExtractor1>::template arg<0>
+            >::value,
+        "KeyExtractor1 has the wrong input type");
+
+    static_assert(
+        std::is_convertible<
+            typename SecondDIA::ValueType,
+            typename common::FunctionTraits<KeyExtractor2>::template arg<0>
+            >::value,
+        "KeyExtractor2 has the wrong input type");
+
+    static_assert(
+        std::is_convertible<
+            ValueType,
+            typename common::FunctionTraits<JoinFunction>::template arg<0>
+            >::value,
+        "JoinFunction has the wrong first input type");
+
+    static_assert(
+        std::is_convertible<
+            typename SecondDIA::ValueType,
+            typename common::FunctionTraits<JoinFunction>::template arg<1>
+            >::value,
+        "JoinFunction has the wrong second input type");
+
+    using JoinResult =
+              typename common::FunctionTraits<JoinFunction>::result_type;
+
+    using InnerJoinNode = api::InnerJoinNode<
+              JoinResult, DIA, SecondDIA, KeyExtractor1, KeyExtractor2,
+              JoinFunction, HashFunction>;
+
+    auto node = common::MakeCounting<InnerJoinNode>(
+        *this, second_dia, key_extractor1, key_extractor2, join_function,
+        hash_function);
+
+    return DIA<JoinResult>(node);
+}
+
+} // namespace api
+} // namespace thrill
+
+#endif // !THRILL_API_INNER_JOIN_HEADER
+
+/******************************************************************************/
@@ -0,0 +1,500 @@
+/*******************************************************************************
+ * thrill/api/merge_join.hpp
+ *
+ * DIANode for a sort-merge inner join of two DIAs sorted by key. Both DIAs are
+ * split at identical key boundaries and joined locally without hashing.
+ *
+ * Part of Project Thrill - http://project-thrill.org
+ *
+ * All rights reserved. Published under the BSD-2 license in the LICENSE file.
+ ******************************************************************************/
+
+#pragma once
+#ifndef THRILL_API_MERGE_JOIN_HEADER
+#define THRILL_API_MERGE_JOIN_HEADER
+
+#include <thrill/api/dia.hpp>
+#include <thrill/api/dop_node.hpp>
+#include <thrill/common/functional.hpp>
+#include <thrill/common/logger.hpp>
+#include <thrill/common/stats_timer.hpp>
+#include <thrill/common/string.hpp>
+#include <thrill/data/file.hpp>
+
+#include <algorithm>
+#include <array>
+#include <functional>
+#include <random>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace thrill {
+namespace api {
+
+/*!
+ * A DIANode which performs an inner join of two DIAs which are both sorted by
+ * their keys.
+ *
+ * The main op selects p-1 splitter keys with the same distributed
+ * multi-sequence selection as MergeNode: random pivots are selected from the
+ * largest remaining search range via an AllReduce, and their global ranks are
+ * calculated from the local ranks in both Files. In contrast to MergeNode, the
+ * pivots are keys, and the ranks are the number of items with smaller key,
+ * hence items with equal keys are never split between workers. The search for
+ * a splitter finishes when all ranges are empty, which yields the key boundary
+ * whose rank is closest above the target rank.
+ *
+ * Both Files are scattered at these key boundaries, such that all items with
+ * equal key of both DIAs arrive on the same worker in sorted order. PushData()
+ * then merges the two sorted streams and applies the join function to all
+ * pairs of items with equal key. Only the items of one key of the second DIA
+ * are held in memory at a time.
+ *
+ * \ingroup api_layer
+ */
+template <typename ValueType,
+          typename FirstDIA, typename SecondDIA,
+          typename KeyExtractor1, typename KeyExtractor2,
+          typename JoinFunction, typename KeyComparator>
+class MergeJoinNode final : public DOpNode<ValueType>
+{
+    static constexpr bool debug = false;
+    static constexpr bool self_verify = debug && common::g_debug_mode;
+
+    using Super = DOpNode<ValueType>;
+    using Super::context_;
+
+    using InputTypeFirst = typename FirstDIA::ValueType;
+    using InputTypeSecond = typename SecondDIA::ValueType;
+
+    using Key = typename common::FunctionTraits<KeyExtractor1>::result_type;
+
+    static_assert(
+        std::is_same<
+            Key, typename common::FunctionTraits<KeyExtractor2>::result_type
+            >::value,
+        "Both KeyExtractors must return the same key type");
+
+    //! a pivot key and the length of the range it was selected from
+    using Pivot = std::pair<Key, size_t>;
+
+    using ArraySizeT = std::array<size_t, 2>;
+
+public:
+    MergeJoinNode(const FirstDIA& first_dia, const SecondDIA& second_dia,
+                  const KeyExtractor1& key_extractor1,
+                  const KeyExtractor2& key_extractor2,
+                  const JoinFunction& join_function,
+                  const KeyComparator& key_comparator)
+        : Super(first_dia.ctx(), "MergeJoin",
+                { first_dia.id(), second_dia.id() },
+                { first_dia.node(), second_dia.node() }),
+          key_extractor1_(key_extractor1),
+          key_extractor2_(key_extractor2),
+          join_function_(join_function),
+          key_comparator_(key_comparator),
+          parent_stack_empty_ {
+              FirstDIA::stack_empty, SecondDIA::stack_empty
+          }
+    {
+        data::File::Writer* writer1 = &writers_[0];
+        auto pre_op_fn1 = [writer1](const InputTypeFirst& input) {
+                              writer1->Put(input);
+                          };
+        data::File::Writer* writer2 = &writers_[1];
+        auto pre_op_fn2 = [writer2](const InputTypeSecond& input) {
+                              writer2->Put(input);
+                          };
+
+        // close the function stacks with our pre ops and register it at
+        // parent nodes for output
+        auto lop_chain1 = first_dia.stack().push(pre_op_fn1).fold();
+        first_dia.node()->AddChild(this, lop_chain1, 0);
+
+        auto lop_chain2 = second_dia.stack().push(pre_op_fn2).fold();
+        second_dia.node()->AddChild(this, lop_chain2, 1);
+    }
+
+    void StartPreOp(size_t parent_index) final {
+        writers_[parent_index] = files_[parent_index].GetWriter();
+    }
+
+    //! Receive a whole data::File, but only if the parent's stack is empty.
+    bool OnPreOpFile(const data::File& file, size_t parent_index) final {
+        assert(parent_index < 2);
+        if (!parent_stack_empty_[parent_index]) return false;
+
+        // accept file
+        assert(files_[parent_index].num_items() == 0);
+        files_[parent_index] = file.Copy();
+        return true;
+    }
+
+    void StopPreOp(size_t parent_index) final {
+        LOG << *this << " StopPreOp() parent_index=" << parent_index;
+        writers_[parent_index].Close();
+    }
+
+    void Execute() final {
+        MainOp();
+    }
+
+    void PushData(bool consume) final {
+        common::StatsTimerStart timer;
+        size_t result_count = 0;
+
+        auto reader1 = streams_[0]->GetCatReader(consume);
+        auto reader2 = streams_[1]->GetCatReader(consume);
+
+        bool has1 = reader1.HasNext(), has2 = reader2.HasNext();
+        if (!has1 || !has2) return;
+
+        InputTypeFirst item1 = reader1.template Next<InputTypeFirst>();
+        InputTypeSecond item2 = reader2.template Next<InputTypeSecond>();
+
+        // items of the second DIA with the current key
+        std::vector<InputTypeSecond> group;
+
+        while (has1 && has2) {
+            Key key1 = key_extractor1_(item1), key2 = key_extractor2_(item2);
+
+            if (key_comparator_(key1, key2)) {
+                if ((has1 = reader1.HasNext()))
+                    item1 = reader1.template Next<InputTypeFirst>();
+                continue;
+            }
+            if (key_comparator_(key2, key1)) {
+                if ((has2 = reader2.HasNext()))
+                    item2 = reader2.template Next<InputTypeSecond>();
+                continue;
+            }
+
+            // collect all items of the second DIA with equal key
+            group.clear();
+            group.emplace_back(std::move(item2));
+            while ((has2 = reader2.HasNext())) {
+                item2 = reader2.template Next<InputTypeSecond>();
+                if (key_comparator_(key2, key_extractor2_(item2))) break;
+                group.emplace_back(item2);
+            }
+
+            // join them with all items of the first DIA with equal key
+            do {
+                for (const InputTypeSecond& g : group)
+                    this->PushItem(join_function_(item1, g));
+                result_count += group.size();
+
+                if ((has1 = reader1.HasNext()))
+                    item1 = reader1.template Next<InputTypeFirst>();
+            } while (has1 &&
+                     !key_comparator_(key2, key_extractor1_(item1)));
+        }
+
+        timer.Stop();
+        LOG << "RESULT"
+            << " name=mergejoin"
+            << " time=" << timer.Milliseconds()
+            << " result_count=" << result_count;
+    }
+
+    void Dispose() final {
+        files_[0].Clear();
+        files_[1].Clear();
+    }
+
+private:
+    KeyExtractor1 key_extractor1_;
+    KeyExtractor2 key_extractor2_;
+    JoinFunction join_function_;
+    KeyComparator key_comparator_;
+
+    //! Whether the parent stacks are empty
+    const bool parent_stack_empty_[2];
+
+    //! Random generator for pivot selection.
+    std::default_random_engine rng_ { std::random_device { } () };
+
+    //! Files for intermediate storage
+    data::File files_[2] = {
+        context_.GetFile(this), context_.GetFile(this)
+    };
+
+    //! Writers to intermediate files
+    data::File::Writer writers_[2];
+
+    //! CatStreams for scattering the Files at the splitter keys
+    data::CatStreamPtr streams_[2] = {
+        context_.GetNewCatStream(this), context_.GetNewCatStream(this)
+    };
+
+    //! \name Accessors selected by input index
+    //! \{
+
+    Key GetKeyAt(size_t input, size_t index) const {
+        if (input == 0) {
+            return key_extractor1_(
+                files_[0].template GetItemAt<InputTypeFirst>(index));
+        }
+        return key_extractor2_(
+            files_[1].template GetItemAt<InputTypeSecond>(index));
+    }
+
+    //! \}
+
+    //! Binary search for the first item in [left,right) of File input whose
+    //! key is not less than key (or greater than key, if upper is set).
+    size_t Bound(size_t input, const Key& key, size_t left, size_t right,
+                 bool upper) const {
+        while (left < right) {
+            size_t mid = (left + right) / 2;
+            Key mid_key = GetKeyAt(input, mid);
+            bool go_right = upper ? !key_comparator_(key, mid_key)
+                            : key_comparator_(mid_key, key);
+            if (go_right)
+                left = mid + 1;
+            else
+                right = mid;
+        }
+        return left;
+    }
+
+    //! Check that the local Files are sorted by key.
+    template <typename Input, typename KeyExtractor>
+    void CheckSorted(const data::File& file,
+                     const KeyExtractor& key_extractor) {
+        auto reader = file.GetKeepReader();
+        if (!reader.HasNext()) return;
+
+        Key prev = key_extractor(reader.template Next<Input>());
+        while (reader.HasNext()) {
+            Key next = key_extractor(reader.template Next<Input>());
+            if (key_comparator_(next, prev))
+                die("MergeJoin input was not sorted by key!");
+            prev = std::move(next);
+        }
+    }
+
+    /*!
+     * Selects random global pivot keys for all splitter searches from the
+     * largest range of all workers, as in MergeNode::SelectPivots().
+     */
+    void SelectPivots(
+        const std::vector<ArraySizeT>& left,
+        const std::vector<ArraySizeT>& width,
+        std::vector<Pivot>& out_pivots) {
+
+        for (size_t s = 0; s < width.size(); ++s) {
+            size_t mp = width[s][1] > width[s][0] ? 1 : 0;
+
+            // an empty range will lose against any other worker's pivot.
+            out_pivots[s] = Pivot(Key(), width[s][mp]);
+
+            if (width[s][mp] > 0) {
+                size_t pivot_idx = left[s][mp] + (rng_() % width[s][mp]);
+                out_pivots[s].first = GetKeyAt(mp, pivot_idx);
+            }
+        }
+
+        // select the pivots from the largest ranges globally.
+        out_pivots = context_.net.AllReduce(
+            out_pivots,
+            common::ComponentSum<std::vector<Pivot>, ReducePivots>());
+    }
+
+    //! Reduce functor that returns the pivot originating from the biggest
+    //! range.
+    class ReducePivots
+    {
+    public:
+        Pivot operator () (const Pivot& a, const Pivot& b) const {
+            return a.second > b.second ? a : b;
+        }
+    };
+
+    /*!
+     * Calculates the global ranks of the given pivot keys, which are the
+     * number of items with smaller key in both DIAs, and shrinks the search
+     * ranges: if the rank is below the target, the range continues after all
+     * items with the pivot key, otherwise before them.
+     */
+    void SearchStep(
+        const std::vector<Pivot>& pivots,
+        const std::vector<size_t>& target_ranks,
+        std::vector<ArraySizeT>& left, std::vector<ArraySizeT>& width) {
+
+        std::vector<ArraySizeT> local_ranks(pivots.size());
+        std::vector<size_t> global_ranks(pivots.size());
+
+        for (size_t s = 0; s < pivots.size(); ++s) {
+            if (pivots[s].second == 0) continue;
+            for (size_t i = 0; i < 2; ++i) {
+                // all items before the range have smaller keys than the pivot,
+                // and all items after it larger keys.
+                local_ranks[s][i] = Bound(
+                    i, pivots[s].first,
+                    left[s][i], left[s][i] + width[s][i], false);
+                global_ranks[s] += local_ranks[s][i];
+            }
+        }
+
+        global_ranks = context_.net.AllReduce(
+            global_ranks, common::ComponentSum<std::vector<size_t> >());
+
+        for (size_t s = 0; s < pivots.size(); ++s) {
+            if (pivots[s].second == 0) continue;
+            for (size_t i = 0; i < 2; ++i) {
+                if (width[s][i] == 0) continue;
+
+                size_t right = left[s][i] + width[s][i];
+                if (global_ranks[s] < target_ranks[s]) {
+                    size_t upper = Bound(
+                        i, pivots[s].first, local_ranks[s][i], right, true);
+                    width[s][i] = right - upper;
+                    left[s][i] = upper;
+                }
+                else {
+                    width[s][i] = local_ranks[s][i] - left[s][i];
+                }
+            }
+        }
+    }
+
+    //! Select the splitter keys and scatter both Files.
+    void MainOp() {
+        common::StatsTimerStart timer;
+
+        if (self_verify) {
+            CheckSorted<InputTypeFirst>(files_[0], key_extractor1_);
+            CheckSorted<InputTypeSecond>(files_[1], key_extractor2_);
+        }
+
+        const size_t p = context_.num_workers();
+
+        size_t global_size = context_.net.AllReduce(
+            files_[0].num_items() + files_[1].num_items());
+
+        // the ranks we search for split the data into equal parts.
+        std::vector<size_t> target_ranks(p - 1);
+        for (size_t r = 0; r < p - 1; ++r) {
+            target_ranks[r] = (global_size / p) * (r + 1);
+            if (r < global_size % p)
+                target_ranks[r] += 1;
+        }
+
+        // search range bounds of each splitter in each File.
+        std::vector<ArraySizeT> left(p - 1), width(p - 1);
+        for (size_t r = 0; r < p - 1; ++r) {
+            for (size_t i = 0; i < 2; ++i) {
+                left[r][i] = 0;
+                width[r][i] = files_[i].num_items();
+            }
+        }
+
+        std::vector<Pivot> pivots(p - 1);
+        size_t iterations = 0;
+
+        while (true) {
+            SelectPivots(left, width, pivots);
+
+            // finished if all ranges on all workers are empty.
+            bool finished = true;
+            for (size_t s = 0; s < p - 1; ++s) {
+                if (pivots[s].second != 0) finished = false;
+            }
+            if (finished) break;
+
+            SearchStep(pivots, target_ranks, left, width);
+            ++iterations;
+        }
+
+        // the empty ranges are at the key boundaries
+        for (size_t i = 0; i < 2; ++i) {
+            std::vector<size_t> offsets(p + 1, 0);
+            for (size_t r = 0; r < p - 1; ++r)
+                offsets[r + 1] = left[r][i];
+            offsets[p] = files_[i].num_items();
+
+            LOG << "MergeJoin: scatter file " << i << " "
+                << common::VecToStr(offsets);
+
+            if (i == 0) {
+                streams_[0]->template Scatter<InputTypeFirst>(
+                    files_[0], offsets, /* consume */ true);
+            }
+            else {
+                streams_[1]->template Scatter<InputTypeSecond>(
+                    files_[1], offsets, /* consume */ true);
+            }
+        }
+
+        timer.Stop();
+        LOG << "RESULT"
+            << " name=mergejoin_split"
+            << " time=" << timer.Milliseconds()
+            << " iterations=" << iterations;
+    }
+};
+
+/******************************************************************************/
+
+template <typename ValueType, typename Stack>
+template <typename JoinFunction, typename KeyExtractor1,
+          typename KeyExtractor2, typename SecondDIA, typename KeyComparator>
+auto DIA<ValueType, Stack>::InnerJoin(
+    struct SortedTag const &, const SecondDIA &second_dia,
+    const KeyExtractor1 &key_extractor1, const KeyExtractor2 &key_extractor2,
+    const JoinFunction &join_function,
+    const KeyComparator &key_comparator) const {
+
+    AssertValid();
+    second_dia.AssertValid();
+
+    static_assert(
+        std::is_convertible<
+            ValueType,
+            typename common::FunctionTraits<KeyExtractor1>::template arg<0>
+            >::value,
+        "KeyExtractor1 has the wrong input type");
+
+    static_assert(
+        std::is_convertible<
+            typename SecondDIA::ValueType,
+            typename common::FunctionTraits<KeyExtractor2>::template arg<0>
+            >::value,
+        "KeyExtractor2 has the wrong input type");
+
+    static_assert(
+        std::is_convertible<
+            ValueType,
+            typename common::FunctionTraits<JoinFunction>::template arg<0>
+            >::value,
+        "JoinFunction has the wrong first input type");
+
+    static_assert(
+        std::is_convertible<
+            typename SecondDIA::ValueType,
+            typename common::FunctionTraits<JoinFunction>::template arg<1>
+            >::value,
+        "JoinFunction has the wrong second input type");
+
+    using JoinResult =
+              typename common::FunctionTraits<JoinFunction>::result_type;
+
+    using MergeJoinNode = api::MergeJoinNode<
+              JoinResult, DIA, SecondDIA, KeyExtractor1, KeyExtractor2,
+              JoinFunction, KeyComparator>;
+
+    auto node = common::MakeCounting<MergeJoinNode>(
+        *this, second_dia, key_extractor1, key_extractor2, join_function,
+        key_comparator);
+
+    return DIA<JoinResult>(node);
+}
+
+} // namespace api
+} // namespace thrill
+
+#endif // !THRILL_API_MERGE_JOIN_HEADER
+
+/******************************************************************************/
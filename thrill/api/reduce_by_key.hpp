@@ -78,6 +78,10 @@ class ReduceNode final : public DOpNode<ValueType>
     static constexpr bool use_mix_stream_ = ReduceConfig::use_mix_stream_;
     static constexpr bool use_post_thread_ = ReduceConfig::use_post_thread_;
 
+    using PrePhase = core::ReducePrePhase<
+              TableItem, Key, ValueType, KeyExtractor, ReduceFunction,
+              VolatileKey, ReduceConfig, HashIndexFunction, KeyEqualFunction>;
+
 private:
     //! Emitter for PostPhase to push elements to next DIA object.
     class Emitter
@@ -104,6 +108,26 @@ public:
                const ReduceConfig& config,
                const KeyHashFunction& key_hash_function,
                const KeyEqualFunction& key_equal_function)
+        : ReduceNode(parent, label, key_extractor, reduce_function, config,
+                     key_hash_function, key_equal_function,
+                     [](PrePhase& pre_phase, const ValueType& input) {
+                         return pre_phase.Insert(input);
+                     }) { }
+
+    /*!
+     * Constructor for a ReduceNode with a custom PreOp, which is called as
+     * pre_op(pre_phase, input) for each element of the parent DIA and inserts
+     * it into the pre phase, e.g. using ReducePrePhase::InsertWith().
+     */
+    template <typename ParentDIA, typename PreOpFunction>
+    ReduceNode(const ParentDIA& parent,
+               const char* label,
+               const KeyExtractor& key_extractor,
+               const ReduceFunction& reduce_function,
+               const ReduceConfig& config,
+               const KeyHashFunction& key_hash_function,
+               const KeyEqualFunction& key_equal_function,
+               const PreOpFunction& pre_op)
         : Super(parent.ctx(), label, { parent.id() }, { parent.node() }),
           mix_stream_(use_mix_stream_ ?
                       parent.ctx().GetNewMixStream(this) : nullptr),
@@ -123,9 +147,10 @@ public:
         // Hook PreOp: Locally hash elements of the current DIA onto buckets and
         // reduce each bucket to a single value, afterwards send data to another
         // worker given by the shuffle algorithm.
-        auto pre_op_fn = [this](const ValueType& input) {
-                             return pre_phase_.Insert(input);
-                         };
+        auto pre_op_fn =
+            [this, pre_op](const typename ParentDIA::ValueType& input) {
+                return pre_op(pre_phase_, input);
+            };
         // close the function stack with our pre op and register it at
         // parent node for output
         auto lop_chain = parent.stack().push(pre_op_fn).fold();
@@ -218,9 +243,7 @@ private:
     //! handle to additional thread for post phase
     std::thread thread_;
 
-    core::ReducePrePhase<
-        TableItem, Key, ValueType, KeyExtractor, ReduceFunction, VolatileKey,
-        ReduceConfig, HashIndexFunction, KeyEqualFunction> pre_phase_;
+    PrePhase pre_phase_;
 
     core::ReduceByHashPostPhase<
         TableItem, Key, ValueType, KeyExtractor, ReduceFunction, Emitter,
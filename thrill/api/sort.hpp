@@ -17,20 +17,26 @@
 #include <thrill/api/context.hpp>
 #include <thrill/api/dia.hpp>
 #include <thrill/api/dop_node.hpp>
+#include <thrill/common/functional.hpp>
 #include <thrill/common/logger.hpp>
 #include <thrill/common/math.hpp>
 #include <thrill/common/porting.hpp>
 #include <thrill/common/qsort.hpp>
+#include <thrill/common/radix_sort.hpp>
+#include <thrill/common/thread_pool.hpp>
 #include <thrill/core/multiway_merge.hpp>
+#include <thrill/core/sample_sort_classifier.hpp>
 #include <thrill/data/file.hpp>
 #include <thrill/net/group.hpp>
 
 #include <algorithm>
+#include <array>
 #include <cstdlib>
 #include <deque>
 #include <functional>
 #include <numeric>
 #include <random>
+#include <thread>
 #include <utility>
 #include <vector>
 
@@ -70,6 +76,19 @@ class SortNode final : public DOpNode<ValueType>
 
     static const bool use_background_thread_ = false;
 
+    //! minimum number of items per thread to sort runs in parallel
+    static const size_t parallel_sort_min_items_ = 65536;
+
+    //! number of samples per run and part to split runs for parallel merging
+    static const size_t parallel_merge_oversampling_ = 16;
+
+    //! number of items read, classified, and then transmitted at once
+    static const size_t transmit_batch_size_ = 256;
+
+    //! minimum average length of natural runs for merging them instead of
+    //! sorting
+    static const size_t natural_run_min_items_ = 1024;
+
 public:
     /*!
      * Constructor for a sort node.
@@ -227,7 +246,12 @@ public:
                 for (size_t t = 0; t < merge_degree; ++t)
                     seq.emplace_back(files_[t].GetConsumeReader(0));
 
-                StartPrefetch(seq, prefetch);
+                data::ForecastPrefetcher<data::File::ConsumeReader> prefetcher(
+                    seq, data::ForecastSchedule(
+                        file_triggers_.begin(),
+                        file_triggers_.begin() + merge_degree,
+                        compare_function_),
+                    merge_degree * prefetch);
 
                 auto puller = core::make_multiway_merge_tree<ValueType>(
                     seq.begin(), seq.end(), compare_function_);
@@ -240,12 +264,15 @@ public:
                     writer.Put(puller.Next());
                 }
                 writer.Close();
+                AddFileTriggers();
 
                 // this clear is important to release references to the files.
                 seq.clear();
 
                 // remove merged files
                 files_.erase(files_.begin(), files_.begin() + merge_degree);
+                file_triggers_.erase(file_triggers_.begin(),
+                                     file_triggers_.begin() + merge_degree);
             }
 
             std::tie(merge_degree, prefetch) = MaxMergeDegreePrefetch();
@@ -254,20 +281,19 @@ public:
                   << "with prefetch" << prefetch;
 
             // construct output merger of remaining Files
-            std::vector<data::File::Reader> seq;
-            seq.reserve(files_.size());
-
-            for (size_t t = 0; t < files_.size(); ++t)
-                seq.emplace_back(files_[t].GetReader(consume, 0));
-
-            StartPrefetch(seq, prefetch);
-
-            auto puller = core::make_multiway_merge_tree<ValueType>(
-                seq.begin(), seq.end(), compare_function_);
-
-            while (puller.HasNext()) {
-                this->PushItem(puller.Next());
-                local_size++;
+            if (consume) {
+                std::vector<data::File::ConsumeReader> seq;
+                seq.reserve(files_.size());
+                for (size_t t = 0; t < files_.size(); ++t)
+                    seq.emplace_back(files_[t].GetConsumeReader(0));
+                local_size = MergeAndPush(seq, prefetch);
+            }
+            else {
+                std::vector<data::File::KeepReader> seq;
+                seq.reserve(files_.size());
+                for (size_t t = 0; t < files_.size(); ++t)
+                    seq.emplace_back(files_[t].GetKeepReader(0));
+                local_size = MergeAndPush(seq, prefetch);
             }
         }
 
@@ -283,6 +309,7 @@ public:
 
     void Dispose() final {
         files_.clear();
+        file_triggers_.clear();
     }
 
 private:
@@ -305,6 +332,10 @@ private:
     //! Number of items on this worker
     size_t local_items_ = 0;
 
+    //! Number of natural ascending runs in the local items, counted only up
+    //! to MaxNaturalRuns() + 1
+    size_t local_runs_ = 0;
+
     //! Sample vector: pairs of (sample,local index)
     std::vector<SampleIndexPair> samples_;
     //! Number of items to process before the next sample was drawn
@@ -330,6 +361,8 @@ private:
 
     //! Local data files
     std::deque<data::File> files_;
+    //! Block triggers of files_ for forecasting prefetch during merging
+    std::deque<std::vector<ValueType> > file_triggers_;
     //! Total number of local elements after communication
     size_t local_out_size_ = 0;
 
@@ -388,77 +421,62 @@ private:
             sample_writers[j].Close();
     }
 
-    class TreeBuilder
-    {
-    public:
-        ValueType* tree_;
-        const SampleIndexPair* samples_;
-        size_t index_ = 0;
-        size_t ssplitter_;
-
-        /*!
-         * Target: tree. Size of 'number of splitter'
-         * Source: sorted splitters. Size of 'number of splitter'
-         * Number of splitter
-         */
-        TreeBuilder(ValueType* splitter_tree,
-                    const SampleIndexPair* samples,
-                    size_t ssplitter)
-            : tree_(splitter_tree),
-              samples_(samples),
-              ssplitter_(ssplitter) {
-            if (ssplitter != 0)
-                recurse(samples, samples + ssplitter, 1);
-        }
-
-        void recurse(const SampleIndexPair* lo, const SampleIndexPair* hi,
-                     unsigned int treeidx) {
-            // pick middle element as splitter
-            const SampleIndexPair* mid = lo + (ssize_t)(hi - lo) / 2;
-            assert(mid < samples_ + ssplitter_);
-            tree_[treeidx] = mid->first;
-
-            if (2 * treeidx < ssplitter_)
-            {
-                const SampleIndexPair* midlo = mid, * midhi = mid + 1;
-                recurse(lo, midlo, 2 * treeidx + 0);
-                recurse(midhi, hi, 2 * treeidx + 1);
-            }
+    //! record the Block triggers of the last File in files_ for forecasting
+    //! the order in which merging needs its Blocks. Must be called while the
+    //! File's Blocks are still in memory.
+    void AddFileTriggers() {
+        file_triggers_.emplace_back(
+            files_.back().template GetBlockTriggers<ValueType>());
+    }
+
+    //! multiway merge all Files with forecasting prefetch of up to prefetch
+    //! Blocks per File and push the items, returns number of items.
+    template <typename Reader>
+    size_t MergeAndPush(std::vector<Reader>& seq, size_t prefetch) {
+        data::ForecastPrefetcher<Reader> prefetcher(
+            seq, data::ForecastSchedule(
+                file_triggers_.begin(), file_triggers_.end(),
+                compare_function_),
+            seq.size() * prefetch);
+
+        auto puller = core::make_multiway_merge_tree<ValueType>(
+            seq.begin(), seq.end(), compare_function_);
+
+        size_t local_size = 0;
+        while (puller.HasNext()) {
+            this->PushItem(puller.Next());
+            local_size++;
         }
-    };
+
+        LOG << "MergeAndPush() prefetched " << prefetcher.num_issued()
+            << " Blocks, forecast missed " << prefetcher.num_missed();
+
+        return local_size;
+    }
 
     bool LessSampleIndex(const SampleIndexPair& a, const SampleIndexPair& b) {
         return compare_function_(a.first, b.first) || (
             !compare_function_(b.first, a.first) && a.second < b.second);
     }
 
-    bool EqualSampleGreaterIndex(const SampleIndexPair& a, const SampleIndexPair& b) {
-        return !compare_function_(a.first, b.first) && a.second >= b.second;
-    }
-
-    //! round n down by k where k is a power of two.
-    template <typename Integral>
-    static inline size_t RoundDown(Integral n, Integral k) {
-        return (n & ~(k - 1));
-    }
+    //! Super Scalar Sample Sort classifier over the splitters
+    using Classifier = core::SampleSortClassifier<ValueType, CompareFunction>;
 
     void TransmitItems(
-        // Tree of splitters, sizeof |splitter|
-        const ValueType* const tree,
-        // Number of buckets: k = 2^{log_k}
-        size_t k,
-        size_t log_k,
+        // Classifier with k = 2^log_k buckets
+        const Classifier& classifier,
         // Number of actual workers to send to
         size_t actual_k,
-        const SampleIndexPair* const sorted_splitters,
         size_t prefix_items,
-        data::MixStreamPtr& data_stream) {
+        data::Stream& data_stream) {
 
         data::File::ConsumeReader unsorted_reader =
             unsorted_file_.GetConsumeReader();
 
-        std::vector<data::MixStream::Writer> data_writers =
-            data_stream->GetWriters();
+        std::vector<data::Stream::Writer> data_writers =
+            data_stream.GetWriters();
+
+        const size_t k = classifier.num_buckets();
 
         // enlarge emitters array to next power of two to have direct access,
         // because we fill the splitter set up with sentinels == last splitter,
@@ -471,75 +489,85 @@ private:
 
         std::swap(data_writers[actual_k - 1], data_writers[k - 1]);
 
-        // classify all items (take two at once) and immediately transmit them.
+        // classify a batch of items into the oracle buffer, then transmit
+        // them. Separating the two keeps the classification loop free of
+        // branches on the tree descent.
+
+        const size_t batch_size = transmit_batch_size_;
 
-        const size_t stepsize = 2;
+        std::vector<ValueType> batch;
+        batch.reserve(batch_size);
+        std::vector<size_t> oracle(batch_size);
 
         size_t i = prefix_items;
-        for ( ; i < prefix_items + RoundDown(local_items_, stepsize); i += stepsize)
+        const size_t end = prefix_items + local_items_;
+        while (i < end)
         {
-            // take two items
-            size_t j0 = 1;
-            ValueType el0 = unsorted_reader.Next<ValueType>();
+            size_t n = std::min(batch_size, end - i);
 
-            size_t j1 = 1;
-            ValueType el1 = unsorted_reader.Next<ValueType>();
+            batch.clear();
+            for (size_t u = 0; u < n; ++u)
+                batch.emplace_back(unsorted_reader.Next<ValueType>());
 
-            // run items down the tree
-            for (size_t l = 0; l < log_k; l++)
-            {
-                j0 = 2 * j0 + (compare_function_(el0, tree[j0]) ? 0 : 1);
-                j1 = 2 * j1 + (compare_function_(el1, tree[j1]) ? 0 : 1);
+            classifier.Classify(batch.data(), batch.data() + n, i,
+                                oracle.data());
+
+            for (size_t u = 0; u < n; ++u) {
+                assert(data_writers[oracle[u]].IsValid());
+                data_writers[oracle[u]].Put(batch[u]);
             }
 
-            size_t b0 = j0 - k;
-            size_t b1 = j1 - k;
+            i += n;
+        }
 
-            while (b0 && EqualSampleGreaterIndex(
-                       sorted_splitters[b0 - 1], SampleIndexPair(el0, i + 0))) {
-                b0--;
+        // close writers and flush data
+        for (size_t j = 0; j < data_writers.size(); j++)
+            data_writers[j].Close();
+    }
 
-                // LOG0 << "el0 equal match b0 " << b0
-                //      << " prefix_items " << prefix_items
-                //      << " lhs.first = " << sorted_splitters[b0 - 1].first
-                //      << " lhs.second = " << sorted_splitters[b0 - 1].second
-                //      << " rhs.first = " << el0
-                //      << " rhs.second = " << i;
-            }
+    using VectorIterator = typename std::vector<ValueType>::iterator;
 
-            while (b1 && EqualSampleGreaterIndex(
-                       sorted_splitters[b1 - 1], SampleIndexPair(el1, i + 1))) {
-                b1--;
-            }
+    //! Reader of a sorted range of the in-memory vector for multiway merging.
+    class RangeReader
+    {
+    public:
+        RangeReader(VectorIterator begin, VectorIterator end)
+            : begin_(begin), end_(end) { }
 
-            assert(data_writers[b0].IsValid());
-            assert(data_writers[b1].IsValid());
+        bool HasNext() const { return begin_ != end_; }
 
-            data_writers[b0].Put(el0);
-            data_writers[b1].Put(el1);
+        template <typename Type>
+        Type Next() {
+            assert(begin_ != end_);
+            return std::move(*begin_++);
         }
 
-        // last iteration of loop if we have an odd number of items.
-        for ( ; i < prefix_items + local_items_; i++)
-        {
-            size_t j0 = 1;
-            ValueType el0 = unsorted_reader.Next<ValueType>();
+    private:
+        VectorIterator begin_, end_;
+    };
 
-            // run item down the tree
-            for (size_t l = 0; l < log_k; l++)
-            {
-                j0 = 2 * j0 + (compare_function_(el0, tree[j0]) ? 0 : 1);
-            }
+    /*!
+     * Transmit the items of a globally sorted DIA by their global rank: worker
+     * w receives the items with ranks [w * total / p, (w + 1) * total / p),
+     * similar to the pivot ranks selected by MergeNode. No comparisons are
+     * needed, and each worker receives a sorted sequence via the CatStream.
+     */
+    void TransmitRanks(size_t prefix_items, size_t total_items,
+                       data::Stream& data_stream) {
 
-            size_t b0 = j0 - k;
+        data::File::ConsumeReader unsorted_reader =
+            unsorted_file_.GetConsumeReader();
 
-            while (b0 && EqualSampleGreaterIndex(
-                       sorted_splitters[b0 - 1], SampleIndexPair(el0, i))) {
-                b0--;
-            }
+        std::vector<data::Stream::Writer> data_writers =
+            data_stream.GetWriters();
+
+        const size_t p = data_writers.size();
 
-            assert(data_writers[b0].IsValid());
-            data_writers[b0].Put(el0);
+        size_t w = 0;
+        for (size_t i = prefix_items; i < prefix_items + local_items_; ++i) {
+            while (w + 1 < p && (w + 1) * total_items / p <= i)
+                ++w;
+            data_writers[w].Put(unsorted_reader.Next<ValueType>());
         }
 
         // close writers and flush data
@@ -547,6 +575,38 @@ private:
             data_writers[j].Close();
     }
 
+    //! Check whether the whole DIA is already sorted, and whether all local
+    //! inputs consist of few natural runs. Returns both collectively.
+    std::pair<bool, bool> DetectPresorted() {
+        local_runs_ = CountNaturalRuns();
+
+        // get the last item of the preceding non-empty worker
+        std::vector<ValueType> my_last;
+        if (local_items_ != 0) {
+            my_last.push_back(
+                unsorted_file_.GetItemAt<ValueType>(local_items_ - 1));
+        }
+
+        std::vector<ValueType> pred = context_.net.Predecessor(1, my_last);
+
+        bool globally_sorted =
+            local_runs_ <= 1 &&
+            (local_items_ == 0 || pred.empty() ||
+             !compare_function_(
+                 unsorted_file_.GetItemAt<ValueType>(0), pred[0]));
+        bool locally_presorted =
+            local_runs_ <= MaxNaturalRuns(local_items_);
+
+        // count workers violating either property
+        std::array<size_t, 2> violations = {
+            { globally_sorted ? 0u : 1u, locally_presorted ? 0u : 1u }
+        };
+        violations = context_.net.AllReduce(
+            violations, common::ComponentSum<std::array<size_t, 2> >());
+
+        return std::make_pair(violations[0] == 0, violations[1] == 0);
+    }
+
     void MainOp() {
         RunTimer timer(timer_execute_);
 
@@ -572,6 +632,102 @@ private:
             return;
         }
 
+        bool globally_sorted, locally_presorted;
+        std::tie(globally_sorted, locally_presorted) = DetectPresorted();
+
+        sLOG << "worker" << context_.my_rank()
+             << "local_runs_" << local_runs_
+             << "globally_sorted" << globally_sorted
+             << "locally_presorted" << locally_presorted;
+
+        size_t sample_size = samples_.size();
+
+        if (globally_sorted) {
+            // only redistribute items by rank, no sampling and sorting.
+            std::vector<SampleIndexPair>().swap(samples_);
+
+            data::CatStreamPtr data_stream = context_.GetNewCatStream(this);
+            Exchange(
+                data_stream,
+                [&]() {
+                    TransmitRanks(prefix_items, total_items, *data_stream);
+                },
+                [&]() {
+                    ReceiveSortedItems(
+                        data_stream->GetCatReader(/* consume */ true));
+                });
+        }
+        else {
+            std::vector<SampleIndexPair> splitters =
+                SelectSplitters(prefix_items);
+
+            // Get the ceiling of log(num_total_workers), as SSSS needs 2^n
+            // buckets.
+            size_t ceil_log = common::IntegerLog2Ceil(num_total_workers);
+
+            Classifier classifier(
+                splitters.data(), ceil_log, compare_function_);
+
+            auto transmit =
+                [&](data::Stream& data_stream) {
+                    TransmitItems(classifier, num_total_workers,
+                                  prefix_items, data_stream);
+                };
+
+            if (locally_presorted) {
+                // a CatStream delivers the items from each worker in order,
+                // hence they arrive as few natural runs, which are merged.
+                data::CatStreamPtr data_stream =
+                    context_.GetNewCatStream(this);
+                Exchange(
+                    data_stream,
+                    [&]() { transmit(*data_stream); },
+                    [&]() {
+                        ReceiveItems(
+                            data_stream->GetCatReader(/* consume */ true));
+                    });
+            }
+            else {
+                data::MixStreamPtr data_stream =
+                    context_.GetNewMixStream(this);
+                Exchange(
+                    data_stream,
+                    [&]() { transmit(*data_stream); },
+                    [&]() {
+                        ReceiveItems(
+                            data_stream->GetMixReader(/* consume */ true));
+                    });
+            }
+        }
+
+        double balance = 0;
+        if (local_out_size_ > 0) {
+            balance = static_cast<double>(local_out_size_)
+                      * static_cast<double>(num_total_workers)
+                      / static_cast<double>(total_items);
+        }
+
+        if (balance > 1) {
+            balance = 1 / balance;
+        }
+
+        Super::logger_
+            << "class" << "SortNode"
+            << "event" << "done"
+            << "workers" << num_total_workers
+            << "local_out_size" << local_out_size_
+            << "balance" << balance
+            << "sample_size" << sample_size
+            << "globally_sorted" << globally_sorted
+            << "locally_presorted" << locally_presorted;
+    }
+
+    //! Collect samples on worker 0, which selects the splitters and sends them
+    //! back. Returns splitters padded with sentinels to the next power of two.
+    std::vector<SampleIndexPair> SelectSplitters(size_t prefix_items) {
+
+        size_t num_total_workers = context_.num_workers();
+
         // stream to send samples to process 0 and receive them back
         data::MixStreamPtr sample_stream = context_.GetNewMixStream(this);
 
@@ -590,7 +746,6 @@ private:
         // Get the ceiling of log(num_total_workers), as SSSS needs 2^n buckets.
         size_t ceil_log = common::IntegerLog2Ceil(num_total_workers);
         size_t workers_algo = size_t(1) << ceil_log;
-        size_t splitter_count_algo = workers_algo - 1;
 
         std::vector<SampleIndexPair> splitters;
         splitters.reserve(workers_algo);
@@ -613,72 +768,38 @@ private:
         sample_writers.clear();
         sample_stream->Close();
 
-        // code from SS2NPartition, slightly altered
-
-        std::vector<ValueType> splitter_tree(workers_algo + 1);
-
         // add sentinel splitters if fewer nodes than splitters.
         for (size_t i = num_total_workers; i < workers_algo; i++) {
             splitters.push_back(splitters.back());
         }
 
-        TreeBuilder(splitter_tree.data(),
-                    splitters.data(),
-                    splitter_count_algo);
-
-        data::MixStreamPtr data_stream = context_.GetNewMixStream(this);
+        return splitters;
+    }
 
+    //! Run transmit() and receive() on the data stream, receiving optionally
+    //! in a background thread, then close the stream.
+    template <typename StreamPtr, typename Transmit, typename Receive>
+    void Exchange(StreamPtr& data_stream,
+                  const Transmit& transmit, const Receive& receive) {
         std::thread thread;
         if (use_background_thread_) {
             // launch receiver thread.
-            thread = common::CreateThread(
-                [this, &data_stream]() {
-                    return ReceiveItems(data_stream);
-                });
+            thread = common::CreateThread(receive);
             common::SetCpuAffinity(thread, context_.local_worker_id());
         }
 
-        TransmitItems(
-            splitter_tree.data(), // Tree. sizeof |splitter|
-            workers_algo,         // Number of buckets
-            ceil_log,
-            num_total_workers,
-            splitters.data(),
-            prefix_items,
-            data_stream);
-
-        std::vector<ValueType>().swap(splitter_tree);
+        transmit();
 
         if (use_background_thread_)
             thread.join();
         else
-            ReceiveItems(data_stream);
+            receive();
 
         data_stream->Close();
-
-        double balance = 0;
-        if (local_out_size_ > 0) {
-            balance = static_cast<double>(local_out_size_)
-                      * static_cast<double>(num_total_workers)
-                      / static_cast<double>(total_items);
-        }
-
-        if (balance > 1) {
-            balance = 1 / balance;
-        }
-
-        Super::logger_
-            << "class" << "SortNode"
-            << "event" << "done"
-            << "workers" << num_total_workers
-            << "local_out_size" << local_out_size_
-            << "balance" << balance
-            << "sample_size" << samples_.size();
     }
 
-    void ReceiveItems(data::MixStreamPtr& data_stream) {
-
-        auto reader = data_stream->GetMixReader(/* consume */ true);
+    template <typename Reader>
+    void ReceiveItems(Reader reader) {
 
         LOG << "Writing files";
 
@@ -705,6 +826,96 @@ private:
         }
     }
 
+    //! Receive the already sorted items of TransmitRanks() into one File.
+    template <typename Reader>
+    void ReceiveSortedItems(Reader reader) {
+
+        files_.emplace_back(context_.GetFile(this));
+        auto writer = files_.back().GetWriter();
+        while (reader.HasNext()) {
+            writer.Put(reader.template Next<ValueType>());
+        }
+        writer.Close();
+        AddFileTriggers();
+
+        local_out_size_ += files_.back().num_items();
+    }
+
+    //! maximum number of natural runs in n items to merge them instead of
+    //! sorting.
+    static size_t MaxNaturalRuns(size_t n) {
+        return std::max<size_t>(1, n / natural_run_min_items_);
+    }
+
+    /*!
+     * Find the natural ascending runs in vec and store their boundaries in
+     * runs. Returns false as soon as there are more than MaxNaturalRuns(),
+     * which for unsorted items happens after scanning a tiny prefix.
+     */
+    bool FindNaturalRuns(std::vector<ValueType>& vec,
+                         std::vector<VectorIterator>& runs) {
+        const size_t max_runs = MaxNaturalRuns(vec.size());
+
+        runs.clear();
+        runs.push_back(vec.begin());
+        for (VectorIterator it = vec.begin() + 1; it < vec.end(); ++it) {
+            if (compare_function_(*it, *(it - 1))) {
+                if (runs.size() == max_runs) return false;
+                runs.push_back(it);
+            }
+        }
+        runs.push_back(vec.end());
+        return true;
+    }
+
+    /*!
+     * Count the natural ascending runs in unsorted_file_. The scan stops after
+     * more than MaxNaturalRuns(), which for unsorted items happens after
+     * reading a tiny prefix.
+     */
+    size_t CountNaturalRuns() {
+        if (local_items_ == 0) return 0;
+
+        const size_t max_runs = MaxNaturalRuns(local_items_);
+
+        auto reader = unsorted_file_.GetKeepReader();
+        ValueType prev = reader.template Next<ValueType>();
+        size_t runs = 1;
+        while (reader.HasNext() && runs <= max_runs) {
+            ValueType item = reader.template Next<ValueType>();
+            if (compare_function_(item, prev))
+                ++runs;
+            prev = std::move(item);
+        }
+        return runs;
+    }
+
+    //! Multiway merge the natural runs of vec into a new File.
+    void MergeNaturalRunsToFile(const std::vector<VectorIterator>& runs) {
+        files_.emplace_back(context_.GetFile(this));
+        auto writer = files_.back().GetWriter();
+
+        if (runs.size() == 2) {
+            // already sorted
+            for (VectorIterator it = runs[0]; it != runs[1]; ++it)
+                writer.Put(*it);
+        }
+        else {
+            std::vector<RangeReader> seq;
+            seq.reserve(runs.size() - 1);
+            for (size_t r = 0; r + 1 < runs.size(); ++r)
+                seq.emplace_back(runs[r], runs[r + 1]);
+
+            auto puller = core::make_multiway_merge_tree<ValueType>(
+                seq.begin(), seq.end(), compare_function_);
+
+            while (puller.HasNext())
+                writer.Put(puller.Next());
+        }
+        writer.Close();
+        AddFileTriggers();
+    }
+
     void SortAndWriteToFile(std::vector<ValueType>& vec) {
 
         LOG << "SortAndWriteToFile() " << vec.size()
@@ -716,6 +927,36 @@ private:
         // advice block pool to write out data if necessary
         context_.block_pool().AdviseFree(vec.size() * sizeof(ValueType));
 
+        // presorted items consist of few natural runs, merge them instead.
+        std::vector<VectorIterator> runs;
+        if (FindNaturalRuns(vec, runs)) {
+            timer_sort_.Start();
+            MergeNaturalRunsToFile(runs);
+            timer_sort_.Stop();
+
+            LOG << "SortAndWriteToFile() merged " << runs.size() - 1
+                << " natural runs";
+
+            vec.clear();
+
+            Super::logger_
+                << "class" << "SortNode"
+                << "event" << "write_file"
+                << "file_num" << (files_.size() - 1)
+                << "items" << vec_size
+                << "natural_runs" << runs.size() - 1
+                << "timer_sort_" << timer_sort_;
+            return;
+        }
+
+        // use helper threads only if each gets enough items
+        size_t num_threads = std::min(
+            context_.local_parallelism(),
+            vec.size() / parallel_sort_min_items_);
+
+        if (num_threads > 1)
+            return ParallelSortAndWriteToFile(vec, num_threads);
+
         timer_sort_.Start();
         sort_algorithm_(vec.begin(), vec.end(), compare_function_);
         // common::qsort_two_pivots_yaroslavskiy(vec.begin(), vec.end(), compare_function_);
@@ -733,6 +974,7 @@ private:
             writer.Put(elem);
         }
         writer.Close();
+        AddFileTriggers();
 
         write_time.Stop();
 
@@ -750,6 +992,125 @@ private:
             << "timer_sort_" << timer_sort_
             << "write_time" << write_time;
     }
+
+    /*!
+     * Sort vec using num_threads threads from the host's helper pool and write
+     * it to a new File: first sort num_threads equal runs in parallel with the
+     * SortAlgorithm, then split all runs at common sampled splitters into
+     * num_threads parts, which are multiway merged in parallel into separate
+     * Files. Finally, the Blocks of the parts are concatenated.
+     *
+     * The SortAlgorithm and the CompareFunction are called concurrently from
+     * the helper threads. Each run is sorted by a separate copy of the
+     * SortAlgorithm, such that it may keep internal state, while the
+     * CompareFunction must be safe to call concurrently.
+     */
+    void ParallelSortAndWriteToFile(
+        std::vector<ValueType>& vec, size_t num_threads) {
+
+        size_t vec_size = vec.size();
+        common::ThreadPool& pool = context_.helper_pool();
+
+        // boundaries of runs
+        std::vector<VectorIterator> runs(num_threads + 1);
+        for (size_t r = 0; r <= num_threads; ++r)
+            runs[r] = vec.begin() + r * vec_size / num_threads;
+
+        timer_sort_.Start();
+
+        pool.RunBatch(
+            num_threads, [this, &runs](size_t r) {
+                SortAlgorithm sort_algorithm = sort_algorithm_;
+                sort_algorithm(runs[r], runs[r + 1], compare_function_);
+            });
+
+        timer_sort_.Stop();
+
+        LOG << "ParallelSortAndWriteToFile() sort of " << num_threads
+            << " runs took " << timer_sort_;
+
+        Timer write_time;
+        write_time.Start();
+
+        // select splitters from equidistant samples of all runs
+        size_t run_samples = num_threads * parallel_merge_oversampling_;
+
+        std::vector<ValueType> samples;
+        samples.reserve(num_threads * run_samples);
+
+        for (size_t r = 0; r < num_threads; ++r) {
+            size_t run_size = runs[r + 1] - runs[r];
+            for (size_t i = 0; i < run_samples; ++i)
+                samples.emplace_back(runs[r][i * run_size / run_samples]);
+        }
+        std::sort(samples.begin(), samples.end(), compare_function_);
+
+        // split each run at the splitters: part p of run r contains the items
+        // in [split[r * (num_threads + 1) + p], split[... + p + 1]).
+        std::vector<VectorIterator> split((num_threads + 1) * num_threads);
+
+        for (size_t r = 0; r < num_threads; ++r) {
+            VectorIterator* rsplit = split.data() + r * (num_threads + 1);
+            rsplit[0] = runs[r];
+            for (size_t p = 1; p < num_threads; ++p) {
+                rsplit[p] = std::lower_bound(
+                    rsplit[p - 1], runs[r + 1],
+                    samples[p * samples.size() / num_threads],
+                    compare_function_);
+            }
+            rsplit[num_threads] = runs[r + 1];
+        }
+        std::vector<ValueType>().swap(samples);
+
+        // merge parts in parallel into separate Files
+        std::vector<data::File> parts;
+        parts.reserve(num_threads);
+        for (size_t p = 0; p < num_threads; ++p)
+            parts.emplace_back(context_.GetFile(this));
+
+        pool.RunBatch(
+            num_threads, [this, num_threads, &split, &parts](size_t p) {
+                std::vector<RangeReader> seq;
+                seq.reserve(num_threads);
+                for (size_t r = 0; r < num_threads; ++r) {
+                    VectorIterator* rsplit =
+                        split.data() + r * (num_threads + 1);
+                    seq.emplace_back(rsplit[p], rsplit[p + 1]);
+                }
+
+                auto puller = core::make_multiway_merge_tree<ValueType>(
+                    seq.begin(), seq.end(), compare_function_);
+
+                auto writer = parts[p].GetWriter();
+                while (puller.HasNext())
+                    writer.Put(puller.Next());
+                writer.Close();
+            });
+
+        // concatenate Blocks of the parts
+        files_.emplace_back(context_.GetFile(this));
+        for (data::File& part : parts) {
+            for (const data::Block& b : part.blocks())
+                files_.back().AppendBlock(b);
+            part.Clear();
+        }
+        AddFileTriggers();
+
+        write_time.Stop();
+
+        LOG << "ParallelSortAndWriteToFile() finished writing files";
+
+        vec.clear();
+
+        Super::logger_
+            << "class" << "SortNode"
+            << "event" << "write_file"
+            << "file_num" << (files_.size() - 1)
+            << "items" << vec_size
+            << "threads" << num_threads
+            << "timer_sort_" << timer_sort_
+            << "write_time" << write_time;
+    }
 };
 
 class DefaultSortAlgorithm
@@ -825,6 +1186,43 @@ auto DIA<ValueType, Stack>::Sort(const CompareFunction &compare_function,
     return DIA<ValueType>(node);
 }
 
+template <typename ValueType, typename Stack>
+template <typename KeyExtractor>
+auto DIA<ValueType, Stack>::SortByKey(const KeyExtractor &key_extractor) const {
+    assert(IsValid());
+
+    using Key = typename std::decay<
+              typename FunctionTraits<KeyExtractor>::result_type>::type;
+
+    static_assert(
+        std::is_convertible<
+            ValueType,
+            typename FunctionTraits<KeyExtractor>::template arg<0> >::value,
+        "KeyExtractor has the wrong input type");
+
+    static_assert(
+        common::RadixKey<Key>::is_radix_key,
+        "KeyExtractor must return an unsigned integer "
+        "or std::array<uint8_t, N>");
+
+    auto compare_function =
+        [key_extractor](const ValueType& a, const ValueType& b) {
+            return common::RadixKey<Key>::Less(
+                key_extractor(a), key_extractor(b));
+        };
+
+    using CompareFunction = decltype(compare_function);
+    using SortAlgorithm = common::RadixSortByKey<KeyExtractor>;
+
+    using SortNode = api::SortNode<
+              ValueType, CompareFunction, SortAlgorithm>;
+
+    auto node = common::MakeCounting<SortNode>(
+        *this, compare_function, SortAlgorithm(key_extractor));
+
+    return DIA<ValueType>(node);
+}
+
 } // namespace api
 } // namespace thrill
 
@@ -0,0 +1,134 @@
+/*******************************************************************************
+ * thrill/api/top_k_frequent.hpp
+ *
+ * Part of Project Thrill - http://project-thrill.org
+ *
+ * All rights reserved. Published under the BSD-2 license in the LICENSE file.
+ ******************************************************************************/
+
+#pragma once
+#ifndef THRILL_API_TOP_K_FREQUENT_HEADER
+#define THRILL_API_TOP_K_FREQUENT_HEADER
+
+#include <thrill/api/action_node.hpp>
+#include <thrill/api/dia.hpp>
+#include <thrill/core/space_saving.hpp>
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+namespace thrill {
+namespace api {
+
+/*!
+ * Finds the k most frequent items approximately with a SpaceSaving sketch on
+ * each worker, which are merged by an all-reduce of the counter lists. The
+ * sketches keep k * oversampling counters, such that the counts of the top k
+ * items are accurate on skewed data.
+ *
+ * \ingroup api_layer
+ */
+template <typename ValueType, typename HashFunction>
+class TopKFrequentNode final
+    : public ActionResultNode<std::vector<std::pair<ValueType, size_t> > >
+{
+    static constexpr bool debug = false;
+
+    using Result = std::vector<std::pair<ValueType, size_t> >;
+    using Super = ActionResultNode<Result>;
+    using Super::context_;
+
+    using Sketch = core::SpaceSaving<ValueType, HashFunction>;
+
+    //! factor of counters kept per requested item
+    static constexpr size_t oversampling_ = 16;
+
+public:
+    template <typename ParentDIA>
+    TopKFrequentNode(const ParentDIA& parent, size_t k,
+                     const HashFunction& hash_function)
+        : Super(parent.ctx(), "TopKFrequent",
+                { parent.id() }, { parent.node() }),
+          k_(k),
+          hash_function_(hash_function),
+          sketch_(std::max<size_t>(k * oversampling_, 1), hash_function) {
+        // Hook PreOp(s)
+        auto pre_op_fn = [this](const ValueType& input) {
+                             sketch_.Insert(input);
+                         };
+
+        auto lop_chain = parent.stack().push(pre_op_fn).fold();
+        parent.node()->AddChild(this, lop_chain);
+    }
+
+    //! Merges the sketches of all workers and selects the top k.
+    void Execute() final {
+        size_t capacity = sketch_.capacity();
+        HashFunction hash_function = hash_function_;
+
+        Result counters = context_.net.AllReduce(
+            sketch_.counters(),
+            [capacity, hash_function](const Result& a, const Result& b) {
+                return Sketch::Merge(a, b, capacity, hash_function);
+            });
+
+        result_ = Sketch::TopK(std::move(counters), k_);
+
+        LOG << "TopKFrequent found " << result_.size() << " items";
+    }
+
+    //! Returns the k most frequent items with their estimated counts.
+    const Result& result() const final {
+        return result_;
+    }
+
+private:
+    //! number of items requested
+    size_t k_;
+    //! hash function for items
+    HashFunction hash_function_;
+    //! local sketch
+    Sketch sketch_;
+    //! global result
+    Result result_;
+};
+
+template <typename ValueType, typename Stack>
+template <typename HashFunction>
+std::vector<std::pair<ValueType, size_t> >
+DIA<ValueType, Stack>::TopKFrequent(
+    size_t k, const HashFunction& hash_function) const {
+    assert(IsValid());
+
+    using TopKFrequentNode = api::TopKFrequentNode<ValueType, HashFunction>;
+
+    auto node = common::MakeCounting<TopKFrequentNode>(
+        *this, k, hash_function);
+
+    node->RunScope();
+
+    return node->result();
+}
+
+template <typename ValueType, typename Stack>
+template <typename HashFunction>
+Future<std::vector<std::pair<ValueType, size_t> > >
+DIA<ValueType, Stack>::TopKFrequentFuture(
+    size_t k, const HashFunction& hash_function) const {
+    assert(IsValid());
+
+    using TopKFrequentNode = api::TopKFrequentNode<ValueType, HashFunction>;
+
+    auto node = common::MakeCounting<TopKFrequentNode>(
+        *this, k, hash_function);
+
+    return Future<std::vector<std::pair<ValueType, size_t> > >(node);
+}
+
+} // namespace api
+} // namespace thrill
+
+#endif // !THRILL_API_TOP_K_FREQUENT_HEADER
+
+/******************************************************************************/
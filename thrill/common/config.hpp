@@ -43,6 +43,8 @@ static constexpr unsigned g_cache_line_size = 64;
 
 #if __linux__
 #define THRILL_HAVE_LINUXAIO_FILE 1
+#define THRILL_HAVE_NET_EPOLL 1
+#define THRILL_HAVE_NET_SHM 1
 #endif
 
 #if defined(_MSC_VER)
@@ -186,6 +186,15 @@ public:
         return out;
     }
 
+    //! return the most recently used key value pair
+    Key pop_front() {
+        assert(size());
+        Key out = list_.front();
+        map_.erase(out);
+        list_.pop_front();
+        return out;
+    }
+
 private:
     //! list of entries in least-recently used order.
     List list_;
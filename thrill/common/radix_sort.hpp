@@ -15,27 +15,32 @@
 #ifndef THRILL_COMMON_RADIX_SORT_HEADER
 #define THRILL_COMMON_RADIX_SORT_HEADER
 
+#include <thrill/common/function_traits.hpp>
 #include <thrill/common/functional.hpp>
 #include <thrill/common/logger.hpp>
 
 #include <algorithm>
+#include <array>
+#include <cstdint>
 #include <functional>
 #include <type_traits>
+#include <vector>
 
 namespace thrill {
 namespace common {
 
 /*!
- * Internal helper method, use radix_sort_CI below.
+ * Internal helper method, use radix_sort_CI or radix_sort_extract_CI below.
  */
 template <
     size_t MaxDepth, typename Iterator, typename Char,
+    typename CharExtractor,
     typename Comparator =
         std::less<typename std::iterator_traits<Iterator>::value_type>,
     typename SubSorter = NoOperation<void> >
 static inline
 void radix_sort_CI(Iterator begin, Iterator end, size_t K,
-                   const Comparator& cmp,
+                   const CharExtractor& char_ex, const Comparator& cmp,
                    const SubSorter& sub_sort, size_t depth,
                    Char* char_cache) {
 
@@ -48,7 +53,7 @@ void radix_sort_CI(Iterator begin, Iterator end, size_t K,
     // cache characters
     Char* cc = char_cache;
     for (Iterator it = begin; it != end; ++it, ++cc) {
-        *cc = it->at_radix(depth);
+        *cc = char_ex(*it, depth);
         assert(*cc < K);
     }
 
@@ -97,7 +102,7 @@ void radix_sort_CI(Iterator begin, Iterator end, size_t K,
             if (bkt_size[i] <= 1) continue;
             radix_sort_CI<MaxDepth>(
                 begin + bsum, begin + bsum + bkt_size[i],
-                K, cmp, sub_sort, depth + 1, char_cache);
+                K, char_ex, cmp, sub_sort, depth + 1, char_cache);
         }
     }
 }
@@ -106,18 +111,19 @@ void radix_sort_CI(Iterator begin, Iterator end, size_t K,
  * Radix sort the iterator range [begin,end). Sort unconditionally up to depth
  * MaxDepth, then call the sub_sort method for further sorting. Small buckets
  * are sorted using std::sort() with given comparator. Characters are extracted
- * from items in the range using the at_radix(depth) method. All character
- * values must be less than K (the counting array size).
+ * from items in the range using char_ex(item, depth). All character values
+ * must be less than K (the counting array size).
  */
 template <
-    size_t MaxDepth, typename Iterator,
+    size_t MaxDepth, typename Iterator, typename CharExtractor,
     typename Comparator =
         std::less<typename std::iterator_traits<Iterator>::value_type>,
     typename SubSorter = NoOperation<void> >
 static inline
-void radix_sort_CI(Iterator begin, Iterator end, size_t K,
-                   const Comparator& cmp = Comparator(),
-                   const SubSorter& sub_sort = SubSorter()) {
+void radix_sort_extract_CI(Iterator begin, Iterator end, size_t K,
+                           const CharExtractor& char_ex,
+                           const Comparator& cmp = Comparator(),
+                           const SubSorter& sub_sort = SubSorter()) {
 
     if (MaxDepth == 0) {
         // allow post-radix sorting when max depth is reached
@@ -127,17 +133,49 @@ void radix_sort_CI(Iterator begin, Iterator end, size_t K,
 
     const size_t size = end - begin;
 
-    using CharRet = decltype(begin->at_radix(0));
+    using CharRet = decltype(char_ex(*begin, 0));
     using Char = typename std::remove_cv<
               typename std::remove_reference<CharRet>::type>::type;
 
     // allocate character cache once
     Char* char_cache = new Char[size];
     radix_sort_CI<MaxDepth>(
-        begin, end, K, cmp, sub_sort, /* depth */ 0, char_cache);
+        begin, end, K, char_ex, cmp, sub_sort, /* depth */ 0, char_cache);
     delete[] char_cache;
 }
 
+//! Character extractor for radix_sort_CI(), which calls the items' at_radix()
+//! method.
+class AtRadixExtractor
+{
+public:
+    template <typename Type>
+    auto operator () (const Type& t, size_t depth) const
+    ->decltype(t.at_radix(depth)) {
+        return t.at_radix(depth);
+    }
+};
+
+/*!
+ * Radix sort the iterator range [begin,end). Sort unconditionally up to depth
+ * MaxDepth, then call the sub_sort method for further sorting. Small buckets
+ * are sorted using std::sort() with given comparator. Characters are extracted
+ * from items in the range using the at_radix(depth) method. All character
+ * values must be less than K (the counting array size).
+ */
+template <
+    size_t MaxDepth, typename Iterator,
+    typename Comparator =
+        std::less<typename std::iterator_traits<Iterator>::value_type>,
+    typename SubSorter = NoOperation<void> >
+static inline
+void radix_sort_CI(Iterator begin, Iterator end, size_t K,
+                   const Comparator& cmp = Comparator(),
+                   const SubSorter& sub_sort = SubSorter()) {
+    return radix_sort_extract_CI<MaxDepth>(
+        begin, end, K, AtRadixExtractor(), cmp, sub_sort);
+}
+
 /*!
  * SortAlgorithm class for use with api::Sort() which calls radix_sort_CI() if K
  * is small enough.
@@ -160,6 +198,170 @@ private:
     const size_t K_;
 };
 
+/*!
+ * Traits of keys which radix sorting can sort by their bytes: unsigned
+ * integers and fixed-size byte arrays, like the 10-byte keys of TeraSort.
+ * Defines the number of bytes, the depth-th most significant byte, and a less
+ * comparator. The primary template is for unsupported key types.
+ */
+template <typename Key, typename Enable = void>
+class RadixKey
+{
+public:
+    static constexpr bool is_radix_key = false;
+};
+
+//! RadixKey traits for unsigned integers.
+template <typename Key>
+class RadixKey<
+        Key, typename std::enable_if<
+            std::is_integral<Key>::value && std::is_unsigned<Key>::value>::type>
+{
+public:
+    static constexpr bool is_radix_key = true;
+
+    //! number of bytes, and hence radix sort depth
+    static constexpr size_t width = sizeof(Key);
+
+    //! the depth-th most significant byte
+    static uint8_t at_radix(const Key& k, size_t depth) {
+        return static_cast<uint8_t>(k >> (8 * (width - 1 - depth)));
+    }
+
+    static bool Less(const Key& a, const Key& b) { return a < b; }
+};
+
+//! RadixKey traits for fixed-size byte arrays, compared lexicographically.
+template <size_t Size>
+class RadixKey<std::array<uint8_t, Size> >
+{
+public:
+    using Key = std::array<uint8_t, Size>;
+
+    static constexpr bool is_radix_key = true;
+
+    //! number of bytes, and hence radix sort depth
+    static constexpr size_t width = Size;
+
+    //! the depth-th most significant byte
+    static uint8_t at_radix(const Key& k, size_t depth) { return k[depth]; }
+
+    //! Compare the first eight bytes as big-endian 64-bit prefix, which the
+    //! compiler reduces to a load and a byte swap, and the rest only on ties.
+    static bool Less(const Key& a, const Key& b) {
+        if (Size < 8) return a < b;
+        uint64_t pa = Prefix(a), pb = Prefix(b);
+        if (pa != pb) return pa < pb;
+        return std::lexicographical_compare(
+            a.begin() + Prefix8, a.end(), b.begin() + Prefix8, b.end());
+    }
+
+private:
+    //! number of bytes in the prefix
+    static constexpr size_t Prefix8 = Size < 8 ? Size : 8;
+
+    //! load the first eight bytes as big-endian integer.
+    static uint64_t Prefix(const Key& k) {
+        uint64_t p = 0;
+        for (size_t i = 0; i < Prefix8; ++i)
+            p = (p << 8) | k[i];
+        return p;
+    }
+};
+
+/*!
+ * SortAlgorithm class for use with api::Sort() which radix sorts items by the
+ * bytes of the RadixKey returned by a key extractor. The keys are extracted
+ * once per item into a cache (requires n * sizeof(Key) extra bytes), which is
+ * permuted along with the items. Buckets are radix sorted up to the full key
+ * width, small buckets are sorted using the comparator.
+ */
+template <typename KeyExtractor>
+class RadixSortByKey
+{
+public:
+    using Key = typename std::decay<
+              typename FunctionTraits<KeyExtractor>::result_type>::type;
+
+    static_assert(RadixKey<Key>::is_radix_key,
+                  "RadixSortByKey requires unsigned integer or "
+                  "std::array<uint8_t, N> keys");
+
+    explicit RadixSortByKey(const KeyExtractor& key_extractor)
+        : key_extractor_(key_extractor) { }
+
+    template <typename Iterator, typename CompareFunction>
+    void operator () (Iterator begin, Iterator end,
+                      const CompareFunction& cmp) const {
+        const size_t size = end - begin;
+        if (size < 32)
+            return std::sort(begin, end, cmp);
+
+        std::vector<Key> key_cache;
+        key_cache.reserve(size);
+        for (Iterator it = begin; it != end; ++it)
+            key_cache.emplace_back(key_extractor_(*it));
+
+        SortCached(begin, key_cache.data(), size, /* depth */ 0, cmp);
+    }
+
+private:
+    KeyExtractor key_extractor_;
+
+    //! MSD radix sort of items [begin,begin+size) and their cached keys.
+    template <typename Iterator, typename CompareFunction>
+    static void SortCached(Iterator begin, Key* keys, size_t size,
+                           size_t depth, const CompareFunction& cmp) {
+        if (size < 32)
+            return std::sort(begin, begin + size, cmp);
+
+        using value_type = typename std::iterator_traits<Iterator>::value_type;
+        static constexpr size_t K = 256;
+
+        // count character occurrences
+        size_t bkt_size[K] = { 0 };
+        for (size_t i = 0; i < size; ++i)
+            ++bkt_size[RadixKey<Key>::at_radix(keys[i], depth)];
+
+        // inclusive prefix sum
+        size_t bkt_index[K];
+        bkt_index[0] = bkt_size[0];
+        size_t last_bkt_size = bkt_size[0];
+        for (size_t i = 1; i < K; ++i) {
+            bkt_index[i] = bkt_index[i - 1] + bkt_size[i];
+            if (bkt_size[i]) last_bkt_size = bkt_size[i];
+        }
+
+        // permute items and keys in-place
+        for (size_t i = 0, j; i < size - last_bkt_size; )
+        {
+            value_type v = std::move(begin[i]);
+            Key vk = keys[i];
+            uint8_t vc;
+            while ((j = --bkt_index[vc = RadixKey<Key>::at_radix(vk, depth)])
+                   > i)
+            {
+                using std::swap;
+                swap(v, begin[j]);
+                swap(vk, keys[j]);
+            }
+            begin[i] = std::move(v);
+            keys[i] = vk;
+            i += bkt_size[vc];
+        }
+
+        // items in a bucket at full key width have equal keys.
+        if (depth + 1 == RadixKey<Key>::width) return;
+
+        size_t bsum = 0;
+        for (size_t i = 0; i < K; bsum += bkt_size[i++]) {
+            if (bkt_size[i] <= 1) continue;
+            SortCached(begin + bsum, keys + bsum, bkt_size[i],
+                       depth + 1, cmp);
+        }
+    }
+};
+
 } // namespace common
 } // namespace thrill
 
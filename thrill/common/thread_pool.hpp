@@ -15,7 +15,9 @@
 #define THRILL_COMMON_THREAD_POOL_HEADER
 
 #include <thrill/common/delegate.hpp>
+#include <thrill/common/semaphore.hpp>
 
+#include <algorithm>
 #include <atomic>
 #include <cassert>
 #include <condition_variable>
@@ -129,6 +131,37 @@ public:
         cv_jobs_.notify_all();
     }
 
+    /*!
+     * Run job(i) for all i in [0,n) on the pool's threads and the calling
+     * thread, and return once all are done. Indexes are handed out
+     * dynamically, and only completion of this batch is awaited (not of other
+     * jobs in the queue), hence multiple threads may share one ThreadPool.
+     */
+    template <typename BatchJob>
+    void RunBatch(size_t n, const BatchJob& job) {
+        std::atomic<size_t> next { 0 };
+        auto run = [&next, &job, n]() {
+                       size_t i;
+                       while ((i = next++) < n) job(i);
+                   };
+
+        // enqueue helpers, the calling thread does the remaining work.
+        size_t helpers = std::min(n, threads_.size() + 1);
+        helpers = helpers ? helpers - 1 : 0;
+
+        Semaphore done;
+        for (size_t h = 0; h < helpers; ++h) {
+            Enqueue([&run, &done]() {
+                        run();
+                        done.signal();
+                    });
+        }
+        run();
+
+        for (size_t h = 0; h < helpers; ++h)
+            done.wait();
+    }
+
     //! Loop until no more jobs are in the queue AND all threads are idle. When
     //! this occurs, this method exits, however, the threads remain active.
     void LoopUntilEmpty();
@@ -0,0 +1,125 @@
+/*******************************************************************************
+ * thrill/core/hyperloglog.hpp
+ *
+ * HyperLogLog sketch for estimating the number of distinct items.
+ *
+ * Part of Project Thrill - http://project-thrill.org
+ *
+ * All rights reserved. Published under the BSD-2 license in the LICENSE file.
+ ******************************************************************************/
+
+#pragma once
+#ifndef THRILL_CORE_HYPERLOGLOG_HEADER
+#define THRILL_CORE_HYPERLOGLOG_HEADER
+
+#include <thrill/common/math.hpp>
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+namespace thrill {
+namespace core {
+
+/*!
+ * A HyperLogLog sketch (Flajolet et al. 2007) with 2^precision registers of
+ * one byte each. Each 64-bit hash value selects a register by its lowest
+ * precision bits, and the register keeps the maximum position of the first
+ * set bit in the remaining bits. The relative standard error of the estimate
+ * is about 1.04 / sqrt(2^precision).
+ *
+ * Two sketches of equal precision are merged by taking the maximum of each
+ * register, hence the registers() can be combined by an all-reduce.
+ */
+class HyperLogLog
+{
+public:
+    //! Register array type, which is all that needs to be transmitted.
+    using Registers = std::vector<uint8_t>;
+
+    explicit HyperLogLog(size_t precision = 14)
+        : precision_(precision), registers_(size_t(1) << precision, 0) {
+        assert(precision >= 4 && precision <= 24);
+    }
+
+    //! Insert a well-mixed 64-bit hash value of an item.
+    void InsertHash(uint64_t hash) {
+        size_t index = hash & (registers_.size() - 1);
+        // sentinel bit caps the rank at 64 - precision + 1.
+        uint64_t rest =
+            (hash >> precision_) | (uint64_t(1) << (64 - precision_));
+        uint8_t rank = static_cast<uint8_t>(common::ffs(rest));
+        registers_[index] = std::max(registers_[index], rank);
+    }
+
+    //! Merge another sketch of equal precision into this one.
+    void Merge(const HyperLogLog& other) {
+        MergeRegisters(registers_, other.registers_);
+    }
+
+    //! Merge the registers b into a, both of equal precision.
+    static void MergeRegisters(Registers& a, const Registers& b) {
+        assert(a.size() == b.size());
+        for (size_t i = 0; i < a.size(); ++i)
+            a[i] = std::max(a[i], b[i]);
+    }
+
+    //! Estimate the number of distinct items in the register array.
+    static double Estimate(const Registers& registers) {
+        const double m = static_cast<double>(registers.size());
+
+        double sum = 0.0;
+        size_t zeros = 0;
+        for (const uint8_t& r : registers) {
+            sum += std::ldexp(1.0, -static_cast<int>(r));
+            if (r == 0) ++zeros;
+        }
+
+        double alpha =
+            registers.size() == 16 ? 0.673 :
+            registers.size() == 32 ? 0.697 :
+            registers.size() == 64 ? 0.709 : 0.7213 / (1.0 + 1.079 / m);
+
+        double estimate = alpha * m * m / sum;
+
+        // small range correction by linear counting. No large range
+        // correction is needed with 64-bit hashes.
+        if (estimate <= 2.5 * m && zeros != 0)
+            estimate = m * std::log(m / static_cast<double>(zeros));
+
+        return estimate;
+    }
+
+    //! Estimate the number of distinct items inserted.
+    double Estimate() const { return Estimate(registers_); }
+
+    //! \name Accessors
+    //! \{
+
+    //! Returns precision_
+    size_t precision() const { return precision_; }
+
+    //! Returns the register array
+    const Registers& registers() const { return registers_; }
+
+    //! Returns the register array (mutable)
+    Registers& registers() { return registers_; }
+
+    //! \}
+
+private:
+    //! number of bits used to select a register
+    size_t precision_;
+
+    //! registers containing the maximum rank
+    Registers registers_;
+};
+
+} // namespace core
+} // namespace thrill
+
+#endif // !THRILL_CORE_HYPERLOGLOG_HEADER
+
+/******************************************************************************/
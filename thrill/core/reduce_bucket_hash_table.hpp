@@ -253,14 +253,31 @@ public:
      * \param kv Value to be inserted into the table.
      */
     void Insert(const TableItem& kv) {
+        return Insert(kv, index_function_(
+                          key(kv), num_partitions_,
+                          num_buckets_per_partition_, num_buckets_));
+    }
+
+    //! Inserts a value like Insert(kv), with the IndexFunction's result h for
+    //! its key already calculated by the caller.
+    void Insert(const TableItem& kv, const typename IndexFunction::Result& h) {
+        return InsertWith(
+            key(kv), h, [&kv]() -> const TableItem& { return kv; },
+            [this, &kv](TableItem& t) { t = reduce(t, kv); });
+    }
+
+    /*!
+     * Inserts an item with key k and the IndexFunction's result h: if k is
+     * already in the table, fold(item) updates the item in place, otherwise
+     * the new item make() is inserted.
+     */
+    template <typename MakeFunction, typename FoldFunction>
+    void InsertWith(const Key& k, const typename IndexFunction::Result& h,
+                    const MakeFunction& make, const FoldFunction& fold) {
 
         while (THRILL_UNLIKELY(mem::memory_exceeded && num_items_ != 0))
             SpillAnyPartition();
 
-        typename IndexFunction::Result h = index_function_(
-            key(kv), num_partitions_,
-            num_buckets_per_partition_, num_buckets_);
-
         size_t local_index = h.local_index(num_buckets_per_partition_);
 
         assert(h.partition_id < num_partitions_);
@@ -277,9 +294,9 @@ public:
                  bi != current->items + current->size; ++bi)
             {
                 // if item and key equals, then reduce.
-                if (key_equal_function_(key(kv), key(*bi)))
+                if (key_equal_function_(k, key(*bi)))
                 {
-                    *bi = reduce(*bi, kv);
+                    fold(*bi);
                     return;
                 }
             }
@@ -308,7 +325,7 @@ public:
         }
 
         // in-place construct/insert new item in current bucket block
-        new (current->items + current->size++)TableItem(kv);
+        new (current->items + current->size++)TableItem(make());
 
         LOGC(debug_items)
             << "h.partition_id" << h.partition_id;
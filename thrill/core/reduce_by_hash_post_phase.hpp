@@ -22,12 +22,14 @@
 #include <thrill/core/reduce_functional.hpp>
 #include <thrill/core/reduce_old_probing_hash_table.hpp>
 #include <thrill/core/reduce_probing_hash_table.hpp>
+#include <thrill/core/reduce_simd_probing_hash_table.hpp>
 #include <thrill/data/file.hpp>
 
 #include <algorithm>
 #include <cassert>
 #include <cmath>
 #include <functional>
+#include <mutex>
 #include <string>
 #include <utility>
 #include <vector>
@@ -146,7 +148,98 @@ public:
         assert(consume && "Items were spilled hence Flushing must consume");
 
         // if partially reduce files remain, create new hash tables to process
-        // them iteratively.
+        // them iteratively. The spilled partitions contain disjoint key sets,
+        // hence they can be re-reduced independently by helper threads.
+
+        size_t num_threads = std::min(
+            table_.ctx().local_parallelism(), remaining_files.size());
+
+        // each thread pins Blocks of its reader and spill writer,
+        // limit the threads to use at most half of the worker's Block RAM.
+        size_t hard_ram_limit = table_.ctx().block_pool().hard_ram_limit();
+        if (hard_ram_limit != 0) {
+            num_threads = std::min(
+                num_threads,
+                hard_ram_limit / 2 / table_.ctx().workers_per_host()
+                / (pinned_blocks_per_thread_ * data::default_block_size));
+        }
+
+        if (ReduceConfig::parallel_post_phase_ && num_threads > 1) {
+            ParallelReReduce<DoCache>(remaining_files, num_threads, writer);
+        }
+        else {
+            ReReduceFiles(
+                remaining_files, table_.limit_memory_bytes(),
+                [this, writer](const size_t& partition_id, const TableItem& p) {
+                    if (DoCache) writer->Put(p);
+                    emitter_.Emit(partition_id, p);
+                });
+        }
+
+        LOG << "Flushed items";
+    }
+
+    //! Push data into emitter
+    void PushData(bool consume = false) {
+        if (!cache_)
+        {
+            if (!table_.has_spilled_data()) {
+                // no items were spilled to disk, hence we can emit all data
+                // from RAM.
+                Flush</* DoCache */ false>(consume);
+            }
+            else {
+                // items were spilled, hence the reduce table must be emptied
+                // and we have to cache the output stream.
+                cache_ = table_.ctx().GetFilePtr(table_.dia_id());
+                data::File::Writer writer = cache_->GetWriter();
+                Flush</* DoCache */ true>(true, &writer);
+            }
+        }
+        else
+        {
+            // previous PushData() has stored data in cache_
+            data::File::Reader reader = cache_->GetReader(consume);
+            while (reader.HasNext())
+                emitter_.Emit(reader.Next<TableItem>());
+        }
+    }
+
+    void Dispose() {
+        table_.Dispose();
+        if (cache_) cache_.reset();
+    }
+
+    //! \name Accessors
+    //! \{
+
+    //! Returns mutable reference to first table_
+    Table& table() { return table_; }
+
+    //! Returns the total num of items in the table.
+    size_t num_items() const { return table_.num_items(); }
+
+    //! \}
+
+private:
+    //! number of Blocks a thread of ParallelReReduce() pins at once: reader
+    //! with prefetch and spill writer.
+    static constexpr size_t pinned_blocks_per_thread_ =
+        data::File::default_prefetch + 2;
+
+    //! number of items a thread of ParallelReReduce() collects before
+    //! locking the emitter.
+    static constexpr size_t emit_batch_size_ = 4096;
+
+    /*!
+     * Re-reduce the partially reduced items in remaining_files using
+     * subtables of limit_memory_bytes each, and pass fully reduced items to
+     * emit(partition_id, item). Partitions of the subtables which spill again
+     * are re-reduced in the next iteration with a different hash function.
+     */
+    template <typename EmitFunction>
+    void ReReduceFiles(std::vector<data::File>& remaining_files,
+                       size_t limit_memory_bytes, const EmitFunction& emit) {
 
         size_t iteration = 1;
 
@@ -166,7 +259,7 @@ public:
                 IndexFunction(iteration, table_.index_function()),
                 table_.key_equal_function());
 
-            subtable.Initialize(table_.limit_memory_bytes());
+            subtable.Initialize(limit_memory_bytes);
 
             size_t num_subfile = 0;
 
@@ -207,12 +300,7 @@ public:
                              << "fully reduced items";
 
                         subtable.FlushPartitionEmit(
-                            id, /* consume */ true, /* grow */ false,
-                            [this, writer](
-                                const size_t& partition_id, const TableItem& p) {
-                                if (DoCache) writer->Put(p);
-                                emitter_.Emit(partition_id, p);
-                            });
+                            id, /* consume */ true, /* grow */ false, emit);
                     }
                 }
             }
@@ -220,53 +308,59 @@ public:
             remaining_files = std::move(next_remaining_files);
             ++iteration;
         }
-
-        LOG << "Flushed items";
     }
 
-    //! Push data into emitter
-    void PushData(bool consume = false) {
-        if (!cache_)
-        {
-            if (!table_.has_spilled_data()) {
-                // no items were spilled to disk, hence we can emit all data
-                // from RAM.
-                Flush</* DoCache */ false>(consume);
-            }
-            else {
-                // items were spilled, hence the reduce table must be emptied
-                // and we have to cache the output stream.
-                cache_ = table_.ctx().GetFilePtr(table_.dia_id());
-                data::File::Writer writer = cache_->GetWriter();
-                Flush</* DoCache */ true>(true, &writer);
-            }
-        }
-        else
-        {
-            // previous PushData() has stored data in cache_
-            data::File::Reader reader = cache_->GetReader(consume);
-            while (reader.HasNext())
-                emitter_.Emit(reader.Next<TableItem>());
-        }
-    }
+    /*!
+     * Re-reduce the spilled files concurrently on num_threads threads of the
+     * host's helper pool, each with its share of the table's memory. The
+     * threads emit fully reduced items in batches into the child nodes'
+     * PreOps, which are serialized by a mutex since they are not thread-safe.
+     */
+    template <bool DoCache>
+    void ParallelReReduce(std::vector<data::File>& remaining_files,
+                          size_t num_threads, data::File::Writer* writer) {
 
-    void Dispose() {
-        table_.Dispose();
-        if (cache_) cache_.reset();
-    }
+        sLOG << "ReducePostPhase: re-reducing" << remaining_files.size()
+             << "spilled files on" << num_threads << "threads";
 
-    //! \name Accessors
-    //! \{
+        size_t limit_memory_bytes = table_.limit_memory_bytes() / num_threads;
+        std::mutex emit_mutex;
 
-    //! Returns mutable reference to first table_
-    Table& table() { return table_; }
+        table_.ctx().helper_pool().RunBatch(
+            num_threads, [&](size_t thread) {
+                std::vector<TableItem> batch;
+                batch.reserve(emit_batch_size_);
 
-    //! Returns the total num of items in the table.
-    size_t num_items() const { return table_.num_items(); }
+                auto flush_batch =
+                    [&]() {
+                        std::unique_lock<std::mutex> lock(emit_mutex);
+                        for (const TableItem& p : batch) {
+                            if (DoCache) writer->Put(p);
+                            emitter_.Emit(p);
+                        }
+                        batch.clear();
+                    };
+
+                // spilled partitions have about equal size, hence they are
+                // distributed round-robin, such that each thread allocates
+                // only one subtable per iteration.
+                std::vector<data::File> files;
+                for (size_t i = thread; i < remaining_files.size();
+                     i += num_threads) {
+                    files.emplace_back(std::move(remaining_files[i]));
+                }
 
-    //! \}
+                ReReduceFiles(
+                    files, limit_memory_bytes,
+                    [&](const size_t& /* partition_id */, const TableItem& p) {
+                        batch.emplace_back(p);
+                        if (batch.size() >= emit_batch_size_)
+                            flush_batch();
+                    });
+                flush_batch();
+            });
+    }
 
-private:
     //! Stored reduce config to initialize the subtable.
     ReduceConfig config_;
 
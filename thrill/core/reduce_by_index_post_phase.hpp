@@ -19,6 +19,7 @@
 #include <thrill/core/reduce_bucket_hash_table.hpp>
 #include <thrill/core/reduce_functional.hpp>
 #include <thrill/core/reduce_probing_hash_table.hpp>
+#include <thrill/core/reduce_simd_probing_hash_table.hpp>
 #include <thrill/data/file.hpp>
 
 #include <algorithm>
@@ -85,10 +86,41 @@ public:
     ReduceByIndexPostPhase& operator = (const ReduceByIndexPostPhase&) = delete;
 
     void Initialize(size_t limit_memory_bytes) {
+        const common::Range& range = table_.index_function().range();
+
+        if (config_.use_dense_index_ &&
+            range.size() * sizeof(TableItem) + range.size() / 8
+            <= limit_memory_bytes)
+        {
+            // the whole index range fits into RAM: reduce into a dense array
+            // of slots instead of the hash table.
+            sLOG << "ReduceByIndexPostPhase: dense array for range" << range;
+            dense_range_ = range;
+            dense_items_.resize(
+                range.size(),
+                MakeTableItem::Make(neutral_element_, table_.key_extractor()));
+            dense_used_.resize(range.size());
+            dense_ = true;
+            return;
+        }
+
         table_.Initialize(limit_memory_bytes);
     }
 
     void Insert(const TableItem& kv) {
+        if (dense_) {
+            const size_t index = key(kv) - dense_range_.begin;
+            assert(index < dense_items_.size() && "Item out of range.");
+            if (!dense_used_[index]) {
+                dense_items_[index] = kv;
+                dense_used_[index] = true;
+            }
+            else {
+                dense_items_[index] = MakeTableItem::Reduce(
+                    dense_items_[index], kv, table_.reduce_function());
+            }
+            return;
+        }
         return table_.Insert(kv);
     }
 
@@ -174,6 +206,11 @@ public:
                 remaining_files.emplace_back(
                     RangeFilePair(file_range, std::move(file)));
             }
+            else if (file_range.IsEmpty()) {
+                // a re-reduced subrange smaller than the number of buckets
+                // leaves partitions without any index.
+                assert(table.items_per_partition(id) == 0);
+            }
             else {
                 // no items have been spilled, but we cannot keep them in
                 // memory due to a second reduce, which is necessary.
@@ -330,7 +367,15 @@ public:
     }
 
     void PushData(bool consume = false) {
-        if (!cache_)
+        if (dense_)
+        {
+            // slots which received no item still hold the neutral element
+            for (const TableItem& kv : dense_items_)
+                emitter_.Emit(kv);
+
+            if (consume) DisposeDense();
+        }
+        else if (!cache_)
         {
             if (!table_.has_spilled_data()) {
                 // no items were spilled to disk, hence we can emit all data
@@ -357,6 +402,7 @@ public:
     void Dispose() {
         table_.Dispose();
         if (cache_) cache_.reset();
+        DisposeDense();
     }
 
     //! \name Accessors
@@ -368,9 +414,18 @@ public:
     //! Returns the total num of items in the table.
     size_t num_items() const { return table_.num_items(); }
 
+    //! Returns whether the dense array is used instead of the table.
+    bool dense() const { return dense_; }
+
     //! \}
 
 private:
+    //! Release the dense array.
+    void DisposeDense() {
+        std::vector<TableItem>().swap(dense_items_);
+        std::vector<bool>().swap(dense_used_);
+    }
+
     //! Stored reduce config to initialize the subtable.
     ReduceConfig config_;
 
@@ -385,6 +440,19 @@ private:
 
     //! File for storing data in-case we need multiple re-reduce levels.
     data::FilePtr cache_;
+
+    //! whether the dense array is used instead of the table.
+    bool dense_ = false;
+
+    //! index range of the dense array
+    common::Range dense_range_;
+
+    //! dense array of items, one slot per index of the range, initialized
+    //! with the neutral element.
+    std::vector<TableItem> dense_items_;
+
+    //! whether a slot of the dense array has received an item.
+    std::vector<bool> dense_used_;
 };
 
 } // namespace core
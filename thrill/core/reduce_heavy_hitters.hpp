@@ -0,0 +1,296 @@
+/*******************************************************************************
+ * thrill/core/reduce_heavy_hitters.hpp
+ *
+ * Small resident cache of heavy hitter keys for the reduce pre phase, which are
+ * combined by an all-reduce instead of being sent to their owners.
+ *
+ * Part of Project Thrill - http://project-thrill.org
+ *
+ * All rights reserved. Published under the BSD-2 license in the LICENSE file.
+ ******************************************************************************/
+
+#pragma once
+#ifndef THRILL_CORE_REDUCE_HEAVY_HITTERS_HEADER
+#define THRILL_CORE_REDUCE_HEAVY_HITTERS_HEADER
+
+#include <thrill/api/context.hpp>
+#include <thrill/common/logger.hpp>
+
+#include <cassert>
+#include <utility>
+#include <vector>
+
+namespace thrill {
+namespace core {
+
+/*!
+ * A direct-mapped cache of heavy hitter keys for the ReducePrePhase in skew
+ * mode.
+ *
+ * Every heavy_hitter_sample_rate_-th inserted item is sampled into a small
+ * array of heavy_hitter_slots_ slots, selected by the index function of the
+ * key. Each slot runs a Misra-Gries style majority counter on the sampled keys
+ * which map to it: the counter is incremented for the candidate key and
+ * decremented for others. A key whose counter reaches heavy_hitter_threshold_
+ * is promoted and stays resident in the slot, all further items with this key
+ * are reduced in the slot and never reach the pre phase table.
+ *
+ * FlushAll() combines the cached items of all workers with an all-reduce over
+ * the network (a tree for many hosts), and only the worker owning the key's
+ * partition emits the final item. Hence the owner of a hot key receives a
+ * single item from itself instead of a stream of partial reductions from all
+ * workers.
+ *
+ * The ReducePrePhase uses this class only in skew mode, and
+ * ReduceNoHeavyHitters otherwise.
+ */
+template <typename TableItem, typename Key, typename Table,
+          typename MakeTableItem, typename ReduceConfig,
+          typename IndexFunction>
+class ReduceHeavyHitters
+{
+    static constexpr bool debug = false;
+
+    static constexpr size_t num_slots_ = ReduceConfig::heavy_hitter_slots_;
+    static constexpr size_t sample_rate_ =
+        ReduceConfig::heavy_hitter_sample_rate_;
+    static constexpr size_t threshold_ = ReduceConfig::heavy_hitter_threshold_;
+
+    static_assert(num_slots_ > 0, "heavy_hitter_slots_ must be positive");
+    static_assert(sample_rate_ > 0,
+                  "heavy_hitter_sample_rate_ must be positive");
+
+public:
+    explicit ReduceHeavyHitters(Table& table)
+        : table_(table) { }
+
+    //! Allocate the slots.
+    void Initialize() {
+        slots_.resize(num_slots_);
+    }
+
+    /*!
+     * Reduce the item into the cache if its key is a heavy hitter, otherwise
+     * insert it into the table. The index function result of the key is
+     * calculated once for both.
+     */
+    void Insert(const TableItem& kv) {
+        return InsertWith(
+            key(kv), [&kv]() -> const TableItem& { return kv; },
+            [this, &kv](TableItem& t) { t = reduce(t, kv); });
+    }
+
+    //! Inserts an item with key k like the table's InsertWith(), but into the
+    //! cache if k is a heavy hitter.
+    template <typename MakeFunction, typename FoldFunction>
+    void InsertWith(const Key& k,
+                    const MakeFunction& make, const FoldFunction& fold) {
+        assert(slots_.size() == num_slots_);
+
+        typename IndexFunction::Result h = table_.index_function()(
+            k, table_.num_partitions(),
+            table_.num_buckets_per_partition(), table_.num_buckets());
+
+        if (!Cache(k, slots_[slot_index(h)], make, fold))
+            table_.InsertWith(k, h, make, fold);
+    }
+
+    /*!
+     * All-reduce the cached heavy hitters of all workers and emit those of
+     * partitions owned by this worker via emit(partition_id, item). Partition
+     * p is owned by worker p % num_workers, which matches the ReduceNodes
+     * sending partition p to worker p. Must be called collectively.
+     */
+    template <typename EmitFunction>
+    void FlushAll(const EmitFunction& emit) {
+        Context& ctx = table_.ctx();
+
+        std::vector<TableItem> heavy;
+        for (Slot& s : slots_) {
+            if (s.heavy) heavy.emplace_back(std::move(s.item));
+            s = Slot();
+        }
+        sample_counter_ = 0;
+
+        LOG << "ReduceHeavyHitters: local heavy keys " << heavy.size()
+            << " num_heavy_ " << num_heavy_ << " num_hits_ " << num_hits_;
+
+        heavy = ctx.net.AllReduce(
+            heavy,
+            [this](const std::vector<TableItem>& a,
+                   const std::vector<TableItem>& b) {
+                return Merge(a, b);
+            });
+
+        size_t num_emitted = 0;
+        for (const TableItem& t : heavy) {
+            typename IndexFunction::Result h = table_.index_function()(
+                key(t), table_.num_partitions(),
+                table_.num_buckets_per_partition(), table_.num_buckets());
+            if (h.partition_id % ctx.num_workers() != ctx.my_rank())
+                continue;
+            emit(h.partition_id, t);
+            ++num_emitted;
+        }
+
+        LOG << "ReduceHeavyHitters: global heavy keys " << heavy.size()
+            << " emitted " << num_emitted;
+    }
+
+    //! \name Accessors
+    //! \{
+
+    //! number of keys promoted to heavy hitters
+    size_t num_heavy() const { return num_heavy_; }
+
+    //! number of items reduced in the cache
+    size_t num_hits() const { return num_hits_; }
+
+    //! \}
+
+private:
+    //! a cache slot with its sample counter and resident item
+    struct Slot {
+        //! candidate key of the majority counter
+        Key       candidate = Key();
+        //! Misra-Gries counter of the candidate key
+        size_t    count = 0;
+        //! whether item holds a resident heavy hitter
+        bool      heavy = false;
+        //! reduced item of the heavy hitter
+        TableItem item = TableItem();
+    };
+
+    //! reference to the pre phase table for its functions and Context
+    Table& table_;
+
+    //! direct-mapped slots
+    std::vector<Slot> slots_;
+
+    //! counter to select every sample_rate_-th item
+    size_t sample_counter_ = 0;
+
+    //! statistics
+    size_t num_heavy_ = 0, num_hits_ = 0;
+
+    Key key(const TableItem& t) {
+        return MakeTableItem::GetKey(t, table_.key_extractor());
+    }
+
+    TableItem reduce(const TableItem& a, const TableItem& b) {
+        return MakeTableItem::Reduce(a, b, table_.reduce_function());
+    }
+
+    //! select slot from the partition and local index of the key
+    size_t slot_index(const typename IndexFunction::Result& h) {
+        return (h.partition_id * 0x9E3779B1u + h.local_index(num_slots_))
+               % num_slots_;
+    }
+
+    /*!
+     * Check if the item's key k is the heavy hitter of slot s and fold it into
+     * the cache, while sampling keys to promote. Returns false if the item
+     * must be inserted into the table.
+     */
+    template <typename MakeFunction, typename FoldFunction>
+    bool Cache(const Key& k, Slot& s,
+               const MakeFunction& make, const FoldFunction& fold) {
+        if (s.heavy) {
+            if (table_.key_equal_function()(key(s.item), k)) {
+                fold(s.item);
+                ++num_hits_;
+                return true;
+            }
+            // slot is occupied by another heavy key.
+            return false;
+        }
+
+        if (++sample_counter_ < sample_rate_) return false;
+        sample_counter_ = 0;
+
+        if (s.count == 0) {
+            s.candidate = k;
+            s.count = 1;
+        }
+        else if (table_.key_equal_function()(s.candidate, k)) {
+            if (++s.count >= threshold_) {
+                // promote key: the item itself starts the resident value.
+                s.heavy = true;
+                s.item = make();
+                ++num_heavy_;
+                ++num_hits_;
+                return true;
+            }
+        }
+        else {
+            --s.count;
+        }
+        return false;
+    }
+
+    //! combine two lists of heavy hitters, reducing items with equal keys.
+    std::vector<TableItem> Merge(
+        const std::vector<TableItem>& a, const std::vector<TableItem>& b) {
+        std::vector<TableItem> out = a;
+        for (const TableItem& t : b) {
+            Key k = key(t);
+            bool found = false;
+            for (TableItem& o : out) {
+                if (table_.key_equal_function()(key(o), k)) {
+                    o = reduce(o, t);
+                    found = true;
+                    break;
+                }
+            }
+            if (!found) out.push_back(t);
+        }
+        return out;
+    }
+};
+
+/*!
+ * Stand-in for ReduceHeavyHitters used by the ReducePrePhase without skew
+ * mode, which inserts all items directly into the table. It does not require
+ * a default constructible Key or an all-reduce over TableItems.
+ */
+template <typename TableItem, typename Key, typename Table>
+class ReduceNoHeavyHitters
+{
+public:
+    explicit ReduceNoHeavyHitters(Table& table)
+        : table_(table) { }
+
+    void Initialize() { }
+
+    void Insert(const TableItem& kv) {
+        table_.Insert(kv);
+    }
+
+    template <typename MakeFunction, typename FoldFunction>
+    void InsertWith(const Key& k,
+                    const MakeFunction& make, const FoldFunction& fold) {
+        table_.InsertWith(
+            k, table_.index_function()(
+                k, table_.num_partitions(),
+                table_.num_buckets_per_partition(), table_.num_buckets()),
+            make, fold);
+    }
+
+    template <typename EmitFunction>
+    void FlushAll(const EmitFunction& /* emit */) { }
+
+    size_t num_heavy() const { return 0; }
+
+    size_t num_hits() const { return 0; }
+
+private:
+    //! reference to the pre phase table
+    Table& table_;
+};
+
+} // namespace core
+} // namespace thrill
+
+#endif // !THRILL_CORE_REDUCE_HEAVY_HITTERS_HEADER
+
+/******************************************************************************/
@@ -165,27 +165,44 @@ public:
      * \param kv Value to be inserted into the table.
      */
     void Insert(const TableItem& kv) {
+        return Insert(kv, index_function_(
+                          key(kv), num_partitions_,
+                          num_buckets_per_partition_, num_buckets_));
+    }
+
+    //! Inserts a value like Insert(kv), with the IndexFunction's result h for
+    //! its key already calculated by the caller.
+    void Insert(const TableItem& kv, const typename IndexFunction::Result& h) {
+        return InsertWith(
+            key(kv), h, [&kv]() -> const TableItem& { return kv; },
+            [this, &kv](TableItem& t) { t = reduce(t, kv); });
+    }
+
+    /*!
+     * Inserts an item with key k and the IndexFunction's result h: if k is
+     * already in the table, fold(item) updates the item in place, otherwise
+     * the new item make() is inserted.
+     */
+    template <typename MakeFunction, typename FoldFunction>
+    void InsertWith(const Key& k, const typename IndexFunction::Result& h,
+                    const MakeFunction& make, const FoldFunction& fold) {
 
         while (THRILL_UNLIKELY(mem::memory_exceeded && num_items_ != 0))
             SpillAnyPartition();
 
-        typename IndexFunction::Result h = index_function_(
-            key(kv), num_partitions_,
-            num_buckets_per_partition_, num_buckets_);
-
         assert(h.partition_id < num_partitions_);
 
-        if (key_equal_function_(key(kv), Key())) {
+        if (key_equal_function_(k, Key())) {
             // handle pairs with sentinel key specially by reducing into last
             // element of items.
             TableItem& sentinel = items_[num_buckets_];
             if (sentinel_partition_ == invalid_partition_) {
                 // first occurrence of sentinel key
-                sentinel = kv;
+                sentinel = make();
                 sentinel_partition_ = h.partition_id;
             }
             else {
-                sentinel = reduce(sentinel, kv);
+                fold(sentinel);
             }
             ++items_per_partition_[h.partition_id];
             ++num_items_;
@@ -207,9 +224,9 @@ public:
 
         while (!key_equal_function_(key(*iter), Key()))
         {
-            if (key_equal_function_(key(*iter), key(kv)))
+            if (key_equal_function_(key(*iter), k))
             {
-                *iter = reduce(*iter, kv);
+                fold(*iter);
                 return;
             }
 
@@ -224,7 +241,7 @@ public:
 
                 SpillPartition(h.partition_id);
 
-                *iter = kv;
+                *iter = make();
 
                 // increase counter for partition
                 ++items_per_partition_[h.partition_id];
@@ -234,7 +251,7 @@ public:
         }
 
         // insert new pair
-        *iter = kv;
+        *iter = make();
 
         // increase counter for partition
         ++items_per_partition_[h.partition_id];
@@ -19,8 +19,10 @@
 #include <thrill/common/logger.hpp>
 #include <thrill/core/reduce_bucket_hash_table.hpp>
 #include <thrill/core/reduce_functional.hpp>
+#include <thrill/core/reduce_heavy_hitters.hpp>
 #include <thrill/core/reduce_old_probing_hash_table.hpp>
 #include <thrill/core/reduce_probing_hash_table.hpp>
+#include <thrill/core/reduce_simd_probing_hash_table.hpp>
 #include <thrill/data/block_writer.hpp>
 
 #include <algorithm>
@@ -28,6 +30,7 @@
 #include <cmath>
 #include <functional>
 #include <string>
+#include <type_traits>
 #include <utility>
 #include <vector>
 
@@ -98,6 +101,15 @@ public:
               KeyExtractor, ReduceFunction, Emitter,
               VolatileKey, ReduceConfig, IndexFunction, KeyEqualFunction>::type;
 
+    //! resident cache of heavy hitters in skew mode, otherwise a stand-in
+    //! which inserts directly into the table.
+    using HeavyHitters = typename std::conditional<
+              ReduceConfig::skew_mode_,
+              ReduceHeavyHitters<
+                  TableItem, Key, Table, MakeTableItem, ReduceConfig,
+                  IndexFunction>,
+              ReduceNoHeavyHitters<TableItem, Key, Table> >::type;
+
     /*!
      * A data structure which takes an arbitrary value and extracts a key using
      * a key extractor function from that value. Afterwards, the value is hashed
@@ -115,7 +127,8 @@ public:
           table_(ctx, dia_id,
                  key_extractor, reduce_function, emit_,
                  num_partitions, config, /* immediate_flush */ true,
-                 index_function, key_equal_function) {
+                 index_function, key_equal_function),
+          heavy_hitters_(table_) {
         sLOG << "creating ReducePrePhase with" << emit.size() << "output emitters";
 
         assert(num_partitions == emit.size());
@@ -128,15 +141,34 @@ public:
 
     void Initialize(size_t limit_memory_bytes) {
         table_.Initialize(limit_memory_bytes);
+        heavy_hitters_.Initialize();
     }
 
     void Insert(const Value& v) {
         // for VolatileKey this makes std::pair and extracts the key
-        return table_.Insert(MakeTableItem::Make(v, table_.key_extractor()));
+        TableItem t = MakeTableItem::Make(v, table_.key_extractor());
+        heavy_hitters_.Insert(t);
     }
 
-    //! Flush all partitions
+    /*!
+     * Inserts an item with key k, which is not made from a Value: if k is
+     * already in the table, fold(item) updates the item in place, otherwise
+     * the new item make() is inserted. Used by AggregateByKey to fold input
+     * elements into accumulators.
+     */
+    template <typename MakeFunction, typename FoldFunction>
+    void InsertWith(const Key& k,
+                    const MakeFunction& make, const FoldFunction& fold) {
+        heavy_hitters_.InsertWith(k, make, fold);
+    }
+
+    //! Flush all partitions. In skew mode this is a collective operation,
+    //! which all-reduces the heavy hitters.
     void FlushAll() {
+        heavy_hitters_.FlushAll(
+            [this](const size_t& partition_id, const TableItem& t) {
+                emit_.Emit(partition_id, t);
+            });
         for (size_t id = 0; id < table_.num_partitions(); ++id) {
             FlushPartition(id, /* consume */ true, /* grow */ false);
         }
@@ -167,6 +199,9 @@ public:
     common::Range key_range(size_t partition_id)
     { return table_.key_range(partition_id); }
 
+    //! Returns the number of items reduced in the heavy hitter cache.
+    size_t num_heavy_hitter_hits() const { return heavy_hitters_.num_hits(); }
+
     //! \}
 
 private:
@@ -175,6 +210,9 @@ private:
 
     //! the first-level hash table implementation
     Table table_;
+
+    //! resident cache of heavy hitters, only active in skew mode
+    HeavyHitters heavy_hitters_;
 };
 
 } // namespace core
@@ -0,0 +1,581 @@
+/*******************************************************************************
+ * thrill/core/reduce_simd_probing_hash_table.hpp
+ *
+ * Part of Project Thrill - http://project-thrill.org
+ *
+ * All rights reserved. Published under the BSD-2 license in the LICENSE file.
+ ******************************************************************************/
+
+#pragma once
+#ifndef THRILL_CORE_REDUCE_SIMD_PROBING_HASH_TABLE_HEADER
+#define THRILL_CORE_REDUCE_SIMD_PROBING_HASH_TABLE_HEADER
+
+#include <thrill/common/math.hpp>
+#include <thrill/core/reduce_functional.hpp>
+#include <thrill/core/reduce_table.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <limits>
+#include <utility>
+#include <vector>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace thrill {
+namespace core {
+
+/*!
+ * A group of consecutive control bytes of a ReduceSimdProbingHashTable, which
+ * are compared at once: 32 with AVX2, 16 with SSE2, or 16 in a plain loop on
+ * other platforms. Control bytes of empty slots have the high bit set, full
+ * slots contain a seven bit tag of the key's hash.
+ */
+class SimdProbingGroup
+{
+public:
+#if defined(__AVX2__)
+    static constexpr size_t width = 32;
+
+    explicit SimdProbingGroup(const uint8_t* p)
+        : ctrl_(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(p))) { }
+
+    //! bit mask of slots containing the tag
+    uint32_t Match(uint8_t tag) const {
+        return static_cast<uint32_t>(_mm256_movemask_epi8(
+                                         _mm256_cmpeq_epi8(
+                                             ctrl_, _mm256_set1_epi8(
+                                                 static_cast<char>(tag)))));
+    }
+
+    //! bit mask of empty slots
+    uint32_t MatchEmpty() const {
+        return static_cast<uint32_t>(_mm256_movemask_epi8(ctrl_));
+    }
+
+private:
+    __m256i ctrl_;
+#elif defined(__SSE2__)
+    static constexpr size_t width = 16;
+
+    explicit SimdProbingGroup(const uint8_t* p)
+        : ctrl_(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p))) { }
+
+    //! bit mask of slots containing the tag
+    uint32_t Match(uint8_t tag) const {
+        return static_cast<uint32_t>(_mm_movemask_epi8(
+                                         _mm_cmpeq_epi8(
+                                             ctrl_, _mm_set1_epi8(
+                                                 static_cast<char>(tag)))));
+    }
+
+    //! bit mask of empty slots
+    uint32_t MatchEmpty() const {
+        return static_cast<uint32_t>(_mm_movemask_epi8(ctrl_));
+    }
+
+private:
+    __m128i ctrl_;
+#else
+    static constexpr size_t width = 16;
+
+    explicit SimdProbingGroup(const uint8_t* p) {
+        std::memcpy(ctrl_, p, width);
+    }
+
+    //! bit mask of slots containing the tag
+    uint32_t Match(uint8_t tag) const {
+        uint32_t mask = 0;
+        for (size_t i = 0; i < width; ++i)
+            mask |= static_cast<uint32_t>(ctrl_[i] == tag) << i;
+        return mask;
+    }
+
+    //! bit mask of empty slots
+    uint32_t MatchEmpty() const {
+        uint32_t mask = 0;
+        for (size_t i = 0; i < width; ++i)
+            mask |= static_cast<uint32_t>(ctrl_[i] >> 7) << i;
+        return mask;
+    }
+
+private:
+    uint8_t ctrl_[width];
+#endif
+};
+
+/*!
+ * A linear probing hash table in the style of Swiss tables, which keeps one
+ * control byte of hash metadata per slot in a separate array. Probing loads a
+ * SimdProbingGroup of control bytes starting at the slot the key hashes to and
+ * compares all of them with the key's seven bit tag and the empty marker at
+ * once. Only slots with matching tags are compared with the full key.
+ *
+ * As there are no deletions except of whole partitions, a key is always found
+ * before the first empty slot after its hash position. Hence items end up in
+ * exactly the slots ReduceProbingHashTable would put them in, which keeps the
+ * order required by ReduceByIndex. Unlike ReduceProbingHashTable, empty slots
+ * are marked in the control bytes, hence no sentinel key is needed and empty
+ * item slots stay unconstructed.
+ *
+ * The partitioning, growing, spilling and flushing mechanisms are those of
+ * ReduceProbingHashTable.
+ */
+template <typename TableItem, typename Key, typename Value,
+          typename KeyExtractor, typename ReduceFunction, typename Emitter,
+          const bool VolatileKey,
+          typename ReduceConfig_,
+          typename IndexFunction,
+          typename KeyEqualFunction = std::equal_to<Key> >
+class ReduceSimdProbingHashTable
+    : public ReduceTable<TableItem, Key, Value,
+                         KeyExtractor, ReduceFunction, Emitter,
+                         VolatileKey, ReduceConfig_,
+                         IndexFunction, KeyEqualFunction>
+{
+    using Super = ReduceTable<TableItem, Key, Value,
+                              KeyExtractor, ReduceFunction, Emitter,
+                              VolatileKey, ReduceConfig_, IndexFunction,
+                              KeyEqualFunction>;
+    using Super::debug;
+    static constexpr bool debug_items = false;
+
+    using Group = SimdProbingGroup;
+
+    //! control byte of empty slots
+    static constexpr uint8_t empty_ = 0x80;
+
+public:
+    using ReduceConfig = ReduceConfig_;
+
+    ReduceSimdProbingHashTable(
+        Context& ctx, size_t dia_id,
+        const KeyExtractor& key_extractor,
+        const ReduceFunction& reduce_function,
+        Emitter& emitter,
+        size_t num_partitions,
+        const ReduceConfig& config = ReduceConfig(),
+        bool immediate_flush = false,
+        const IndexFunction& index_function = IndexFunction(),
+        const KeyEqualFunction& key_equal_function = KeyEqualFunction())
+        : Super(ctx, dia_id,
+                key_extractor, reduce_function, emitter,
+                num_partitions, config, immediate_flush,
+                index_function, key_equal_function)
+    { assert(num_partitions > 0); }
+
+    //! Construct the hash table itself and mark all slots as empty.
+    void Initialize(size_t limit_memory_bytes) {
+        assert(!items_);
+
+        limit_memory_bytes_ = limit_memory_bytes;
+
+        // calculate num_buckets_per_partition_ from the memory limit and the
+        // number of partitions required, each slot also needs a control byte.
+
+        num_buckets_per_partition_ = std::max<size_t>(
+            1,
+            (size_t)(static_cast<double>(limit_memory_bytes_)
+                     / static_cast<double>(sizeof(TableItem) + 1)
+                     / static_cast<double>(num_partitions_)));
+
+        num_buckets_ = num_buckets_per_partition_ * num_partitions_;
+
+        assert(num_buckets_per_partition_ > 0);
+        assert(num_buckets_ > 0);
+
+        partition_size_.resize(
+            num_partitions_,
+            std::min(size_t(config_.initial_items_per_partition_),
+                     num_buckets_per_partition_));
+
+        // calculate limit on the number of items in a partition before these
+        // are spilled to disk or flushed to network.
+
+        double limit_fill_rate = config_.limit_partition_fill_rate();
+
+        assert(limit_fill_rate >= 0.0 && limit_fill_rate <= 1.0
+               && "limit_partition_fill_rate must be between 0.0 and 1.0. "
+               "with a fill rate of 0.0, items are immediately flushed.");
+
+        limit_items_per_partition_.resize(
+            num_partitions_,
+            static_cast<size_t>(
+                static_cast<double>(partition_size_[0]) * limit_fill_rate));
+
+        // allocate the table and the control bytes, items in slots are only
+        // constructed when inserted.
+
+        items_ = static_cast<TableItem*>(
+            operator new (num_buckets_ * sizeof(TableItem)));
+        ctrl_ = static_cast<uint8_t*>(operator new (num_buckets_));
+
+        for (size_t id = 0; id < num_partitions_; ++id) {
+            std::memset(ctrl_ + id * num_buckets_per_partition_, empty_,
+                        partition_size_[id]);
+        }
+    }
+
+    ~ReduceSimdProbingHashTable() {
+        if (items_) Dispose();
+    }
+
+    /*!
+     * Inserts a value into the table, potentially reducing it in case both the
+     * key of the value already in the table and the key of the value to be
+     * inserted are the same.
+     *
+     * An insert may trigger a spill of a partition, if its fill rate limit is
+     * reached or all its slots are occupied.
+     *
+     * \param kv Value to be inserted into the table.
+     */
+    void Insert(const TableItem& kv) {
+        return Insert(kv, index_function_(
+                          key(kv), num_partitions_,
+                          num_buckets_per_partition_, num_buckets_));
+    }
+
+    //! Inserts a value like Insert(kv), with the IndexFunction's result h for
+    //! its key already calculated by the caller.
+    void Insert(const TableItem& kv, const typename IndexFunction::Result& h) {
+        return InsertWith(
+            key(kv), h, [&kv]() -> const TableItem& { return kv; },
+            [this, &kv](TableItem& t) { t = reduce(t, kv); });
+    }
+
+    /*!
+     * Inserts an item with key k and the IndexFunction's result h: if k is
+     * already in the table, fold(item) updates the item in place, otherwise
+     * the new item make() is inserted.
+     */
+    template <typename MakeFunction, typename FoldFunction>
+    void InsertWith(const Key& k, const typename IndexFunction::Result& h,
+                    const MakeFunction& make, const FoldFunction& fold) {
+
+        while (THRILL_UNLIKELY(mem::memory_exceeded && num_items_ != 0))
+            SpillAnyPartition();
+
+        assert(h.partition_id < num_partitions_);
+
+        const size_t psize = partition_size_[h.partition_id];
+        const uint8_t tag = Tag(h);
+
+        TableItem* items = items_ + h.partition_id * num_buckets_per_partition_;
+        uint8_t* ctrl = ctrl_ + h.partition_id * num_buckets_per_partition_;
+
+        // calculate local index depending on the current subtable's size
+        size_t pos = h.local_index(psize);
+
+        for (size_t scanned = 0; scanned < psize; )
+        {
+            if (pos + Group::width <= psize)
+            {
+                Group group(ctrl + pos);
+                uint32_t empty = group.MatchEmpty();
+                uint32_t match = group.Match(tag);
+
+                // only slots before the first empty slot can contain the key
+                if (empty)
+                    match &= (empty & (~empty + 1)) - 1;
+
+                while (match) {
+                    size_t i = pos + common::ffs(match) - 1;
+                    if (key_equal_function_(key(items[i]), k)) {
+                        fold(items[i]);
+                        return;
+                    }
+                    match &= match - 1;
+                }
+
+                if (empty)
+                    return InsertAt(h.partition_id, items, ctrl,
+                                    pos + common::ffs(empty) - 1, tag, make());
+
+                pos += Group::width;
+                scanned += Group::width;
+            }
+            else
+            {
+                // probe the slots at the end of the partition one by one
+                if (ctrl[pos] == empty_)
+                    return InsertAt(
+                        h.partition_id, items, ctrl, pos, tag, make());
+
+                if (ctrl[pos] == tag &&
+                    key_equal_function_(key(items[pos]), k)) {
+                    fold(items[pos]);
+                    return;
+                }
+
+                ++pos;
+                ++scanned;
+            }
+
+            // wrap around if beyond the current partition
+            if (THRILL_UNLIKELY(pos == psize))
+                pos = 0;
+        }
+
+        // flush partition and retry, if all slots are reserved
+        SpillPartition(h.partition_id);
+        return InsertWith(k, h, make, fold);
+    }
+
+    //! Deallocate items and memory
+    void Dispose() {
+        if (!items_) return;
+
+        // dispose the items by destructor
+
+        for (size_t id = 0; id < num_partitions_; ++id) {
+            TableItem* items = items_ + id * num_buckets_per_partition_;
+            uint8_t* ctrl = ctrl_ + id * num_buckets_per_partition_;
+
+            for (size_t i = 0; i < partition_size_[id]; ++i) {
+                if (ctrl[i] != empty_)
+                    items[i].~TableItem();
+            }
+        }
+
+        operator delete (items_);
+        items_ = nullptr;
+        operator delete (ctrl_);
+        ctrl_ = nullptr;
+
+        Super::Dispose();
+    }
+
+    //! Grow a partition after a spill or flush (if possible)
+    void GrowPartition(size_t partition_id) {
+
+        if (partition_size_[partition_id] == num_buckets_per_partition_)
+            return;
+
+        size_t new_size = std::min(
+            num_buckets_per_partition_, 2 * partition_size_[partition_id]);
+
+        sLOG << "Growing partition" << partition_id
+             << "from" << partition_size_[partition_id] << "to" << new_size
+             << "limit_items" << new_size * config_.limit_partition_fill_rate();
+
+        // mark new slots as empty
+
+        uint8_t* ctrl = ctrl_ + partition_id * num_buckets_per_partition_;
+        std::memset(ctrl + partition_size_[partition_id], empty_,
+                    new_size - partition_size_[partition_id]);
+
+        partition_size_[partition_id] = new_size;
+        limit_items_per_partition_[partition_id]
+            = new_size * config_.limit_partition_fill_rate();
+    }
+
+    //! \name Spilling Mechanisms to External Memory Files
+    //! \{
+
+    //! Spill all items of a partition into an external memory File.
+    void SpillPartition(size_t partition_id) {
+
+        if (immediate_flush_) {
+            return FlushPartition(
+                partition_id, /* consume */ true, /* grow */ true);
+        }
+
+        LOG << "Spilling " << items_per_partition_[partition_id]
+            << " items of partition with id: " << partition_id;
+
+        if (items_per_partition_[partition_id] == 0)
+            return;
+
+        data::File::Writer writer = partition_files_[partition_id].GetWriter();
+
+        TableItem* items = items_ + partition_id * num_buckets_per_partition_;
+        uint8_t* ctrl = ctrl_ + partition_id * num_buckets_per_partition_;
+
+        for (size_t i = 0; i < partition_size_[partition_id]; ++i) {
+            if (ctrl[i] != empty_) {
+                writer.Put(items[i]);
+                items[i].~TableItem();
+                ctrl[i] = empty_;
+            }
+        }
+
+        // reset partition specific counter
+        num_items_ -= items_per_partition_[partition_id];
+        items_per_partition_[partition_id] = 0;
+        assert(num_items_ == this->num_items_calc());
+
+        LOG << "Spilled items of partition with id: " << partition_id;
+
+        GrowPartition(partition_id);
+    }
+
+    //! Spill all items of an arbitrary partition into an external memory File.
+    void SpillAnyPartition() {
+        // maybe make a policy later -tb
+        return SpillLargestPartition();
+    }
+
+    //! Spill all items of the largest partition into an external memory File.
+    void SpillLargestPartition() {
+        // get partition with max size
+        size_t size_max = 0, index = 0;
+
+        for (size_t i = 0; i < num_partitions_; ++i)
+        {
+            if (items_per_partition_[i] > size_max)
+            {
+                size_max = items_per_partition_[i];
+                index = i;
+            }
+        }
+
+        if (size_max == 0) {
+            return;
+        }
+
+        return SpillPartition(index);
+    }
+
+    //! \}
+
+    //! \name Flushing Mechanisms to Next Stage or Phase
+    //! \{
+
+    template <typename Emit>
+    void FlushPartitionEmit(
+        size_t partition_id, bool consume, bool grow, Emit emit) {
+
+        LOG << "Flushing " << items_per_partition_[partition_id]
+            << " items of partition: " << partition_id;
+
+        TableItem* items = items_ + partition_id * num_buckets_per_partition_;
+        uint8_t* ctrl = ctrl_ + partition_id * num_buckets_per_partition_;
+
+        for (size_t i = 0; i < partition_size_[partition_id]; ++i)
+        {
+            if (ctrl[i] != empty_) {
+                emit(partition_id, items[i]);
+
+                if (consume) {
+                    items[i].~TableItem();
+                    ctrl[i] = empty_;
+                }
+            }
+        }
+
+        if (consume) {
+            // reset partition specific counter
+            num_items_ -= items_per_partition_[partition_id];
+            items_per_partition_[partition_id] = 0;
+            assert(num_items_ == this->num_items_calc());
+        }
+
+        LOG << "Done flushed items of partition: " << partition_id;
+
+        if (grow)
+            GrowPartition(partition_id);
+    }
+
+    void FlushPartition(size_t partition_id, bool consume, bool grow) {
+        FlushPartitionEmit(
+            partition_id, consume, grow,
+            [this](const size_t& partition_id, const TableItem& p) {
+                this->emitter_.Emit(partition_id, p);
+            });
+    }
+
+    void FlushAll() {
+        for (size_t i = 0; i < num_partitions_; ++i) {
+            FlushPartition(i, /* consume */ true, /* grow */ false);
+        }
+    }
+
+    //! \}
+
+private:
+    using Super::config_;
+    using Super::immediate_flush_;
+    using Super::index_function_;
+    using Super::items_per_partition_;
+    using Super::key;
+    using Super::key_equal_function_;
+    using Super::limit_memory_bytes_;
+    using Super::num_buckets_;
+    using Super::num_buckets_per_partition_;
+    using Super::num_items_;
+    using Super::num_partitions_;
+    using Super::partition_files_;
+    using Super::reduce;
+
+    //! Storing the actual hash table, slots are constructed when occupied.
+    TableItem* items_ = nullptr;
+
+    //! Control bytes of the slots: empty_ or a seven bit tag.
+    uint8_t* ctrl_ = nullptr;
+
+    //! Current sizes of the partitions because the valid allocated areas grow
+    std::vector<size_t> partition_size_;
+
+    //! Current limits on the number of items in a partitions, different for
+    //! different partitions, because the valid allocated areas grow.
+    std::vector<size_t> limit_items_per_partition_;
+
+    //! Calculate the seven bit tag of a key from its index function result,
+    //! which must not depend on the current size of the partition.
+    static uint8_t Tag(const typename IndexFunction::Result& h) {
+        uint64_t x = h.local_index(std::numeric_limits<uint32_t>::max());
+        return static_cast<uint8_t>((x * 0x9E3779B97F4A7C15ull) >> 57);
+    }
+
+    //! Construct a new item in an empty slot
+    void InsertAt(size_t partition_id, TableItem* items, uint8_t* ctrl,
+                  size_t i, uint8_t tag, const TableItem& kv) {
+        new (items + i)TableItem(kv);
+        ctrl[i] = tag;
+
+        // increase counter for partition
+        ++items_per_partition_[partition_id];
+        ++num_items_;
+
+        while (THRILL_UNLIKELY(
+                   items_per_partition_[partition_id] >=
+                   limit_items_per_partition_[partition_id])) {
+            LOG << "Spill due to "
+                << items_per_partition_[partition_id] << " >= "
+                << limit_items_per_partition_[partition_id]
+                << " among " << partition_size_[partition_id];
+            SpillPartition(partition_id);
+        }
+    }
+};
+
+template <typename TableItem, typename Key, typename Value,
+          typename KeyExtractor, typename ReduceFunction,
+          typename Emitter, const bool VolatileKey,
+          typename ReduceConfig, typename IndexFunction,
+          typename KeyEqualFunction>
+class ReduceTableSelect<
+        ReduceTableImpl::SIMD_PROBING,
+        TableItem, Key, Value, KeyExtractor, ReduceFunction,
+        Emitter, VolatileKey, ReduceConfig, IndexFunction, KeyEqualFunction>
+{
+public:
+    using type = ReduceSimdProbingHashTable<
+              TableItem, Key, Value, KeyExtractor, ReduceFunction,
+              Emitter, VolatileKey, ReduceConfig,
+              IndexFunction, KeyEqualFunction>;
+};
+
+} // namespace core
+} // namespace thrill
+
+#endif // !THRILL_CORE_REDUCE_SIMD_PROBING_HASH_TABLE_HEADER
+
+/******************************************************************************/
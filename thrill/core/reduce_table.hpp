@@ -27,7 +27,7 @@ namespace core {
 
 //! Enum class to select a hash table implementation.
 enum class ReduceTableImpl {
-    PROBING, OLD_PROBING, BUCKET
+    PROBING, OLD_PROBING, BUCKET, SIMD_PROBING
 };
 
 /*!
@@ -49,7 +49,8 @@ public:
     //! select the hash table in the reduce phase by enum
     static constexpr ReduceTableImpl table_impl_ = ReduceTableImpl::PROBING;
 
-    //! only for growing ProbingHashTable: items initially in a partition.
+    //! only for growing ProbingHashTable and SimdProbingHashTable: items
+    //! initially in a partition.
     static constexpr size_t initial_items_per_partition_ = 512;
 
     //! only for BucketHashTable: size of a block in the bucket chain in bytes
@@ -64,6 +65,30 @@ public:
     //! the pre and post phases simultaneously.
     static constexpr bool use_post_thread_ = true;
 
+    //! re-reduce spilled partitions of ReduceByHashPostPhase concurrently
+    //! using the host's helper threads.
+    static constexpr bool parallel_post_phase_ = true;
+
+    //! only for ReduceByIndexPostPhase: reduce into a dense array of slots
+    //! over the worker's index range instead of the hash table, if the range
+    //! fits into RAM.
+    static constexpr bool use_dense_index_ = true;
+
+    //! enable skew mode in ReducePrePhase: sample keys and keep heavy hitters
+    //! in a small resident cache, which is combined by an all-reduce across
+    //! workers at the end instead of being sent to the key's owner.
+    static constexpr bool skew_mode_ = false;
+
+    //! only for skew mode: number of slots in the heavy hitter cache.
+    static constexpr size_t heavy_hitter_slots_ = 64;
+
+    //! only for skew mode: sample every n-th item inserted.
+    static constexpr size_t heavy_hitter_sample_rate_ = 8;
+
+    //! only for skew mode: net count of samples of a key in its slot after
+    //! which it becomes a resident heavy hitter.
+    static constexpr size_t heavy_hitter_threshold_ = 16;
+
     //! \name Accessors
     //! \{
 
@@ -86,6 +111,9 @@ class DefaultReduceConfigSelect : public DefaultReduceConfig
 public:
     //! select the hash table in the reduce phase by enum
     static constexpr ReduceTableImpl table_impl_ = table_impl;
+
+    //! always use the selected hash table in ReduceByIndexPostPhase
+    static constexpr bool use_dense_index_ = false;
 };
 
 /*!
@@ -0,0 +1,185 @@
+/*******************************************************************************
+ * thrill/core/sample_sort_classifier.hpp
+ *
+ * Branchless, unrolled item classification of Super Scalar Sample Sort.
+ *
+ * Part of Project Thrill - http://project-thrill.org
+ *
+ * Copyright (C) 2015 Michael Axtmann <michael.axtmann@kit.edu>
+ * Copyright (C) 2015-2016 Timo Bingmann <tb@panthema.net>
+ *
+ * All rights reserved. Published under the BSD-2 license in the LICENSE file.
+ ******************************************************************************/
+
+#pragma once
+#ifndef THRILL_CORE_SAMPLE_SORT_CLASSIFIER_HEADER
+#define THRILL_CORE_SAMPLE_SORT_CLASSIFIER_HEADER
+
+#include <thrill/common/defines.hpp>
+#include <thrill/common/math.hpp>
+
+#include <cassert>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace thrill {
+namespace core {
+
+/*!
+ * Classifier of Super Scalar Sample Sort [Sanders, Winkel; ESA 2004], which
+ * assigns items to k = 2^log_k buckets defined by k-1 sorted splitters.
+ *
+ * The splitters are stored as an implicit binary search tree. Items are
+ * classified in batches of BatchSize: the loop over the tree levels is the
+ * outer loop and the loop over the batch is the inner one, such that the
+ * descents of all items in the batch are independent and interleaved. The
+ * branch direction is computed with a conditional move, hence no branch
+ * mispredictions occur in the descent. The bucket ids are written into an
+ * oracle buffer, from which the caller scatters the items afterwards.
+ *
+ * Splitters are (item, global index) pairs to break ties between equal items:
+ * an item equal to a splitter is placed left of it if the item's global index
+ * is not larger than the splitter's index. This keeps buckets balanced even if
+ * all items are equal.
+ *
+ * If fewer than k-1 splitters are needed, the splitter array must be padded
+ * with copies of the last splitter. All items larger than the last splitter
+ * then land in bucket k-1.
+ *
+ * \tparam ValueType the item type
+ * \tparam Comparator less comparator for items
+ * \tparam BatchSize number of items classified in an unrolled batch
+ */
+template <typename ValueType, typename Comparator, size_t BatchSize = 8>
+class SampleSortClassifier
+{
+public:
+    //! splitter item and global index for tie breaking
+    using SampleIndexPair = std::pair<ValueType, size_t>;
+
+    //! number of items classified in an unrolled batch
+    static constexpr size_t batch_size = BatchSize;
+
+    /*!
+     * Construct classifier from k-1 = 2^log_k - 1 sorted splitters.
+     */
+    SampleSortClassifier(const SampleIndexPair* splitters, size_t log_k,
+                         const Comparator& compare = Comparator())
+        : log_k_(log_k), k_(size_t(1) << log_k),
+          splitters_(splitters, splitters + k_ - 1),
+          compare_(compare) {
+        // tree_[0] is unused, the root is tree_[1].
+        if (k_ > 1) {
+            tree_.resize(k_, splitters_[0].first);
+            BuildTree(0, k_ - 1, 1);
+        }
+    }
+
+    //! number of buckets k
+    size_t num_buckets() const { return k_; }
+
+    //! logarithm of the number of buckets
+    size_t log_num_buckets() const { return log_k_; }
+
+    //! Classify a single item with global index.
+    size_t Classify(const ValueType& item, size_t index) const {
+        size_t j = 1;
+        for (size_t l = 0; l < log_k_; ++l)
+            j = 2 * j + (compare_(item, tree_[j]) ? 0 : 1);
+        return BreakTies(j - k_, item, index);
+    }
+
+    //! Classify exactly BatchSize items with consecutive global indexes
+    //! starting at index and write their bucket ids into oracle.
+    void ClassifyBatch(const ValueType* items, size_t index,
+                       size_t* oracle) const {
+        // interleave the descents of all items. The loop over the batch is
+        // unrolled explicitly such that the tree positions can be kept in
+        // registers.
+        const ValueType* tree = tree_.data();
+        size_t j[BatchSize];
+
+        for (size_t u = 0; u < BatchSize; ++u)
+            j[u] = 1;
+
+        for (size_t l = 0; l < log_k_; ++l)
+            Descend(items, tree, j,
+                    std::integral_constant<size_t, BatchSize>());
+
+        for (size_t u = 0; u < BatchSize; ++u)
+            oracle[u] = BreakTies(j[u] - k_, items[u], index + u);
+    }
+
+    //! Classify items [begin,end) with consecutive global indexes starting at
+    //! index and write their bucket ids into oracle.
+    void Classify(const ValueType* begin, const ValueType* end, size_t index,
+                  size_t* oracle) const {
+        for ( ; begin + BatchSize <= end;
+              begin += BatchSize, index += BatchSize, oracle += BatchSize) {
+            ClassifyBatch(begin, index, oracle);
+        }
+        for ( ; begin < end; ++begin, ++index, ++oracle)
+            *oracle = Classify(*begin, index);
+    }
+
+private:
+    //! logarithm of the number of buckets
+    size_t log_k_;
+
+    //! number of buckets
+    size_t k_;
+
+    //! sorted splitters for tie breaking, size k-1
+    std::vector<SampleIndexPair> splitters_;
+
+    //! implicit binary search tree of splitters, size k, root at index 1
+    std::vector<ValueType> tree_;
+
+    //! less comparator for items
+    Comparator compare_;
+
+    //! recursively build implicit tree from splitters [lo,hi)
+    void BuildTree(size_t lo, size_t hi, size_t treeidx) {
+        // pick middle element as splitter
+        size_t mid = lo + (hi - lo) / 2;
+        assert(mid < k_ - 1);
+        tree_[treeidx] = splitters_[mid].first;
+
+        if (2 * treeidx < k_) {
+            BuildTree(lo, mid, 2 * treeidx + 0);
+            BuildTree(mid + 1, hi, 2 * treeidx + 1);
+        }
+    }
+
+    //! descend items [0,U) one level down the tree, unrolled.
+    template <size_t U>
+    void Descend(const ValueType* items, const ValueType* tree, size_t* j,
+                 std::integral_constant<size_t, U>) const {
+        Descend(items, tree, j, std::integral_constant<size_t, U - 1>());
+        j[U - 1] = 2 * j[U - 1]
+                   + (compare_(items[U - 1], tree[j[U - 1]]) ? 0 : 1);
+    }
+
+    //! end of unrolled descent recursion
+    void Descend(const ValueType*, const ValueType*, size_t*,
+                 std::integral_constant<size_t, 0>) const { }
+
+    //! move item left over all splitters which are equal to it but have a
+    //! larger or equal global index. Items are rarely equal to a splitter,
+    //! hence the loop is usually not entered.
+    size_t BreakTies(size_t b, const ValueType& item, size_t index) const {
+        while (b && !compare_(splitters_[b - 1].first, item) &&
+               splitters_[b - 1].second >= index) {
+            --b;
+        }
+        return b;
+    }
+};
+
+} // namespace core
+} // namespace thrill
+
+#endif // !THRILL_CORE_SAMPLE_SORT_CLASSIFIER_HEADER
+
+/******************************************************************************/
@@ -0,0 +1,196 @@
+/*******************************************************************************
+ * thrill/core/space_saving.hpp
+ *
+ * SpaceSaving sketch for finding the most frequent items.
+ *
+ * Part of Project Thrill - http://project-thrill.org
+ *
+ * All rights reserved. Published under the BSD-2 license in the LICENSE file.
+ ******************************************************************************/
+
+#pragma once
+#ifndef THRILL_CORE_SPACE_SAVING_HEADER
+#define THRILL_CORE_SPACE_SAVING_HEADER
+
+#include <algorithm>
+#include <cassert>
+#include <functional>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace thrill {
+namespace core {
+
+/*!
+ * The SpaceSaving sketch (Metwally et al. 2005) keeps at most capacity
+ * counters of (key, count). A new key replaces the key with the smallest
+ * count and inherits its count plus one, hence counts are overestimates by at
+ * most the smallest count, and every key with frequency above n / capacity is
+ * guaranteed to be among the counters.
+ *
+ * The counters are kept in a binary min-heap, with a hash map from key to
+ * heap position, such that updates take O(log capacity) time.
+ *
+ * Counter lists of different sketches with equal capacity are combined with
+ * Merge() (Agarwal et al. 2012), which is suitable for an all-reduce.
+ */
+template <typename Key, typename HashFunction = std::hash<Key>,
+          typename KeyEqualFunction = std::equal_to<Key> >
+class SpaceSaving
+{
+public:
+    //! a counter of a key
+    using Counter = std::pair<Key, size_t>;
+
+    //! list of counters, which is all that needs to be transmitted.
+    using CounterList = std::vector<Counter>;
+
+    explicit SpaceSaving(
+        size_t capacity,
+        const HashFunction& hash_function = HashFunction(),
+        const KeyEqualFunction& key_equal_function = KeyEqualFunction())
+        : capacity_(capacity),
+          map_(capacity, hash_function, key_equal_function) {
+        assert(capacity > 0);
+        heap_.reserve(capacity);
+    }
+
+    //! Count an occurrence of key.
+    void Insert(const Key& key, size_t count = 1) {
+        typename Map::iterator it = map_.find(key);
+        if (it != map_.end()) {
+            heap_[it->second].second += count;
+            SiftDown(it->second);
+        }
+        else if (heap_.size() < capacity_) {
+            size_t pos = heap_.size();
+            heap_.emplace_back(key, count);
+            map_[key] = pos;
+            SiftUp(pos);
+        }
+        else {
+            // replace the key with the smallest count
+            map_.erase(heap_[0].first);
+            heap_[0].first = key;
+            heap_[0].second += count;
+            map_[key] = 0;
+            SiftDown(0);
+        }
+    }
+
+    //! Returns the unordered list of counters.
+    const CounterList& counters() const { return heap_; }
+
+    //! Returns capacity_
+    size_t capacity() const { return capacity_; }
+
+    /*!
+     * Merge two counter lists of sketches with equal capacity. Keys missing
+     * in a full list are assumed to have its smallest count, and the result
+     * is cut to the capacity largest counts.
+     */
+    static CounterList Merge(
+        const CounterList& a, const CounterList& b, size_t capacity,
+        const HashFunction& hash_function = HashFunction(),
+        const KeyEqualFunction& key_equal_function = KeyEqualFunction()) {
+
+        size_t min_a = MinCount(a, capacity), min_b = MinCount(b, capacity);
+
+        std::unordered_map<Key, size_t, HashFunction, KeyEqualFunction> index(
+            a.size() + b.size(), hash_function, key_equal_function);
+
+        CounterList out;
+        out.reserve(a.size() + b.size());
+
+        for (const Counter& c : a) {
+            index[c.first] = out.size();
+            out.emplace_back(c.first, c.second + min_b);
+        }
+        for (const Counter& c : b) {
+            typename std::unordered_map<
+                Key, size_t, HashFunction, KeyEqualFunction>::iterator it =
+                index.find(c.first);
+            if (it != index.end())
+                out[it->second].second += c.second - min_b;
+            else
+                out.emplace_back(c.first, c.second + min_a);
+        }
+
+        if (out.size() > capacity) {
+            std::nth_element(
+                out.begin(), out.begin() + capacity, out.end(),
+                [](const Counter& x, const Counter& y) {
+                    return x.second > y.second;
+                });
+            out.resize(capacity);
+        }
+        return out;
+    }
+
+    //! Return the k counters with the largest counts in descending order.
+    static CounterList TopK(CounterList list, size_t k) {
+        std::stable_sort(list.begin(), list.end(),
+                         [](const Counter& x, const Counter& y) {
+                             return x.second > y.second;
+                         });
+        if (list.size() > k) list.resize(k);
+        return list;
+    }
+
+private:
+    using Map = std::unordered_map<
+              Key, size_t, HashFunction, KeyEqualFunction>;
+
+    //! maximum number of counters
+    size_t capacity_;
+
+    //! min-heap of counters
+    CounterList heap_;
+
+    //! map from key to position in the heap
+    Map map_;
+
+    //! smallest count of a full list, zero otherwise.
+    static size_t MinCount(const CounterList& list, size_t capacity) {
+        if (list.size() < capacity) return 0;
+        size_t min = list[0].second;
+        for (const Counter& c : list) min = std::min(min, c.second);
+        return min;
+    }
+
+    void Swap(size_t i, size_t j) {
+        std::swap(heap_[i], heap_[j]);
+        map_[heap_[i].first] = i;
+        map_[heap_[j].first] = j;
+    }
+
+    void SiftUp(size_t pos) {
+        while (pos > 0) {
+            size_t parent = (pos - 1) / 2;
+            if (heap_[parent].second <= heap_[pos].second) break;
+            Swap(pos, parent);
+            pos = parent;
+        }
+    }
+
+    void SiftDown(size_t pos) {
+        while (true) {
+            size_t left = 2 * pos + 1, right = left + 1, min = pos;
+            if (left < heap_.size() && heap_[left].second < heap_[min].second)
+                min = left;
+            if (right < heap_.size() && heap_[right].second < heap_[min].second)
+                min = right;
+            if (min == pos) break;
+            Swap(pos, min);
+            pos = min;
+        }
+    }
+};
+
+} // namespace core
+} // namespace thrill
+
+#endif // !THRILL_CORE_SPACE_SAVING_HEADER
+
+/******************************************************************************/
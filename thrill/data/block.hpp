@@ -354,6 +354,9 @@ private:
     //! running read request
     io::RequestPtr req_;
 
+    //! buffer for reading compressed data, see ByteBlock::em_compressed_
+    Byte* em_buffer_ = nullptr;
+
     //! indication that the PinnedBlocks ready
     std::atomic<bool> ready_;
 
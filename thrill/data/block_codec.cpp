@@ -0,0 +1,223 @@
+/*******************************************************************************
+ * thrill/data/block_codec.cpp
+ *
+ * Part of Project Thrill - http://project-thrill.org
+ *
+ * All rights reserved. Published under the BSD-2 license in the LICENSE file.
+ ******************************************************************************/
+
+#include <thrill/data/block_codec.hpp>
+
+#include <cstring>
+
+namespace thrill {
+namespace data {
+
+//! number of bits of the hash table of recent positions
+static constexpr size_t kHashBits = 12;
+//! minimum length of a back-reference
+static constexpr size_t kMinMatch = 4;
+//! maximum distance of a back-reference
+static constexpr size_t kMaxOffset = 65535;
+//! the last bytes are always literals, such that the decoder can rely on it.
+static constexpr size_t kLastLiterals = 5;
+//! no match may start in the last bytes of the input
+static constexpr size_t kMatchLimit = 12;
+
+static inline uint32_t Read32(const Byte* p) {
+    uint32_t v;
+    std::memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+static inline uint64_t Read64(const Byte* p) {
+    uint64_t v;
+    std::memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+static inline size_t Hash32(uint32_t v) {
+    return (v * 2654435761u) >> (32 - kHashBits);
+}
+
+//! write a length extension: a sequence of 255 bytes and the remainder.
+static inline Byte * WriteLength(Byte* op, size_t len) {
+    while (len >= 255) {
+        *op++ = 255;
+        len -= 255;
+    }
+    *op++ = static_cast<Byte>(len);
+    return op;
+}
+
+size_t BlockCodec::Compress(const Byte* src, size_t size,
+                            Byte* dst, size_t dst_capacity) {
+
+    if (dst_capacity < header_size) return 0;
+
+    Byte* op = dst + header_size;
+    Byte* const oend = dst + dst_capacity;
+
+    //! emit one sequence of literals [anchor,ip) and a match, or only the
+    //! literals if match_len == 0. Returns false if dst is full.
+    auto emit =
+        [&](const Byte* anchor, const Byte* ip,
+            size_t offset, size_t match_len) -> bool {
+            size_t lit_len = ip - anchor;
+            // worst case length of the sequence
+            if (static_cast<size_t>(oend - op) <
+                1 + lit_len + lit_len / 255 + 1 + 2 + match_len / 255 + 1)
+                return false;
+
+            Byte* token = op++;
+            *token = static_cast<Byte>((lit_len < 15 ? lit_len : 15) << 4);
+            if (lit_len >= 15) op = WriteLength(op, lit_len - 15);
+            std::memcpy(op, anchor, lit_len);
+            op += lit_len;
+
+            if (match_len == 0) return true;
+
+            *op++ = static_cast<Byte>(offset);
+            *op++ = static_cast<Byte>(offset >> 8);
+            size_t ml = match_len - kMinMatch;
+            *token |= static_cast<Byte>(ml < 15 ? ml : 15);
+            if (ml >= 15) op = WriteLength(op, ml - 15);
+            return true;
+        };
+
+    const Byte* ip = src;
+    const Byte* anchor = src;
+    const Byte* const iend = src + size;
+
+    if (size > kMatchLimit)
+    {
+        const Byte* const ilimit = iend - kMatchLimit;
+        const Byte* const mlimit = iend - kLastLiterals;
+
+        uint32_t table[size_t(1) << kHashBits];
+        std::memset(table, 0, sizeof(table));
+
+        // skip faster through incompressible data
+        size_t misses = 0;
+
+        while (ip < ilimit)
+        {
+            uint32_t seq = Read32(ip);
+            size_t h = Hash32(seq);
+            const Byte* ref = src + table[h];
+            table[h] = static_cast<uint32_t>(ip - src);
+
+            if (ref >= ip || static_cast<size_t>(ip - ref) > kMaxOffset ||
+                Read32(ref) != seq) {
+                ip += 1 + (misses++ >> 6);
+                continue;
+            }
+            misses = 0;
+
+            // extend match forward
+            const Byte* mp = ip + kMinMatch;
+            const Byte* rp = ref + kMinMatch;
+            while (mp + 8 <= mlimit && Read64(mp) == Read64(rp))
+                mp += 8, rp += 8;
+            while (mp < mlimit && *mp == *rp)
+                ++mp, ++rp;
+
+            if (!emit(anchor, ip, ip - ref, mp - ip))
+                return 0;
+
+            ip = anchor = mp;
+        }
+    }
+
+    // last literals
+    if (!emit(anchor, iend, 0, 0))
+        return 0;
+
+    size_t total = op - dst;
+    uint32_t prefix[2] = {
+        static_cast<uint32_t>(total), static_cast<uint32_t>(size)
+    };
+    std::memcpy(dst, prefix, sizeof(prefix));
+    return total;
+}
+
+size_t BlockCodec::CompressedSize(const Byte* src) {
+    return Read32(src);
+}
+
+size_t BlockCodec::DecompressedSize(const Byte* src) {
+    return Read32(src + sizeof(uint32_t));
+}
+
+bool BlockCodec::Decompress(const Byte* src, size_t src_capacity,
+                            Byte* dst, size_t size) {
+
+    if (src_capacity < header_size) return false;
+    size_t total = CompressedSize(src);
+    if (total < header_size || total > src_capacity) return false;
+    if (DecompressedSize(src) != size) return false;
+
+    const Byte* ip = src + header_size;
+    const Byte* const iend = src + total;
+    Byte* op = dst;
+    Byte* const oend = dst + size;
+
+    //! read a length extension, returns false on truncated input.
+    auto read_length =
+        [&](size_t& len) -> bool {
+            Byte b;
+            do {
+                if (ip >= iend) return false;
+                b = *ip++;
+                len += b;
+            } while (b == 255);
+            return true;
+        };
+
+    while (ip < iend)
+    {
+        Byte token = *ip++;
+
+        // literals
+        size_t lit_len = token >> 4;
+        if (lit_len == 15 && !read_length(lit_len)) return false;
+        if (static_cast<size_t>(iend - ip) < lit_len ||
+            static_cast<size_t>(oend - op) < lit_len)
+            return false;
+        std::memcpy(op, ip, lit_len);
+        ip += lit_len, op += lit_len;
+
+        // last sequence has no match
+        if (ip == iend) break;
+
+        // match
+        if (iend - ip < 2) return false;
+        size_t offset = ip[0] | (static_cast<size_t>(ip[1]) << 8);
+        ip += 2;
+        if (offset == 0 || offset > static_cast<size_t>(op - dst))
+            return false;
+
+        size_t match_len = token & 15;
+        if (match_len == 15 && !read_length(match_len)) return false;
+        match_len += kMinMatch;
+        if (static_cast<size_t>(oend - op) < match_len) return false;
+
+        const Byte* rp = op - offset;
+        if (offset >= match_len) {
+            std::memcpy(op, rp, match_len);
+            op += match_len;
+        }
+        else {
+            // overlapping copy repeats the pattern
+            for (size_t i = 0; i < match_len; ++i)
+                *op++ = *rp++;
+        }
+    }
+
+    return op == oend;
+}
+
+} // namespace data
+} // namespace thrill
+
+/******************************************************************************/
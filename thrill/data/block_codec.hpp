@@ -0,0 +1,75 @@
+/*******************************************************************************
+ * thrill/data/block_codec.hpp
+ *
+ * Fast LZ77 byte compression of ByteBlocks for swapping and network transfer.
+ *
+ * Part of Project Thrill - http://project-thrill.org
+ *
+ * All rights reserved. Published under the BSD-2 license in the LICENSE file.
+ ******************************************************************************/
+
+#pragma once
+#ifndef THRILL_DATA_BLOCK_CODEC_HEADER
+#define THRILL_DATA_BLOCK_CODEC_HEADER
+
+#include <thrill/data/byte_block.hpp>
+
+#include <cstddef>
+#include <cstdint>
+
+namespace thrill {
+namespace data {
+
+//! \addtogroup data_layer
+//! \{
+
+/*!
+ * A fast byte-oriented LZ77 codec in the style of LZ4: sequences of literal
+ * runs and back-references of at least four bytes within a 64 KiB window,
+ * found using a small hash table. It trades compression ratio for speed,
+ * which is the right choice for spilling ByteBlocks to disk and sending them
+ * over the network.
+ *
+ * The compressed stream starts with its total length and the decompressed
+ * length as 32-bit integers, hence it can be decoded from a larger, padded
+ * buffer.
+ */
+class BlockCodec
+{
+public:
+    //! size of the length prefix of compressed data
+    static constexpr size_t header_size = 2 * sizeof(uint32_t);
+
+    /*!
+     * Compress size bytes from src into dst, which has room for dst_capacity
+     * bytes. Returns the compressed size including the length prefix, or zero
+     * if the compressed data does not fit. Pass dst_capacity < size to abort
+     * early on incompressible data.
+     */
+    static size_t Compress(const Byte* src, size_t size,
+                           Byte* dst, size_t dst_capacity);
+
+    //! Return the total length of the compressed data in src, read from the
+    //! length prefix.
+    static size_t CompressedSize(const Byte* src);
+
+    //! Return the length of the decompressed data, read from the length
+    //! prefix of src.
+    static size_t DecompressedSize(const Byte* src);
+
+    /*!
+     * Decompress data from src, which holds src_capacity bytes, into exactly
+     * size bytes at dst. Returns false if the compressed data is corrupt.
+     */
+    static bool Decompress(const Byte* src, size_t src_capacity,
+                           Byte* dst, size_t size);
+};
+
+//! \}
+
+} // namespace data
+} // namespace thrill
+
+#endif // !THRILL_DATA_BLOCK_CODEC_HEADER
+
+/******************************************************************************/
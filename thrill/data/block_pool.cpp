@@ -8,18 +8,21 @@
  * All rights reserved. Published under the BSD-2 license in the LICENSE file.
  ******************************************************************************/
 
+#include <thrill/common/config.hpp>
 #include <thrill/common/die.hpp>
 #include <thrill/common/logger.hpp>
-#include <thrill/common/lru_cache.hpp>
 #include <thrill/common/math.hpp>
 #include <thrill/data/block.hpp>
+#include <thrill/data/block_codec.hpp>
 #include <thrill/data/block_pool.hpp>
+#include <thrill/data/eviction_policy.hpp>
 #include <thrill/io/file_base.hpp>
 #include <thrill/io/iostats.hpp>
 #include <thrill/mem/aligned_allocator.hpp>
 #include <thrill/mem/pool.hpp>
 
 #include <algorithm>
+#include <atomic>
 #include <functional>
 #include <limits>
 #include <thread>
@@ -65,7 +68,15 @@ static void OurNewHandler() {
     static size_t s_iter = 0;
     io::RequestPtr req;
 
-    // first try to find a handle to a currently being written block.
+    // first release cached free ByteBlocks, which needs no I/O.
+    for (size_t i = 0; i < s_blockpools.size(); ++i) {
+        if (s_blockpools[i]->ReleaseCachedBlocks() != 0) {
+            in_new_handler = false;
+            return;
+        }
+    }
+
+    // then try to find a handle to a currently being written block.
     for (size_t i = 0; i < s_blockpools.size(); ++i) {
         req = s_blockpools[s_iter]->GetAnyWriting();
         ++s_iter %= s_blockpools.size();
@@ -75,7 +86,7 @@ static void OurNewHandler() {
     if (!req) {
         // if no writing active, evict a block
         for (size_t i = 0; i < s_blockpools.size(); ++i) {
-            req = s_blockpools[s_iter]->EvictBlockLRU();
+            req = s_blockpools[s_iter]->EvictVictim();
             ++s_iter %= s_blockpools.size();
             if (req) break;
         }
@@ -230,6 +241,27 @@ using ReadingMap = std::unordered_map<
 class BlockPool::Data
 {
 public:
+    //! number of free ByteBlocks cached per local worker
+    static constexpr size_t block_cache_slots_ = 4;
+
+    //! cache of free ByteBlocks of one local worker. The slots are taken
+    //! without locking by the worker, and filled or released while holding
+    //! the BlockPool's mutex.
+    struct BlockCache {
+        std::atomic<ByteBlock*> slots[block_cache_slots_];
+        //! padding to avoid false sharing between workers
+        char padding[common::g_cache_line_size
+                     - block_cache_slots_ * sizeof(ByteBlock*)];
+
+        BlockCache() {
+            for (size_t i = 0; i < block_cache_slots_; ++i)
+                slots[i].store(nullptr, std::memory_order_relaxed);
+        }
+    };
+
+    static_assert(sizeof(BlockCache) % common::g_cache_line_size == 0,
+                  "BlockCache must be a multiple of the cache line size");
+
     //! For waiting on hard memory limit
     std::condition_variable cv_memory_change_;
 
@@ -241,9 +273,14 @@ public:
     //! is reached. 0 for no limit.
     size_t hard_ram_limit_;
 
-    //! list of all blocks that are _in_memory_ but are _not_ pinned.
-    common::LruCacheSet<
-        ByteBlock*, mem::GPoolAllocator<ByteBlock*> > unpinned_blocks_;
+    //! replacement policy
+    const EvictionPolicyType eviction_policy_;
+
+    //! set of all blocks that are _in_memory_ but are _not_ pinned, ordered
+    //! by the replacement policy.
+    std::unique_ptr<EvictionPolicy<
+                        ByteBlock*, mem::GPoolAllocator<ByteBlock*> > >
+    unpinned_blocks_;
 
     //! set of ByteBlocks currently begin written to EM.
     WritingMap writing_;
@@ -256,6 +293,31 @@ public:
         ByteBlock*, std::hash<ByteBlock*>, std::equal_to<ByteBlock*>,
         mem::GPoolAllocator<ByteBlock*> > swapped_;
 
+    //! compress ByteBlocks before writing them to EM
+    const bool swap_compression_;
+
+    //! set of ByteBlocks which are compressed with the mutex unlocked.
+    std::unordered_set<
+        ByteBlock*, std::hash<ByteBlock*>, std::equal_to<ByteBlock*>,
+        mem::GPoolAllocator<ByteBlock*> > compressing_;
+
+    //! buffers with compressed data of ByteBlocks currently being written.
+    std::unordered_map<
+        ByteBlock*, std::pair<Byte*, size_t>,
+        std::hash<ByteBlock*>, std::equal_to<ByteBlock*>,
+        mem::GPoolAllocator<std::pair<ByteBlock* const,
+                                      std::pair<Byte*, size_t> > > >
+    compress_buffers_;
+
+    //! number of bytes of ByteBlocks which were compressed before writing
+    size_t compress_raw_bytes_ = 0;
+
+    //! number of bytes written for compressed ByteBlocks
+    size_t compress_bytes_ = 0;
+
+    //! number of ByteBlocks written raw because they were incompressible
+    size_t compress_skipped_ = 0;
+
     //! I/O layer stats when BlockPool was created.
     io::StatsData io_stats_first_;
 
@@ -310,15 +372,42 @@ public:
     std::chrono::steady_clock::time_point tp_last_
         = std::chrono::steady_clock::now();
 
+    //! caches of free ByteBlocks per local worker
+    std::vector<BlockCache> block_cache_;
+
+    //! whether destroyed ByteBlocks are recycled into the caches
+    bool recycle_blocks_ = true;
+
+    //! number of allocations served from the caches
+    std::atomic<size_t> cache_hits_ { 0 };
+
 public:
     Data(BlockPool& block_pool,
          size_t soft_ram_limit, size_t hard_ram_limit,
-         size_t workers_per_host)
+         size_t workers_per_host, EvictionPolicyType eviction_policy,
+         bool swap_compression)
         : soft_ram_limit_(soft_ram_limit),
           hard_ram_limit_(hard_ram_limit),
+          eviction_policy_(eviction_policy),
+          unpinned_blocks_(
+              MakeEvictionPolicy<ByteBlock*, mem::GPoolAllocator<ByteBlock*> >(
+                  eviction_policy)),
+          swap_compression_(swap_compression),
           bm_(io::BlockManager::GetInstance()),
           aligned_alloc_(mem::Allocator<char>(block_pool.mem_manager_)),
-          pin_count_(workers_per_host) { }
+          pin_count_(workers_per_host),
+          block_cache_(workers_per_host) { }
+
+    //! Take a free ByteBlock from the worker's cache without locking, returns
+    //! nullptr if the cache is empty. The ByteBlock is pinned by the worker.
+    ByteBlock * TakeCachedBlock(size_t local_worker_id);
+
+    //! Put an unpinned ByteBlock into its home worker's cache, if there is
+    //! space and memory is not scarce. Returns false if it must be destroyed.
+    bool IntRecycleBlock(ByteBlock* block_ptr);
+
+    //! Release all cached ByteBlocks, returns the number of bytes freed.
+    size_t IntReleaseCachedBlocks();
 
     //! Updates the memory manager for internal memory. If the hard limit is
     //! reached, the call is blocked intil memory is free'd
@@ -328,17 +417,37 @@ public:
     //! BlockPool::RequestInternalMemory calls
     void IntReleaseInternalMemory(size_t size);
 
-    //! Unpins a block. If all pins are removed, the block might be swapped.
-    //! Returns immediately. Actual unpinning is async.
+    //! Releases the memory accounted to a worker after its last pin of a
+    //! block was removed.
     void IntUnpinBlock(
         BlockPool& bp, ByteBlock* block_ptr, size_t local_worker_id);
 
-    //! Evict a block from the lru list into external memory
-    io::RequestPtr IntEvictBlockLRU();
+    //! Inserts a block whose last pin was removed into unpinned_blocks_,
+    //! from where it may be swapped out.
+    void IntAllowSwapOut(ByteBlock* block_ptr);
+
+    //! Evict the victim block selected by the replacement policy into external
+    //! memory
+    io::RequestPtr IntEvictVictim(std::unique_lock<std::mutex>& lock);
 
     //! Evict a block into external memory. The block must be unpinned and not
-    //! swapped.
-    io::RequestPtr IntEvictBlock(ByteBlock* block_ptr);
+    //! swapped. May unlock the mutex while compressing the block.
+    io::RequestPtr IntEvictBlock(
+        std::unique_lock<std::mutex>& lock, ByteBlock* block_ptr);
+
+    //! Compress the block's data into a buffer for writing, returns the
+    //! number of bytes to write or zero if the block is incompressible. The
+    //! mutex is unlocked during compression, and the buffer is counted in
+    //! total_ram_bytes_ and writing_bytes_ until it is released.
+    size_t IntCompressBlock(
+        std::unique_lock<std::mutex>& lock, ByteBlock* block_ptr);
+
+    //! Release the buffer allocated by IntCompressBlock() after writing.
+    void IntReleaseCompressBuffer(ByteBlock* block_ptr);
+
+    //! Wait until the block is not being compressed by IntCompressBlock().
+    void IntWaitCompressing(
+        std::unique_lock<std::mutex>& lock, ByteBlock* block_ptr);
 
     //! \name Block Statistics
     //! \{
@@ -360,12 +469,15 @@ BlockPool::BlockPool(size_t workers_per_host)
 
 BlockPool::BlockPool(size_t soft_ram_limit, size_t hard_ram_limit,
                      common::JsonLogger* logger, mem::Manager* mem_manager,
-                     size_t workers_per_host)
+                     size_t workers_per_host,
+                     EvictionPolicyType eviction_policy,
+                     bool swap_compression)
     : logger_(logger),
       mem_manager_(mem_manager, "BlockPool"),
       workers_per_host_(workers_per_host),
       d_(std::make_unique<Data>(
-             *this, soft_ram_limit, hard_ram_limit, workers_per_host)) {
+             *this, soft_ram_limit, hard_ram_limit, workers_per_host,
+             eviction_policy, swap_compression)) {
 
     die_unless(hard_ram_limit >= soft_ram_limit);
     {
@@ -383,12 +495,18 @@ BlockPool::BlockPool(size_t soft_ram_limit, size_t hard_ram_limit,
     logger_ << "class" << "BlockPool"
             << "event" << "create"
             << "soft_ram_limit" << soft_ram_limit
-            << "hard_ram_limit" << hard_ram_limit;
+            << "hard_ram_limit" << hard_ram_limit
+            << "eviction_policy" << EvictionPolicyName(eviction_policy)
+            << "swap_compression" << swap_compression;
 }
 
 BlockPool::~BlockPool() {
     std::unique_lock<std::mutex> lock(mutex_);
 
+    // stop recycling and free cached ByteBlocks
+    d_->recycle_blocks_ = false;
+    d_->IntReleaseCachedBlocks();
+
     // check that not writing any block.
     while (d_->writing_.begin() != d_->writing_.end()) {
 
@@ -448,7 +566,7 @@ BlockPool::~BlockPool() {
     d_->pin_count_.AssertZero();
     die_unequal(d_->total_ram_bytes_, 0u);
     die_unequal(d_->total_bytes_, 0u);
-    die_unequal(d_->unpinned_blocks_.size(), 0u);
+    die_unequal(d_->unpinned_blocks_->size(), 0u);
 
     LOGC(debug_pin)
         << "~BlockPool()"
@@ -458,7 +576,8 @@ BlockPool::~BlockPool() {
     logger_ << "class" << "BlockPool"
             << "event" << "destroy"
             << "max_pins" << d_->pin_count_.max_pins
-            << "max_pinned_bytes" << d_->pin_count_.max_pinned_bytes;
+            << "max_pinned_bytes" << d_->pin_count_.max_pinned_bytes
+            << "cache_hits" << d_->cache_hits_.load();
 
     std::unique_lock<std::recursive_mutex> s_new_lock(s_new_mutex);
     s_blockpools.erase(
@@ -468,6 +587,21 @@ BlockPool::~BlockPool() {
 PinnedByteBlockPtr
 BlockPool::AllocateByteBlock(size_t size, size_t local_worker_id) {
     assert(local_worker_id < workers_per_host_);
+
+    // fast path without locking: take a recycled ByteBlock, whose memory is
+    // still accounted as pinned by this worker.
+    if (size == default_block_size) {
+        if (ByteBlock* block_ptr = d_->TakeCachedBlock(local_worker_id)) {
+            LOGC(debug_blc)
+                << "BlockPool::AllocateBlock()"
+                << " ptr=" << block_ptr
+                << " size=" << size
+                << " local_worker_id=" << local_worker_id
+                << " from cache";
+            return PinnedByteBlockPtr(block_ptr, local_worker_id);
+        }
+    }
+
     std::unique_lock<std::mutex> lock(mutex_);
 
     if (!(size % THRILL_DEFAULT_ALIGN == 0 && common::IsPowerOfTwo(size))
@@ -489,6 +623,7 @@ BlockPool::AllocateByteBlock(size_t size, size_t local_worker_id) {
     // create common::CountingPtr, no need for special make_shared()-equivalent
     PinnedByteBlockPtr block_ptr(
         mem::GPool().make<ByteBlock>(this, data, size), local_worker_id);
+    block_ptr->home_worker_id_ = local_worker_id;
     ++d_->total_byte_blocks_;
     d_->total_bytes_ += size;
     d_->max_total_bytes_ = std::max(d_->max_total_bytes_, d_->total_bytes_.value);
@@ -539,7 +674,7 @@ PinRequestPtr BlockPool::PinBlock(const Block& block, size_t local_worker_id) {
         // PinnedBlock become Blocks when transfered between Files or delivered
         // via GetItemRange() or Scatter().
 
-        die_unless(!d_->unpinned_blocks_.exists(block_ptr));
+        die_unless(!d_->unpinned_blocks_->exists(block_ptr));
         die_unless(d_->reading_.find(block_ptr) == d_->reading_.end());
 
         LOGC(debug_pin)
@@ -556,7 +691,7 @@ PinRequestPtr BlockPool::PinBlock(const Block& block, size_t local_worker_id) {
         // This block was already pinned by another thread, hence we only need
         // to get a pin for the new thread.
 
-        die_unless(!d_->unpinned_blocks_.exists(block_ptr));
+        die_unless(!d_->unpinned_blocks_->exists(block_ptr));
         die_unless(d_->reading_.find(block_ptr) == d_->reading_.end());
 
         LOGC(debug_pin)
@@ -571,6 +706,9 @@ PinRequestPtr BlockPool::PinBlock(const Block& block, size_t local_worker_id) {
                                  this, PinnedBlock(block, local_worker_id)));
     }
 
+    // wait if the block is being compressed for writing.
+    d_->IntWaitCompressing(lock, block_ptr);
+
     // check that not writing the block.
     WritingMap::iterator write_it;
     while ((write_it = d_->writing_.find(block_ptr)) != d_->writing_.end()) {
@@ -619,8 +757,8 @@ PinRequestPtr BlockPool::PinBlock(const Block& block, size_t local_worker_id) {
         // unpinned block in memory, no need to load from EM.
 
         // remove from unpinned list
-        die_unless(d_->unpinned_blocks_.exists(block_ptr));
-        d_->unpinned_blocks_.erase(block_ptr);
+        die_unless(d_->unpinned_blocks_->exists(block_ptr));
+        d_->unpinned_blocks_->pin(block_ptr);
         d_->unpinned_bytes_ -= block_ptr->size();
 
         IntIncBlockPinCount(block_ptr, local_worker_id);
@@ -669,11 +807,20 @@ PinRequestPtr BlockPool::PinBlock(const Block& block, size_t local_worker_id) {
         << " requested from external memory"
         << d_->pin_count_;
 
+    // compressed blocks are read into a buffer and decompressed in
+    // OnReadComplete().
+    if (block_ptr->em_compressed_) {
+        lock.unlock();
+        data = read->em_buffer_ =
+                   d_->aligned_alloc_.allocate(block_ptr->em_bid_.size);
+        lock.lock();
+    }
+
     // issue I/O request, hold the reference to the request in the hashmap
     read->req_ =
         block_ptr->em_bid_.storage->aread(
             // parameters for the read
-            data, block_ptr->em_bid_.offset, block_ptr->size(),
+            data, block_ptr->em_bid_.offset, block_ptr->em_bid_.size,
             // construct an immediate CompletionHandler callback
             io::CompletionHandler::make<
                 PinRequest, & PinRequest::OnComplete>(*read));
@@ -689,11 +836,25 @@ void PinRequest::OnComplete(io::Request* req, bool success) {
 
 void BlockPool::OnReadComplete(
     PinRequest* read, io::Request* req, bool success) {
-    std::unique_lock<std::mutex> lock(mutex_);
 
     ByteBlock* block_ptr = read->block_.byte_block().get();
     size_t block_size = block_ptr->size();
 
+    if (read->em_buffer_ && success) {
+        // decompress outside the lock, the block is not accessed otherwise
+        // while it is being read.
+        die_unless(BlockCodec::Decompress(
+                       read->em_buffer_, block_ptr->em_bid_.size,
+                       read->byte_block()->data_, block_size));
+    }
+
+    std::unique_lock<std::mutex> lock(mutex_);
+
+    if (read->em_buffer_) {
+        d_->aligned_alloc_.deallocate(read->em_buffer_, block_ptr->em_bid_.size);
+        read->em_buffer_ = nullptr;
+    }
+
     LOGC(debug_em)
         << "OnReadComplete():"
         << " req " << req << " block " << block_ptr
@@ -730,6 +891,7 @@ void BlockPool::OnReadComplete(
         if (!block_ptr->ext_file_) {
             d_->bm_->delete_block(block_ptr->em_bid_);
             block_ptr->em_bid_ = io::BID<0>();
+            block_ptr->em_compressed_ = false;
         }
     }
 
@@ -750,7 +912,8 @@ void BlockPool::OnReadComplete(
 }
 
 void BlockPool::IncBlockPinCount(ByteBlock* block_ptr, size_t local_worker_id) {
-    std::unique_lock<std::mutex> lock(mutex_);
+    // the caller holds a pin of this worker, hence no pin count leaves zero and
+    // the BlockPool's state does not change: no locking required.
     assert(local_worker_id < workers_per_host_);
     die_unless(block_ptr->pin_count_[local_worker_id] > 0);
     return IntIncBlockPinCount(block_ptr, local_worker_id);
@@ -759,22 +922,47 @@ void BlockPool::IncBlockPinCount(ByteBlock* block_ptr, size_t local_worker_id) {
 void BlockPool::IntIncBlockPinCount(ByteBlock* block_ptr, size_t local_worker_id) {
     assert(local_worker_id < workers_per_host_);
 
-    ++block_ptr->pin_count_[local_worker_id];
+    // increment the total first, such that it is never smaller than the sum
+    // of the per-worker counts.
     ++block_ptr->total_pins_;
+    ++block_ptr->pin_count_[local_worker_id];
 
     LOGC(debug_pin)
         << "BlockPool::IncBlockPinCount()"
         << " block=" << block_ptr
         << " ++block.pin_count[" << local_worker_id << "]="
         << block_ptr->pin_count_[local_worker_id]
-        << " ++block.total_pins_=" << block_ptr->total_pins_
-        << d_->pin_count_;
+        << " ++block.total_pins_=" << block_ptr->total_pins_;
 }
 
 void BlockPool::DecBlockPinCount(ByteBlock* block_ptr, size_t local_worker_id) {
+    assert(local_worker_id < workers_per_host_);
+
+    // fast path: release a pin which is not the worker's last one without
+    // locking. The total is decremented last, see IntIncBlockPinCount(), and
+    // never to zero without the mutex, since PinBlock() expects a block
+    // without pins to be in unpinned_blocks_.
+    std::atomic<size_t>& pin_count = block_ptr->pin_count_[local_worker_id];
+    size_t pc = pin_count.load(std::memory_order_relaxed);
+    while (pc > 1) {
+        if (!pin_count.compare_exchange_weak(pc, pc - 1)) continue;
+
+        size_t tp = block_ptr->total_pins_.load(std::memory_order_relaxed);
+        while (tp > 1) {
+            if (block_ptr->total_pins_.compare_exchange_weak(tp, tp - 1))
+                return;
+        }
+
+        // all other pins were released concurrently, which left unpinning
+        // the block to us.
+        std::unique_lock<std::mutex> lock(mutex_);
+        if (--block_ptr->total_pins_ == 0)
+            d_->IntAllowSwapOut(block_ptr);
+        return;
+    }
+
     std::unique_lock<std::mutex> lock(mutex_);
 
-    assert(local_worker_id < workers_per_host_);
     die_unless(block_ptr->pin_count_[local_worker_id] > 0);
     die_unless(block_ptr->total_pins_ > 0);
 
@@ -790,6 +978,8 @@ void BlockPool::DecBlockPinCount(ByteBlock* block_ptr, size_t local_worker_id) {
 
     if (p == 0)
         d_->IntUnpinBlock(*this, block_ptr, local_worker_id);
+    if (tp == 0)
+        d_->IntAllowSwapOut(block_ptr);
 }
 
 void BlockPool::Data::IntUnpinBlock(
@@ -800,23 +990,18 @@ void BlockPool::Data::IntUnpinBlock(
     die_unless(block_ptr->pin_count(local_worker_id) == 0);
 
     pin_count_.Decrement(local_worker_id, block_ptr->size());
+}
 
-    if (block_ptr->total_pins_ != 0) {
-        LOGC(debug_pin)
-            << "BlockPool::IntUnpinBlock()"
-            << " --block.total_pins_=" << block_ptr->total_pins_;
-        return;
-    }
-
-    // if all per-thread pins are zero, allow this Block to be swapped out.
-    die_unless(!unpinned_blocks_.exists(block_ptr));
-    unpinned_blocks_.put(block_ptr);
+void BlockPool::Data::IntAllowSwapOut(ByteBlock* block_ptr) {
+    // all per-thread pins are zero, allow this Block to be swapped out.
+    die_unless(block_ptr->total_pins_ == 0);
+    die_unless(!unpinned_blocks_->exists(block_ptr));
+    unpinned_blocks_->put(block_ptr, block_ptr->eviction_hint());
     unpinned_bytes_ += block_ptr->size();
 
     LOGC(debug_pin)
-        << "BlockPool::IntUnpinBlock()"
+        << "BlockPool::IntAllowSwapOut()"
         << " block=" << block_ptr
-        << " --total_pins_=" << block_ptr->total_pins_
         << " allow swap out.";
 }
 
@@ -829,13 +1014,13 @@ size_t BlockPool::Data::int_total_blocks() noexcept {
 
     LOG << "BlockPool::total_blocks()"
         << " pinned_blocks_=" << pin_count_.total_pins_
-        << " unpinned_blocks_=" << unpinned_blocks_.size()
+        << " unpinned_blocks_=" << unpinned_blocks_->size()
         << " writing_.size()=" << writing_.size()
         << " swapped_.size()=" << swapped_.size()
         << " reading_.size()=" << reading_.size();
 
     return pin_count_.total_pins_
-           + unpinned_blocks_.size() + writing_.size()
+           + unpinned_blocks_->size() + writing_.size()
            + swapped_.size() + reading_.size();
 }
 
@@ -874,7 +1059,7 @@ size_t BlockPool::pinned_blocks() noexcept {
 
 size_t BlockPool::unpinned_blocks() noexcept {
     std::unique_lock<std::mutex> lock(mutex_);
-    return d_->unpinned_blocks_.size();
+    return d_->unpinned_blocks_->size();
 }
 
 size_t BlockPool::writing_blocks() noexcept {
@@ -892,7 +1077,7 @@ size_t BlockPool::reading_blocks() noexcept {
     return d_->reading_.size();
 }
 
-void BlockPool::DestroyBlock(ByteBlock* block_ptr) {
+bool BlockPool::DestroyBlock(ByteBlock* block_ptr) {
     LOGC(debug_blc)
         << "BlockPool::DestroyBlock() block_ptr=" << block_ptr
         << " byte_block=" << *block_ptr;
@@ -904,6 +1089,10 @@ void BlockPool::DestroyBlock(ByteBlock* block_ptr) {
     // pinned blocks cannot be destroyed since they are always unpinned first
     die_unless(block_ptr->total_pins_ == 0);
 
+    // an evicting thread may be compressing the block, after which it is
+    // being written.
+    d_->IntWaitCompressing(lock, block_ptr);
+
     do {
         if (block_ptr->in_memory())
         {
@@ -958,8 +1147,8 @@ void BlockPool::DestroyBlock(ByteBlock* block_ptr) {
             << "BlockPool::DestroyBlock() block_ptr=" << block_ptr
             << " external block, in memory: release memory.";
 
-        die_unless(d_->unpinned_blocks_.exists(block_ptr));
-        d_->unpinned_blocks_.erase(block_ptr);
+        die_unless(d_->unpinned_blocks_->exists(block_ptr));
+        d_->unpinned_blocks_->erase(block_ptr);
         d_->unpinned_bytes_ -= block_ptr->size();
 
         // release memory
@@ -981,10 +1170,14 @@ void BlockPool::DestroyBlock(ByteBlock* block_ptr) {
             << "BlockPool::DestroyBlock() block_ptr=" << block_ptr
             << " unpinned block in memory, remove from list";
 
-        die_unless(d_->unpinned_blocks_.exists(block_ptr));
-        d_->unpinned_blocks_.erase(block_ptr);
+        die_unless(d_->unpinned_blocks_->exists(block_ptr));
+        d_->unpinned_blocks_->erase(block_ptr);
         d_->unpinned_bytes_ -= block_ptr->size();
 
+        // keep the ByteBlock with its memory for the next allocation
+        if (d_->IntRecycleBlock(block_ptr))
+            return true;
+
         // release memory
         d_->aligned_alloc_.deallocate(block_ptr->data_, block_ptr->size());
         block_ptr->data_ = nullptr;
@@ -1012,6 +1205,93 @@ void BlockPool::DestroyBlock(ByteBlock* block_ptr) {
     --d_->total_byte_blocks_;
     d_->total_bytes_ -= block_ptr->size();
     d_->cv_total_byte_blocks_.notify_all();
+    return false;
+}
+
+ByteBlock* BlockPool::Data::TakeCachedBlock(size_t local_worker_id) {
+    BlockCache& cache = block_cache_[local_worker_id];
+    for (size_t i = 0; i < block_cache_slots_; ++i) {
+        if (cache.slots[i].load(std::memory_order_relaxed) == nullptr)
+            continue;
+        ByteBlock* block_ptr =
+            cache.slots[i].exchange(nullptr, std::memory_order_acquire);
+        if (block_ptr) {
+            ++cache_hits_;
+            return block_ptr;
+        }
+    }
+    return nullptr;
+}
+
+bool BlockPool::Data::IntRecycleBlock(ByteBlock* block_ptr) {
+    if (!recycle_blocks_ || block_ptr->size() != default_block_size)
+        return false;
+
+    // do not hold on to memory if the soft limit is reached.
+    if (soft_ram_limit_ != 0 &&
+        total_ram_bytes_ + requested_bytes_ > soft_ram_limit_)
+        return false;
+
+    // the cached ByteBlock is pinned by its home worker, such that it is
+    // ready for delivery by TakeCachedBlock() without locking.
+    size_t home = block_ptr->home_worker_id_;
+    block_ptr->total_pins_ = 1;
+    block_ptr->pin_count_[home] = 1;
+    block_ptr->eviction_hint_ = EvictionHint::None;
+
+    BlockCache& cache = block_cache_[home];
+    for (size_t i = 0; i < block_cache_slots_; ++i) {
+        ByteBlock* expected = nullptr;
+        if (cache.slots[i].compare_exchange_strong(
+                expected, block_ptr, std::memory_order_release)) {
+            pin_count_.Increment(home, block_ptr->size());
+            return true;
+        }
+    }
+
+    // cache is full
+    block_ptr->pin_count_[home] = 0;
+    block_ptr->total_pins_ = 0;
+    return false;
+}
+
+size_t BlockPool::ReleaseCachedBlocks() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    return d_->IntReleaseCachedBlocks();
+}
+
+size_t BlockPool::Data::IntReleaseCachedBlocks() {
+    size_t freed = 0;
+    for (size_t w = 0; w < block_cache_.size(); ++w) {
+        for (size_t i = 0; i < block_cache_slots_; ++i) {
+            ByteBlock* block_ptr = block_cache_[w].slots[i].exchange(
+                nullptr, std::memory_order_acquire);
+            if (!block_ptr) continue;
+
+            size_t size = block_ptr->size();
+            block_ptr->pin_count_[w] = 0;
+            block_ptr->total_pins_ = 0;
+            pin_count_.Decrement(w, size);
+
+            // release memory
+            aligned_alloc_.deallocate(block_ptr->data_, size);
+            block_ptr->data_ = nullptr;
+            IntReleaseInternalMemory(size);
+
+            assert(total_byte_blocks_ > 0);
+            --total_byte_blocks_;
+            total_bytes_ -= size;
+            mem::GPool().destroy(block_ptr);
+
+            freed += size;
+        }
+    }
+    if (freed != 0) {
+        LOGC(debug_mem)
+            << "BlockPool::IntReleaseCachedBlocks() freed " << freed;
+        cv_total_byte_blocks_.notify_all();
+    }
+    return freed;
 }
 
 void BlockPool::RequestInternalMemory(size_t size) {
@@ -1033,15 +1313,22 @@ void BlockPool::Data::IntRequestInternalMemory(
         << " soft_ram_limit_=" << soft_ram_limit_
         << " hard_ram_limit_=" << hard_ram_limit_
         << pin_count_
-        << " unpinned_blocks_.size()=" << unpinned_blocks_.size()
+        << " unpinned_blocks_.size()=" << unpinned_blocks_->size()
         << " swapped_.size()=" << swapped_.size();
 
+    // cached free ByteBlocks are released first.
+    if (soft_ram_limit_ != 0 &&
+        total_ram_bytes_ + requested_bytes_ > soft_ram_limit_ + writing_bytes_)
+    {
+        IntReleaseCachedBlocks();
+    }
+
     while (soft_ram_limit_ != 0 &&
-           unpinned_blocks_.size() &&
+           unpinned_blocks_->size() &&
            total_ram_bytes_ + requested_bytes_ > soft_ram_limit_ + writing_bytes_)
     {
         // evict blocks: schedule async writing which increases writing_bytes_.
-        IntEvictBlockLRU();
+        IntEvictVictim(lock);
     }
 
     // wait up to 60 seconds for other threads to free up memory or pins
@@ -1053,11 +1340,11 @@ void BlockPool::Data::IntRequestInternalMemory(
     while (hard_ram_limit_ != 0 && total_ram_bytes_ + size > hard_ram_limit_)
     {
         while (hard_ram_limit_ != 0 &&
-               unpinned_blocks_.size() &&
+               unpinned_blocks_->size() &&
                total_ram_bytes_ + requested_bytes_ > hard_ram_limit_ + writing_bytes_)
         {
             // evict blocks: schedule async writing which increases writing_bytes_.
-            IntEvictBlockLRU();
+            IntEvictVictim(lock);
         }
 
         cv_memory_change_.wait_for(lock, std::chrono::seconds(1));
@@ -1070,7 +1357,7 @@ void BlockPool::Data::IntRequestInternalMemory(
             << " soft_ram_limit_=" << soft_ram_limit_
             << " hard_ram_limit_=" << hard_ram_limit_
             << pin_count_
-            << " unpinned_blocks_.size()=" << unpinned_blocks_.size()
+            << " unpinned_blocks_.size()=" << unpinned_blocks_->size()
             << " swapped_.size()=" << swapped_.size();
 
         if (writing_bytes_ == 0 &&
@@ -1083,7 +1370,7 @@ void BlockPool::Data::IntRequestInternalMemory(
                  << " soft_ram_limit_=" << soft_ram_limit_
                  << " hard_ram_limit_=" << hard_ram_limit_
                  << pin_count_
-                 << " unpinned_blocks_.size()=" << unpinned_blocks_.size()
+                 << " unpinned_blocks_.size()=" << unpinned_blocks_->size()
                  << " swapped_.size()=" << swapped_.size();
 
             if (writing_bytes_ == last_writing_bytes) {
@@ -1113,14 +1400,17 @@ void BlockPool::AdviseFree(size_t size) {
         << " soft_ram_limit_=" << d_->soft_ram_limit_
         << " hard_ram_limit_=" << d_->hard_ram_limit_
         << d_->pin_count_
-        << " unpinned_blocks_.size()=" << d_->unpinned_blocks_.size()
+        << " unpinned_blocks_.size()=" << d_->unpinned_blocks_->size()
         << " swapped_.size()=" << d_->swapped_.size();
 
-    while (d_->soft_ram_limit_ != 0 && d_->unpinned_blocks_.size() &&
+    if (d_->soft_ram_limit_ != 0)
+        d_->IntReleaseCachedBlocks();
+
+    while (d_->soft_ram_limit_ != 0 && d_->unpinned_blocks_->size() &&
            d_->total_ram_bytes_ + d_->requested_bytes_ + size > d_->hard_ram_limit_ + d_->writing_bytes_)
     {
         // evict blocks: schedule async writing which increases writing_bytes_.
-        d_->IntEvictBlockLRU();
+        d_->IntEvictVictim(lock);
     }
 }
 void BlockPool::ReleaseInternalMemory(size_t size) {
@@ -1146,11 +1436,56 @@ void BlockPool::EvictBlock(ByteBlock* block_ptr) {
 
     die_unless(block_ptr->in_memory());
 
-    die_unless(d_->unpinned_blocks_.exists(block_ptr));
-    d_->unpinned_blocks_.erase(block_ptr);
+    die_unless(d_->unpinned_blocks_->exists(block_ptr));
+    d_->unpinned_blocks_->erase(block_ptr);
+    d_->unpinned_bytes_ -= block_ptr->size();
+
+    d_->IntEvictBlock(lock, block_ptr);
+}
+
+bool BlockPool::SpillBlock(ByteBlock* block_ptr) {
+    std::unique_lock<std::mutex> lock(mutex_);
+
+    if (d_->soft_ram_limit_ == 0 ||
+        d_->total_ram_bytes_ + d_->requested_bytes_ <=
+        d_->soft_ram_limit_ + d_->writing_bytes_)
+        return false;
+
+    if (!block_ptr->in_memory() ||
+        !d_->unpinned_blocks_->exists(block_ptr))
+        return false;
+
+    d_->unpinned_blocks_->erase(block_ptr);
     d_->unpinned_bytes_ -= block_ptr->size();
 
-    d_->IntEvictBlock(block_ptr);
+    d_->IntEvictBlock(lock, block_ptr);
+    return true;
+}
+
+size_t BlockPool::compress_raw_bytes() noexcept {
+    std::unique_lock<std::mutex> lock(mutex_);
+    return d_->compress_raw_bytes_;
+}
+
+size_t BlockPool::compress_bytes() noexcept {
+    std::unique_lock<std::mutex> lock(mutex_);
+    return d_->compress_bytes_;
+}
+
+EvictionPolicyType BlockPool::eviction_policy() const {
+    return d_->eviction_policy_;
+}
+
+void BlockPool::HintBlock(ByteBlock* block_ptr, EvictionHint hint) {
+    if (d_->eviction_policy_ != EvictionPolicyType::Hint) return;
+    if (block_ptr->eviction_hint() == hint) return;
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    block_ptr->set_eviction_hint(hint);
+
+    if (!d_->unpinned_blocks_->exists(block_ptr)) return;
+    d_->unpinned_blocks_->erase(block_ptr);
+    d_->unpinned_blocks_->put(block_ptr, hint);
 }
 
 io::RequestPtr BlockPool::GetAnyWriting() {
@@ -1159,23 +1494,25 @@ io::RequestPtr BlockPool::GetAnyWriting() {
     return d_->writing_.begin()->second;
 }
 
-io::RequestPtr BlockPool::EvictBlockLRU() {
+io::RequestPtr BlockPool::EvictVictim() {
     std::unique_lock<std::mutex> lock(mutex_);
-    return d_->IntEvictBlockLRU();
+    return d_->IntEvictVictim(lock);
 }
 
-io::RequestPtr BlockPool::Data::IntEvictBlockLRU() {
+io::RequestPtr BlockPool::Data::IntEvictVictim(
+    std::unique_lock<std::mutex>& lock) {
 
-    if (!unpinned_blocks_.size()) return io::RequestPtr();
+    if (!unpinned_blocks_->size()) return io::RequestPtr();
 
-    ByteBlock* block_ptr = unpinned_blocks_.pop();
+    ByteBlock* block_ptr = unpinned_blocks_->pop();
     die_unless(block_ptr);
     unpinned_bytes_ -= block_ptr->size();
 
-    return IntEvictBlock(block_ptr);
+    return IntEvictBlock(lock, block_ptr);
 }
 
-io::RequestPtr BlockPool::Data::IntEvictBlock(ByteBlock* block_ptr) {
+io::RequestPtr BlockPool::Data::IntEvictBlock(
+    std::unique_lock<std::mutex>& lock, ByteBlock* block_ptr) {
 
     // die_unless(block_ptr->block_pool_ == this);
 
@@ -1196,20 +1533,30 @@ io::RequestPtr BlockPool::Data::IntEvictBlock(ByteBlock* block_ptr) {
 
     die_unless(block_ptr->em_bid_.storage == nullptr);
 
+    // count the block as being written already during compression, such that
+    // eviction loops make progress while the mutex is unlocked.
+    writing_bytes_ += block_ptr->size();
+
+    Byte* write_data = block_ptr->data_;
+    size_t write_size =
+        swap_compression_ ? IntCompressBlock(lock, block_ptr) : 0;
+    if (write_size != 0)
+        write_data = compress_buffers_[block_ptr].first;
+    else
+        write_size = block_ptr->size();
+
     // allocate EM block
-    block_ptr->em_bid_.size = block_ptr->size();
+    block_ptr->em_bid_.size = write_size;
     bm_->new_block(io::FullyRandom(), block_ptr->em_bid_);
 
     LOGC(debug_em)
         << "EvictBlock(): " << block_ptr << " - " << *block_ptr
         << " to em_bid " << block_ptr->em_bid_;
 
-    writing_bytes_ += block_ptr->size();
-
     // initiate writing to EM.
     io::RequestPtr req =
         block_ptr->em_bid_.storage->awrite(
-            block_ptr->data_, block_ptr->em_bid_.offset, block_ptr->size(),
+            write_data, block_ptr->em_bid_.offset, write_size,
             // construct an immediate CompletionHandler callback
             io::CompletionHandler::make<
                 ByteBlock, & ByteBlock::OnWriteComplete>(block_ptr));
@@ -1217,6 +1564,66 @@ io::RequestPtr BlockPool::Data::IntEvictBlock(ByteBlock* block_ptr) {
     return (writing_[block_ptr] = std::move(req));
 }
 
+size_t BlockPool::Data::IntCompressBlock(
+    std::unique_lock<std::mutex>& lock, ByteBlock* block_ptr) {
+    // the compressed data must save at least one aligned unit of I/O,
+    // otherwise the raw block is written.
+    size_t capacity =
+        block_ptr->size() / THRILL_DEFAULT_ALIGN * THRILL_DEFAULT_ALIGN;
+    if (capacity <= THRILL_DEFAULT_ALIGN) return 0;
+    capacity -= THRILL_DEFAULT_ALIGN;
+
+    // the buffer is freed once the block is written, like the block's memory.
+    total_ram_bytes_ += capacity;
+    writing_bytes_ += capacity;
+
+    // the block is neither unpinned nor writing, PinBlock() and DestroyBlock()
+    // wait until it was compressed.
+    compressing_.insert(block_ptr);
+    lock.unlock();
+
+    Byte* buffer = aligned_alloc_.allocate(capacity);
+    size_t size = BlockCodec::Compress(
+        block_ptr->data_, block_ptr->size(), buffer, capacity);
+
+    lock.lock();
+    compressing_.erase(block_ptr);
+    cv_memory_change_.notify_all();
+
+    compress_buffers_[block_ptr] = std::make_pair(buffer, capacity);
+
+    if (size == 0) {
+        IntReleaseCompressBuffer(block_ptr);
+        ++compress_skipped_;
+        return 0;
+    }
+
+    block_ptr->em_compressed_ = true;
+
+    size = common::IntegerDivRoundUp(size, size_t(THRILL_DEFAULT_ALIGN))
+           * THRILL_DEFAULT_ALIGN;
+    compress_raw_bytes_ += block_ptr->size();
+    compress_bytes_ += size;
+    return size;
+}
+
+void BlockPool::Data::IntReleaseCompressBuffer(ByteBlock* block_ptr) {
+    auto it = compress_buffers_.find(block_ptr);
+    if (it == compress_buffers_.end()) return;
+    size_t capacity = it->second.second;
+    aligned_alloc_.deallocate(it->second.first, capacity);
+    compress_buffers_.erase(it);
+
+    writing_bytes_ -= capacity;
+    IntReleaseInternalMemory(capacity);
+}
+
+void BlockPool::Data::IntWaitCompressing(
+    std::unique_lock<std::mutex>& lock, ByteBlock* block_ptr) {
+    while (compressing_.count(block_ptr))
+        cv_memory_change_.wait(lock);
+}
+
 void BlockPool::OnWriteComplete(
     ByteBlock* block_ptr, io::Request* req, bool success) {
     std::unique_lock<std::mutex> lock(mutex_);
@@ -1229,18 +1636,20 @@ void BlockPool::OnWriteComplete(
     die_unless(!block_ptr->ext_file_);
     die_unequal(d_->writing_.erase(block_ptr), 1u);
     d_->writing_bytes_ -= block_ptr->size();
+    d_->IntReleaseCompressBuffer(block_ptr);
 
     if (!success)
     {
         // request was canceled. this is not an I/O error, but intentional,
         // e.g. because the block was deleted.
 
-        die_unless(!d_->unpinned_blocks_.exists(block_ptr));
-        d_->unpinned_blocks_.put(block_ptr);
+        die_unless(!d_->unpinned_blocks_->exists(block_ptr));
+        d_->unpinned_blocks_->put(block_ptr, block_ptr->eviction_hint());
         d_->unpinned_bytes_ += block_ptr->size();
 
         d_->bm_->delete_block(block_ptr->em_bid_);
         block_ptr->em_bid_ = io::BID<0>();
+        block_ptr->em_compressed_ = false;
     }
     else    // success
     {
@@ -1286,7 +1695,7 @@ void BlockPool::RunTask(const std::chrono::steady_clock::time_point& tp) {
             << (unpinned_bytes + pinned_bytes + writing_bytes + reading_bytes)
             << "pinned_blocks" << d_->pin_count_.total_pins_
             << "pinned_bytes" << pinned_bytes
-            << "unpinned_blocks" << d_->unpinned_blocks_.size()
+            << "unpinned_blocks" << d_->unpinned_blocks_->size()
             << "unpinned_bytes" << unpinned_bytes
             << "swapped_blocks" << d_->swapped_.size()
             << "swapped_bytes" << d_->swapped_bytes_.hmax_update()
@@ -1306,6 +1715,9 @@ void BlockPool::RunTask(const std::chrono::steady_clock::time_point& tp) {
             << "wr_ops" << stp.write_ops()
             << "wr_bytes" << stp.write_volume()
             << "wr_speed" << static_cast<double>(stp.write_volume()) / elapsed
+            << "compress_raw_bytes" << d_->compress_raw_bytes_
+            << "compress_bytes" << d_->compress_bytes_
+            << "compress_skipped" << d_->compress_skipped_
             << "disk_allocation" << d_->bm_->current_allocation();
 }
 
@@ -16,6 +16,7 @@
 #include <thrill/common/profile_task.hpp>
 #include <thrill/data/block.hpp>
 #include <thrill/data/byte_block.hpp>
+#include <thrill/data/eviction_policy.hpp>
 #include <thrill/io/block_manager.hpp>
 #include <thrill/io/request.hpp>
 #include <thrill/mem/manager.hpp>
@@ -36,6 +37,14 @@ namespace data {
 /*!
  * Pool to allocate, keep, swap out/in, and free all ByteBlocks on the host.
  * Starts a backgroud thread which is responsible for disk I/O
+ *
+ * The common operations do not lock the BlockPool's mutex: pin count changes
+ * of a ByteBlock which do not reach or leave zero are done with atomic
+ * operations, and each local worker has a small cache of free ByteBlocks of
+ * default_block_size. A destroyed ByteBlock is recycled into the cache of the
+ * worker which allocated it, hence its memory stays on that worker's NUMA node
+ * due to the first-touch policy. Cached ByteBlocks remain accounted as pinned
+ * by their worker, and are released when memory becomes scarce.
  */
 class BlockPool : public common::ProfileTask
 {
@@ -68,10 +77,18 @@ public:
      * allocated. the BlockPool will create a child manager.
      *
      * \param workers_per_host number of workers on this host.
+     *
+     * \param eviction_policy replacement policy which selects the unpinned
+     * Block to swap out next.
+     *
+     * \param swap_compression compress Blocks with the BlockCodec before
+     * writing them to external memory.
      */
     BlockPool(size_t soft_ram_limit, size_t hard_ram_limit,
               common::JsonLogger* logger,
-              mem::Manager* mem_manager, size_t workers_per_host);
+              mem::Manager* mem_manager, size_t workers_per_host,
+              EvictionPolicyType eviction_policy = EvictionPolicyType::LRU,
+              bool swap_compression = false);
 
     //! Checks that all blocks were freed
     ~BlockPool();
@@ -100,9 +117,10 @@ public:
     //! Return any currently being written block (for waiting on completion)
     io::RequestPtr GetAnyWriting();
 
-    //! Evict a Block from the LRU chain into external memory. This can return
-    //! nullptr if no blocks available, or if the Block was not dirty.
-    io::RequestPtr EvictBlockLRU();
+    //! Evict the Block selected by the replacement policy into external
+    //! memory. This can return nullptr if no blocks available, or if the Block
+    //! was not dirty.
+    io::RequestPtr EvictVictim();
 
     //! Allocates a byte block with the request size. May block this thread if
     //! the hard memory limit is reached, until memory is freed by another
@@ -121,13 +139,32 @@ public:
     //! Decrement a ByteBlock's pin count and possibly unpin it.
     void DecBlockPinCount(ByteBlock* block_ptr, size_t local_worker_id);
 
-    //! Destroys the block. Called by ByteBlockPtr's deleter.
-    void DestroyBlock(ByteBlock* block_ptr);
+    //! Destroys the block. Called by ByteBlockPtr's deleter. Returns true if
+    //! the ByteBlock object was kept for recycling and must not be deleted.
+    bool DestroyBlock(ByteBlock* block_ptr);
+
+    //! Release all ByteBlocks in the workers' caches, returns number of bytes
+    //! freed.
+    size_t ReleaseCachedBlocks();
 
     //! Evict a block into external memory. The block must be unpinned and not
     //! swapped.
     void EvictBlock(ByteBlock* block_ptr);
 
+    //! Evict a block into external memory if the BlockPool's RAM usage exceeds
+    //! the soft limit. Unlike EvictBlock() the block may be pinned, swapped or
+    //! being written already, in which case nothing happens. Returns true if
+    //! the block is being written.
+    bool SpillBlock(ByteBlock* block_ptr);
+
+    //! return the replacement policy for unpinned blocks
+    EvictionPolicyType eviction_policy() const;
+
+    //! Attach an eviction hint to a ByteBlock. If the block is unpinned, it is
+    //! reordered immediately, otherwise the hint is considered when it is
+    //! unpinned. Only EvictionPolicyType::Hint regards hints.
+    void HintBlock(ByteBlock* block_ptr, EvictionHint hint);
+
     //! \name Block Statistics
     //! \{
 
@@ -158,6 +195,12 @@ public:
     //! Total number of blocks currently begin read from EM.
     size_t reading_blocks() noexcept;
 
+    //! Total number of bytes of blocks compressed before writing to EM
+    size_t compress_raw_bytes() noexcept;
+
+    //! Total number of bytes written to EM for compressed blocks
+    size_t compress_bytes() noexcept;
+
     //! \}
 
     //! \name Methods for ProfileTask
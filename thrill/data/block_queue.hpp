@@ -54,6 +54,8 @@ public:
 
     using CloseCallback = common::Delegate<void(BlockQueue&)>;
 
+    using PopCallback = common::Delegate<void()>;
+
     //! Constructor from BlockPool
     BlockQueue(BlockPool& block_pool, size_t local_worker_id,
                size_t dia_id,
@@ -93,6 +95,7 @@ public:
         Block b;
         queue_.pop(b);
         read_closed_ = !b.IsValid();
+        if (!read_closed_ && pop_callback_) pop_callback_();
         return b;
     }
 
@@ -107,6 +110,11 @@ public:
         close_callback_ = cb;
     }
 
+    //! set the callback issued when a reader takes a Block from the Queue
+    void set_pop_callback(const PopCallback& cb) {
+        pop_callback_ = cb;
+    }
+
     //! check if writer side Close() was called.
     bool write_closed() const { return write_closed_; }
 
@@ -172,6 +180,10 @@ private:
     //! stats
     CloseCallback close_callback_;
 
+    //! callback to issue when a reader takes a Block -- for granting stream
+    //! credits
+    PopCallback pop_callback_;
+
     //! opaque pointer to the source (used by close_callback_ if needed).
     void* source_ = nullptr;
 
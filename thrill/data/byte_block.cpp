@@ -43,9 +43,10 @@ void ByteBlock::Deleter::operator () (ByteBlock* bb) const {
     assert(bb->total_pins_ == 0);
     assert(bb->reference_count() == 0);
 
-    // call BlockPool's DestroyBlock() to de-register ByteBlock and free data
+    // call BlockPool's DestroyBlock() to de-register ByteBlock and free data,
+    // unless the BlockPool keeps the ByteBlock for recycling.
     assert(bb->block_pool_);
-    bb->block_pool_->DestroyBlock(bb);
+    if (bb->block_pool_->DestroyBlock(bb)) return;
 
     sLOG << "ByteBlock[ " << bb << "]::destroy()";
     mem::GPool().destroy(bb);
@@ -56,7 +57,14 @@ void ByteBlock::Deleter::operator () (const ByteBlock* bb) const {
 }
 
 std::string ByteBlock::pin_count_str() const {
-    return "[" + common::Join(",", pin_count_) + "]";
+    std::ostringstream oss;
+    oss << '[';
+    for (size_t i = 0; i < pin_count_.size(); ++i) {
+        if (i != 0) oss << ',';
+        oss << pin_count_[i].load();
+    }
+    oss << ']';
+    return oss.str();
 }
 
 void ByteBlock::IncPinCount(size_t local_worker_id) {
@@ -75,7 +83,7 @@ std::ostream& operator << (std::ostream& os, const ByteBlock& b) {
     os << "[ByteBlock" << " " << &b
        << " size_=" << b.size_
        << " block_pool_=" << b.block_pool_
-       << " total_pins_=" << b.total_pins_
+       << " total_pins_=" << b.total_pins_.load()
        << " ext_file_=" << b.ext_file_;
     return os << "]";
 }
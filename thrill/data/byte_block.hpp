@@ -13,10 +13,12 @@
 #define THRILL_DATA_BYTE_BLOCK_HEADER
 
 #include <thrill/common/counting_ptr.hpp>
+#include <thrill/data/eviction_policy.hpp>
 #include <thrill/io/bid.hpp>
 #include <thrill/io/file_base.hpp>
 #include <thrill/mem/pool.hpp>
 
+#include <atomic>
 #include <string>
 #include <vector>
 
@@ -87,7 +89,7 @@ public:
 
     //! return current pin count
     size_t pin_count(size_t local_worker_id) const {
-        return pin_count_[local_worker_id];
+        return pin_count_[local_worker_id].load(std::memory_order_relaxed);
     }
 
     //! return string list of pin_counts
@@ -98,6 +100,17 @@ public:
         return data_ != nullptr;
     }
 
+    //! return the eviction hint attached by the data layer
+    EvictionHint eviction_hint() const {
+        return eviction_hint_.load(std::memory_order_relaxed);
+    }
+
+    //! attach an eviction hint, which is considered when the ByteBlock is
+    //! unpinned next. Use BlockPool::HintBlock() for unpinned ByteBlocks.
+    void set_eviction_hint(EvictionHint hint) {
+        eviction_hint_.store(hint, std::memory_order_relaxed);
+    }
+
     //! increment pin count, must be >= 1 before.
     void IncPinCount(size_t local_worker_id);
 
@@ -115,17 +128,29 @@ private:
     //! reference to BlockPool for deletion.
     BlockPool* block_pool_;
 
-    //! counts the number of pins in this block per thread_id.
-    std::vector<size_t, mem::GPoolAllocator<size_t> > pin_count_;
+    //! counts the number of pins in this block per thread_id. Changes which do
+    //! not reach or leave zero are done without locking the BlockPool.
+    std::vector<std::atomic<size_t>,
+                mem::GPoolAllocator<std::atomic<size_t> > > pin_count_;
 
     //! counts the total number of pins, the data_ may be swapped out when this
     //! reaches zero.
-    size_t total_pins_ = 0;
+    std::atomic<size_t> total_pins_ { 0 };
+
+    //! local worker which allocated the ByteBlock, its memory is recycled into
+    //! that worker's cache of free ByteBlocks.
+    size_t home_worker_id_ = 0;
+
+    //! hint about the future use for EvictionPolicyType::Hint
+    std::atomic<EvictionHint> eviction_hint_ { EvictionHint::None };
 
     //! external memory block, which contains a pointer to io::FileBase, an
     //! offset into the file, and (unfortunately) also the size.
     io::BID<0> em_bid_;
 
+    //! whether the data in em_bid_ is compressed by the BlockCodec
+    bool em_compressed_ = false;
+
     //! shared pointer to external file, if this is != nullptr then the Block
     //! was created for directly reading binary files.
     io::FileBasePtr ext_file_;
@@ -88,9 +88,15 @@ CatStream::CatStream(Multiplexer& multiplexer, const StreamId& id,
                     my_host_rank(), local_worker_id,
                     host, worker);
 
-                // construct inbound BlockQueue
+                // construct inbound BlockQueue, which grants credits when the
+                // reader consumes Blocks
+                size_t from = host * workers_per_host() + worker;
                 queues_.emplace_back(
                     multiplexer_.block_pool_, local_worker_id, dia_id);
+                queues_.back().set_pop_callback(
+                    [this, from]() {
+                        OnCreditConsumed(MagicByte::CatStreamCredit, from);
+                    });
             }
         }
     }
@@ -258,12 +264,15 @@ void CatStream::OnStreamBlock(size_t from, PinnedBlock&& b) {
              << common::Hexdump(b.ToString());
     }
 
-    queues_[from].AppendPinnedBlock(std::move(b), /* is_last_block */ false);
+    queues_[from].AppendBlock(
+        OnCreditBlock(MagicByte::CatStreamCredit, from, std::move(b)),
+        /* is_last_block */ false);
 }
 
 void CatStream::OnCloseStream(size_t from) {
     assert(from < queues_.size());
     queues_[from].Close();
+    OnCreditClose(from);
 
     rx_net_blocks_++;
 
@@ -277,6 +286,11 @@ void CatStream::OnCloseStream(size_t from) {
     sem_closing_blocks_.signal();
 }
 
+void CatStream::OnStreamCredit(size_t from, size_t credits) {
+    assert(from < sinks_.size());
+    sinks_[from].OnCredit(credits);
+}
+
 BlockQueue* CatStream::loopback_queue(size_t from_worker_id) {
     assert(from_worker_id < workers_per_host());
     size_t global_worker_rank = workers_per_host() * my_host_rank() + from_worker_id;
@@ -131,6 +131,10 @@ private:
     //! received.
     void OnCloseStream(size_t from);
 
+    //! called from Multiplexer when a worker granted credits to our
+    //! StreamSink for it.
+    void OnStreamCredit(size_t from, size_t credits);
+
     //! Returns the loopback queue for the worker of this stream.
     BlockQueue * loopback_queue(size_t from_worker_id);
 };
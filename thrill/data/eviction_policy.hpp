@@ -0,0 +1,347 @@
+/*******************************************************************************
+ * thrill/data/eviction_policy.hpp
+ *
+ * Replacement policies which select the unpinned ByteBlock that the BlockPool
+ * evicts into external memory next.
+ *
+ * Part of Project Thrill - http://project-thrill.org
+ *
+ * All rights reserved. Published under the BSD-2 license in the LICENSE file.
+ ******************************************************************************/
+
+#pragma once
+#ifndef THRILL_DATA_EVICTION_POLICY_HEADER
+#define THRILL_DATA_EVICTION_POLICY_HEADER
+
+#include <thrill/common/die.hpp>
+#include <thrill/common/lru_cache.hpp>
+
+#include <cassert>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace thrill {
+namespace data {
+
+//! \addtogroup data_layer
+//! \{
+
+//! Replacement policies for unpinned ByteBlocks in the BlockPool.
+enum class EvictionPolicyType {
+    //! evict the least recently unpinned Block (default)
+    LRU,
+    //! evict the most recently unpinned Block, best for cyclic scans of Files
+    //! larger than RAM.
+    MRU,
+    //! second-chance approximation of LRU with a reference bit per Block.
+    CLOCK,
+    //! LRU amended by EvictionHint marks set by the data layer.
+    Hint
+};
+
+//! Parse name of an EvictionPolicyType (lru, mru, clock, or hint). Returns
+//! false if the name is unknown.
+static inline
+bool ParseEvictionPolicy(const std::string& name, EvictionPolicyType& out) {
+    if (name == "lru" || name == "LRU")
+        out = EvictionPolicyType::LRU;
+    else if (name == "mru" || name == "MRU")
+        out = EvictionPolicyType::MRU;
+    else if (name == "clock" || name == "CLOCK")
+        out = EvictionPolicyType::CLOCK;
+    else if (name == "hint" || name == "Hint")
+        out = EvictionPolicyType::Hint;
+    else
+        return false;
+    return true;
+}
+
+//! Return name of an EvictionPolicyType.
+static inline
+const char * EvictionPolicyName(EvictionPolicyType type) {
+    switch (type) {
+    case EvictionPolicyType::LRU:
+        return "lru";
+    case EvictionPolicyType::MRU:
+        return "mru";
+    case EvictionPolicyType::CLOCK:
+        return "clock";
+    case EvictionPolicyType::Hint:
+        return "hint";
+    }
+    return "unknown";
+}
+
+//! Hints about the future use of a Block, which the data layer attaches to
+//! ByteBlocks. They are considered only by EvictionPolicyType::Hint.
+enum class EvictionHint : uint8_t {
+    //! no information, use LRU order.
+    None,
+    //! Block will be read again soon: evict it only if nothing else remains.
+    ConsumedNext,
+    //! Block will not be read again soon or will be deleted: evict it first,
+    //! most recently marked Blocks before older ones.
+    DeadSoon
+};
+
+/*!
+ * Abstract set of unpinned Keys (ByteBlock pointers in the BlockPool) from
+ * which pop() extracts the next victim for eviction. Like LruCacheSet, the
+ * policy does not limit its size, the BlockPool calls pop() when it needs to
+ * free memory.
+ */
+template <typename Key, typename Alloc = std::allocator<Key> >
+class EvictionPolicy
+{
+public:
+    virtual ~EvictionPolicy() { }
+
+    //! insert an unpinned key with the given hint, key must not exist.
+    virtual void put(const Key& key, EvictionHint hint) = 0;
+
+    //! remove key from the set, key must exist.
+    virtual void erase(const Key& key) = 0;
+
+    //! remove key from the set because it was pinned again, key must
+    //! exist. Policies may remember the reference until it is put() back.
+    virtual void pin(const Key& key) { erase(key); }
+
+    //! test if key exists in the set
+    virtual bool exists(const Key& key) const = 0;
+
+    //! return number of keys in the set
+    virtual size_t size() const = 0;
+
+    //! remove and return the next victim, the set must not be empty.
+    virtual Key pop() = 0;
+};
+
+//! Evicts the least recently unpinned key.
+template <typename Key, typename Alloc = std::allocator<Key> >
+class LruEvictionPolicy : public EvictionPolicy<Key, Alloc>
+{
+public:
+    explicit LruEvictionPolicy(const Alloc& alloc = Alloc())
+        : lru_(alloc) { }
+
+    void put(const Key& key, EvictionHint /* hint */) final {
+        lru_.put(key);
+    }
+    void erase(const Key& key) final { lru_.erase(key); }
+    bool exists(const Key& key) const final { return lru_.exists(key); }
+    size_t size() const final { return lru_.size(); }
+    Key pop() final { return lru_.pop(); }
+
+private:
+    common::LruCacheSet<Key, Alloc> lru_;
+};
+
+//! Evicts the most recently unpinned key.
+template <typename Key, typename Alloc = std::allocator<Key> >
+class MruEvictionPolicy : public EvictionPolicy<Key, Alloc>
+{
+public:
+    explicit MruEvictionPolicy(const Alloc& alloc = Alloc())
+        : lru_(alloc) { }
+
+    void put(const Key& key, EvictionHint /* hint */) final {
+        lru_.put(key);
+    }
+    void erase(const Key& key) final { lru_.erase(key); }
+    bool exists(const Key& key) const final { return lru_.exists(key); }
+    size_t size() const final { return lru_.size(); }
+    Key pop() final { return lru_.pop_front(); }
+
+private:
+    common::LruCacheSet<Key, Alloc> lru_;
+};
+
+/*!
+ * CLOCK (second-chance) policy: keys are kept in a circular array of slots
+ * with a reference bit. A pinned key keeps its slot, and its reference bit is
+ * set when it is put() back, while new keys start without it. pop() advances
+ * the clock hand, clears set reference bits, and evicts the first key without
+ * one.
+ */
+template <typename Key, typename Alloc = std::allocator<Key> >
+class ClockEvictionPolicy : public EvictionPolicy<Key, Alloc>
+{
+public:
+    explicit ClockEvictionPolicy(const Alloc& alloc = Alloc())
+        : slots_(SlotAlloc(alloc)), free_(SizeAlloc(alloc)),
+          map_(MapAlloc(alloc)) { }
+
+    void put(const Key& key, EvictionHint /* hint */) final {
+        assert(!exists(key));
+        typename Map::iterator it = map_.find(key);
+        if (it != map_.end()) {
+            // re-reference of a pinned key
+            Slot& s = slots_[it->second];
+            s.used = s.referenced = true;
+            ++size_;
+            return;
+        }
+        size_t index;
+        if (!free_.empty()) {
+            index = free_.back();
+            free_.pop_back();
+        }
+        else {
+            index = slots_.size();
+            slots_.emplace_back();
+        }
+        slots_[index] = Slot { key, true, false };
+        map_[key] = index;
+        ++size_;
+    }
+
+    void erase(const Key& key) final {
+        typename Map::iterator it = map_.find(key);
+        assert(it != map_.end() && slots_[it->second].used);
+        slots_[it->second].used = false;
+        free_.push_back(it->second);
+        map_.erase(it);
+        --size_;
+    }
+
+    void pin(const Key& key) final {
+        typename Map::iterator it = map_.find(key);
+        assert(it != map_.end() && slots_[it->second].used);
+        slots_[it->second].used = false;
+        --size_;
+    }
+
+    bool exists(const Key& key) const final {
+        typename Map::const_iterator it = map_.find(key);
+        return it != map_.end() && slots_[it->second].used;
+    }
+
+    size_t size() const final { return size_; }
+
+    Key pop() final {
+        assert(size());
+        // terminates after at most two rounds, as the first clears all bits.
+        while (true) {
+            if (hand_ >= slots_.size()) hand_ = 0;
+            Slot& s = slots_[hand_++];
+            if (!s.used) continue;
+            if (s.referenced) {
+                s.referenced = false;
+                continue;
+            }
+            Key out = s.key;
+            erase(out);
+            return out;
+        }
+    }
+
+private:
+    struct Slot {
+        Key  key;
+        //! whether the key is unpinned, pinned keys keep their slot
+        bool used;
+        bool referenced;
+    };
+
+    using SlotAlloc = typename Alloc::template rebind<Slot>::other;
+    using SizeAlloc = typename Alloc::template rebind<size_t>::other;
+    using Map = std::unordered_map<
+              Key, size_t, std::hash<Key>, std::equal_to<Key>,
+              typename Alloc::template rebind<
+                  std::pair<const Key, size_t> >::other>;
+    using MapAlloc = typename Map::allocator_type;
+
+    //! circular array of slots
+    std::vector<Slot, SlotAlloc> slots_;
+    //! indexes of free slots
+    std::vector<size_t, SizeAlloc> free_;
+    //! map from unpinned and pinned keys to slot index
+    Map map_;
+    //! number of unpinned keys
+    size_t size_ = 0;
+    //! clock hand, next slot to inspect
+    size_t hand_ = 0;
+};
+
+/*!
+ * Uses the EvictionHint marks: keys marked DeadSoon are evicted first, most
+ * recently marked first, then unmarked keys in LRU order, and keys marked
+ * ConsumedNext last, also in LRU order.
+ */
+template <typename Key, typename Alloc = std::allocator<Key> >
+class HintEvictionPolicy : public EvictionPolicy<Key, Alloc>
+{
+public:
+    explicit HintEvictionPolicy(const Alloc& alloc = Alloc())
+        : dead_(alloc), lru_(alloc), next_(alloc) { }
+
+    void put(const Key& key, EvictionHint hint) final {
+        if (hint == EvictionHint::DeadSoon)
+            dead_.put(key);
+        else if (hint == EvictionHint::ConsumedNext)
+            next_.put(key);
+        else
+            lru_.put(key);
+    }
+
+    void erase(const Key& key) final {
+        if (dead_.exists(key))
+            dead_.erase(key);
+        else if (next_.exists(key))
+            next_.erase(key);
+        else
+            lru_.erase(key);
+    }
+
+    bool exists(const Key& key) const final {
+        return lru_.exists(key) || dead_.exists(key) || next_.exists(key);
+    }
+
+    size_t size() const final {
+        return dead_.size() + lru_.size() + next_.size();
+    }
+
+    Key pop() final {
+        if (dead_.size()) return dead_.pop_front();
+        if (lru_.size()) return lru_.pop();
+        return next_.pop();
+    }
+
+private:
+    //! keys marked DeadSoon
+    common::LruCacheSet<Key, Alloc> dead_;
+    //! unmarked keys
+    common::LruCacheSet<Key, Alloc> lru_;
+    //! keys marked ConsumedNext
+    common::LruCacheSet<Key, Alloc> next_;
+};
+
+//! Construct an EvictionPolicy of the given type.
+template <typename Key, typename Alloc = std::allocator<Key> >
+std::unique_ptr<EvictionPolicy<Key, Alloc> >
+MakeEvictionPolicy(EvictionPolicyType type, const Alloc& alloc = Alloc()) {
+    switch (type) {
+    case EvictionPolicyType::LRU:
+        return std::make_unique<LruEvictionPolicy<Key, Alloc> >(alloc);
+    case EvictionPolicyType::MRU:
+        return std::make_unique<MruEvictionPolicy<Key, Alloc> >(alloc);
+    case EvictionPolicyType::CLOCK:
+        return std::make_unique<ClockEvictionPolicy<Key, Alloc> >(alloc);
+    case EvictionPolicyType::Hint:
+        return std::make_unique<HintEvictionPolicy<Key, Alloc> >(alloc);
+    }
+    die("Unknown EvictionPolicyType");
+}
+
+//! \}
+
+} // namespace data
+} // namespace thrill
+
+#endif // !THRILL_DATA_EVICTION_POLICY_HEADER
+
+/******************************************************************************/
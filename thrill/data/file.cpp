@@ -10,6 +10,7 @@
 
 #include <thrill/data/file.hpp>
 
+#include <algorithm>
 #include <deque>
 #include <string>
 
@@ -82,6 +83,12 @@ File::Reader File::GetReader(bool consume, size_t num_prefetch) {
             *this, local_worker_id_, num_prefetch);
 }
 
+void File::HintBlocks(EvictionHint hint, size_t begin, size_t end) {
+    end = std::min(end, blocks_.size());
+    for (size_t i = begin; i < end; ++i)
+        block_pool()->HintBlock(blocks_[i].byte_block().get(), hint);
+}
+
 std::string File::ReadComplete() const {
     std::string output;
     for (const Block& b : blocks_)
@@ -127,6 +134,12 @@ void KeepFileBlockSource::Prefetch(size_t prefetch) {
     }
 }
 
+bool KeepFileBlockSource::FetchBlock() {
+    if (current_block_ >= file_.num_blocks()) return false;
+    fetching_blocks_.emplace_back(NextUnpinnedBlock().Pin(local_worker_id_));
+    return true;
+}
+
 PinnedBlock KeepFileBlockSource::NextBlock() {
 
     if (current_block_ >= file_.num_blocks() && fetching_blocks_.empty())
@@ -134,6 +147,13 @@ PinnedBlock KeepFileBlockSource::NextBlock() {
 
     if (num_prefetch_ == 0)
     {
+        if (!fetching_blocks_.empty()) {
+            // take Block prefetched by a ForecastPrefetcher
+            PinnedBlock b = fetching_blocks_.front()->Wait();
+            fetching_blocks_.pop_front();
+            if (fetch_callback_) fetch_callback_();
+            return b;
+        }
         // operate without prefetching
         return NextUnpinnedBlock().PinWait(local_worker_id_);
     }
@@ -156,6 +176,13 @@ PinnedBlock KeepFileBlockSource::NextBlock() {
 
 //! Determine current unpinned Block to deliver via NextBlock()
 Block KeepFileBlockSource::NextUnpinnedBlock() {
+    // a keeping reader passes each Block once, hence it is not needed again
+    // until the next scan of the File: mark it to be evicted early.
+    if (file_.block_pool()->eviction_policy() == EvictionPolicyType::Hint) {
+        file_.block(current_block_).byte_block()->set_eviction_hint(
+            EvictionHint::DeadSoon);
+    }
+
     if (current_block_ == first_block_) {
         // construct first block differently, in case we want to shorten it.
         Block b = file_.block(current_block_++);
@@ -181,18 +208,16 @@ ConsumeFileBlockSource::ConsumeFileBlockSource(
 ConsumeFileBlockSource::ConsumeFileBlockSource(ConsumeFileBlockSource&& s)
     : file_(s.file_), local_worker_id_(s.local_worker_id_),
       num_prefetch_(s.num_prefetch_),
-      fetching_blocks_(std::move(s.fetching_blocks_)) {
+      fetching_blocks_(std::move(s.fetching_blocks_)),
+      num_fetched_(s.num_fetched_),
+      fetch_callback_(std::move(s.fetch_callback_)) {
     s.file_ = nullptr;
 }
 
 void ConsumeFileBlockSource::Prefetch(size_t prefetch) {
     if (prefetch >= num_prefetch_) {
         num_prefetch_ = prefetch;
-        while (fetching_blocks_.size() < num_prefetch_ && !file_->blocks_.empty()) {
-            fetching_blocks_.emplace_back(
-                file_->blocks_.front().Pin(local_worker_id_));
-            file_->blocks_.pop_front();
-        }
+        while (fetching_blocks_.size() < num_prefetch_ && FetchBlock()) { }
     }
     else if (prefetch < num_prefetch_) {
         num_prefetch_ = prefetch;
@@ -200,24 +225,36 @@ void ConsumeFileBlockSource::Prefetch(size_t prefetch) {
     }
 }
 
+bool ConsumeFileBlockSource::FetchBlock() {
+    if (file_->blocks_.empty()) return false;
+    fetching_blocks_.emplace_back(file_->blocks_.front().Pin(local_worker_id_));
+    file_->blocks_.pop_front();
+    ++num_fetched_;
+    return true;
+}
+
 PinnedBlock ConsumeFileBlockSource::NextBlock() {
     assert(file_);
     if (file_->blocks_.empty() && fetching_blocks_.empty())
         return PinnedBlock();
 
-    // operate without prefetching
     if (num_prefetch_ == 0) {
+        if (!fetching_blocks_.empty()) {
+            // take Block prefetched by a ForecastPrefetcher
+            PinnedBlock b = fetching_blocks_.front()->Wait();
+            fetching_blocks_.pop_front();
+            if (fetch_callback_) fetch_callback_();
+            return b;
+        }
+        // operate without prefetching
         PinRequestPtr f = file_->blocks_.front().Pin(local_worker_id_);
         file_->blocks_.pop_front();
+        ++num_fetched_;
         return f->Wait();
     }
 
     // prefetch #desired blocks
-    while (fetching_blocks_.size() < num_prefetch_ && !file_->blocks_.empty()) {
-        fetching_blocks_.emplace_back(
-            file_->blocks_.front().Pin(local_worker_id_));
-        file_->blocks_.pop_front();
-    }
+    while (fetching_blocks_.size() < num_prefetch_ && FetchBlock()) { }
 
     // this might block if the prefetching is not finished
     PinnedBlock b = fetching_blocks_.front()->Wait();
@@ -12,6 +12,7 @@
 #ifndef THRILL_DATA_FILE_HEADER
 #define THRILL_DATA_FILE_HEADER
 
+#include <thrill/common/delegate.hpp>
 #include <thrill/common/die.hpp>
 #include <thrill/common/function_traits.hpp>
 #include <thrill/common/logger.hpp>
@@ -21,11 +22,14 @@
 #include <thrill/data/block_writer.hpp>
 #include <thrill/data/dyn_block_reader.hpp>
 
+#include <algorithm>
 #include <cassert>
 #include <deque>
 #include <functional>
+#include <iterator>
 #include <limits>
 #include <string>
+#include <utility>
 #include <vector>
 
 namespace thrill {
@@ -246,6 +250,26 @@ public:
     template <typename ItemType>
     std::vector<Block> GetItemRange(size_t begin, size_t end) const;
 
+    /*!
+     * Return the trigger of each Block of a sorted File: a multiway merge
+     * needs Block j+1 as soon as it has output the last item beginning in
+     * Blocks 0..j, which is the trigger of Block j+1. Block 0 is needed at the
+     * start, its trigger is the first item and is ignored by
+     * ForecastSchedule(). Reads one item per Block, hence this should be called
+     * while the Blocks are still in memory.
+     */
+    template <typename ItemType>
+    std::vector<ItemType> GetBlockTriggers() const;
+
+    /*!
+     * Attach an eviction hint to the ByteBlocks [begin,end) of the File, which
+     * is regarded if the BlockPool uses EvictionPolicyType::Hint. For example,
+     * mark a File ConsumedNext if it is read again soon. KeepReaders mark each
+     * Block they pass DeadSoon.
+     */
+    void HintBlocks(EvictionHint hint, size_t begin = 0,
+                    size_t end = std::numeric_limits<size_t>::max());
+
     //! Output the Block objects contained in this File.
     friend std::ostream& operator << (std::ostream& os, const File& f);
 
@@ -307,6 +331,19 @@ public:
     //! Perform prefetch
     void Prefetch(size_t prefetch);
 
+    //! Pin the next unfetched Block into the prefetch queue, used by
+    //! ForecastPrefetcher. Returns false if all Blocks were fetched.
+    bool FetchBlock();
+
+    //! Number of Blocks fetched from the File so far, delivered or queued.
+    size_t num_fetched() const { return current_block_ - first_block_; }
+
+    //! Set callback which is called when NextBlock() takes a Block out of the
+    //! prefetch queue.
+    void set_fetch_callback(const common::Delegate<void()>& cb) {
+        fetch_callback_ = cb;
+    }
+
 protected:
     //! Determine current unpinned Block to deliver via NextBlock()
     Block NextUnpinnedBlock();
@@ -335,6 +372,9 @@ private:
 
     //! offset of first item in first block read
     size_t first_item_;
+
+    //! callback of a ForecastPrefetcher
+    common::Delegate<void()> fetch_callback_;
 };
 
 /*!
@@ -365,6 +405,19 @@ public:
     //! Perform prefetch
     void Prefetch(size_t prefetch);
 
+    //! Pin the next unfetched Block into the prefetch queue, used by
+    //! ForecastPrefetcher. Returns false if all Blocks were fetched.
+    bool FetchBlock();
+
+    //! Number of Blocks fetched from the File so far, delivered or queued.
+    size_t num_fetched() const { return num_fetched_; }
+
+    //! Set callback which is called when NextBlock() takes a Block out of the
+    //! prefetch queue.
+    void set_fetch_callback(const common::Delegate<void()>& cb) {
+        fetch_callback_ = cb;
+    }
+
     //! Get the next block of file.
     PinnedBlock NextBlock();
 
@@ -383,6 +436,12 @@ private:
 
     //! current prefetch operations
     std::deque<PinRequestPtr> fetching_blocks_;
+
+    //! number of Blocks taken from the File
+    size_t num_fetched_ = 0;
+
+    //! callback of a ForecastPrefetcher
+    common::Delegate<void()> fetch_callback_;
 };
 
 //! Get BlockReader seeked to the corresponding item index
@@ -454,6 +513,26 @@ ItemType File::GetItemAt(size_t index) const {
     return reader.Next<ItemType>();
 }
 
+template <typename ItemType>
+std::vector<ItemType> File::GetBlockTriggers() const {
+    std::vector<ItemType> triggers;
+    if (num_items() == 0) return triggers;
+    triggers.reserve(blocks_.size());
+
+    // placeholder for Block 0, which is needed immediately.
+    triggers.emplace_back(GetItemAt<ItemType>(0));
+
+    for (size_t b = 0; b + 1 < blocks_.size(); ++b) {
+        if (blocks_[b].num_items() == 0) {
+            // no item begins in Block b, it only continues an item.
+            triggers.push_back(triggers.back());
+            continue;
+        }
+        triggers.emplace_back(GetItemAt<ItemType>(num_items_sum_[b] - 1));
+    }
+    return triggers;
+}
+
 template <typename ItemType, typename CompareFunction>
 size_t File::GetIndexOf(
     const ItemType& item, size_t tie, size_t left, size_t right,
@@ -513,6 +592,150 @@ void StartPrefetch(std::vector<Reader>& readers, size_t prefetch) {
     }
 }
 
+/*!
+ * Calculate the forecasting prefetch schedule of a multiway merge of sorted
+ * Files from the triggers of their Blocks, see File::GetBlockTriggers(). A
+ * merge needs the first Blocks of all Files immediately, and all further
+ * Blocks in the order of their triggers, hence the schedule is the sequence of
+ * File indexes of all first Blocks followed by those of all other Blocks
+ * sorted by trigger. The j-th occurrence of index f in the schedule stands for
+ * Block j of File f.
+ *
+ * \param triggers_begin iterator to std::vector<ItemType> of triggers of the
+ * first File
+ * \param triggers_end end iterator of triggers of the Files
+ * \param less comparator of the merge
+ */
+template <typename TriggersIterator, typename CompareFunction>
+std::vector<size_t> ForecastSchedule(
+    TriggersIterator triggers_begin, TriggersIterator triggers_end,
+    const CompareFunction& less) {
+
+    using ItemType = typename std::iterator_traits<
+              TriggersIterator>::value_type::value_type;
+
+    std::vector<size_t> schedule;
+
+    // (trigger, File index) of all Blocks but the first ones, which are
+    // scheduled immediately, in File and Block order.
+    std::vector<std::pair<const ItemType*, size_t> > blocks;
+    for (TriggersIterator it = triggers_begin; it != triggers_end; ++it) {
+        if (it->empty()) continue;
+        schedule.push_back(it - triggers_begin);
+        for (auto t = it->begin() + 1; t != it->end(); ++t)
+            blocks.emplace_back(&*t, it - triggers_begin);
+    }
+
+    // stable sort keeps Blocks of a File with equal triggers in order.
+    std::stable_sort(
+        blocks.begin(), blocks.end(),
+        [&less](const std::pair<const ItemType*, size_t>& a,
+                const std::pair<const ItemType*, size_t>& b) {
+            return less(*a.first, *b.first);
+        });
+
+    schedule.reserve(schedule.size() + blocks.size());
+    for (const std::pair<const ItemType*, size_t>& b : blocks)
+        schedule.push_back(b.second);
+    return schedule;
+}
+
+/*!
+ * ForecastPrefetcher issues Block prefetches for a multiway merge of sorted
+ * Files in the order in which the merge will need the Blocks, following a
+ * schedule computed by ForecastSchedule(). This is "forecasting" [Knuth, TAOCP
+ * Vol. 3, 5.4.6] as in STXXL's prefetch sequences: instead of reading ahead a
+ * fixed number of Blocks per File, up to num_prefetch Blocks are in flight in
+ * total, and whenever the merge takes a prefetched Block out of a reader's
+ * queue, the next Block in the schedule is requested. If the forecast misses,
+ * the reader pins the Block on demand, and the schedule entry is skipped.
+ *
+ * The Readers must be ConsumeReaders or KeepReaders created with zero prefetch.
+ * They must not be moved while the ForecastPrefetcher exists. Its destructor
+ * detaches it from the readers, which then deliver the Blocks already
+ * prefetched and pin all others on demand.
+ */
+template <typename Reader>
+class ForecastPrefetcher
+{
+public:
+    ForecastPrefetcher(std::vector<Reader>& readers,
+                       std::vector<size_t>&& schedule, size_t num_prefetch)
+        : readers_(readers), schedule_(std::move(schedule)),
+          scheduled_(readers.size()), num_prefetch_(num_prefetch) {
+        for (Reader& r : readers_) {
+            r.source().set_fetch_callback(
+                common::Delegate<void()>::make<
+                    ForecastPrefetcher, &ForecastPrefetcher::BlockTaken>(this));
+        }
+        Issue();
+    }
+
+    //! non-copyable: delete copy-constructor
+    ForecastPrefetcher(const ForecastPrefetcher&) = delete;
+    //! non-copyable: delete assignment operator
+    ForecastPrefetcher& operator = (const ForecastPrefetcher&) = delete;
+
+    //! detach from the readers, which may outlive the ForecastPrefetcher.
+    ~ForecastPrefetcher() {
+        for (Reader& r : readers_)
+            r.source().set_fetch_callback(common::Delegate<void()>());
+    }
+
+    //! number of Blocks requested from the schedule
+    size_t num_issued() const { return num_issued_; }
+
+    //! number of schedule entries skipped, because the reader already fetched
+    //! the Block on demand
+    size_t num_missed() const { return num_missed_; }
+
+private:
+    //! readers of the merge
+    std::vector<Reader>& readers_;
+
+    //! sequence of reader indexes in which their next Blocks are needed
+    std::vector<size_t> schedule_;
+
+    //! current position in schedule_
+    size_t pos_ = 0;
+
+    //! number of schedule entries processed per reader
+    std::vector<size_t> scheduled_;
+
+    //! maximum number of prefetched Blocks in flight
+    size_t num_prefetch_;
+
+    //! number of prefetched Blocks not yet taken by the readers
+    size_t in_flight_ = 0;
+
+    //! statistics
+    size_t num_issued_ = 0, num_missed_ = 0;
+
+    //! called by a reader's BlockSource when it takes a prefetched Block.
+    void BlockTaken() {
+        assert(in_flight_ > 0);
+        --in_flight_;
+        Issue();
+    }
+
+    //! request the next Blocks in the schedule until num_prefetch are in flight
+    void Issue() {
+        while (in_flight_ < num_prefetch_ && pos_ < schedule_.size()) {
+            size_t f = schedule_[pos_++];
+            size_t block = scheduled_[f]++;
+            auto& source = readers_[f].source();
+            if (source.num_fetched() > block) {
+                ++num_missed_;
+                continue;
+            }
+            if (source.FetchBlock()) {
+                ++in_flight_;
+                ++num_issued_;
+            }
+        }
+    }
+};
+
 //! \}
 
 } // namespace data
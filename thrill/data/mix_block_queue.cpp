@@ -62,6 +62,12 @@ void MixBlockQueue::Close(size_t src) {
     mix_queue_.emplace(SrcBlockPair { src, Block() });
 }
 
+void MixBlockQueue::set_pop_callback(
+    size_t src, const BlockQueue::PopCallback& cb) {
+    assert(src < queues_.size());
+    queues_[src].set_pop_callback(cb);
+}
+
 MixBlockQueue::SrcBlockPair MixBlockQueue::Pop() {
     if (read_open_ == 0)
         return SrcBlockPair {
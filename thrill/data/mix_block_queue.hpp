@@ -101,6 +101,9 @@ public:
     //! append closing sentinel block from src (also delivered via the network).
     void Close(size_t src);
 
+    //! set the callback issued when a reader takes a Block from src.
+    void set_pop_callback(size_t src, const BlockQueue::PopCallback& cb);
+
     //! Blocking retrieval of a (source,block) pair.
     SrcBlockPair Pop();
 
@@ -47,6 +47,13 @@ MixStream::MixStream(Multiplexer& multiplexer, const StreamId& id,
                     id,
                     my_host_rank(), local_worker_id,
                     host, worker);
+
+                // grant credits when the reader consumes Blocks
+                size_t from = host * workers_per_host() + worker;
+                queue_.set_pop_callback(
+                    from, [this, from]() {
+                        OnCreditConsumed(MagicByte::MixStreamCredit, from);
+                    });
             }
         }
     }
@@ -184,12 +191,14 @@ void MixStream::OnStreamBlock(size_t from, PinnedBlock&& b) {
     sLOG0 << "stream" << id_ << "receive from" << from << ":"
           << common::Hexdump(b.ToString());
 
-    queue_.AppendBlock(from, std::move(b).MoveToBlock());
+    queue_.AppendBlock(
+        from, OnCreditBlock(MagicByte::MixStreamCredit, from, std::move(b)));
 }
 
 void MixStream::OnCloseStream(size_t from) {
     assert(from < num_workers());
     queue_.Close(from);
+    OnCreditClose(from);
 
     rx_net_blocks_++;
 
@@ -205,6 +214,11 @@ void MixStream::OnCloseStream(size_t from) {
     sem_closing_blocks_.signal();
 }
 
+void MixStream::OnStreamCredit(size_t from, size_t credits) {
+    assert(from < sinks_.size());
+    sinks_[from].OnCredit(credits);
+}
+
 MixBlockQueueSink* MixStream::loopback_queue(size_t from_worker_id) {
     assert(from_worker_id < workers_per_host());
     assert(from_worker_id < loopback_.size());
@@ -107,6 +107,10 @@ private:
     //! received.
     void OnCloseStream(size_t from);
 
+    //! called from Multiplexer when a worker granted credits to our
+    //! StreamSink for it.
+    void OnStreamCredit(size_t from, size_t credits);
+
     //! Returns the loopback queue for the worker of this stream.
     MixBlockQueueSink * loopback_queue(size_t from_worker_id);
 };
@@ -11,6 +11,7 @@
 
 #include <thrill/data/multiplexer.hpp>
 
+#include <thrill/data/block_codec.hpp>
 #include <thrill/data/cat_stream.hpp>
 #include <thrill/data/mix_stream.hpp>
 #include <thrill/data/multiplexer_header.hpp>
@@ -303,6 +304,32 @@ void Multiplexer::OnMultiplexerHeader(Connection& s, net::Buffer&& buffer) {
                 });
         }
     }
+    else if (header.magic == MagicByte::CatStreamCredit)
+    {
+        sLOG << "credit from" << s << "on CatStream" << id
+             << "from worker" << header.sender_worker
+             << "for local_worker" << local_worker
+             << "credits" << header.credits();
+
+        CatStreamPtr stream = GetOrCreateCatStream(
+            id, local_worker, /* dia_id (unknown at this time) */ 0);
+        stream->OnStreamCredit(header.sender_worker, header.credits());
+
+        AsyncReadMultiplexerHeader(s);
+    }
+    else if (header.magic == MagicByte::MixStreamCredit)
+    {
+        sLOG << "credit from" << s << "on MixStream" << id
+             << "from worker" << header.sender_worker
+             << "for local_worker" << local_worker
+             << "credits" << header.credits();
+
+        MixStreamPtr stream = GetOrCreateMixStream(
+            id, local_worker, /* dia_id (unknown at this time) */ 0);
+        stream->OnStreamCredit(header.sender_worker, header.credits());
+
+        AsyncReadMultiplexerHeader(s);
+    }
     else {
         die("Invalid magic byte in MultiplexerHeader");
     }
@@ -318,10 +345,7 @@ void Multiplexer::OnCatStreamBlock(
          << "from worker" << header.sender_worker;
 
     stream->OnStreamBlock(
-        header.sender_worker,
-        PinnedBlock(std::move(bytes), 0, header.size,
-                    header.first_item, header.num_items,
-                    header.typecode_verify));
+        header.sender_worker, MakeReceivedBlock(header, std::move(bytes)));
 
     if (header.is_last_block)
         stream->OnCloseStream(header.sender_worker);
@@ -339,10 +363,7 @@ void Multiplexer::OnMixStreamBlock(
          << "from worker" << header.sender_worker;
 
     stream->OnStreamBlock(
-        header.sender_worker,
-        PinnedBlock(std::move(bytes), 0, header.size,
-                    header.first_item, header.num_items,
-                    header.typecode_verify));
+        header.sender_worker, MakeReceivedBlock(header, std::move(bytes)));
 
     if (header.is_last_block)
         stream->OnCloseStream(header.sender_worker);
@@ -350,6 +371,32 @@ void Multiplexer::OnMixStreamBlock(
     AsyncReadMultiplexerHeader(s);
 }
 
+PinnedBlock Multiplexer::MakeReceivedBlock(
+    const StreamMultiplexerHeader& header, PinnedByteBlockPtr&& bytes) {
+
+    if (!header.is_compressed) {
+        return PinnedBlock(std::move(bytes), 0, header.size,
+                           header.first_item, header.num_items,
+                           header.typecode_verify);
+    }
+
+    size_t size = BlockCodec::DecompressedSize(bytes->data());
+
+    size_t alloc_size = size;
+    if (alloc_size < THRILL_DEFAULT_ALIGN) alloc_size = THRILL_DEFAULT_ALIGN;
+    alloc_size = common::RoundUpToPowerOfTwo(alloc_size);
+
+    PinnedByteBlockPtr raw = block_pool_.AllocateByteBlock(
+        alloc_size, header.receiver_local_worker);
+
+    die_unless(BlockCodec::Decompress(
+                   bytes->data(), header.size, raw->data(), size));
+
+    return PinnedBlock(std::move(raw), 0, size,
+                       header.first_item, header.num_items,
+                       header.typecode_verify);
+}
+
 BlockQueue* Multiplexer::CatLoopback(
     size_t stream_id, size_t from_worker_id, size_t to_worker_id) {
     std::unique_lock<std::mutex> lock(mutex_);
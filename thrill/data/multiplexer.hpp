@@ -45,7 +45,9 @@ using MixStreamSetPtr = common::CountingPtr<MixStreamSet>;
 class BlockQueue;
 class MixBlockQueueSink;
 
+class Stream;
 class StreamMultiplexerHeader;
+enum class MagicByte : uint8_t;
 
 /*!
  * Multiplexes virtual Connections on Dispatcher.
@@ -167,6 +169,7 @@ private:
     size_t max_active_streams_ = 0;
 
     //! friends for access to network components
+    friend class Stream;
     friend class CatStream;
     friend class MixStream;
     friend class StreamSink;
@@ -213,6 +216,11 @@ private:
     void OnMixStreamBlock(
         Connection& s, const StreamMultiplexerHeader& header,
         const MixStreamPtr& stream, PinnedByteBlockPtr&& bytes);
+
+    //! Construct the PinnedBlock of received bytes, decompresses the payload
+    //! if it was compressed by the sender.
+    PinnedBlock MakeReceivedBlock(
+        const StreamMultiplexerHeader& header, PinnedByteBlockPtr&& bytes);
 };
 
 //! \}
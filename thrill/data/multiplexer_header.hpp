@@ -41,8 +41,10 @@ public:
     MagicByte magic = MagicByte::Invalid;
     uint32_t size = 0;
     uint32_t num_items = 0;
-    // previous two bits are packed with first_item
-    uint32_t first_item : 30;
+    // following three bits are packed with first_item
+    uint32_t first_item : 29;
+    //! payload is compressed by the BlockCodec
+    uint32_t is_compressed : 1;
     //! typecode self verify
     uint32_t typecode_verify : 1;
     //! is last block piggybacked indicator
@@ -55,6 +57,7 @@ public:
           size(static_cast<uint32_t>(b.size())),
           num_items(static_cast<uint32_t>(b.num_items())),
           first_item(static_cast<uint32_t>(b.first_item_relative())),
+          is_compressed(0),
           typecode_verify(b.typecode_verify()) {
         if (!self_verify)
             assert(!typecode_verify);
@@ -76,6 +79,10 @@ static_assert(sizeof(MultiplexerHeader) == MultiplexerHeader::header_size,
  *
  * Provides a serializer and two partial deserializers. A
  * StreamMultiplexerHeader with size = 0 marks the end of a stream.
+ *
+ * Headers with a CatStreamCredit or MixStreamCredit magic byte flow in the
+ * opposite direction: they are sent by the receiving worker (sender_worker) to
+ * the StreamSink on receiver_local_worker and grant num_items more Blocks.
  */
 class StreamMultiplexerHeader : public MultiplexerHeader
 {
@@ -90,6 +97,23 @@ public:
     explicit StreamMultiplexerHeader(MagicByte m, const PinnedBlock& b)
         : MultiplexerHeader(m, b) { }
 
+    //! Construct a header granting credits for more Blocks to a StreamSink.
+    static StreamMultiplexerHeader Credit(
+        MagicByte m, size_t stream_id, size_t sender_worker,
+        size_t receiver_local_worker, size_t credits) {
+        StreamMultiplexerHeader h;
+        h.magic = m;
+        h.num_items = static_cast<uint32_t>(credits);
+        h.first_item = 0;
+        h.is_compressed = 0;
+        h.typecode_verify = 0;
+        h.is_last_block = 0;
+        h.stream_id = stream_id;
+        h.sender_worker = sender_worker;
+        h.receiver_local_worker = receiver_local_worker;
+        return h;
+    }
+
     //! Serializes the whole block struct into a buffer
     void Serialize(net::BufferBuilder& bb) const {
         bb.Reserve(MultiplexerHeader::total_size);
@@ -106,6 +130,11 @@ public:
         return size == 0;
     }
 
+    //! Number of Blocks granted by a credit header.
+    size_t credits() const {
+        return num_items;
+    }
+
     //! Calculate the sender host_rank from sender_worker and workers_per_host.
     size_t CalcHostRank(size_t workers_per_host) const {
         return sender_worker / workers_per_host;
@@ -13,6 +13,8 @@
 
 #include <thrill/data/cat_stream.hpp>
 #include <thrill/data/mix_stream.hpp>
+#include <thrill/data/multiplexer_header.hpp>
+#include <thrill/data/stream_sink.hpp>
 
 namespace thrill {
 namespace data {
@@ -23,7 +25,8 @@ Stream::Stream(Multiplexer& multiplexer, const StreamId& id,
       local_worker_id_(local_worker_id),
       dia_id_(dia_id),
       multiplexer_(multiplexer),
-      remaining_closing_blocks_((num_hosts() - 1) * workers_per_host())
+      remaining_closing_blocks_((num_hosts() - 1) * workers_per_host()),
+      rx_credit_(num_workers())
 { }
 
 Stream::~Stream() { }
@@ -41,9 +44,12 @@ void Stream::OnAllClosed(const char* stream_type) {
         << "rx_net_items" << rx_net_items_
         << "rx_net_bytes" << rx_net_bytes_
         << "rx_net_blocks" << rx_net_blocks_
+        << "rx_net_spilled_blocks" << rx_net_spilled_blocks_
         << "tx_net_items" << tx_net_items_
         << "tx_net_bytes" << tx_net_bytes_
         << "tx_net_blocks" << tx_net_blocks_
+        << "tx_compress_raw_bytes" << tx_compress_raw_bytes_
+        << "tx_compress_bytes" << tx_compress_bytes_
         << "rx_int_items" << rx_int_items_
         << "rx_int_bytes" << rx_int_bytes_
         << "rx_int_blocks" << rx_int_blocks_
@@ -52,6 +58,92 @@ void Stream::OnAllClosed(const char* stream_type) {
         << "tx_int_blocks" << tx_int_blocks_;
 }
 
+Block Stream::OnCreditBlock(
+    MagicByte credit_magic, size_t from, PinnedBlock&& b) {
+    assert(from < rx_credit_.size());
+
+    bool spill;
+    size_t credits = 0;
+    {
+        std::unique_lock<std::mutex> lock(rx_credit_mutex_);
+        RxCredit& rc = rx_credit_[from];
+
+        spill = (rc.held >= StreamSink::credit_window_ / 2);
+        rc.spilled.push_back(spill);
+
+        if (!spill)
+            ++rc.held;
+        else
+            credits = AddCredit(rc);
+    }
+
+    Block block = std::move(b).MoveToBlock();
+
+    if (spill) {
+        // the Block is unpinned, hence the BlockPool may evict it anyway. Start
+        // writing it right away if RAM is short.
+        multiplexer_.block_pool_.SpillBlock(block.byte_block().get());
+        ++rx_net_spilled_blocks_;
+    }
+
+    if (credits != 0)
+        SendCredit(credit_magic, from, credits);
+
+    return block;
+}
+
+void Stream::OnCreditConsumed(MagicByte credit_magic, size_t from) {
+    assert(from < rx_credit_.size());
+
+    size_t credits = 0;
+    {
+        std::unique_lock<std::mutex> lock(rx_credit_mutex_);
+        RxCredit& rc = rx_credit_[from];
+
+        assert(!rc.spilled.empty());
+        bool spilled = rc.spilled.front();
+        rc.spilled.pop_front();
+
+        if (spilled) return;
+
+        assert(rc.held > 0);
+        --rc.held;
+        credits = AddCredit(rc);
+    }
+
+    if (credits != 0)
+        SendCredit(credit_magic, from, credits);
+}
+
+void Stream::OnCreditClose(size_t from) {
+    assert(from < rx_credit_.size());
+    std::unique_lock<std::mutex> lock(rx_credit_mutex_);
+    rx_credit_[from].closed = true;
+}
+
+size_t Stream::AddCredit(RxCredit& rc) {
+    if (rc.closed) return 0;
+    if (++rc.pending < StreamSink::credit_window_ / 4) return 0;
+
+    size_t credits = rc.pending;
+    rc.pending = 0;
+    return credits;
+}
+
+void Stream::SendCredit(MagicByte credit_magic, size_t from, size_t credits) {
+    StreamMultiplexerHeader credit = StreamMultiplexerHeader::Credit(
+        credit_magic, id_, my_worker_rank(),
+        from % workers_per_host(), credits);
+
+    net::BufferBuilder bb;
+    credit.Serialize(bb);
+
+    // credits are sent by the dispatcher thread, also if granted by a reader.
+    multiplexer_.dispatcher_.AsyncWrite(
+        multiplexer_.group_.connection(from / workers_per_host()),
+        bb.ToBuffer());
+}
+
 } // namespace data
 } // namespace thrill
 
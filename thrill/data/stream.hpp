@@ -20,6 +20,7 @@
 #include <thrill/data/file.hpp>
 #include <thrill/data/multiplexer.hpp>
 
+#include <deque>
 #include <mutex>
 #include <vector>
 
@@ -32,7 +33,8 @@ namespace data {
 using StreamId = size_t;
 
 enum class MagicByte : uint8_t {
-    Invalid, CatStreamBlock, MixStreamBlock, PartitionBlock
+    Invalid, CatStreamBlock, MixStreamBlock, PartitionBlock,
+    CatStreamCredit, MixStreamCredit
 };
 
 /*!
@@ -73,6 +75,13 @@ public:
 
     virtual bool closed() const = 0;
 
+    //! Enable compression of Blocks sent to other hosts with the BlockCodec.
+    //! Blocks which are in transit or sent to local workers are not affected.
+    void set_compression(bool compression) { compression_ = compression; }
+
+    //! Returns whether Blocks sent to other hosts are compressed.
+    bool compression() const { return compression_; }
+
     //! Creates BlockWriters for each worker. BlockWriter can only be opened
     //! once, otherwise the block sequence is incorrectly interleaved!
     virtual std::vector<Writer> GetWriters() = 0;
@@ -151,11 +160,19 @@ public:
     //! transfer
     size_t rx_net_items_ = 0, rx_net_bytes_ = 0, rx_net_blocks_ = 0;
 
+    //! StatsCounter for incoming Blocks beyond the credit window, which were
+    //! handed to the BlockPool for spilling.
+    size_t rx_net_spilled_blocks_ = 0;
+
     //! StatsCounters for outgoing data transfer - shared by all sinks.  Does
     //! not include loopback data transfer
     std::atomic<size_t>
     tx_net_items_ { 0 }, tx_net_bytes_ { 0 }, tx_net_blocks_ { 0 };
 
+    //! StatsCounters for compressed outgoing data transfer: size of the Blocks
+    //! before and after compression, the latter is included in tx_net_bytes_.
+    std::atomic<size_t> tx_compress_raw_bytes_ { 0 }, tx_compress_bytes_ { 0 };
+
     //! StatsCounter for incoming data transfer.  Exclusively contains only
     //! loopback (internal) data transfer
     std::atomic<size_t>
@@ -193,8 +210,61 @@ protected:
     //! number of received stream closing Blocks.
     common::Semaphore sem_closing_blocks_;
 
+    //! compress Blocks sent to other hosts
+    std::atomic<bool> compression_ { false };
+
+    //! \name Credit-based Flow Control
+    //! \{
+
+    //! credit accounting of Blocks received from one remote worker
+    struct RxCredit {
+        //! whether each Block in the queue was spilled, in receive order,
+        //! which is also the order in which readers consume them.
+        std::deque<bool> spilled;
+        //! number of Blocks held in RAM, which are credited when consumed
+        size_t held = 0;
+        //! number of Blocks for which no credit was sent back yet
+        size_t pending = 0;
+        //! whether the sender closed, hence needs no further credits
+        bool closed = false;
+    };
+
+    //! credit accounting for each remote worker
+    std::vector<RxCredit> rx_credit_;
+
+    //! mutex protecting rx_credit_, which is accessed by the Multiplexer's
+    //! dispatcher thread and by the readers.
+    std::mutex rx_credit_mutex_;
+
+    /*!
+     * Account a Block received from worker from, and return it unpinned for
+     * the Stream's queues. Up to half a credit window of Blocks per sender are
+     * held in RAM and credited when a reader consumes them. Blocks beyond are
+     * credited immediately and handed to the BlockPool for spilling, hence a
+     * sender never waits on a reader, e.g. when Streams are closed before they
+     * are read.
+     */
+    Block OnCreditBlock(MagicByte credit_magic, size_t from, PinnedBlock&& b);
+
+    //! Account a Block from worker from consumed by a reader.
+    void OnCreditConsumed(MagicByte credit_magic, size_t from);
+
+    //! Stop sending credits to worker from, which closed its sink.
+    void OnCreditClose(size_t from);
+
+    //! Add credits for worker from and send them back once a quarter credit
+    //! window accumulated. Returns number of credits to send, must be called
+    //! with rx_credit_mutex_ held.
+    size_t AddCredit(RxCredit& rc);
+
+    //! Send credits to the StreamSink of worker from.
+    void SendCredit(MagicByte credit_magic, size_t from, size_t credits);
+
+    //! \}
+
     //! friends for access to multiplexer_
     friend class StreamSink;
+    friend class Multiplexer;
 };
 
 using StreamPtr = common::CountingPtr<Stream>;
@@ -10,10 +10,15 @@
 
 #include <thrill/data/stream_sink.hpp>
 
+#include <thrill/common/math.hpp>
+#include <thrill/data/block_codec.hpp>
 #include <thrill/data/cat_stream.hpp>
 #include <thrill/data/mix_stream.hpp>
 #include <thrill/data/multiplexer_header.hpp>
 #include <thrill/data/stream.hpp>
+#include <thrill/mem/aligned_allocator.hpp>
+
+#include <algorithm>
 
 namespace thrill {
 namespace data {
@@ -64,6 +69,12 @@ void StreamSink::AppendBlock(Block&& block, bool is_last_block) {
 void StreamSink::AppendPinnedBlock(const PinnedBlock& block, bool is_last_block) {
     if (block.size() == 0) return;
 
+    // wait for a credit from the receiver
+    if (!credit_sem_.try_wait()) {
+        ++credit_stall_counter_;
+        credit_sem_.wait();
+    }
+
     sem_.wait();
 
     LOG << "StreamSink::AppendPinnedBlock()"
@@ -78,6 +89,18 @@ void StreamSink::AppendPinnedBlock(const PinnedBlock& block, bool is_last_block)
     header.receiver_local_worker = peer_local_worker_;
     header.is_last_block = is_last_block;
 
+    // send a compressed copy if the stream opted in and it pays off
+    PinnedBlock send_block =
+        stream_.compression() ? Compress(block) : PinnedBlock();
+
+    if (send_block.IsValid()) {
+        header.size = static_cast<uint32_t>(send_block.size());
+        header.is_compressed = 1;
+    }
+    else {
+        send_block = PinnedBlock(block);
+    }
+
     net::BufferBuilder bb;
     header.Serialize(bb);
 
@@ -85,13 +108,13 @@ void StreamSink::AppendPinnedBlock(const PinnedBlock& block, bool is_last_block)
     assert(buffer.size() == MultiplexerHeader::total_size);
 
     item_counter_ += block.num_items();
-    byte_counter_ += buffer.size() + block.size();
+    byte_counter_ += buffer.size() + send_block.size();
     ++block_counter_;
 
     stream_.multiplexer_.dispatcher_.AsyncWrite(
         *connection_,
         // send out Buffer and Block, guaranteed to be successive
-        std::move(buffer), PinnedBlock(block),
+        std::move(buffer), std::move(send_block),
         [this](net::Connection&) { sem_.signal(); });
 
     if (is_last_block) {
@@ -118,6 +141,31 @@ void StreamSink::AppendPinnedBlock(PinnedBlock&& block, bool is_last_block) {
     return AppendPinnedBlock(block, is_last_block);
 }
 
+PinnedBlock StreamSink::Compress(const PinnedBlock& block) {
+    if (block.size() < compress_min_size_) return PinnedBlock();
+
+    // compression must save at least 1/16 of the bytes, otherwise the raw
+    // Block is sent.
+    size_t capacity = block.size() - block.size() / 16;
+
+    // the BlockPool hands out only power of two sizes, round up like the
+    // receiver does.
+    size_t alloc_size = std::max<size_t>(block.size(), THRILL_DEFAULT_ALIGN);
+    alloc_size = common::RoundUpToPowerOfTwo(alloc_size);
+
+    PinnedByteBlockPtr bytes =
+        block_pool()->AllocateByteBlock(alloc_size, local_worker_id_);
+    size_t size = BlockCodec::Compress(
+        block.data_begin(), block.size(), bytes->data(), capacity);
+
+    if (size == 0) return PinnedBlock();
+
+    compress_raw_counter_ += block.size();
+    compress_counter_ += size;
+
+    return PinnedBlock(std::move(bytes), 0, size, 0, 0, false);
+}
+
 void StreamSink::Close() {
     if (closed_) return;
     closed_ = true;
@@ -153,6 +201,12 @@ void StreamSink::Close() {
     Finalize();
 }
 
+void StreamSink::OnCredit(size_t credits) {
+    LOG << "StreamSink::OnCredit() id=" << id_
+        << " from=" << peer_worker_rank() << " credits=" << credits;
+    credit_sem_.signal(credits);
+}
+
 void StreamSink::Finalize() {
     logger()
         << "class" << "StreamSink"
@@ -164,11 +218,16 @@ void StreamSink::Finalize() {
         << "items" << item_counter_
         << "bytes" << byte_counter_
         << "blocks" << block_counter_
+        << "compress_raw_bytes" << compress_raw_counter_
+        << "compress_bytes" << compress_counter_
+        << "credit_stalls" << credit_stall_counter_
         << "timespan" << timespan_;
 
     stream_.tx_net_items_ += item_counter_;
     stream_.tx_net_bytes_ += byte_counter_;
     stream_.tx_net_blocks_ += block_counter_;
+    stream_.tx_compress_raw_bytes_ += compress_raw_counter_;
+    stream_.tx_compress_bytes_ += compress_counter_;
 }
 
 } // namespace data
@@ -72,6 +72,15 @@ public:
     //! Finalize structure after sending the piggybacked or explicit close
     void Finalize();
 
+    //! Called by the Multiplexer when the receiver granted more credits.
+    void OnCredit(size_t credits);
+
+    //! number of Blocks which the receiver grants initially. A StreamSink
+    //! stalls if it has sent this many Blocks which were not yet credited
+    //! back. The receiver credits Blocks when its reader consumes them, or
+    //! right away if it spills them, hence a slow reader throttles its senders.
+    static constexpr size_t credit_window_ = 16;
+
     //! return close flag
     bool closed() const { return closed_; }
 
@@ -89,6 +98,13 @@ public:
 private:
     static constexpr bool debug = false;
 
+    //! Blocks smaller than this are never compressed
+    static constexpr size_t compress_min_size_ = 1024;
+
+    //! Compress the Block if the stream has opted in, returns an invalid
+    //! PinnedBlock if the Block is small or incompressible.
+    PinnedBlock Compress(const PinnedBlock& block);
+
     Stream& stream_;
     net::Connection* connection_ = nullptr;
 
@@ -107,9 +123,15 @@ private:
     //! layer for transmission.
     common::Semaphore sem_ { num_queue_ };
 
+    //! semaphore counting the credits granted by the receiver.
+    common::Semaphore credit_sem_ { credit_window_ };
+
     size_t item_counter_ = 0;
     size_t byte_counter_ = 0;
     size_t block_counter_ = 0;
+    size_t compress_raw_counter_ = 0;
+    size_t compress_counter_ = 0;
+    size_t credit_stall_counter_ = 0;
     common::StatsTimerStart timespan_;
 };
 
@@ -102,7 +102,8 @@ public:
     //! unlink file immediately after opening (available on most Unix)
     bool unlink_on_open;
 
-    //! desired queue length for linuxaio_file and linuxaio_queue
+    //! desired queue length for linuxaio_file and linuxaio_queue, or ring
+    //! size for iouring_file and iouring_queue
     int queue_length;
 
     //! \}
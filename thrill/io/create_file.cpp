@@ -17,6 +17,7 @@
 #include <thrill/io/config_file.hpp>
 #include <thrill/io/create_file.hpp>
 #include <thrill/io/error_handling.hpp>
+#include <thrill/io/iouring_file.hpp>
 #include <thrill/io/linuxaio_file.hpp>
 #include <thrill/io/memory_file.hpp>
 #include <thrill/io/mmap_file.hpp>
@@ -141,6 +142,41 @@ FileBasePtr CreateFile(DiskConfig& cfg, int mode, int disk_allocator_id) {
         return FileBasePtr(result);
     }
 #endif
+#if THRILL_HAVE_IOURING_FILE
+    // iouring can have the desired ring size, specified as queue_length=?
+    else if (cfg.io_impl == "iouring")
+    {
+        // iouring_queue is a singleton.
+        cfg.queue = FileBase::DEFAULT_IOURING_QUEUE;
+
+        UfsFileBase* result =
+            new IoUringFile(cfg.path, mode, cfg.queue, disk_allocator_id,
+                            cfg.device_id, cfg.queue_length);
+
+        result->lock();
+
+        // if marked as device but file is not -> throw!
+        if (cfg.raw_device && !result->is_device())
+        {
+            delete result;
+            THRILL_THROWS(IoError, "Disk " << cfg.path << " was expected to be "
+                          "a raw block device, but it is a normal file!");
+        }
+
+        // if is raw_device -> get size and remove some flags.
+        if (result->is_device())
+        {
+            cfg.raw_device = true;
+            cfg.size = result->size();
+            cfg.autogrow = cfg.delete_on_exit = cfg.unlink_on_open = false;
+        }
+
+        if (cfg.unlink_on_open)
+            result->unlink();
+
+        return FileBasePtr(result);
+    }
+#endif
 #if THRILL_HAVE_MMAP_FILE
     else if (cfg.io_impl == "mmap")
     {
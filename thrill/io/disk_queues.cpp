@@ -17,6 +17,9 @@
 #include <thrill/io/disk_queues.hpp>
 
 #include <thrill/io/iostats.hpp>
+#include <thrill/io/iouring_file.hpp>
+#include <thrill/io/iouring_queue.hpp>
+#include <thrill/io/iouring_request.hpp>
 #include <thrill/io/linuxaio_file.hpp>
 #include <thrill/io/linuxaio_queue.hpp>
 #include <thrill/io/linuxaio_request.hpp>
@@ -60,6 +63,13 @@ void DiskQueues::MakeQueue(const FileBasePtr& file) {
         d_->queues[queue_id] = new LinuxaioQueue(af->desired_queue_length());
         return;
     }
+#endif
+#if THRILL_HAVE_IOURING_FILE
+    if (const IoUringFile* uf =
+            dynamic_cast<const IoUringFile*>(file.get())) {
+        d_->queues[queue_id] = new IoUringQueue(uf->desired_queue_length());
+        return;
+    }
 #endif
     d_->queues[queue_id] = new RequestQueueImplQwQr();
 }
@@ -79,6 +89,13 @@ void DiskQueues::AddRequest(RequestPtr& req, DiskId disk) {
                     dynamic_cast<LinuxaioFile*>(req->file().get())
                     ->desired_queue_length());
         else
+#endif
+#if THRILL_HAVE_IOURING_FILE
+        if (dynamic_cast<IoUringRequest*>(req.get()))
+            q = d_->queues[disk] = new IoUringQueue(
+                    dynamic_cast<IoUringFile*>(req->file().get())
+                    ->desired_queue_length());
+        else
 #endif
         q = d_->queues[disk] = new RequestQueueImplQwQr();
     }
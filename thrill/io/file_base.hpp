@@ -95,6 +95,7 @@ public:
 
     static constexpr int DEFAULT_QUEUE = -1;
     static constexpr int DEFAULT_LINUXAIO_QUEUE = -2;
+    static constexpr int DEFAULT_IOURING_QUEUE = -3;
     static constexpr int NO_ALLOCATOR = -1;
     static constexpr unsigned int DEFAULT_DEVICE_ID = (unsigned int)(-1);
 
@@ -0,0 +1,333 @@
+/*******************************************************************************
+ * thrill/io/iouring_queue.cpp
+ *
+ * Part of Project Thrill - http://project-thrill.org
+ *
+ * All rights reserved. Published under the BSD-2 license in the LICENSE file.
+ ******************************************************************************/
+
+#include <thrill/io/file_base.hpp>
+#include <thrill/io/iouring_queue.hpp>
+
+#if THRILL_HAVE_IOURING_FILE
+
+#include <thrill/io/error_handling.hpp>
+#include <thrill/io/iouring_request.hpp>
+
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+
+namespace thrill {
+namespace io {
+
+static inline unsigned LoadAcquire(const unsigned* p) {
+    return __atomic_load_n(p, __ATOMIC_ACQUIRE);
+}
+
+static inline void StoreRelease(unsigned* p, unsigned v) {
+    __atomic_store_n(p, v, __ATOMIC_RELEASE);
+}
+
+IoUringQueue::IoUringQueue(int desired_queue_length)
+    : post_thread_state_(NOT_RUNNING), wait_thread_state_(NOT_RUNNING) {
+    if (desired_queue_length == 0) {
+        // default value, 64 entries per queue (i.e. usually per disk) should
+        // be enough
+        max_events_ = 64;
+    }
+    else
+        max_events_ = desired_queue_length;
+
+    io_uring_params p;
+    memset(&p, 0, sizeof(p));
+    long fd = syscall(SYS_io_uring_setup, max_events_, &p);
+    if (fd < 0) {
+        THRILL_THROW_ERRNO(IoError, "IoUringQueue::IoUringQueue"
+                           " io_uring_setup() entries=" << max_events_);
+    }
+    ring_fd_ = static_cast<int>(fd);
+
+    // the kernel rounds up to a power of two, the completion ring is twice
+    // as large, hence limiting to sq_entries in flight never overflows it.
+    max_events_ = static_cast<int>(p.sq_entries);
+
+    sq_size_ = p.sq_off.array + p.sq_entries * sizeof(unsigned);
+    cq_size_ = p.cq_off.cqes + p.cq_entries * sizeof(io_uring_cqe);
+    bool single_mmap = (p.features & IORING_FEAT_SINGLE_MMAP) != 0;
+    if (single_mmap)
+        sq_size_ = cq_size_ = std::max(sq_size_, cq_size_);
+
+    sq_ptr_ = mmap(nullptr, sq_size_, PROT_READ | PROT_WRITE,
+                   MAP_SHARED | MAP_POPULATE, ring_fd_, IORING_OFF_SQ_RING);
+    if (sq_ptr_ == MAP_FAILED)
+        THRILL_THROW_ERRNO(IoError, "IoUringQueue mmap() of SQ ring");
+
+    if (single_mmap) {
+        cq_ptr_ = sq_ptr_;
+    }
+    else {
+        cq_ptr_ = mmap(nullptr, cq_size_, PROT_READ | PROT_WRITE,
+                       MAP_SHARED | MAP_POPULATE, ring_fd_, IORING_OFF_CQ_RING);
+        if (cq_ptr_ == MAP_FAILED)
+            THRILL_THROW_ERRNO(IoError, "IoUringQueue mmap() of CQ ring");
+    }
+
+    sqes_size_ = p.sq_entries * sizeof(io_uring_sqe);
+    sqes_ = static_cast<io_uring_sqe*>(
+        mmap(nullptr, sqes_size_, PROT_READ | PROT_WRITE,
+             MAP_SHARED | MAP_POPULATE, ring_fd_, IORING_OFF_SQES));
+    if (sqes_ == MAP_FAILED)
+        THRILL_THROW_ERRNO(IoError, "IoUringQueue mmap() of SQEs");
+
+    char* sq = static_cast<char*>(sq_ptr_);
+    sq_tail_ = reinterpret_cast<unsigned*>(sq + p.sq_off.tail);
+    sq_mask_ = reinterpret_cast<unsigned*>(sq + p.sq_off.ring_mask);
+    sq_array_ = reinterpret_cast<unsigned*>(sq + p.sq_off.array);
+
+    char* cq = static_cast<char*>(cq_ptr_);
+    cq_head_ = reinterpret_cast<unsigned*>(cq + p.cq_off.head);
+    cq_tail_ = reinterpret_cast<unsigned*>(cq + p.cq_off.tail);
+    cq_mask_ = reinterpret_cast<unsigned*>(cq + p.cq_off.ring_mask);
+    cqes_ = reinterpret_cast<io_uring_cqe*>(cq + p.cq_off.cqes);
+
+    num_free_events_.signal(max_events_);
+
+    LOG1 << "Set up an io_uring queue with " << max_events_ << " entries.";
+
+    StartThread(PostAsync, static_cast<void*>(this), post_thread_, post_thread_state_);
+    StartThread(WaitAsync, static_cast<void*>(this), wait_thread_, wait_thread_state_);
+}
+
+IoUringQueue::~IoUringQueue() {
+    StopThread(post_thread_, post_thread_state_, num_waiting_requests_);
+    StopThread(wait_thread_, wait_thread_state_, num_posted_requests_);
+
+    LOG1 << "io_uring queue submitted " << num_submitted_
+         << " requests in " << num_submit_calls_ << " batches.";
+
+    munmap(sqes_, sqes_size_);
+    if (cq_ptr_ != sq_ptr_)
+        munmap(cq_ptr_, cq_size_);
+    munmap(sq_ptr_, sq_size_);
+    close(ring_fd_);
+}
+
+void IoUringQueue::AddRequest(RequestPtr& req) {
+    if (req.empty())
+        THRILL_THROW_INVALID_ARGUMENT("Empty request submitted to disk_queue.");
+    if (post_thread_state_() != RUNNING)
+        LOG1 << "Request submitted to stopped queue.";
+    if (!dynamic_cast<IoUringRequest*>(req.get()))
+        LOG1 << "Non-io_uring request submitted to io_uring queue.";
+
+    std::unique_lock<std::mutex> lock(waiting_mtx_);
+
+    waiting_requests_.push_back(req);
+    num_waiting_requests_.signal();
+}
+
+bool IoUringQueue::CancelRequest(Request* req) {
+    if (!req)
+        THRILL_THROW_INVALID_ARGUMENT("Empty request canceled disk_queue.");
+    if (post_thread_state_() != RUNNING)
+        LOG1 << "Request canceled in stopped queue.";
+    if (!dynamic_cast<IoUringRequest*>(req))
+        LOG1 << "Non-io_uring request submitted to io_uring queue.";
+
+    std::unique_lock<std::mutex> lock(waiting_mtx_);
+
+    Queue::iterator pos =
+        std::find(waiting_requests_.begin(), waiting_requests_.end(), req);
+    if (pos == waiting_requests_.end()) {
+        // requests in the rings can no longer be canceled
+        return false;
+    }
+
+    waiting_requests_.erase(pos);
+
+    // request is canceled, but was not yet posted.
+    dynamic_cast<IoUringRequest*>(req)->completed(false, true);
+
+    num_waiting_requests_.wait(); // will never block
+    return true;
+}
+
+bool IoUringQueue::IsSupported() {
+    io_uring_params p;
+    memset(&p, 0, sizeof(p));
+    long fd = syscall(SYS_io_uring_setup, 1, &p);
+    if (fd < 0) {
+        if (errno == ENOSYS || errno == EPERM) return false;
+        THRILL_THROW_ERRNO(IoError, "IoUringQueue::IsSupported"
+                           " io_uring_setup()");
+    }
+    close(static_cast<int>(fd));
+    return true;
+}
+
+double IoUringQueue::average_batch_size() const {
+    return num_submit_calls_ == 0 ? 0.0
+           : static_cast<double>(num_submitted_)
+           / static_cast<double>(num_submit_calls_);
+}
+
+// internal routines, run by the posting thread
+void IoUringQueue::PostRequests() {
+    std::vector<RequestPtr> batch;
+
+    for ( ; ; ) // as long as thread is running
+    {
+        // might block until next request or message comes in
+        size_t num_currently_waiting_requests = num_waiting_requests_.wait();
+
+        // terminate if termination has been requested
+        if (post_thread_state_() == TERMINATING && num_currently_waiting_requests == 0)
+            break;
+
+        // might block because too many requests are posted
+        num_free_events_.wait();
+
+        std::unique_lock<std::mutex> lock(waiting_mtx_);
+        if (waiting_requests_.empty())
+        {
+            lock.unlock();
+
+            // num_waiting_requests-- was premature, compensate for that
+            num_free_events_.signal();
+            num_waiting_requests_.signal();
+            continue;
+        }
+
+        batch.push_back(waiting_requests_.front());
+        waiting_requests_.pop_front();
+
+        // take all further waiting requests which fit into the rings
+        while (!waiting_requests_.empty() && num_free_events_.try_wait())
+        {
+            num_waiting_requests_.wait(); // will never block
+            batch.push_back(waiting_requests_.front());
+            waiting_requests_.pop_front();
+        }
+        lock.unlock();
+
+        SubmitBatch(batch);
+        batch.clear();
+    }
+}
+
+void IoUringQueue::SubmitBatch(std::vector<RequestPtr>& batch) {
+    // only this thread writes the submission ring's tail
+    unsigned tail = *sq_tail_;
+    const unsigned mask = *sq_mask_;
+
+    for (RequestPtr& req : batch)
+    {
+        unsigned index = tail & mask;
+        dynamic_cast<IoUringRequest*>(req.get())->fill_sqe(&sqes_[index]);
+        sq_array_[index] = index;
+        ++tail;
+    }
+    StoreRelease(sq_tail_, tail);
+
+    // let the waiting thread reap the completions
+    num_posted_requests_.signal(batch.size());
+
+    size_t to_submit = batch.size();
+    while (to_submit > 0)
+    {
+        long result = syscall(SYS_io_uring_enter, ring_fd_,
+                              static_cast<unsigned>(to_submit), 0, 0,
+                              nullptr, 0);
+        if (result < 0) {
+            if (errno == EINTR || errno == EAGAIN || errno == EBUSY)
+                continue;
+            THRILL_THROW_ERRNO(IoError, "IoUringQueue::SubmitBatch"
+                               " io_uring_enter() to_submit=" << to_submit);
+        }
+        to_submit -= static_cast<size_t>(result);
+    }
+
+    ++num_submit_calls_;
+    num_submitted_ += batch.size();
+}
+
+void IoUringQueue::HandleEvents() {
+    unsigned head = *cq_head_;
+    const unsigned mask = *cq_mask_;
+
+    while (head != LoadAcquire(cq_tail_))
+    {
+        io_uring_cqe* cqe = &cqes_[head & mask];
+        // size_t is as long as a pointer, and like this, we avoid an icpc warning
+        RequestPtr* r = reinterpret_cast<RequestPtr*>(
+            static_cast<size_t>(cqe->user_data));
+        int res = cqe->res;
+
+        // release the completion ring entry before running the handler
+        StoreRelease(cq_head_, ++head);
+
+        IoUringRequest* req = dynamic_cast<IoUringRequest*>(r->get());
+        req->handle_result(res);
+        req->completed(false);
+        delete r;                    // release auto_ptr reference
+        num_free_events_.signal();
+        num_posted_requests_.wait(); // will never block
+    }
+}
+
+// internal routines, run by the waiting thread
+void IoUringQueue::WaitRequests() {
+    for ( ; ; ) // as long as thread is running
+    {
+        // might block until next request is posted or message comes in
+        size_t num_currently_posted_requests = num_posted_requests_.wait();
+
+        // terminate if termination has been requested
+        if (wait_thread_state_() == TERMINATING && num_currently_posted_requests == 0)
+            break;
+
+        // wait for at least one of them to finish
+        while (*cq_head_ == LoadAcquire(cq_tail_))
+        {
+            long result = syscall(SYS_io_uring_enter, ring_fd_, 0, 1,
+                                  IORING_ENTER_GETEVENTS, nullptr, 0);
+            if (result < 0 && errno != EINTR) {
+                THRILL_THROW_ERRNO(IoError, "IoUringQueue::WaitRequests"
+                                   " io_uring_enter()");
+            }
+        }
+
+        // compensate for the one eaten prematurely above
+        num_posted_requests_.signal();
+
+        HandleEvents();
+    }
+}
+
+void* IoUringQueue::PostAsync(void* arg) {
+    (static_cast<IoUringQueue*>(arg))->PostRequests();
+
+    self_type* pthis = static_cast<self_type*>(arg);
+    pthis->post_thread_state_.set_to(TERMINATED);
+    return nullptr;
+}
+
+void* IoUringQueue::WaitAsync(void* arg) {
+    (static_cast<IoUringQueue*>(arg))->WaitRequests();
+
+    self_type* pthis = static_cast<self_type*>(arg);
+    pthis->wait_thread_state_.set_to(TERMINATED);
+    return nullptr;
+}
+
+} // namespace io
+} // namespace thrill
+
+#endif // #if THRILL_HAVE_IOURING_FILE
+
+/******************************************************************************/
@@ -0,0 +1,128 @@
+/*******************************************************************************
+ * thrill/io/iouring_queue.hpp
+ *
+ * Part of Project Thrill - http://project-thrill.org
+ *
+ * All rights reserved. Published under the BSD-2 license in the LICENSE file.
+ ******************************************************************************/
+
+#pragma once
+#ifndef THRILL_IO_IOURING_QUEUE_HEADER
+#define THRILL_IO_IOURING_QUEUE_HEADER
+
+#include <thrill/io/request_queue_impl_worker.hpp>
+
+#if THRILL_HAVE_IOURING_FILE
+
+#include <linux/io_uring.h>
+
+#include <atomic>
+#include <list>
+#include <mutex>
+#include <vector>
+
+namespace thrill {
+namespace io {
+
+//! \addtogroup io_layer_req
+//! \{
+
+/*!
+ * Queue for IoUringFile(s), which submits requests to the kernel via an
+ * io_uring submission ring and reaps them from its completion ring.
+ *
+ * Like LinuxaioQueue, one thread posts and another waits for completions. But
+ * instead of one io_submit() per request, the posting thread moves all
+ * currently waiting requests into the submission ring and hands them to the
+ * kernel in a single io_uring_enter() call.
+ *
+ * Only one queue exists in a program, i.e. it is a singleton.
+ */
+class IoUringQueue final : public RequestQueueImplWorker
+{
+    friend class IoUringRequest;
+
+    using self_type = IoUringQueue;
+
+private:
+    //! io_uring file descriptor
+    int ring_fd_;
+
+    //! \name Memory Mapped Rings
+    //! \{
+
+    void* sq_ptr_ = nullptr;
+    size_t sq_size_ = 0;
+    void* cq_ptr_ = nullptr;
+    size_t cq_size_ = 0;
+    io_uring_sqe* sqes_ = nullptr;
+    size_t sqes_size_ = 0;
+
+    unsigned* sq_tail_;
+    unsigned* sq_mask_;
+    unsigned* sq_array_;
+
+    unsigned* cq_head_;
+    unsigned* cq_tail_;
+    unsigned* cq_mask_;
+    io_uring_cqe* cqes_;
+
+    //! \}
+
+    //! storing IoUringRequest* would drop ownership
+    using Queue = std::list<RequestPtr>;
+
+    // "waiting" request have submitted to this queue, but not yet to the
+    // kernel, those are "posted"
+    std::mutex waiting_mtx_;
+    Queue waiting_requests_;
+
+    //! max number of requests in flight, limited by the submission ring size
+    int max_events_;
+    //! number of requests in waitings_requests
+    common::Semaphore num_waiting_requests_, num_free_events_, num_posted_requests_;
+
+    //! number of io_uring_enter() submission calls and submitted requests
+    std::atomic<size_t> num_submit_calls_ { 0 }, num_submitted_ { 0 };
+
+    // two threads, one for posting, one for waiting
+    std::thread post_thread_, wait_thread_;
+    common::SharedState<ThreadState> post_thread_state_, wait_thread_state_;
+
+    static constexpr PriorityOp priority_op_ = WRITE;
+
+    static void * PostAsync(void* arg);   // thread start callback
+    static void * WaitAsync(void* arg);   // thread start callback
+    void PostRequests();
+    void SubmitBatch(std::vector<RequestPtr>& batch);
+    void HandleEvents();
+    void WaitRequests();
+
+public:
+    //! Construct queue. Requests max number of requests simultaneously
+    //! submitted to disk, 0 means the default of 64.
+    explicit IoUringQueue(int desired_queue_length = 0);
+
+    void AddRequest(RequestPtr& req) final;
+    bool CancelRequest(Request* req) final;
+    ~IoUringQueue();
+
+    //! Check whether the kernel permits setting up an io_uring, which fails
+    //! with ENOSYS on old kernels and EPERM if disabled by a sysctl or a
+    //! seccomp filter.
+    static bool IsSupported();
+
+    //! average number of requests per io_uring_enter() submission call
+    double average_batch_size() const;
+};
+
+//! \}
+
+} // namespace io
+} // namespace thrill
+
+#endif // #if THRILL_HAVE_IOURING_FILE
+
+#endif // !THRILL_IO_IOURING_QUEUE_HEADER
+
+/******************************************************************************/
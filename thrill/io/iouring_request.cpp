@@ -0,0 +1,105 @@
+/*******************************************************************************
+ * thrill/io/iouring_request.cpp
+ *
+ * Part of Project Thrill - http://project-thrill.org
+ *
+ * All rights reserved. Published under the BSD-2 license in the LICENSE file.
+ ******************************************************************************/
+
+#include <thrill/io/iouring_request.hpp>
+
+#if THRILL_HAVE_IOURING_FILE
+
+#include <thrill/io/disk_queues.hpp>
+#include <thrill/io/iostats.hpp>
+#include <thrill/mem/pool.hpp>
+
+#include <cstring>
+
+namespace thrill {
+namespace io {
+
+void IoUringRequest::completed(bool posted, bool canceled) {
+    LOG << "IoUringRequest[" << this << "] completed("
+        << posted << "," << canceled << ")";
+
+    if (!canceled)
+    {
+        if (type_ == READ)
+            Stats::GetInstance()->read_finished();
+        else
+            Stats::GetInstance()->write_finished();
+    }
+    else if (posted)
+    {
+        if (type_ == READ)
+            Stats::GetInstance()->read_canceled(bytes_);
+        else
+            Stats::GetInstance()->write_canceled(bytes_);
+    }
+    Request::completed(canceled);
+}
+
+void IoUringRequest::fill_sqe(io_uring_sqe* sqe) {
+    IoUringFile* uf = dynamic_cast<IoUringFile*>(file_.get());
+
+    memset(sqe, 0, sizeof(*sqe));
+    sqe->opcode = (type_ == READ) ? IORING_OP_READ : IORING_OP_WRITE;
+    sqe->fd = uf->file_des_;
+    sqe->off = offset_;
+    sqe->addr = static_cast<__u64>((unsigned long)(buffer_));
+    sqe->len = static_cast<__u32>(bytes_);
+    // indirection, so the I/O system retains a counting_ptr reference
+    sqe->user_data = reinterpret_cast<__u64>(new RequestPtr(this));
+
+    if (type_ == READ)
+        Stats::GetInstance()->read_started(bytes_);
+    else
+        Stats::GetInstance()->write_started(bytes_);
+}
+
+void IoUringRequest::handle_result(int res) {
+    if (res < 0) {
+        mem::safe_ostringstream msg;
+        msg << "Error in IoUringRequest::handle_result : "
+            << "path=" << dynamic_cast<IoUringFile*>(file_.get())->path_
+            << " offset=" << offset_ << " bytes=" << bytes_
+            << " type=" << (type_ == READ ? "READ" : "WRITE")
+            << " : " << strerror(-res);
+        save_error(msg.str());
+    }
+    else if (static_cast<size_type>(res) < bytes_) {
+        if (type_ == READ) {
+            // read request extends past end-of-file, fill reminder with zeroes
+            memset(static_cast<char*>(buffer_) + res, 0, bytes_ - res);
+        }
+        else {
+            mem::safe_ostringstream msg;
+            msg << "Error in IoUringRequest::handle_result : "
+                << "short write of " << res << " of " << bytes_ << " bytes";
+            save_error(msg.str());
+        }
+    }
+}
+
+//! Cancel the request
+//!
+//! Routine is called by user, as part of the request interface. Only requests
+//! not yet submitted to the kernel can be canceled.
+bool IoUringRequest::cancel() {
+    LOG << "IoUringRequest[" << this << "] cancel()";
+
+    if (!file_) return false;
+
+    RequestPtr req(this);
+    IoUringQueue* queue = dynamic_cast<IoUringQueue*>(
+        DiskQueues::GetInstance()->GetQueue(file_->get_queue_id()));
+    return queue->CancelRequest(req.get());
+}
+
+} // namespace io
+} // namespace thrill
+
+#endif // #if THRILL_HAVE_IOURING_FILE
+
+/******************************************************************************/
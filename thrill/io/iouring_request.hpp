@@ -0,0 +1,63 @@
+/*******************************************************************************
+ * thrill/io/iouring_request.hpp
+ *
+ * Part of Project Thrill - http://project-thrill.org
+ *
+ * All rights reserved. Published under the BSD-2 license in the LICENSE file.
+ ******************************************************************************/
+
+#pragma once
+#ifndef THRILL_IO_IOURING_REQUEST_HEADER
+#define THRILL_IO_IOURING_REQUEST_HEADER
+
+#include <thrill/io/iouring_file.hpp>
+
+#if THRILL_HAVE_IOURING_FILE
+
+#include <linux/io_uring.h>
+#include <thrill/io/request.hpp>
+
+namespace thrill {
+namespace io {
+
+//! \addtogroup io_layer_req
+//! \{
+
+//! Request for an IoUringFile.
+class IoUringRequest final : public Request
+{
+public:
+    IoUringRequest(
+        const CompletionHandler& on_complete,
+        const FileBasePtr& file,
+        void* buffer, offset_type offset, size_type bytes,
+        ReadOrWriteType type)
+        : Request(on_complete, file, buffer, offset, bytes, type) {
+        assert(dynamic_cast<IoUringFile*>(file.get()));
+        LOG << "IoUringRequest[" << this << "]" << " IoUringRequest"
+            << "(file=" << file << " buffer=" << buffer
+            << " offset=" << offset << " bytes=" << bytes
+            << " type=" << type << ")";
+    }
+
+    //! Fill a submission queue entry for this request.
+    void fill_sqe(io_uring_sqe* sqe);
+
+    //! Process the result of a completion queue entry.
+    void handle_result(int res);
+
+    bool cancel() final;
+    void completed(bool posted, bool canceled);
+    void completed(bool canceled) final { completed(true, canceled); }
+};
+
+//! \}
+
+} // namespace io
+} // namespace thrill
+
+#endif // #if THRILL_HAVE_IOURING_FILE
+
+#endif // !THRILL_IO_IOURING_REQUEST_HEADER
+
+/******************************************************************************/
@@ -15,6 +15,7 @@
 #include <thrill/io/disk_queues.hpp>
 #include <thrill/io/file_base.hpp>
 #include <thrill/io/iostats.hpp>
+#include <thrill/io/iouring_request.hpp>
 #include <thrill/io/linuxaio_request.hpp>
 #include <thrill/io/request.hpp>
 #include <thrill/io/serving_request.hpp>
@@ -105,6 +106,11 @@ void RequestDeleter::operator () (Request* req) const {
     else if (LinuxaioRequest* r = dynamic_cast<LinuxaioRequest*>(req)) {
         mem::GPool().destroy(r);
     }
+#endif
+#if THRILL_HAVE_IOURING_FILE
+    else if (IoUringRequest* r = dynamic_cast<IoUringRequest*>(req)) {
+        mem::GPool().destroy(r);
+    }
 #endif
     else {
         abort();
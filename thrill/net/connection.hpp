@@ -178,6 +178,11 @@ public:
     //! actually received. check errno for errors.
     virtual ssize_t RecvOne(void* out_data, size_t size) = 0;
 
+    //! Return whether received data is buffered in user space, which is not
+    //! reported by the kernel's readiness notifications. The Dispatcher then
+    //! tries to complete an AsyncRead() before registering it.
+    virtual bool HasBufferedRecv() const { return false; }
+
     //! Receive any serializable POD item T.
     template <typename T>
     typename std::enable_if<std::is_pod<T>::value, void>::type
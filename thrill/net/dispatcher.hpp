@@ -590,8 +590,9 @@ public:
         // add new async reader object
         async_read_.emplace_back(c, size, done_cb);
 
-        // register read callback
+        // register read callback, unless it completes from buffered data
         AsyncReadBuffer& arb = async_read_.back();
+        if (c.HasBufferedRecv() && !arb()) return;
         AddRead(c, AsyncCallback::make<
                     AsyncReadBuffer, & AsyncReadBuffer::operator ()>(&arb));
     }
@@ -611,8 +612,9 @@ public:
         // add new async reader object
         async_read_block_.emplace_back(c, size, std::move(block), done_cb);
 
-        // register read callback
+        // register read callback, unless it completes from buffered data
         AsyncReadByteBlock& arbb = async_read_block_.back();
+        if (c.HasBufferedRecv() && !arbb()) return;
         AddRead(c, AsyncCallback::make<
                     AsyncReadByteBlock, & AsyncReadByteBlock::operator ()>(&arbb));
     }
@@ -659,6 +661,15 @@ public:
                      AsyncWriteBlock, & AsyncWriteBlock::operator ()>(&awb));
     }
 
+    //! asynchronously write a header Buffer and a Block successively, and
+    //! callback when both are delivered. Both are MOVED into the async writer.
+    virtual void AsyncWrite(
+        Connection& c, Buffer&& buffer, data::PinnedBlock&& block,
+        const AsyncWriteCallback& done_cb = AsyncWriteCallback()) {
+        AsyncWrite(c, std::move(buffer));
+        AsyncWrite(c, std::move(block), done_cb);
+    }
+
     //! asynchronously write buffer and callback when delivered. COPIES the data
     //! into a Buffer!
     void AsyncWriteCopy(
@@ -749,7 +760,7 @@ public:
     }
 
     //! Check whether there are still AsyncWrite()s in the queue.
-    bool HasAsyncWrites() const {
+    virtual bool HasAsyncWrites() const {
         return (async_write_.size() != 0) || (async_write_block_.size() != 0);
     }
 
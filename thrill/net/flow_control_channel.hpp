@@ -645,6 +645,25 @@ public:
         return result;
     }
 
+    /*!
+     * Shares a pointer among the local workers of this host: returns the
+     * pointer passed by local worker local_origin on all local workers. This
+     * synchronizes only the threads of this host, there is no network
+     * communication. The pointed object must outlive its use by all local
+     * workers, e.g. guarded by a LocalBarrier().
+     */
+    template <typename T>
+    T * LocalBroadcastPointer(T* value, size_t local_origin = 0) {
+        assert(local_origin < thread_count_);
+
+        size_t step = GetNextStep();
+        SetLocalShared(step, value);
+
+        barrier_.Await();
+
+        return GetLocalShared<T>(step, local_origin);
+    }
+
     //! A trivial global barrier.
     void Barrier();
 
@@ -0,0 +1,81 @@
+/*******************************************************************************
+ * thrill/net/hybrid/construct.cpp
+ *
+ * Part of Project Thrill - http://project-thrill.org
+ *
+ * All rights reserved. Published under the BSD-2 license in the LICENSE file.
+ ******************************************************************************/
+
+#include <thrill/net/hybrid/construct.hpp>
+
+#if THRILL_HAVE_NET_SHM
+
+#include <thrill/common/die.hpp>
+#include <thrill/net/shm/construct.hpp>
+#include <thrill/net/tcp/construct.hpp>
+
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace thrill {
+namespace net {
+namespace hybrid {
+
+//! \addtogroup net_hybrid Hybrid Shared Memory and TCP API
+//! \{
+
+//! return the host name part of an endpoint "host:port"
+static std::string EndpointHost(const std::string& endpoint) {
+    return endpoint.substr(0, endpoint.rfind(':'));
+}
+
+std::vector<bool> SameHostPeers(size_t my_rank,
+                                const std::vector<std::string>& endpoints) {
+    die_unless(my_rank < endpoints.size());
+
+    std::string my_host = EndpointHost(endpoints[my_rank]);
+
+    std::vector<bool> local(endpoints.size());
+    for (size_t i = 0; i < endpoints.size(); ++i) {
+        local[i] = (i != my_rank && EndpointHost(endpoints[i]) == my_host);
+    }
+    return local;
+}
+
+void Construct(size_t my_rank, const std::vector<std::string>& endpoints,
+               std::unique_ptr<Group>* groups, size_t group_count,
+               size_t ring_size) {
+
+    std::vector<bool> local = SameHostPeers(my_rank, endpoints);
+
+    std::vector<bool> remote(endpoints.size());
+    for (size_t i = 0; i < endpoints.size(); ++i)
+        remote[i] = (i != my_rank && !local[i]);
+
+    // the shm handshakes only wait for processes on this host, which also
+    // construct their shm::Groups first. Hence, no host blocks in the shm
+    // handshakes on one which is already waiting for TCP connections.
+    std::vector<std::unique_ptr<shm::Group> > shm_groups(group_count);
+    shm::Construct(my_rank, endpoints, local,
+                   shm_groups.data(), group_count, ring_size);
+
+    std::vector<std::unique_ptr<tcp::Group> > tcp_groups(group_count);
+    tcp::Construct(my_rank, endpoints, remote,
+                   tcp_groups.data(), group_count);
+
+    for (size_t g = 0; g < group_count; ++g) {
+        groups[g] = std::make_unique<Group>(
+            my_rank, local, std::move(tcp_groups[g]), std::move(shm_groups[g]));
+    }
+}
+
+//! \}
+
+} // namespace hybrid
+} // namespace net
+} // namespace thrill
+
+#endif // THRILL_HAVE_NET_SHM
+
+/******************************************************************************/
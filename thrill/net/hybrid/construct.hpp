@@ -0,0 +1,58 @@
+/*******************************************************************************
+ * thrill/net/hybrid/construct.hpp
+ *
+ * Part of Project Thrill - http://project-thrill.org
+ *
+ * All rights reserved. Published under the BSD-2 license in the LICENSE file.
+ ******************************************************************************/
+
+#pragma once
+#ifndef THRILL_NET_HYBRID_CONSTRUCT_HEADER
+#define THRILL_NET_HYBRID_CONSTRUCT_HEADER
+
+#include <thrill/net/hybrid/group.hpp>
+
+#if THRILL_HAVE_NET_SHM
+
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace thrill {
+namespace net {
+namespace hybrid {
+
+//! \addtogroup net_hybrid Hybrid Shared Memory and TCP API
+//! \{
+
+/*!
+ * Determine the peers on the same host as my_rank: those whose endpoint has
+ * the same host name, which is the part before the last colon. The entry of
+ * my_rank itself is false.
+ */
+std::vector<bool> SameHostPeers(size_t my_rank,
+                                const std::vector<std::string>& endpoints);
+
+/*!
+ * Connect to peers on the same host via shared memory and to all others via
+ * TCP sockets. Construct group_count hybrid::Group objects at once. Within
+ * each Group this host has my_rank. Peers are on the same host if the host
+ * names of their endpoints are equal, hence all processes must use the same
+ * name for a host.
+ */
+void Construct(size_t my_rank,
+               const std::vector<std::string>& endpoints,
+               std::unique_ptr<Group>* groups, size_t group_count,
+               size_t ring_size = shm::Connection::default_ring_size);
+
+//! \}
+
+} // namespace hybrid
+} // namespace net
+} // namespace thrill
+
+#endif // THRILL_HAVE_NET_SHM
+
+#endif // !THRILL_NET_HYBRID_CONSTRUCT_HEADER
+
+/******************************************************************************/
@@ -0,0 +1,99 @@
+/*******************************************************************************
+ * thrill/net/hybrid/dispatcher.cpp
+ *
+ * Part of Project Thrill - http://project-thrill.org
+ *
+ * All rights reserved. Published under the BSD-2 license in the LICENSE file.
+ ******************************************************************************/
+
+#include <thrill/net/hybrid/dispatcher.hpp>
+
+#if THRILL_HAVE_NET_SHM
+
+#include <utility>
+
+namespace thrill {
+namespace net {
+namespace hybrid {
+
+Dispatcher::Dispatcher(mem::Manager& mem_manager)
+    : net::Dispatcher(mem_manager),
+      tcp_(mem_manager),
+      shm_(mem_manager) {
+    // the epoll fd of shm_ is registered edge-triggered, hence all pending
+    // events must be processed on each edge. The callback stays registered.
+    tcp_.AddRead(shm_.epoll_fd(),
+                 [this]() {
+                     shm_.DispatchPending();
+                     return true;
+                 });
+}
+
+void Dispatcher::AddRead(net::Connection& c, const AsyncCallback& read_cb) {
+    if (AsShm(c))
+        shm_.AddRead(c, read_cb);
+    else
+        tcp_.AddRead(c, read_cb);
+}
+
+void Dispatcher::AddWrite(net::Connection& c, const AsyncCallback& write_cb) {
+    if (AsShm(c))
+        shm_.AddWrite(c, write_cb);
+    else
+        tcp_.AddWrite(c, write_cb);
+}
+
+void Dispatcher::Cancel(net::Connection& c) {
+    if (AsShm(c))
+        shm_.Cancel(c);
+    else
+        tcp_.Cancel(c);
+}
+
+void Dispatcher::AsyncWrite(
+    net::Connection& c, Buffer&& buffer, data::PinnedBlock&& block,
+    const AsyncWriteCallback& done_cb) {
+    if (AsShm(c))
+        net::Dispatcher::AsyncWrite(
+            c, std::move(buffer), std::move(block), done_cb);
+    else
+        tcp_.AsyncWrite(c, std::move(buffer), std::move(block), done_cb);
+}
+
+void Dispatcher::AsyncWrite(
+    net::Connection& c, Buffer&& buffer, const AsyncWriteCallback& done_cb) {
+    if (AsShm(c))
+        net::Dispatcher::AsyncWrite(c, std::move(buffer), done_cb);
+    else
+        tcp_.AsyncWrite(c, std::move(buffer), done_cb);
+}
+
+void Dispatcher::AsyncWrite(
+    net::Connection& c, data::PinnedBlock&& block,
+    const AsyncWriteCallback& done_cb) {
+    if (AsShm(c))
+        net::Dispatcher::AsyncWrite(c, std::move(block), done_cb);
+    else
+        tcp_.AsyncWrite(c, std::move(block), done_cb);
+}
+
+bool Dispatcher::HasAsyncWrites() const {
+    return net::Dispatcher::HasAsyncWrites() ||
+           tcp_.HasAsyncWrites() || shm_.HasAsyncWrites();
+}
+
+void Dispatcher::DispatchOne(const std::chrono::milliseconds& timeout) {
+    tcp_.DispatchOne(timeout);
+}
+
+void Dispatcher::Interrupt() {
+    tcp_.Interrupt();
+}
+
+} // namespace hybrid
+} // namespace net
+} // namespace thrill
+
+#endif // THRILL_HAVE_NET_SHM
+
+/******************************************************************************/
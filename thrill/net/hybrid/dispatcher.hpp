@@ -0,0 +1,113 @@
+/*******************************************************************************
+ * thrill/net/hybrid/dispatcher.hpp
+ *
+ * Dispatcher multiplexing tcp::Connections and shm::Connections.
+ *
+ * Part of Project Thrill - http://project-thrill.org
+ *
+ * All rights reserved. Published under the BSD-2 license in the LICENSE file.
+ ******************************************************************************/
+
+#pragma once
+#ifndef THRILL_NET_HYBRID_DISPATCHER_HEADER
+#define THRILL_NET_HYBRID_DISPATCHER_HEADER
+
+#include <thrill/common/config.hpp>
+
+#if THRILL_HAVE_NET_SHM
+
+#include <thrill/net/dispatcher.hpp>
+#include <thrill/net/shm/connection.hpp>
+#include <thrill/net/shm/dispatcher.hpp>
+#include <thrill/net/tcp/epoll_dispatcher.hpp>
+
+#include <chrono>
+
+namespace thrill {
+namespace net {
+namespace hybrid {
+
+//! \addtogroup net_hybrid Hybrid Shared Memory and TCP API
+//! \{
+
+/*!
+ * Dispatcher for a hybrid::Group, which routes the callbacks of each
+ * Connection to a tcp::EPollDispatcher or a shm::Dispatcher by its type. The
+ * tcp::EPollDispatcher is the main loop: it watches the epoll file descriptor
+ * of the nested shm::Dispatcher, which becomes readable when a peer signals
+ * an eventfd, and then runs all pending shm callbacks.
+ *
+ * AsyncWrite()s to tcp::Connections go through the send queues of the
+ * tcp::EPollDispatcher, all others use the generic buffered writers.
+ */
+class Dispatcher final : public net::Dispatcher
+{
+    static constexpr bool debug = false;
+
+public:
+    //! constructor
+    explicit Dispatcher(mem::Manager& mem_manager);
+
+    //! non-copyable: delete copy-constructor
+    Dispatcher(const Dispatcher&) = delete;
+    //! non-copyable: delete assignment operator
+    Dispatcher& operator = (const Dispatcher&) = delete;
+
+    //! Register a buffered read callback.
+    void AddRead(net::Connection& c, const AsyncCallback& read_cb) final;
+
+    //! Register a buffered write callback.
+    void AddWrite(net::Connection& c, const AsyncCallback& write_cb) final;
+
+    //! Cancel all callbacks on a given Connection.
+    void Cancel(net::Connection& c) final;
+
+    //! asynchronously write a header Buffer and a Block successively.
+    void AsyncWrite(
+        net::Connection& c, Buffer&& buffer, data::PinnedBlock&& block,
+        const AsyncWriteCallback& done_cb = AsyncWriteCallback()) final;
+
+    //! asynchronously write a Buffer.
+    void AsyncWrite(
+        net::Connection& c, Buffer&& buffer,
+        const AsyncWriteCallback& done_cb = AsyncWriteCallback()) final;
+
+    //! asynchronously write a Block.
+    void AsyncWrite(
+        net::Connection& c, data::PinnedBlock&& block,
+        const AsyncWriteCallback& done_cb = AsyncWriteCallback()) final;
+
+    //! Check whether there are still AsyncWrite()s queued in any Dispatcher.
+    bool HasAsyncWrites() const final;
+
+    //! Run one iteration of dispatching epoll_wait() on the TCP sockets and
+    //! the nested shm::Dispatcher.
+    void DispatchOne(const std::chrono::milliseconds& timeout) final;
+
+    //! Interrupt the current epoll_wait() of the main loop
+    void Interrupt() final;
+
+private:
+    //! main loop handling tcp::Connections
+    tcp::EPollDispatcher tcp_;
+
+    //! nested Dispatcher handling shm::Connections
+    shm::Dispatcher shm_;
+
+    //! return the Connection as shm::Connection, or nullptr if it is not one.
+    static shm::Connection * AsShm(net::Connection& c) {
+        return dynamic_cast<shm::Connection*>(&c);
+    }
+};
+
+//! \}
+
+} // namespace hybrid
+} // namespace net
+} // namespace thrill
+
+#endif // THRILL_HAVE_NET_SHM
+
+#endif // !THRILL_NET_HYBRID_DISPATCHER_HEADER
+
+/******************************************************************************/
@@ -0,0 +1,98 @@
+/*******************************************************************************
+ * thrill/net/hybrid/group.cpp
+ *
+ * Part of Project Thrill - http://project-thrill.org
+ *
+ * All rights reserved. Published under the BSD-2 license in the LICENSE file.
+ ******************************************************************************/
+
+#include <thrill/net/hybrid/group.hpp>
+
+#if THRILL_HAVE_NET_SHM
+
+#include <thrill/common/die.hpp>
+#include <thrill/net/hybrid/dispatcher.hpp>
+#include <thrill/net/shm/construct.hpp>
+
+#include <random>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace thrill {
+namespace net {
+namespace hybrid {
+
+Group::Group(size_t my_rank, const std::vector<bool>& local,
+             std::unique_ptr<tcp::Group> tcp, std::unique_ptr<shm::Group> shm)
+    : net::Group(my_rank),
+      local_(local), tcp_(std::move(tcp)), shm_(std::move(shm)) {
+    die_unless(tcp_->num_hosts() == local_.size());
+    die_unless(shm_->num_hosts() == local_.size());
+}
+
+std::unique_ptr<net::Dispatcher>
+Group::ConstructDispatcher(mem::Manager& mem_manager) const {
+    return std::make_unique<Dispatcher>(mem_manager);
+}
+
+std::vector<std::unique_ptr<Group> >
+Group::ConstructLoopbackMesh(size_t num_hosts, size_t hosts_per_node,
+                             size_t ring_size) {
+
+    // randomize rendezvous names for concurrent tests
+    std::default_random_engine generator(std::random_device { } ());
+    std::uniform_int_distribution<uint64_t> distribution;
+    std::string prefix = "hybrid-" + std::to_string(distribution(generator));
+
+    std::vector<std::string> endpoints;
+    for (size_t i = 0; i < num_hosts; ++i)
+        endpoints.push_back(prefix + "-" + std::to_string(i));
+
+    std::vector<std::vector<bool> > local(
+        num_hosts, std::vector<bool>(num_hosts));
+    for (size_t i = 0; i < num_hosts; ++i) {
+        for (size_t j = 0; j < num_hosts; ++j) {
+            local[i][j] = (i != j && i / hosts_per_node == j / hosts_per_node);
+        }
+    }
+
+    // stream socket pairs to all peers, of which the ones on other nodes are
+    // used.
+    std::vector<std::unique_ptr<tcp::Group> > tcp_groups
+        = tcp::Group::ConstructLoopbackMesh(num_hosts);
+
+    // shared memory only between ranks on the same node, constructed in
+    // threads because the handshakes are synchronous.
+    std::vector<std::unique_ptr<shm::Group> > shm_groups(num_hosts);
+    std::vector<std::thread> threads(num_hosts);
+
+    for (size_t i = 0; i < num_hosts; i++) {
+        threads[i] = std::thread(
+            [i, ring_size, &endpoints, &local, &shm_groups]() {
+                shm::Construct(i, endpoints, local[i],
+                               shm_groups.data() + i, 1, ring_size);
+            });
+    }
+
+    for (size_t i = 0; i < num_hosts; i++) {
+        threads[i].join();
+    }
+
+    std::vector<std::unique_ptr<Group> > groups(num_hosts);
+    for (size_t i = 0; i < num_hosts; i++) {
+        groups[i] = std::make_unique<Group>(
+            i, local[i], std::move(tcp_groups[i]), std::move(shm_groups[i]));
+    }
+
+    return groups;
+}
+
+} // namespace hybrid
+} // namespace net
+} // namespace thrill
+
+#endif // THRILL_HAVE_NET_SHM
+
+/******************************************************************************/
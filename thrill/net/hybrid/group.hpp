@@ -0,0 +1,116 @@
+/*******************************************************************************
+ * thrill/net/hybrid/group.hpp
+ *
+ * Part of Project Thrill - http://project-thrill.org
+ *
+ * All rights reserved. Published under the BSD-2 license in the LICENSE file.
+ ******************************************************************************/
+
+#pragma once
+#ifndef THRILL_NET_HYBRID_GROUP_HEADER
+#define THRILL_NET_HYBRID_GROUP_HEADER
+
+#include <thrill/common/config.hpp>
+
+#if THRILL_HAVE_NET_SHM
+
+#include <thrill/net/group.hpp>
+#include <thrill/net/shm/group.hpp>
+#include <thrill/net/tcp/group.hpp>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace thrill {
+namespace net {
+namespace hybrid {
+
+//! \addtogroup net_hybrid Hybrid Shared Memory and TCP API
+//! \{
+
+/*!
+ * Collection of Connections which reach peers on the same host via a
+ * shm::Group and all others via a tcp::Group. Both Groups span all hosts, but
+ * only one of the two Connections to each peer is valid.
+ */
+class Group final : public net::Group
+{
+    static constexpr bool debug = false;
+
+public:
+    //! \name Construction and Initialization
+    //! \{
+
+    /*!
+     * Construct a test network in which hosts_per_node consecutive ranks are
+     * connected via shm::Connections, and all others via local stream socket
+     * pairs. Returns vector of Groups for each virtual client.
+     */
+    static std::vector<std::unique_ptr<Group> > ConstructLoopbackMesh(
+        size_t num_hosts, size_t hosts_per_node,
+        size_t ring_size = shm::Connection::default_ring_size);
+
+    //! Initializing constructor, used by Construct(). local[i] selects the
+    //! shm::Connection to peer i.
+    Group(size_t my_rank, const std::vector<bool>& local,
+          std::unique_ptr<tcp::Group> tcp, std::unique_ptr<shm::Group> shm);
+
+    //! \}
+
+    //! \name Status and Access to Connections
+    //! \{
+
+    //! Return whether peer id is reached via shared memory.
+    bool is_local(size_t id) const {
+        return local_.at(id);
+    }
+
+    net::Connection& connection(size_t id) final {
+        if (is_local(id))
+            return shm_->connection(id);
+        else
+            return tcp_->connection(id);
+    }
+
+    //! Return number of connections in this group (= number computing hosts)
+    size_t num_hosts() const final {
+        return local_.size();
+    }
+
+    //! Closes all Connections. As with tcp::Group, the Group is empty
+    //! afterwards.
+    void Close() final {
+        shm_->Close();
+        tcp_->Close();
+        local_.clear();
+    }
+
+    //! Construct a hybrid::Dispatcher.
+    std::unique_ptr<net::Dispatcher> ConstructDispatcher(
+        mem::Manager& mem_manager) const final;
+
+    //! \}
+
+private:
+    //! whether each peer is on the same host
+    std::vector<bool> local_;
+
+    //! Connections to peers on other hosts
+    std::unique_ptr<tcp::Group> tcp_;
+
+    //! Connections to peers on the same host
+    std::unique_ptr<shm::Group> shm_;
+};
+
+//! \}
+
+} // namespace hybrid
+} // namespace net
+} // namespace thrill
+
+#endif // THRILL_HAVE_NET_SHM
+
+#endif // !THRILL_NET_HYBRID_GROUP_HEADER
+
+/******************************************************************************/
@@ -0,0 +1,328 @@
+/*******************************************************************************
+ * thrill/net/shm/connection.cpp
+ *
+ * Part of Project Thrill - http://project-thrill.org
+ *
+ * All rights reserved. Published under the BSD-2 license in the LICENSE file.
+ ******************************************************************************/
+
+#include <thrill/net/shm/connection.hpp>
+
+#if THRILL_HAVE_NET_SHM
+
+#include <thrill/common/die.hpp>
+
+#include <poll.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+
+namespace thrill {
+namespace net {
+namespace shm {
+
+size_t Ring::RegionSize(size_t capacity) {
+    size_t page_size = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    size_t size = 2 * (sizeof(Ring) + capacity);
+    return (size + page_size - 1) / page_size * page_size;
+}
+
+Connection::Connection(size_t peer, bool lower, int mem_fd, size_t offset,
+                       size_t ring_size, int event_fd, int peer_event_fd)
+    : peer_(peer), ring_size_(ring_size),
+      event_fd_(event_fd), peer_event_fd_(peer_event_fd) {
+    assert((ring_size & (ring_size - 1)) == 0);
+
+    region_size_ = Ring::RegionSize(ring_size);
+    region_ = mmap(nullptr, region_size_, PROT_READ | PROT_WRITE,
+                   MAP_SHARED, mem_fd, static_cast<off_t>(offset));
+    if (region_ == MAP_FAILED) {
+        region_ = nullptr;
+        throw Exception("shm::Connection() could not map shared memory",
+                        errno);
+    }
+
+    // a new memfd is zero-filled, which is the initial state of both Rings.
+    Ring* first = reinterpret_cast<Ring*>(region_);
+    Ring* second = reinterpret_cast<Ring*>(
+        reinterpret_cast<uint8_t*>(first->data()) + ring_size);
+
+    send_ = lower ? first : second;
+    recv_ = lower ? second : first;
+}
+
+Connection& Connection::operator = (Connection&& other) noexcept {
+    if (this == &other) return *this;
+    if (IsValid()) {
+        sLOG1 << "Assignment-destruction of valid Connection" << this;
+        Close();
+    }
+    peer_ = other.peer_;
+    region_ = other.region_;
+    region_size_ = other.region_size_;
+    ring_size_ = other.ring_size_;
+    send_ = other.send_;
+    recv_ = other.recv_;
+    event_fd_ = other.event_fd_;
+    peer_event_fd_ = other.peer_event_fd_;
+    recv_queued_ = other.recv_queued_;
+    is_loopback_ = other.is_loopback_;
+
+    other.region_ = nullptr;
+    other.send_ = other.recv_ = nullptr;
+    other.event_fd_ = other.peer_event_fd_ = -1;
+    return *this;
+}
+
+Connection::~Connection() {
+    Close();
+}
+
+void Connection::Close() {
+    if (region_) {
+        send_->closed.store(1);
+        recv_->closed.store(1);
+        NotifyPeer();
+
+        munmap(region_, region_size_);
+        region_ = nullptr;
+        send_ = recv_ = nullptr;
+    }
+    if (event_fd_ >= 0) ::close(event_fd_);
+    if (peer_event_fd_ >= 0) ::close(peer_event_fd_);
+    event_fd_ = peer_event_fd_ = -1;
+}
+
+std::string Connection::ToString() const {
+    return "peer: " + std::to_string(peer_);
+}
+
+std::ostream& Connection::OutputOstream(std::ostream& os) const {
+    return os << "[shm::Connection"
+              << " peer=" << peer_
+              << " event_fd=" << event_fd_
+              << "]";
+}
+
+/******************************************************************************/
+// Ring Transfers
+
+size_t Connection::Produce(const uint8_t* data, size_t size) {
+    uint64_t head = send_->head.load(std::memory_order_relaxed);
+    uint64_t tail = send_->tail.load(std::memory_order_acquire);
+
+    size_t n = std::min(size, ring_size_ - static_cast<size_t>(head - tail));
+    if (n == 0) return 0;
+
+    size_t pos = static_cast<size_t>(head) & (ring_size_ - 1);
+    size_t first = std::min(n, ring_size_ - pos);
+    std::copy(data, data + first, send_->data() + pos);
+    std::copy(data + first, data + n, send_->data());
+
+    send_->head.store(head + n, std::memory_order_release);
+
+    // pairs with the fence in ArmRecv() of the peer.
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (send_->reader_waiting.load(std::memory_order_relaxed) &&
+        send_->reader_waiting.exchange(0))
+        NotifyPeer();
+
+    return n;
+}
+
+size_t Connection::Consume(uint8_t* out_data, size_t size) {
+    uint64_t tail = recv_->tail.load(std::memory_order_relaxed);
+    uint64_t head = recv_->head.load(std::memory_order_acquire);
+
+    size_t n = std::min(size, static_cast<size_t>(head - tail));
+    if (n == 0) return 0;
+
+    size_t pos = static_cast<size_t>(tail) & (ring_size_ - 1);
+    size_t first = std::min(n, ring_size_ - pos);
+    std::copy(recv_->data() + pos, recv_->data() + pos + first, out_data);
+    std::copy(recv_->data(), recv_->data() + (n - first), out_data + first);
+
+    recv_->tail.store(tail + n, std::memory_order_release);
+
+    // pairs with the fence in ArmSend() of the peer.
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (recv_->writer_waiting.load(std::memory_order_relaxed) &&
+        recv_->writer_waiting.exchange(0))
+        NotifyPeer();
+
+    return n;
+}
+
+bool Connection::ArmRecv() {
+    recv_->reader_waiting.store(1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    return recv_->head.load(std::memory_order_relaxed)
+           != recv_->tail.load(std::memory_order_relaxed);
+}
+
+bool Connection::ArmSend() {
+    send_->writer_waiting.store(1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    return send_->head.load(std::memory_order_relaxed)
+           - send_->tail.load(std::memory_order_relaxed) < ring_size_;
+}
+
+/******************************************************************************/
+// Notifications
+
+void Connection::NotifyPeer() {
+    uint64_t one = 1;
+    ssize_t wb;
+    while ((wb = write(peer_event_fd_, &one, sizeof(one))) < 0 &&
+           errno == EINTR) { }
+    die_unless(wb == sizeof(one));
+}
+
+void Connection::NotifySelf() {
+    uint64_t one = 1;
+    ssize_t wb;
+    while ((wb = write(event_fd_, &one, sizeof(one))) < 0 && errno == EINTR) { }
+    die_unless(wb == sizeof(one));
+}
+
+void Connection::DrainEvents() {
+    uint64_t counter;
+    while (read(event_fd_, &counter, sizeof(counter)) > 0) {
+        /* repeat, until counter is reset */
+    }
+}
+
+void Connection::Wait() {
+    struct pollfd pfd;
+    pfd.fd = event_fd_;
+    pfd.events = POLLIN;
+
+    while (poll(&pfd, 1, -1) < 0) {
+        if (errno != EINTR)
+            throw Exception("shm::Connection::Wait() poll() failed", errno);
+    }
+    DrainEvents();
+}
+
+/******************************************************************************/
+// Send and Receive Functions
+
+ssize_t Connection::SendOne(const void* data, size_t size, Flags) {
+    assert(IsValid());
+
+    if (send_->closed.load()) {
+        errno = EPIPE;
+        return -1;
+    }
+
+    const uint8_t* cdata = static_cast<const uint8_t*>(data);
+    size_t n = 0;
+    do {
+        n += Produce(cdata + n, size - n);
+    } while (n < size && ArmSend());
+
+    if (n == 0) {
+        errno = EAGAIN;
+        return -1;
+    }
+    tx_bytes_ += n;
+    return n;
+}
+
+void Connection::SyncSend(const void* data, size_t size, Flags) {
+    assert(IsValid());
+
+    const uint8_t* cdata = static_cast<const uint8_t*>(data);
+    size_t n = 0;
+    while (true) {
+        if (send_->closed.load())
+            throw Exception("shm::Connection::SyncSend() peer closed "
+                            "connection " + ToString(), EPIPE);
+
+        n += Produce(cdata + n, size - n);
+        if (n == size) break;
+        if (!ArmSend()) Wait();
+    }
+    tx_bytes_ += size;
+}
+
+ssize_t Connection::RecvOne(void* out_data, size_t size) {
+    assert(IsValid());
+
+    uint8_t* out = static_cast<uint8_t*>(out_data);
+    size_t n = 0;
+    do {
+        n += Consume(out + n, size - n);
+    } while (n < size && ArmRecv());
+
+    if (n == 0) {
+        // end-of-file is signaled by errno = 0.
+        errno = recv_->closed.load() ? 0 : EAGAIN;
+        return recv_->closed.load() ? 0 : -1;
+    }
+    rx_bytes_ += n;
+    return n;
+}
+
+void Connection::SyncRecv(void* out_data, size_t size) {
+    assert(IsValid());
+
+    uint8_t* out = static_cast<uint8_t*>(out_data);
+    size_t n = 0;
+    while (true) {
+        n += Consume(out + n, size - n);
+        if (n == size) break;
+        if (ArmRecv()) continue;
+        if (recv_->closed.load())
+            throw Exception("shm::Connection::SyncRecv() peer closed "
+                            "connection " + ToString(), EPIPE);
+        Wait();
+    }
+    rx_bytes_ += size;
+}
+
+void Connection::SyncSendRecv(const void* send_data, size_t send_size,
+                              void* recv_data, size_t recv_size) {
+    assert(IsValid());
+
+    // interleave both directions, since each Ring may be too small to hold a
+    // whole message.
+    const uint8_t* sdata = static_cast<const uint8_t*>(send_data);
+    uint8_t* rdata = static_cast<uint8_t*>(recv_data);
+    size_t sn = 0, rn = 0;
+
+    while (sn < send_size || rn < recv_size) {
+        if (send_->closed.load() && sn < send_size)
+            throw Exception("shm::Connection::SyncSendRecv() peer closed "
+                            "connection " + ToString(), EPIPE);
+
+        size_t progress = Produce(sdata + sn, send_size - sn);
+        sn += progress;
+        size_t r = Consume(rdata + rn, recv_size - rn);
+        rn += r, progress += r;
+        if (progress != 0) continue;
+
+        // no progress: arm both directions before sleeping.
+        bool ready = (sn < send_size && ArmSend());
+        ready = (rn < recv_size && ArmRecv()) || ready;
+        if (!ready) {
+            if (rn < recv_size && recv_->closed.load())
+                throw Exception("shm::Connection::SyncSendRecv() peer closed "
+                                "connection " + ToString(), EPIPE);
+            Wait();
+        }
+    }
+    tx_bytes_ += send_size;
+    rx_bytes_ += recv_size;
+}
+
+} // namespace shm
+} // namespace net
+} // namespace thrill
+
+#endif // THRILL_HAVE_NET_SHM
+
+/******************************************************************************/
@@ -0,0 +1,238 @@
+/*******************************************************************************
+ * thrill/net/shm/connection.hpp
+ *
+ * Point-to-point connection between two processes on the same host via a pair
+ * of shared-memory ring buffers.
+ *
+ * Part of Project Thrill - http://project-thrill.org
+ *
+ * All rights reserved. Published under the BSD-2 license in the LICENSE file.
+ ******************************************************************************/
+
+#pragma once
+#ifndef THRILL_NET_SHM_CONNECTION_HEADER
+#define THRILL_NET_SHM_CONNECTION_HEADER
+
+#include <thrill/common/config.hpp>
+
+#if THRILL_HAVE_NET_SHM
+
+#include <thrill/net/connection.hpp>
+
+#include <atomic>
+#include <cassert>
+#include <string>
+
+namespace thrill {
+namespace net {
+namespace shm {
+
+//! \addtogroup net_shm Shared Memory API
+//! \{
+
+/*!
+ * Header of a single-producer single-consumer byte ring in shared memory. The
+ * producer only advances head, the consumer only advances tail, both are
+ * running byte counters. The waiting flags are set by a side before it sleeps
+ * on its eventfd, the other side clears them and signals the eventfd.
+ */
+struct Ring {
+    //! total bytes written, advanced by the producer
+    alignas(64) std::atomic<uint64_t> head;
+    //! total bytes read, advanced by the consumer
+    alignas(64) std::atomic<uint64_t> tail;
+    //! consumer waits for data
+    alignas(64) std::atomic<uint32_t> reader_waiting;
+    //! producer waits for free space
+    std::atomic<uint32_t>             writer_waiting;
+    //! set by either side on Close(): EOF for the consumer, EPIPE for the
+    //! producer.
+    std::atomic<uint32_t>             closed;
+
+    //! data area following the header, whose size is a power of two.
+    uint8_t * data() {
+        return reinterpret_cast<uint8_t*>(this + 1);
+    }
+
+    //! size of the shared region containing two Rings of given capacity, padded
+    //! to whole pages such that regions can be mapped separately.
+    static size_t RegionSize(size_t capacity);
+};
+
+static_assert(ATOMIC_LLONG_LOCK_FREE == 2 && ATOMIC_INT_LOCK_FREE == 2,
+              "shm::Ring requires address-free lock-free atomics");
+
+/*!
+ * Connection to a peer process on the same host. Each direction is a Ring in
+ * a shared memory region mapped by both processes. Each side owns an eventfd,
+ * which the peer signals when data or free space becomes available while the
+ * owner waits for it. Unlike a socket, a Connection is not drained by the
+ * kernel, hence RecvOne() and SendOne() transfer as much as possible and a
+ * short transfer leaves the waiting flag set, which makes the peer signal the
+ * eventfd on progress.
+ */
+class Connection final : public net::Connection
+{
+    static constexpr bool debug = false;
+
+public:
+    //! default capacity of each ring buffer
+    static constexpr size_t default_ring_size = 1024 * 1024;
+
+    //! construct invalid Connection
+    Connection() = default;
+
+    /*!
+     * Construct Connection to peer from the region of a shared memory file
+     * descriptor at given offset. The lower rank of both sends via the first
+     * Ring of the region. Takes ownership of event_fd and peer_event_fd.
+     */
+    Connection(size_t peer, bool lower, int mem_fd, size_t offset,
+               size_t ring_size, int event_fd, int peer_event_fd);
+
+    //! non-copyable: delete copy-constructor
+    Connection(const Connection&) = delete;
+    //! non-copyable: delete assignment operator
+    Connection& operator = (const Connection&) = delete;
+
+    //! move-constructor
+    Connection(Connection&& other) noexcept {
+        *this = std::move(other);
+    }
+
+    //! move-assignment operator
+    Connection& operator = (Connection&& other) noexcept;
+
+    //! destructor: unmaps the region and closes the eventfds.
+    ~Connection();
+
+    //! \name Base Status Functions
+    //! \{
+
+    bool IsValid() const final { return region_ != nullptr; }
+
+    std::string ToString() const final;
+
+    std::ostream& OutputOstream(std::ostream& os) const final;
+
+    //! \}
+
+    //! \name Send Functions
+    //! \{
+
+    void SyncSend(const void* data, size_t size,
+                  Flags /* flags */ = NoFlags) final;
+
+    ssize_t SendOne(const void* data, size_t size,
+                    Flags /* flags */ = NoFlags) final;
+
+    //! \}
+
+    //! \name Receive Functions
+    //! \{
+
+    void SyncRecv(void* out_data, size_t size) final;
+
+    ssize_t RecvOne(void* out_data, size_t size) final;
+
+    //! data in the inbound ring is not reported by the eventfd. It may only be
+    //! read directly if no earlier reads are queued in the Dispatcher.
+    bool HasBufferedRecv() const final {
+        return !recv_queued_ &&
+               recv_->head.load(std::memory_order_acquire)
+               != recv_->tail.load(std::memory_order_relaxed);
+    }
+
+    //! \}
+
+    //! \name Paired SendReceive Methods
+    //! \{
+
+    void SyncSendRecv(const void* send_data, size_t send_size,
+                      void* recv_data, size_t recv_size) final;
+
+    //! \}
+
+    //! \name Readiness Notification
+    //! \{
+
+    //! eventfd signaled by the peer, watched by shm::Dispatcher.
+    int event_fd() const { return event_fd_; }
+
+    //! Request a signal when data arrives. Returns true if data is already
+    //! available, in which case no signal may come.
+    bool ArmRecv();
+
+    //! Request a signal when space is freed. Returns true if space is already
+    //! available, in which case no signal may come.
+    bool ArmSend();
+
+    //! Drain the counter of our eventfd.
+    void DrainEvents();
+
+    //! Signal our own eventfd, used by the Dispatcher to create an edge.
+    void NotifySelf();
+
+    //! \}
+
+    //! mark both Rings closed, wake up the peer, and release resources.
+    void Close();
+
+    //! return the peer id
+    size_t peer_id() const { return peer_; }
+
+private:
+    //! id of the peer
+    size_t peer_ = size_t(-1);
+
+    //! mapped shared memory region containing both Rings
+    void* region_ = nullptr;
+
+    //! size of the mapped region
+    size_t region_size_ = 0;
+
+    //! capacity of each Ring, a power of two
+    size_t ring_size_ = 0;
+
+    //! outbound Ring, we are the producer
+    Ring* send_ = nullptr;
+
+    //! inbound Ring, we are the consumer
+    Ring* recv_ = nullptr;
+
+    //! eventfd signaled by the peer
+    int event_fd_ = -1;
+
+    //! eventfd of the peer, signaled by us
+    int peer_event_fd_ = -1;
+
+    //! whether read callbacks are queued in a Dispatcher
+    bool recv_queued_ = false;
+
+    //! for access to recv_queued_
+    friend class Dispatcher;
+
+    //! copy as many bytes as fit into the outbound Ring.
+    size_t Produce(const uint8_t* data, size_t size);
+
+    //! copy as many bytes as available from the inbound Ring.
+    size_t Consume(uint8_t* out_data, size_t size);
+
+    //! signal the peer's eventfd
+    void NotifyPeer();
+
+    //! block on our eventfd until the peer signals.
+    void Wait();
+};
+
+//! \}
+
+} // namespace shm
+} // namespace net
+} // namespace thrill
+
+#endif // THRILL_HAVE_NET_SHM
+
+#endif // !THRILL_NET_SHM_CONNECTION_HEADER
+
+/******************************************************************************/
@@ -0,0 +1,375 @@
+/*******************************************************************************
+ * thrill/net/shm/construct.cpp
+ *
+ * Part of Project Thrill - http://project-thrill.org
+ *
+ * All rights reserved. Published under the BSD-2 license in the LICENSE file.
+ ******************************************************************************/
+
+#include <thrill/net/shm/construct.hpp>
+
+#if THRILL_HAVE_NET_SHM
+
+#include <thrill/common/die.hpp>
+#include <thrill/common/logger.hpp>
+
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstddef>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace thrill {
+namespace net {
+namespace shm {
+
+//! \addtogroup net_shm Shared Memory API
+//! \{
+
+class Construction
+{
+    static constexpr bool debug = false;
+
+public:
+    Construction(std::unique_ptr<Group>* groups, size_t group_count,
+                 size_t ring_size)
+        : groups_(groups), group_count_(group_count), ring_size_(ring_size),
+          region_size_(Ring::RegionSize(ring_size))
+    { }
+
+    /*!
+     * Connect to all peers with peers[i] set: the higher rank connects to the
+     * lower rank, creates the shared memory file and passes it with its
+     * eventfds. The lower rank answers with its eventfds.
+     */
+    void Initialize(size_t my_rank, const std::vector<std::string>& endpoints,
+                    const std::vector<bool>& peers) {
+        die_unless(my_rank < endpoints.size());
+        die_unless(peers.size() == endpoints.size());
+        if (ring_size_ < 4096 || (ring_size_ & (ring_size_ - 1)) != 0)
+            throw Exception("shm::Construct() ring size must be a power of "
+                            "two of at least 4 KiB");
+
+        my_rank_ = my_rank;
+        num_hosts_ = endpoints.size();
+        peers_ = peers;
+
+        for (size_t g = 0; g < group_count_; ++g)
+            groups_[g] = std::make_unique<Group>(my_rank, num_hosts_);
+
+        // listen first, such that higher ranks can connect early.
+        int listen_fd = Listen(endpoints[my_rank]);
+
+        for (size_t peer = 0; peer < my_rank; ++peer) {
+            if (!peers_[peer]) continue;
+            int fd = ConnectPeer(peer, endpoints[peer]);
+            InitiatePeer(fd, peer);
+            ::close(fd);
+        }
+
+        for (size_t i = my_rank + 1; i < num_hosts_; ++i) {
+            if (!peers_[i]) continue;
+            int fd;
+            while ((fd = accept4(listen_fd, nullptr, nullptr,
+                                 SOCK_CLOEXEC)) < 0) {
+                if (errno != EINTR)
+                    throw Exception("shm::Construct() accept() failed", errno);
+            }
+            AnswerPeer(fd);
+            ::close(fd);
+        }
+
+        ::close(listen_fd);
+    }
+
+private:
+    //! array of Groups to construct
+    std::unique_ptr<Group>* groups_;
+
+    //! number of Groups
+    size_t group_count_;
+
+    //! capacity of each Ring
+    size_t ring_size_;
+
+    //! size of the shared region of one Connection
+    size_t region_size_;
+
+    //! our rank
+    size_t my_rank_ = 0;
+
+    //! number of processes
+    size_t num_hosts_ = 0;
+
+    //! mask of peers to connect to
+    std::vector<bool> peers_;
+
+    //! start connect backoff at 10msec
+    const size_t initial_timeout_ = 10;
+
+    //! maximum connect backoff, after which the program fails. Total waiting
+    //! time is about 2 * final_timeout_ (in millisec).
+    const size_t final_timeout_ = 40960;
+
+    //! message exchanged with the file descriptors during construction.
+    struct HelloMsg {
+        //! the Thrill signature flag.
+        uint64_t thrill_sign;
+        //! rank of the sender
+        uint64_t rank;
+        //! number of Groups, must match
+        uint64_t group_count;
+        //! capacity of each Ring, must match
+        uint64_t ring_size;
+    };
+
+    //! A sentinel value which identifies the shm construction protocol.
+    static const uint64_t thrill_sign = 0x0C7A0C7AD5D5D5D5;
+
+    //! fill sockaddr_un with an abstract name derived from the endpoint.
+    static socklen_t MakeAddress(const std::string& endpoint,
+                                 struct sockaddr_un* sa) {
+        std::string name = "thrill-shm:" + endpoint;
+        if (name.size() + 1 > sizeof(sa->sun_path))
+            throw Exception("shm::Construct() endpoint name too long: "
+                            + endpoint);
+
+        memset(sa, 0, sizeof(*sa));
+        sa->sun_family = AF_UNIX;
+        // a leading zero selects Linux's abstract socket namespace.
+        std::copy(name.begin(), name.end(), sa->sun_path + 1);
+        return static_cast<socklen_t>(
+            offsetof(struct sockaddr_un, sun_path) + 1 + name.size());
+    }
+
+    static int CreateSocket() {
+        int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        if (fd < 0)
+            throw Exception("shm::Construct() could not create socket", errno);
+        return fd;
+    }
+
+    int Listen(const std::string& endpoint) {
+        struct sockaddr_un sa;
+        socklen_t len = MakeAddress(endpoint, &sa);
+
+        int fd = CreateSocket();
+        if (bind(fd, reinterpret_cast<struct sockaddr*>(&sa), len) != 0)
+            throw Exception("shm::Construct() could not bind to "
+                            + endpoint, errno);
+        if (listen(fd, static_cast<int>(num_hosts_)) != 0)
+            throw Exception("shm::Construct() could not listen on "
+                            + endpoint, errno);
+        return fd;
+    }
+
+    //! connect to a lower rank, retrying with exponential backoff until it
+    //! listens.
+    int ConnectPeer(size_t peer, const std::string& endpoint) {
+        struct sockaddr_un sa;
+        socklen_t len = MakeAddress(endpoint, &sa);
+
+        for (size_t timeout = initial_timeout_; ; timeout *= 2) {
+            int fd = CreateSocket();
+            if (connect(fd, reinterpret_cast<struct sockaddr*>(&sa), len) == 0)
+                return fd;
+
+            int err = errno;
+            ::close(fd);
+
+            if (err != ECONNREFUSED && err != ENOENT && err != EINTR)
+                throw Exception("shm::Construct() could not connect to "
+                                + endpoint, err);
+            if (timeout >= final_timeout_)
+                throw Exception("Timeout error connecting to client "
+                                + std::to_string(peer) + " via " + endpoint);
+
+            LOG << "shm::Construct() connect to " << endpoint
+                << " failed, retrying in " << timeout << " ms";
+            std::this_thread::sleep_for(std::chrono::milliseconds(timeout));
+        }
+    }
+
+    //! send HelloMsg with file descriptors attached as SCM_RIGHTS.
+    static void SendHello(int sock, const HelloMsg& hello,
+                          const std::vector<int>& fds) {
+        size_t fds_size = fds.size() * sizeof(int);
+        std::vector<struct cmsghdr> control(
+            (CMSG_SPACE(fds_size) + sizeof(struct cmsghdr) - 1)
+            / sizeof(struct cmsghdr));
+
+        struct iovec iov;
+        iov.iov_base = const_cast<HelloMsg*>(&hello);
+        iov.iov_len = sizeof(hello);
+
+        struct msghdr msg;
+        memset(&msg, 0, sizeof(msg));
+        msg.msg_iov = &iov;
+        msg.msg_iovlen = 1;
+        msg.msg_control = control.data();
+        msg.msg_controllen = CMSG_SPACE(fds_size);
+
+        struct cmsghdr* cm = CMSG_FIRSTHDR(&msg);
+        cm->cmsg_level = SOL_SOCKET;
+        cm->cmsg_type = SCM_RIGHTS;
+        cm->cmsg_len = CMSG_LEN(fds_size);
+        memcpy(CMSG_DATA(cm), fds.data(), fds_size);
+
+        ssize_t r;
+        while ((r = sendmsg(sock, &msg, MSG_NOSIGNAL)) < 0 &&
+               errno == EINTR) { }
+        if (r != static_cast<ssize_t>(sizeof(hello)))
+            throw Exception("shm::Construct() error sending hello", errno);
+    }
+
+    //! receive HelloMsg and exactly fd_count file descriptors.
+    std::vector<int> RecvHello(int sock, HelloMsg* hello, size_t fd_count) {
+        size_t fds_size = fd_count * sizeof(int);
+        std::vector<struct cmsghdr> control(
+            (CMSG_SPACE(fds_size) + sizeof(struct cmsghdr) - 1)
+            / sizeof(struct cmsghdr));
+
+        struct iovec iov;
+        iov.iov_base = hello;
+        iov.iov_len = sizeof(*hello);
+
+        struct msghdr msg;
+        memset(&msg, 0, sizeof(msg));
+        msg.msg_iov = &iov;
+        msg.msg_iovlen = 1;
+        msg.msg_control = control.data();
+        msg.msg_controllen = CMSG_SPACE(fds_size);
+
+        ssize_t r;
+        while ((r = recvmsg(sock, &msg, MSG_CMSG_CLOEXEC | MSG_WAITALL)) < 0 &&
+               errno == EINTR) { }
+        if (r != static_cast<ssize_t>(sizeof(*hello)))
+            throw Exception("shm::Construct() error receiving hello", errno);
+
+        struct cmsghdr* cm = CMSG_FIRSTHDR(&msg);
+        if (!cm || cm->cmsg_level != SOL_SOCKET ||
+            cm->cmsg_type != SCM_RIGHTS ||
+            cm->cmsg_len != CMSG_LEN(fds_size) ||
+            (msg.msg_flags & MSG_CTRUNC))
+            throw Exception("shm::Construct() hello without file descriptors");
+
+        std::vector<int> fds(fd_count);
+        memcpy(fds.data(), CMSG_DATA(cm), fds_size);
+
+        if (hello->thrill_sign != thrill_sign ||
+            hello->group_count != group_count_ ||
+            hello->ring_size != ring_size_ ||
+            hello->rank >= num_hosts_)
+            throw Exception("shm::Construct() received invalid hello");
+
+        return fds;
+    }
+
+    //! create one eventfd per Group
+    std::vector<int> CreateEventFds() {
+        std::vector<int> fds(group_count_);
+        for (size_t g = 0; g < group_count_; ++g) {
+            fds[g] = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+            if (fds[g] < 0)
+                throw Exception("shm::Construct() could not create eventfd",
+                                errno);
+        }
+        return fds;
+    }
+
+    //! map the Groups' regions and assign the Connections.
+    void AssignConnections(size_t peer, int mem_fd,
+                           const std::vector<int>& event_fds,
+                           const std::vector<int>& peer_event_fds) {
+        for (size_t g = 0; g < group_count_; ++g) {
+            groups_[g]->AssignConnection(
+                Connection(peer, /* lower */ my_rank_ < peer,
+                           mem_fd, g * region_size_, ring_size_,
+                           event_fds[g], peer_event_fds[g]));
+        }
+        LOG << "shm::Construct() rank " << my_rank_
+            << " connected to peer " << peer;
+    }
+
+    //! as higher rank: create the shared memory and send it to the peer.
+    void InitiatePeer(int sock, size_t peer) {
+        int mem_fd = memfd_create("thrill-shm", MFD_CLOEXEC);
+        if (mem_fd < 0)
+            throw Exception("shm::Construct() could not create memfd", errno);
+        if (ftruncate(mem_fd, static_cast<off_t>(
+                          group_count_ * region_size_)) != 0)
+            throw Exception("shm::Construct() could not resize memfd", errno);
+
+        std::vector<int> event_fds = CreateEventFds();
+
+        std::vector<int> fds = { mem_fd };
+        fds.insert(fds.end(), event_fds.begin(), event_fds.end());
+
+        HelloMsg hello = { thrill_sign, my_rank_, group_count_, ring_size_ };
+        SendHello(sock, hello, fds);
+
+        HelloMsg reply;
+        std::vector<int> peer_event_fds = RecvHello(sock, &reply, group_count_);
+        if (reply.rank != peer)
+            throw Exception("shm::Construct() connected to wrong peer "
+                            + std::to_string(reply.rank));
+
+        AssignConnections(peer, mem_fd, event_fds, peer_event_fds);
+        ::close(mem_fd);
+    }
+
+    //! as lower rank: receive the shared memory and answer with eventfds.
+    void AnswerPeer(int sock) {
+        HelloMsg hello;
+        std::vector<int> fds = RecvHello(sock, &hello, 1 + group_count_);
+        size_t peer = hello.rank;
+        if (peer <= my_rank_ || !peers_[peer] ||
+            groups_[0]->shm_connection(peer).IsValid())
+            throw Exception("shm::Construct() unexpected peer "
+                            + std::to_string(peer));
+
+        int mem_fd = fds[0];
+        std::vector<int> peer_event_fds(fds.begin() + 1, fds.end());
+        std::vector<int> event_fds = CreateEventFds();
+
+        HelloMsg reply = { thrill_sign, my_rank_, group_count_, ring_size_ };
+        SendHello(sock, reply, event_fds);
+
+        AssignConnections(peer, mem_fd, event_fds, peer_event_fds);
+        ::close(mem_fd);
+    }
+};
+
+void Construct(size_t my_rank, const std::vector<std::string>& endpoints,
+               std::unique_ptr<Group>* groups, size_t group_count,
+               size_t ring_size) {
+    Construction(groups, group_count, ring_size).Initialize(
+        my_rank, endpoints, std::vector<bool>(endpoints.size(), true));
+}
+
+void Construct(size_t my_rank, const std::vector<std::string>& endpoints,
+               const std::vector<bool>& peers,
+               std::unique_ptr<Group>* groups, size_t group_count,
+               size_t ring_size) {
+    Construction(groups, group_count, ring_size).Initialize(
+        my_rank, endpoints, peers);
+}
+
+//! \}
+
+} // namespace shm
+} // namespace net
+} // namespace thrill
+
+#endif // THRILL_HAVE_NET_SHM
+
+/******************************************************************************/
@@ -0,0 +1,61 @@
+/*******************************************************************************
+ * thrill/net/shm/construct.hpp
+ *
+ * Part of Project Thrill - http://project-thrill.org
+ *
+ * All rights reserved. Published under the BSD-2 license in the LICENSE file.
+ ******************************************************************************/
+
+#pragma once
+#ifndef THRILL_NET_SHM_CONSTRUCT_HEADER
+#define THRILL_NET_SHM_CONSTRUCT_HEADER
+
+#include <thrill/net/shm/group.hpp>
+
+#if THRILL_HAVE_NET_SHM
+
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace thrill {
+namespace net {
+namespace shm {
+
+//! \addtogroup net_shm Shared Memory API
+//! \{
+
+/*!
+ * Connect to peer processes on the same host via shared memory. Construct
+ * group_count shm::Group objects at once. Within each Group this host has
+ * my_rank. The endpoints are only used as unique rendezvous names: each
+ * process listens on an abstract Unix domain socket named after its endpoint,
+ * via which the shared memory regions and eventfds are passed to the peers.
+ */
+void Construct(size_t my_rank,
+               const std::vector<std::string>& endpoints,
+               std::unique_ptr<Group>* groups, size_t group_count,
+               size_t ring_size = Connection::default_ring_size);
+
+/*!
+ * Connect via shared memory only to the peers with peers[i] set, the
+ * Connections to all others remain invalid. The mask must be symmetric among
+ * all processes.
+ */
+void Construct(size_t my_rank,
+               const std::vector<std::string>& endpoints,
+               const std::vector<bool>& peers,
+               std::unique_ptr<Group>* groups, size_t group_count,
+               size_t ring_size = Connection::default_ring_size);
+
+//! \}
+
+} // namespace shm
+} // namespace net
+} // namespace thrill
+
+#endif // THRILL_HAVE_NET_SHM
+
+#endif // !THRILL_NET_SHM_CONSTRUCT_HEADER
+
+/******************************************************************************/
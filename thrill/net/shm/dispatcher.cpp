@@ -0,0 +1,200 @@
+/*******************************************************************************
+ * thrill/net/shm/dispatcher.cpp
+ *
+ * Part of Project Thrill - http://project-thrill.org
+ *
+ * All rights reserved. Published under the BSD-2 license in the LICENSE file.
+ ******************************************************************************/
+
+#include <thrill/net/shm/dispatcher.hpp>
+
+#if THRILL_HAVE_NET_SHM
+
+#include <thrill/common/die.hpp>
+
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+#include <cerrno>
+
+namespace thrill {
+namespace net {
+namespace shm {
+
+Dispatcher::Dispatcher(mem::Manager& mem_manager)
+    : net::Dispatcher(mem_manager) {
+
+    epoll_fd_ = epoll_create1(EPOLL_CLOEXEC);
+    if (epoll_fd_ < 0)
+        throw Exception("shm::Dispatcher() could not create epoll fd", errno);
+
+    event_fd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (event_fd_ < 0)
+        throw Exception("shm::Dispatcher() could not create eventfd", errno);
+
+    // wait for interrupts via eventfd.
+    struct epoll_event ev;
+    ev.events = EPOLLIN | EPOLLET;
+    ev.data.fd = event_fd_;
+    if (epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, event_fd_, &ev) != 0)
+        throw Exception("shm::Dispatcher() could not register eventfd", errno);
+}
+
+Dispatcher::~Dispatcher() {
+    ::close(event_fd_);
+    ::close(epoll_fd_);
+}
+
+Dispatcher::Watch& Dispatcher::GetWatch(Connection& c) {
+    int fd = c.event_fd();
+    assert(fd >= 0);
+    if (static_cast<size_t>(fd) >= watch_.size())
+        watch_.resize(fd + 1, Watch(mem_manager_));
+
+    Watch& w = watch_[fd];
+    if (w.conn == nullptr) {
+        struct epoll_event ev;
+        ev.events = EPOLLIN | EPOLLET;
+        ev.data.fd = fd;
+        if (epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, fd, &ev) != 0 &&
+            errno != EEXIST)
+            throw Exception("shm::Dispatcher() epoll_ctl() failed", errno);
+        w.conn = &c;
+    }
+    return w;
+}
+
+void Dispatcher::AddRead(net::Connection& _c, const Callback& read_cb) {
+    assert(dynamic_cast<Connection*>(&_c));
+    Connection& c = static_cast<Connection&>(_c);
+
+    Watch& w = GetWatch(c);
+    bool arm = w.read_cb.empty();
+    w.read_cb.emplace_back(read_cb);
+    c.recv_queued_ = true;
+    if (arm && c.ArmRecv()) c.NotifySelf();
+}
+
+void Dispatcher::AddWrite(net::Connection& _c, const Callback& write_cb) {
+    assert(dynamic_cast<Connection*>(&_c));
+    Connection& c = static_cast<Connection&>(_c);
+
+    Watch& w = GetWatch(c);
+    bool arm = w.write_cb.empty();
+    w.write_cb.emplace_back(write_cb);
+    if (arm && c.ArmSend()) c.NotifySelf();
+}
+
+void Dispatcher::Cancel(net::Connection& _c) {
+    assert(dynamic_cast<Connection*>(&_c));
+    Connection& c = static_cast<Connection&>(_c);
+    int fd = c.event_fd();
+
+    if (fd < 0 || static_cast<size_t>(fd) >= watch_.size() ||
+        watch_[fd].conn == nullptr) {
+        LOG << "shm::Dispatcher::Cancel() fd=" << fd
+            << " called with no callbacks registered.";
+        return;
+    }
+
+    Watch& w = watch_[fd];
+    struct epoll_event ev;
+    if (epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, fd, &ev) != 0 &&
+        errno != ENOENT && errno != EBADF)
+        throw Exception("shm::Dispatcher() epoll_ctl() failed", errno);
+
+    w.read_cb.clear();
+    w.write_cb.clear();
+    w.conn = nullptr;
+    c.recv_queued_ = false;
+}
+
+bool Dispatcher::HasAsyncWrites() const {
+    if (net::Dispatcher::HasAsyncWrites()) return true;
+
+    for (const Watch& w : watch_) {
+        if (!w.write_cb.empty()) return true;
+    }
+    return false;
+}
+
+void Dispatcher::RunQueue(int fd, mem::deque<Callback> Watch::* queue) {
+    // the watch_ table may be regrown when callback handlers are called, hence
+    // the Watch object must be looked up again after each callback.
+    while (!(watch_[fd].*queue).empty() &&
+           (watch_[fd].*queue).front()() == false) {
+        (watch_[fd].*queue).pop_front();
+    }
+}
+
+void Dispatcher::DispatchOne(const std::chrono::milliseconds& timeout) {
+    Poll(timeout);
+}
+
+void Dispatcher::DispatchPending() {
+    while (Poll(std::chrono::milliseconds(0)) != 0) { }
+}
+
+int Dispatcher::Poll(const std::chrono::milliseconds& timeout) {
+
+    LOG << "Performing epoll_wait() on " << watch_.size() << " eventfds";
+
+    int r = epoll_wait(epoll_fd_, events_.data(),
+                       static_cast<int>(events_.size()),
+                       static_cast<int>(timeout.count()));
+
+    if (r < 0) {
+        // if we caught a signal, this is intended to interrupt epoll_wait().
+        if (errno == EINTR) return 0;
+
+        throw Exception("shm::Dispatcher::Poll() epoll_wait() failed!",
+                        errno);
+    }
+
+    for (int i = 0; i < r; ++i)
+    {
+        int fd = events_[i].data.fd;
+
+        if (fd == event_fd_) {
+            uint64_t counter;
+            while (read(event_fd_, &counter, sizeof(counter)) > 0) { }
+            continue;
+        }
+
+        if (static_cast<size_t>(fd) >= watch_.size() ||
+            watch_[fd].conn == nullptr)
+            continue;
+
+        // reset the counter first: later signals create new edges.
+        watch_[fd].conn->DrainEvents();
+
+        RunQueue(fd, &Watch::read_cb);
+        if (watch_[fd].read_cb.empty())
+            watch_[fd].conn->recv_queued_ = false;
+        RunQueue(fd, &Watch::write_cb);
+    }
+
+    // if the event buffer was filled, enlarge it for the next round.
+    if (static_cast<size_t>(r) == events_.size())
+        events_.resize(2 * events_.size());
+
+    return r;
+}
+
+void Dispatcher::Interrupt() {
+    // add one to the eventfd counter to wake up epoll_wait().
+    uint64_t one = 1;
+    ssize_t wb;
+    while ((wb = write(event_fd_, &one, sizeof(one))) < 0 && errno == EINTR) {
+        LOG1 << "WakeUp: error sending to eventfd: " << errno;
+    }
+    die_unless(wb == sizeof(one));
+}
+
+} // namespace shm
+} // namespace net
+} // namespace thrill
+
+#endif // THRILL_HAVE_NET_SHM
+
+/******************************************************************************/
@@ -0,0 +1,142 @@
+/*******************************************************************************
+ * thrill/net/shm/dispatcher.hpp
+ *
+ * Asynchronous callback wrapper around epoll() on the eventfds of
+ * shm::Connections.
+ *
+ * Part of Project Thrill - http://project-thrill.org
+ *
+ * All rights reserved. Published under the BSD-2 license in the LICENSE file.
+ ******************************************************************************/
+
+#pragma once
+#ifndef THRILL_NET_SHM_DISPATCHER_HEADER
+#define THRILL_NET_SHM_DISPATCHER_HEADER
+
+#include <thrill/common/config.hpp>
+
+#if THRILL_HAVE_NET_SHM
+
+#include <thrill/common/logger.hpp>
+#include <thrill/mem/allocator.hpp>
+#include <thrill/net/dispatcher.hpp>
+#include <thrill/net/shm/connection.hpp>
+
+#include <sys/epoll.h>
+
+#include <chrono>
+
+namespace thrill {
+namespace net {
+namespace shm {
+
+//! \addtogroup net_shm Shared Memory API
+//! \{
+
+/*!
+ * Dispatcher for shm::Connections, which waits with epoll() on the eventfds
+ * signaled by the peers. The eventfds are registered edge-triggered, and every
+ * signal by a peer creates a new edge, which runs the read and the write
+ * callbacks of the Connection: the eventfd does not tell which direction made
+ * progress.
+ *
+ * As with tcp::EPollDispatcher, a callback returns true only after a short
+ * transfer, which armed the waiting flag of its Ring, hence the peer will
+ * signal again. When a callback queue was empty, the Ring state is unknown to
+ * the peer, and AddRead() or AddWrite() signal the eventfd themselves if the
+ * Ring is already ready.
+ */
+class Dispatcher final : public net::Dispatcher
+{
+    static constexpr bool debug = false;
+
+public:
+    //! type for file descriptor readiness callbacks
+    using Callback = AsyncCallback;
+
+    //! constructor
+    explicit Dispatcher(mem::Manager& mem_manager);
+
+    //! destructor
+    ~Dispatcher();
+
+    //! non-copyable: delete copy-constructor
+    Dispatcher(const Dispatcher&) = delete;
+    //! non-copyable: delete assignment operator
+    Dispatcher& operator = (const Dispatcher&) = delete;
+
+    //! Register a buffered read callback.
+    void AddRead(net::Connection& c, const Callback& read_cb) final;
+
+    //! Register a buffered write callback.
+    void AddWrite(net::Connection& c, const Callback& write_cb) final;
+
+    //! Cancel all callbacks on a given Connection.
+    void Cancel(net::Connection& c) final;
+
+    //! Check whether there are still AsyncWrite()s queued.
+    bool HasAsyncWrites() const final;
+
+    //! Run one iteration of dispatching epoll_wait().
+    void DispatchOne(const std::chrono::milliseconds& timeout) final;
+
+    //! Interrupt the current epoll_wait() via eventfd
+    void Interrupt() final;
+
+    //! epoll file descriptor, which is readable while events are pending. This
+    //! allows nesting the Dispatcher in another epoll loop.
+    int epoll_fd() const { return epoll_fd_; }
+
+    //! Run callbacks of pending events without blocking, until none are left.
+    void DispatchPending();
+
+private:
+    //! epoll file descriptor
+    int epoll_fd_;
+
+    //! eventfd to wake up epoll_wait().
+    int event_fd_;
+
+    //! callback queues per watched Connection
+    struct Watch {
+        //! Connection, if the eventfd is registered with epoll.
+        Connection           * conn = nullptr;
+        //! queue of callbacks for the Connection.
+        mem::deque<Callback> read_cb, write_cb;
+
+        explicit Watch(mem::Manager& mem_manager)
+            : read_cb(mem::Allocator<Callback>(mem_manager)),
+              write_cb(mem::Allocator<Callback>(mem_manager)) { }
+    };
+
+    //! handlers for all registered Connections, indexed by eventfd.
+    mem::vector<Watch> watch_ { mem::Allocator<Watch>(mem_manager_) };
+
+    //! buffer for events returned by epoll_wait()
+    mem::vector<struct epoll_event> events_ {
+        64, mem::Allocator<struct epoll_event>(mem_manager_)
+    };
+
+    //! Look up the Watch of a Connection, registering its eventfd on first use
+    Watch& GetWatch(Connection& c);
+
+    //! Wait for events for at most timeout and run their callbacks. Returns
+    //! the number of events processed.
+    int Poll(const std::chrono::milliseconds& timeout);
+
+    //! Run callbacks of a queue until one returns true (in which case it wants
+    //! to be called again) or the queue is empty.
+    void RunQueue(int fd, mem::deque<Callback> Watch::* queue);
+};
+
+//! \}
+
+} // namespace shm
+} // namespace net
+} // namespace thrill
+
+#endif // THRILL_HAVE_NET_SHM
+
+#endif // !THRILL_NET_SHM_DISPATCHER_HEADER
+
+/******************************************************************************/
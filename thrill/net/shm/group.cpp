@@ -0,0 +1,74 @@
+/*******************************************************************************
+ * thrill/net/shm/group.cpp
+ *
+ * Part of Project Thrill - http://project-thrill.org
+ *
+ * All rights reserved. Published under the BSD-2 license in the LICENSE file.
+ ******************************************************************************/
+
+#include <thrill/net/shm/group.hpp>
+
+#if THRILL_HAVE_NET_SHM
+
+#include <thrill/net/shm/construct.hpp>
+#include <thrill/net/shm/dispatcher.hpp>
+
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace thrill {
+namespace net {
+namespace shm {
+
+std::unique_ptr<net::Dispatcher>
+Group::ConstructDispatcher(mem::Manager& mem_manager) const {
+    return std::make_unique<Dispatcher>(mem_manager);
+}
+
+std::vector<std::unique_ptr<Group> >
+Group::ConstructLoopbackMesh(size_t num_hosts, size_t ring_size) {
+
+    // randomize rendezvous names for concurrent tests
+    std::default_random_engine generator(std::random_device { } ());
+    std::uniform_int_distribution<uint64_t> distribution;
+    std::string prefix = "loopback-" + std::to_string(distribution(generator));
+
+    std::vector<std::string> endpoints;
+    for (size_t i = 0; i < num_hosts; ++i)
+        endpoints.push_back(prefix + "-" + std::to_string(i));
+
+    // we have to create and run threads to construct Group because the
+    // handshakes are synchronous.
+
+    std::vector<std::unique_ptr<Group> > groups(num_hosts);
+    std::vector<std::thread> threads(num_hosts);
+
+    for (size_t i = 0; i < num_hosts; i++) {
+        threads[i] = std::thread(
+            [i, ring_size, &endpoints, &groups]() {
+                Construct(i, endpoints, groups.data() + i, 1, ring_size);
+            });
+    }
+
+    for (size_t i = 0; i < num_hosts; i++) {
+        threads[i].join();
+    }
+
+    for (size_t i = 0; i < num_hosts; i++) {
+        for (size_t j = 0; j < num_hosts; j++) {
+            if (i != j) groups[i]->connections_[j].is_loopback_ = true;
+        }
+    }
+
+    return groups;
+}
+
+} // namespace shm
+} // namespace net
+} // namespace thrill
+
+#endif // THRILL_HAVE_NET_SHM
+
+/******************************************************************************/
@@ -0,0 +1,116 @@
+/*******************************************************************************
+ * thrill/net/shm/group.hpp
+ *
+ * Part of Project Thrill - http://project-thrill.org
+ *
+ * All rights reserved. Published under the BSD-2 license in the LICENSE file.
+ ******************************************************************************/
+
+#pragma once
+#ifndef THRILL_NET_SHM_GROUP_HEADER
+#define THRILL_NET_SHM_GROUP_HEADER
+
+#include <thrill/common/config.hpp>
+
+#if THRILL_HAVE_NET_SHM
+
+#include <thrill/net/group.hpp>
+#include <thrill/net/shm/connection.hpp>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace thrill {
+namespace net {
+namespace shm {
+
+//! \addtogroup net_shm Shared Memory API
+//! \{
+
+/*!
+ * Collection of shm::Connections to processes on the same host. The
+ * Connections are established by Construct(), which exchanges the shared
+ * memory regions and eventfds via Unix domain sockets.
+ */
+class Group final : public net::Group
+{
+    static constexpr bool debug = false;
+
+public:
+    //! \name Construction and Initialization
+    //! \{
+
+    /*!
+     * Construct a test network with shm::Connections between threads of this
+     * process, which are established via Construct() with random rendezvous
+     * names. Returns vector of Groups for each virtual client.
+     */
+    static std::vector<std::unique_ptr<Group> > ConstructLoopbackMesh(
+        size_t num_hosts, size_t ring_size = Connection::default_ring_size);
+
+    //! Initializing constructor, used by Construct().
+    Group(size_t my_rank, size_t group_size)
+        : net::Group(my_rank),
+          connections_(group_size) { }
+
+    //! \}
+
+    //! \name Status and Access to Connections
+    //! \{
+
+    //! Return Connection to client id.
+    Connection& shm_connection(size_t id) {
+        if (id >= connections_.size())
+            throw Exception("Group::Connection() requested "
+                            "invalid client id " + std::to_string(id));
+
+        if (id == my_rank_)
+            throw Exception("Group::Connection() requested "
+                            "connection to self.");
+
+        return connections_[id];
+    }
+
+    net::Connection& connection(size_t id) final {
+        return shm_connection(id);
+    }
+
+    //! Assign the Connection to its peer id.
+    void AssignConnection(Connection&& connection) {
+        size_t peer = connection.peer_id();
+        connections_.at(peer) = std::move(connection);
+    }
+
+    //! Return number of connections in this group (= number computing hosts)
+    size_t num_hosts() const final {
+        return connections_.size();
+    }
+
+    //! Closes all Connections
+    void Close() final {
+        for (Connection& c : connections_) c.Close();
+    }
+
+    //! Construct a shm::Dispatcher.
+    std::unique_ptr<net::Dispatcher> ConstructDispatcher(
+        mem::Manager& mem_manager) const final;
+
+    //! \}
+
+private:
+    //! Connections to all peers, the one to ourself is invalid.
+    std::vector<Connection> connections_;
+};
+
+//! \}
+
+} // namespace shm
+} // namespace net
+} // namespace thrill
+
+#endif // THRILL_HAVE_NET_SHM
+
+#endif // !THRILL_NET_SHM_GROUP_HEADER
+
+/******************************************************************************/
@@ -0,0 +1,308 @@
+/*******************************************************************************
+ * thrill/net/tcp/connection.cpp
+ *
+ * Send queue and read-ahead buffer of tcp::Connection.
+ *
+ * Part of Project Thrill - http://project-thrill.org
+ *
+ * All rights reserved. Published under the BSD-2 license in the LICENSE file.
+ ******************************************************************************/
+
+#include <thrill/common/defines.hpp>
+#include <thrill/net/tcp/connection.hpp>
+
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+
+#if __linux__
+#include <linux/errqueue.h>
+#endif
+
+#include <algorithm>
+#include <cstring>
+
+#if __linux__ && defined(SO_ZEROCOPY) && defined(MSG_ZEROCOPY) && \
+    defined(SO_EE_ORIGIN_ZEROCOPY)
+#define THRILL_NET_TCP_ZEROCOPY 1
+#else
+#define THRILL_NET_TCP_ZEROCOPY 0
+#endif
+
+namespace thrill {
+namespace net {
+namespace tcp {
+
+/******************************************************************************/
+// Batched Asynchronous Writes
+
+Connection::SendAction Connection::EnqueueWrite(
+    Buffer&& buffer, data::PinnedBlock&& block,
+    const AsyncWriteCallback& done_cb) {
+    assert(IsValid());
+
+    if (buffer.size() == 0 && block.size() == 0) {
+        if (done_cb) done_cb(*this);
+        return SendAction::None;
+    }
+
+    bool was_empty = send_queue_.empty();
+    send_queue_.emplace_back(std::move(buffer), std::move(block), done_cb);
+
+    if (!send_registered_) {
+        send_registered_ = true;
+        return SendAction::Register;
+    }
+    return was_empty ? SendAction::Rearm : SendAction::None;
+}
+
+bool Connection::SendQueued() {
+#if __APPLE__
+    // MacOSX has no MSG_DONTWAIT
+    SetNonBlocking(true);
+#endif
+    if (zerocopy_min_size_ != 0) ReapZeroCopy();
+
+    struct iovec iov[max_iovec_];
+
+    while (!send_queue_.empty())
+    {
+        // gather the unsent pieces of as many SendItems as fit into iov
+        size_t iovcnt = 0, total = 0, skip = send_pos_;
+
+        auto add_piece =
+            [&](const uint8_t* data, size_t size) {
+                if (skip >= size) {
+                    skip -= size;
+                    return;
+                }
+                iov[iovcnt].iov_base = const_cast<uint8_t*>(data + skip);
+                iov[iovcnt].iov_len = size - skip;
+                total += size - skip;
+                ++iovcnt;
+                skip = 0;
+            };
+
+        SendQueue::iterator it = send_queue_.begin();
+        for ( ; it != send_queue_.end() && iovcnt + 2 <= max_iovec_; ++it) {
+            add_piece(it->buffer.data(), it->buffer.size());
+            if (it->block.size() != 0)
+                add_piece(it->block.data_begin(), it->block.size());
+        }
+
+        int flags = MSG_DONTWAIT;
+        if (it != send_queue_.end()) flags |= MSG_MORE;
+
+        bool zerocopy =
+            (zerocopy_min_size_ != 0 && total >= zerocopy_min_size_);
+#if THRILL_NET_TCP_ZEROCOPY
+        if (zerocopy) flags |= MSG_ZEROCOPY;
+#endif
+
+        ssize_t r = socket_.sendmsg_one(iov, iovcnt, flags);
+
+        if (r <= 0) {
+            if (errno == EINTR || errno == EAGAIN) return true;
+
+#if THRILL_NET_TCP_ZEROCOPY
+            // the kernel may refuse to pin more pages, then copy instead.
+            if (zerocopy && errno == ENOBUFS) {
+                r = socket_.sendmsg_one(iov, iovcnt, flags & ~MSG_ZEROCOPY);
+                zerocopy = false;
+            }
+#endif
+
+            if (r <= 0) {
+                if (errno == EINTR || errno == EAGAIN) return true;
+
+                if (errno == EPIPE) {
+                    AbortSendQueue();
+                    break;
+                }
+                throw Exception("tcp::Connection::SendQueued() error in "
+                                "sendmsg() on connection " + ToString(),
+                                errno);
+            }
+        }
+
+        tx_bytes_ += r;
+        uint32_t zerocopy_id = zerocopy ? zerocopy_next_++ : 0;
+
+        // advance the queue over the bytes sent and deliver callbacks
+        size_t n = static_cast<size_t>(r);
+        while (n != 0)
+        {
+            SendItem& front = send_queue_.front();
+            if (zerocopy) {
+                front.zerocopy = true;
+                front.zerocopy_id = zerocopy_id;
+            }
+
+            size_t remaining = front.size() - send_pos_;
+            if (n < remaining) {
+                send_pos_ += n;
+                break;
+            }
+            n -= remaining;
+            send_pos_ = 0;
+
+            SendItem item = std::move(front);
+            send_queue_.pop_front();
+
+            // the callback may enqueue further writes.
+            AsyncWriteCallback callback = item.callback;
+            if (item.zerocopy)
+                zerocopy_pending_.emplace_back(std::move(item));
+            if (callback) callback(*this);
+        }
+
+        // short write: the socket buffer is full
+        if (static_cast<size_t>(r) < total) return true;
+    }
+
+    if (!zerocopy_pending_.empty()) {
+        ReapZeroCopy();
+        // keep the callback registered: EPOLLERR signals completions.
+        if (!zerocopy_pending_.empty()) return true;
+    }
+
+    send_registered_ = false;
+    return false;
+}
+
+void Connection::AbortSendQueue() {
+    LOG1 << "tcp::Connection::SendQueued() got SIGPIPE";
+
+    send_pos_ = 0;
+    while (!send_queue_.empty()) {
+        AsyncWriteCallback callback = send_queue_.front().callback;
+        send_queue_.pop_front();
+        if (callback) callback(*this);
+    }
+}
+
+void Connection::EnableZeroCopy(size_t min_size) {
+    if (zerocopy_enabled_) return;
+    zerocopy_enabled_ = true;
+
+#if THRILL_NET_TCP_ZEROCOPY
+    if (socket_.SetZeroCopy(true))
+        zerocopy_min_size_ = std::max<size_t>(min_size, 1);
+#else
+    common::UNUSED(min_size);
+#endif
+}
+
+void Connection::ReapZeroCopy() {
+#if THRILL_NET_TCP_ZEROCOPY
+    char control[256];
+
+    while (true)
+    {
+        struct msghdr msg;
+        memset(&msg, 0, sizeof(msg));
+        msg.msg_control = control;
+        msg.msg_controllen = sizeof(control);
+
+        if (::recvmsg(socket_.fd(), &msg, MSG_ERRQUEUE | MSG_DONTWAIT) < 0)
+            break;
+
+        for (struct cmsghdr* cm = CMSG_FIRSTHDR(&msg); cm != nullptr;
+             cm = CMSG_NXTHDR(&msg, cm))
+        {
+            if (!(cm->cmsg_level == SOL_IP && cm->cmsg_type == IP_RECVERR) &&
+                !(cm->cmsg_level == SOL_IPV6 && cm->cmsg_type == IPV6_RECVERR))
+                continue;
+
+            const struct sock_extended_err* ee =
+                reinterpret_cast<const struct sock_extended_err*>(
+                    CMSG_DATA(cm));
+
+            if (ee->ee_errno != 0 || ee->ee_origin != SO_EE_ORIGIN_ZEROCOPY)
+                continue;
+
+            // ids [ee_info, ee_data] are complete. completions of a TCP socket
+            // are delivered in order.
+            uint32_t done = ee->ee_data + 1;
+            if (static_cast<int32_t>(done - zerocopy_done_) > 0)
+                zerocopy_done_ = done;
+        }
+    }
+
+    while (!zerocopy_pending_.empty() &&
+           static_cast<int32_t>(
+               zerocopy_done_ - zerocopy_pending_.front().zerocopy_id) > 0) {
+        zerocopy_pending_.pop_front();
+    }
+#endif
+}
+
+/******************************************************************************/
+// Read-Ahead Buffer
+
+size_t Connection::RecvBuffered(uint8_t* out_data, size_t size) {
+    size_t n = std::min(size, recv_end_ - recv_begin_);
+    std::copy(recv_buffer_.data() + recv_begin_,
+              recv_buffer_.data() + recv_begin_ + n, out_data);
+    recv_begin_ += n;
+    return n;
+}
+
+void Connection::SyncRecv(void* out_data, size_t size) {
+    uint8_t* out = static_cast<uint8_t*>(out_data);
+    size_t rb = RecvBuffered(out, size);
+    if (rb == size) return;
+
+    SetNonBlocking(false);
+    if (socket_.recv(out + rb, size - rb) != static_cast<ssize_t>(size - rb))
+        throw Exception("Error during SyncRecv", errno);
+    rx_bytes_ += size - rb;
+}
+
+ssize_t Connection::RecvOne(void* out_data, size_t size) {
+#if __APPLE__
+    // MacOSX has no MSG_DONTWAIT
+    SetNonBlocking(true);
+#endif
+    uint8_t* out = static_cast<uint8_t*>(out_data);
+    size_t rb = RecvBuffered(out, size);
+
+    // a short receive tells the caller that the socket was drained, hence
+    // continue after the buffered data until the socket is empty.
+    while (rb < size)
+    {
+        size_t need = size - rb;
+
+        if (need >= recv_buffer_size_ / 2) {
+            // large receives go directly into the destination.
+            ssize_t r = socket_.recv_one(out + rb, need, MSG_DONTWAIT);
+            if (r <= 0) return rb != 0 ? static_cast<ssize_t>(rb) : r;
+
+            rx_bytes_ += r;
+            rb += r;
+            if (static_cast<size_t>(r) < need) break;
+        }
+        else {
+            // small receives are served from one large recv().
+            if (!recv_buffer_.IsValid())
+                recv_buffer_ = Buffer(recv_buffer_size_);
+
+            ssize_t r = socket_.recv_one(
+                recv_buffer_.data(), recv_buffer_.size(), MSG_DONTWAIT);
+            if (r <= 0) return rb != 0 ? static_cast<ssize_t>(rb) : r;
+
+            rx_bytes_ += r;
+            recv_begin_ = 0, recv_end_ = r;
+            rb += RecvBuffered(out + rb, need);
+            if (static_cast<size_t>(r) < recv_buffer_.size()) break;
+        }
+    }
+
+    return rb;
+}
+
+} // namespace tcp
+} // namespace net
+} // namespace thrill
+
+/******************************************************************************/
@@ -16,13 +16,19 @@
 #define THRILL_NET_TCP_CONNECTION_HEADER
 
 #include <thrill/common/config.hpp>
+#include <thrill/data/block.hpp>
+#include <thrill/mem/allocator.hpp>
+#include <thrill/net/buffer.hpp>
 #include <thrill/net/connection.hpp>
+#include <thrill/net/dispatcher.hpp>
 #include <thrill/net/tcp/socket.hpp>
 
 #include <cassert>
 #include <cerrno>
+#include <cstdint>
 #include <cstdio>
 #include <cstring>
+#include <deque>
 #include <string>
 
 namespace thrill {
@@ -50,6 +56,12 @@ enum ConnectionState : unsigned {
  * If any function fails to send or receive, then a NetException is thrown
  * instead of explicit error handling. If ever an error occurs, we probably have
  * to rebuild the whole network explicitly.
+ *
+ * Asynchronous writes of the tcp Dispatchers are collected in a send queue per
+ * Connection, which is flushed with as few sendmsg() calls as possible, such
+ * that many small header and Block pairs do not cost a system call each. Small
+ * receives are served from a read-ahead buffer, which is filled with one large
+ * recv().
  */
 class Connection final : public net::Connection
 {
@@ -76,7 +88,18 @@ public:
         : socket_(std::move(other.socket_)),
           state_(other.state_),
           group_id_(other.group_id_),
-          peer_id_(other.peer_id_) {
+          peer_id_(other.peer_id_),
+          send_queue_(std::move(other.send_queue_)),
+          send_pos_(other.send_pos_),
+          send_registered_(other.send_registered_),
+          zerocopy_enabled_(other.zerocopy_enabled_),
+          zerocopy_min_size_(other.zerocopy_min_size_),
+          zerocopy_next_(other.zerocopy_next_),
+          zerocopy_done_(other.zerocopy_done_),
+          zerocopy_pending_(std::move(other.zerocopy_pending_)),
+          recv_buffer_(std::move(other.recv_buffer_)),
+          recv_begin_(other.recv_begin_),
+          recv_end_(other.recv_end_) {
         other.state_ = ConnectionState::Invalid;
     }
 
@@ -91,6 +114,19 @@ public:
         group_id_ = other.group_id_;
         peer_id_ = other.peer_id_;
 
+        send_queue_ = std::move(other.send_queue_);
+        send_pos_ = other.send_pos_;
+        send_registered_ = other.send_registered_;
+        zerocopy_enabled_ = other.zerocopy_enabled_;
+        zerocopy_min_size_ = other.zerocopy_min_size_;
+        zerocopy_next_ = other.zerocopy_next_;
+        zerocopy_done_ = other.zerocopy_done_;
+        zerocopy_pending_ = std::move(other.zerocopy_pending_);
+
+        recv_buffer_ = std::move(other.recv_buffer_);
+        recv_begin_ = other.recv_begin_;
+        recv_end_ = other.recv_end_;
+
         other.state_ = ConnectionState::Invalid;
         return *this;
     }
@@ -180,22 +216,13 @@ public:
         return wb;
     }
 
-    void SyncRecv(void* out_data, size_t size) final {
-        SetNonBlocking(false);
-        if (socket_.recv(out_data, size) != static_cast<ssize_t>(size))
-            throw Exception("Error during SyncRecv", errno);
-        rx_bytes_ += size;
-    }
+    void SyncRecv(void* out_data, size_t size) final;
 
-    ssize_t RecvOne(void* out_data, size_t size) final {
-#if __APPLE__
-        // MacOSX has no MSG_DONTWAIT
-        SetNonBlocking(true);
-#endif
-        ssize_t rb = socket_.recv_one(out_data, size, MSG_DONTWAIT);
-        if (rb > 0) rx_bytes_ += rb;
-        return rb;
-    }
+    ssize_t RecvOne(void* out_data, size_t size) final;
+
+    //! Data remaining in the read-ahead buffer is not reported by the kernel.
+    bool HasBufferedRecv() const final
+    { return recv_begin_ != recv_end_; }
 
     void SyncSendRecv(const void* send_data, size_t send_size,
                       void* recv_data, size_t recv_size) final {
@@ -206,8 +233,45 @@ public:
     //! Close this Connection
     void Close() {
         socket_.close();
+        send_queue_.clear();
+        zerocopy_pending_.clear();
     }
 
+    //! \name Batched Asynchronous Writes
+    //! \{
+
+    //! Actions required from the Dispatcher after EnqueueWrite().
+    enum class SendAction {
+        //! SendQueued() is registered and will pick up the write.
+        None,
+        //! SendQueued() must be registered as write callback.
+        Register,
+        //! SendQueued() is registered, but only waits for zero-copy
+        //! completions: a new writability notification must be requested.
+        Rearm
+    };
+
+    //! Append a header Buffer and a Block (both may be empty) to the send
+    //! queue. done_cb is called once both were passed to the kernel.
+    SendAction EnqueueWrite(Buffer&& buffer, data::PinnedBlock&& block,
+                            const AsyncWriteCallback& done_cb);
+
+    //! Write callback for the Dispatcher: sends the send queue with sendmsg()
+    //! until it is empty (returns false) or the socket buffer is full (returns
+    //! true).
+    bool SendQueued();
+
+    //! Send queued data with MSG_ZEROCOPY if a sendmsg() call contains at least
+    //! min_size bytes. The Blocks stay pinned until the kernel reports
+    //! completion on the socket's error queue, which is signaled as EPOLLERR,
+    //! hence this requires an edge-triggered epoll Dispatcher.
+    void EnableZeroCopy(size_t min_size);
+
+    //! Forget the registration of SendQueued() after Dispatcher::Cancel().
+    void CancelSend() { send_registered_ = false; }
+
+    //! \}
+
     //! make ostreamable
     std::ostream& OutputOstream(std::ostream& os) const final {
         os << "[tcp::Connection"
@@ -232,6 +296,82 @@ private:
 
     //! The id of the worker this connection is connected to.
     size_t peer_id_ = size_t(-1);
+
+    //! \name Send Queue
+    //! \{
+
+    //! maximum number of iovec pieces per sendmsg() call
+    static constexpr size_t max_iovec_ = 64;
+
+    //! a header Buffer and Block written successively
+    struct SendItem {
+        Buffer             buffer;
+        data::PinnedBlock  block;
+        AsyncWriteCallback callback;
+        //! whether any bytes were sent with MSG_ZEROCOPY
+        bool               zerocopy = false;
+        //! id of the last MSG_ZEROCOPY sendmsg() containing bytes of the item
+        uint32_t           zerocopy_id = 0;
+
+        SendItem(Buffer&& _buffer, data::PinnedBlock&& _block,
+                 const AsyncWriteCallback& _callback)
+            : buffer(std::move(_buffer)), block(std::move(_block)),
+              callback(_callback) { }
+
+        size_t size() const { return buffer.size() + block.size(); }
+    };
+
+    using SendQueue = std::deque<SendItem, mem::GPoolAllocator<SendItem> >;
+
+    //! queue of pending asynchronous writes
+    SendQueue send_queue_;
+
+    //! number of bytes of the front SendItem already sent
+    size_t send_pos_ = 0;
+
+    //! whether SendQueued() is registered as write callback
+    bool send_registered_ = false;
+
+    //! whether EnableZeroCopy() was called
+    bool zerocopy_enabled_ = false;
+
+    //! minimum sendmsg() size for MSG_ZEROCOPY, zero if disabled
+    size_t zerocopy_min_size_ = 0;
+
+    //! id of the next MSG_ZEROCOPY sendmsg(), counted like the kernel does
+    uint32_t zerocopy_next_ = 0;
+
+    //! all MSG_ZEROCOPY sendmsg() ids below this were completed
+    uint32_t zerocopy_done_ = 0;
+
+    //! sent SendItems whose memory is still referenced by the kernel
+    SendQueue zerocopy_pending_;
+
+    //! Read MSG_ZEROCOPY completions from the error queue and release the
+    //! SendItems they cover.
+    void ReapZeroCopy();
+
+    //! Call the callbacks of all queued writes after the peer vanished.
+    void AbortSendQueue();
+
+    //! \}
+
+    //! \name Read-Ahead Buffer
+    //! \{
+
+    //! size of the read-ahead buffer, larger receives bypass it
+    static constexpr size_t recv_buffer_size_ = 64 * 1024;
+
+    //! read-ahead buffer, allocated on first use
+    Buffer recv_buffer_;
+
+    //! range of unconsumed data in recv_buffer_
+    size_t recv_begin_ = 0, recv_end_ = 0;
+
+    //! Copy up to size bytes from the read-ahead buffer.
+    size_t RecvBuffered(uint8_t* out_data, size_t size);
+
+    //! \}
 };
 
 // \}
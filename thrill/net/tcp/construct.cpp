@@ -45,12 +45,17 @@ public:
      * \param my_rank_ The rank of the worker that owns this Manager.
      * \param endpoints The ordered list of all endpoints, including the local worker,
      * where the endpoint at position i corresponds to the worker with id i.
+     * \param peers Connect only to workers with peers[i] set, the
+     * Connections to all others remain invalid.
      */
     void Initialize(size_t my_rank_,
-                    const std::vector<std::string>& endpoints) {
+                    const std::vector<std::string>& endpoints,
+                    const std::vector<bool>& peers) {
 
         this->my_rank_ = my_rank_;
         die_unless(my_rank_ < endpoints.size());
+        die_unless(peers.size() == endpoints.size());
+        peers_ = peers;
 
         LOG << "Client " << my_rank_ << " starting: " << endpoints[my_rank_];
 
@@ -85,6 +90,7 @@ public:
         // Initiate connections to all hosts with higher id.
         for (uint32_t g = 0; g < group_count_; g++) {
             for (size_t id = my_rank_ + 1; id < address_list.size(); ++id) {
+                if (!peers_[id]) continue;
                 AsyncConnect(g, id, address_list[id]);
             }
         }
@@ -110,7 +116,7 @@ public:
         for (size_t j = 0; j < group_count_; j++) {
             // output list of file descriptors connected to partners
             for (size_t i = 0; i != address_list.size(); ++i) {
-                if (i == my_rank_) continue;
+                if (i == my_rank_ || !peers_[i]) continue;
                 LOG << "Group " << j
                     << " link " << my_rank_ << " -> " << i << " = fd "
                     << groups_[j]->tcp_connection(i).GetSocket().fd();
@@ -131,6 +137,9 @@ private:
     //! The rank associated with the local worker.
     size_t my_rank_ = size_t(-1);
 
+    //! Mask of workers to connect to.
+    std::vector<bool> peers_;
+
     //! The Connections responsible for listening to incoming connections.
     Connection listener_;
 
@@ -207,7 +216,7 @@ private:
         for (size_t g = 0; g < group_count_; g++) {
 
             for (size_t id = 0; id < groups_[g]->num_hosts(); ++id) {
-                if (id == my_rank_) continue;
+                if (id == my_rank_ || !peers_[id]) continue;
 
                 // Just checking the state works since this implicitey checks the
                 // size. Unset connections have state ConnectionState::Invalid.
@@ -477,6 +486,7 @@ private:
 
         die_unless(msg_in->group_id < group_count_);
         die_unless(msg_in->id < groups_[msg_in->group_id]->num_hosts());
+        die_unless(peers_[msg_in->id]);
 
         die_unequal(groups_[msg_in->group_id]->tcp_connection(msg_in->id).state(),
                     ConnectionState::Invalid);
@@ -538,7 +548,18 @@ private:
 void Construct(size_t my_rank,
                const std::vector<std::string>& endpoints,
                std::unique_ptr<Group>* groups, size_t group_count) {
-    Construction(groups, group_count).Initialize(my_rank, endpoints);
+    Construction(groups, group_count).Initialize(
+        my_rank, endpoints, std::vector<bool>(endpoints.size(), true));
+}
+
+//! Connect to a subset of peers via endpoints using TCP sockets. Construct a
+//! group_count tcp::Group objects at once, in which only the Connections to
+//! peers with peers[i] set are valid.
+void Construct(size_t my_rank,
+               const std::vector<std::string>& endpoints,
+               const std::vector<bool>& peers,
+               std::unique_ptr<Group>* groups, size_t group_count) {
+    Construction(groups, group_count).Initialize(my_rank, endpoints, peers);
 }
 
 //! Connect to peers via endpoints using TCP sockets. Construct a group_count
@@ -547,7 +568,8 @@ std::vector<std::unique_ptr<net::Group> >
 Construct(size_t my_rank, const std::vector<std::string>& endpoints,
           size_t group_count) {
     std::vector<std::unique_ptr<tcp::Group> > tcp_groups(group_count);
-    Construction(&tcp_groups[0], tcp_groups.size()).Initialize(my_rank, endpoints);
+    Construction(&tcp_groups[0], tcp_groups.size()).Initialize(
+        my_rank, endpoints, std::vector<bool>(endpoints.size(), true));
     std::vector<std::unique_ptr<net::Group> > groups(group_count);
     std::move(tcp_groups.begin(), tcp_groups.end(), groups.begin());
     return groups;
@@ -32,6 +32,15 @@ void Construct(size_t my_rank,
                const std::vector<std::string>& endpoints,
                std::unique_ptr<Group>* groups, size_t group_count);
 
+//! Connect to a subset of peers via endpoints using TCP sockets. Construct a
+//! group_count tcp::Group objects at once, in which only the Connections to
+//! peers with peers[i] set are valid. The mask must be symmetric among all
+//! hosts.
+void Construct(size_t my_rank,
+               const std::vector<std::string>& endpoints,
+               const std::vector<bool>& peers,
+               std::unique_ptr<Group>* groups, size_t group_count);
+
 //! Connect to peers via endpoints using TCP sockets. Construct a group_count
 //! net::Group objects at once. Within each Group this host has my_rank.
 std::vector<std::unique_ptr<net::Group> >
@@ -0,0 +1,228 @@
+/*******************************************************************************
+ * thrill/net/tcp/epoll_dispatcher.cpp
+ *
+ * Asynchronous callback wrapper around edge-triggered epoll()
+ *
+ * Part of Project Thrill - http://project-thrill.org
+ *
+ * All rights reserved. Published under the BSD-2 license in the LICENSE file.
+ ******************************************************************************/
+
+#include <thrill/net/tcp/epoll_dispatcher.hpp>
+
+#if THRILL_HAVE_NET_EPOLL
+
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <csignal>
+
+namespace thrill {
+namespace net {
+namespace tcp {
+
+EPollDispatcher::EPollDispatcher(
+    mem::Manager& mem_manager, size_t zerocopy_min_size)
+    : net::Dispatcher(mem_manager), zerocopy_min_size_(zerocopy_min_size) {
+
+    epoll_fd_ = epoll_create1(EPOLL_CLOEXEC);
+    if (epoll_fd_ < 0)
+        throw Exception("EPollDispatcher() could not create epoll fd", errno);
+
+    event_fd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (event_fd_ < 0)
+        throw Exception("EPollDispatcher() could not create eventfd", errno);
+
+    // Ignore PIPE signals (received when writing to closed sockets)
+    signal(SIGPIPE, SIG_IGN);
+
+    // wait for interrupts via eventfd.
+    struct epoll_event ev;
+    ev.events = EPOLLIN | EPOLLET;
+    ev.data.fd = event_fd_;
+    if (epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, event_fd_, &ev) != 0)
+        throw Exception("EPollDispatcher() could not register eventfd", errno);
+}
+
+EPollDispatcher::~EPollDispatcher() {
+    ::close(event_fd_);
+    ::close(epoll_fd_);
+}
+
+void EPollDispatcher::Arm(int fd) {
+    Watch& w = watch_[fd];
+
+    uint32_t events = EPOLLET;
+    if (!w.read_cb.empty()) events |= EPOLLIN | EPOLLRDHUP;
+    if (!w.write_cb.empty()) events |= EPOLLOUT;
+
+    struct epoll_event ev;
+    ev.events = events;
+    ev.data.fd = fd;
+
+    int op = w.events ? EPOLL_CTL_MOD : EPOLL_CTL_ADD;
+
+    if (epoll_ctl(epoll_fd_, op, fd, &ev) != 0) {
+        // the kernel drops closed fds from the epoll set, hence a reused fd
+        // number may be unknown even though we registered it before, and vice
+        // versa.
+        if (op == EPOLL_CTL_MOD && errno == ENOENT)
+            op = EPOLL_CTL_ADD;
+        else if (op == EPOLL_CTL_ADD && errno == EEXIST)
+            op = EPOLL_CTL_MOD;
+        else
+            throw Exception("EPollDispatcher() epoll_ctl() failed", errno);
+
+        if (epoll_ctl(epoll_fd_, op, fd, &ev) != 0)
+            throw Exception("EPollDispatcher() epoll_ctl() failed", errno);
+    }
+
+    w.events = events;
+}
+
+void EPollDispatcher::Cancel(net::Connection& c) {
+    assert(dynamic_cast<Connection*>(&c));
+    Connection& tc = static_cast<Connection&>(c);
+    int fd = tc.GetSocket().fd();
+    CheckSize(fd);
+
+    Watch& w = watch_[fd];
+
+    if (w.read_cb.size() == 0 && w.write_cb.size() == 0)
+        LOG << "EPollDispatcher::Cancel() fd=" << fd
+            << " called with no callbacks registered.";
+
+    if (w.events != 0) {
+        struct epoll_event ev;
+        if (epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, fd, &ev) != 0 &&
+            errno != ENOENT && errno != EBADF)
+            throw Exception("EPollDispatcher() epoll_ctl() failed", errno);
+    }
+
+    w.read_cb.clear();
+    w.write_cb.clear();
+    w.events = 0;
+
+    tc.CancelSend();
+}
+
+void EPollDispatcher::AsyncWrite(
+    net::Connection& c, Buffer&& buffer, data::PinnedBlock&& block,
+    const AsyncWriteCallback& done_cb) {
+    assert(dynamic_cast<Connection*>(&c));
+    Connection& tc = static_cast<Connection&>(c);
+
+    if (zerocopy_min_size_ != 0)
+        tc.EnableZeroCopy(zerocopy_min_size_);
+
+    switch (tc.EnqueueWrite(std::move(buffer), std::move(block), done_cb)) {
+    case Connection::SendAction::None:
+        break;
+    case Connection::SendAction::Register:
+        AddWrite(tc.GetSocket().fd(),
+                 Callback::make<Connection, & Connection::SendQueued>(&tc));
+        break;
+    case Connection::SendAction::Rearm:
+        // SendQueued() waits for EPOLLERR only, request a new EPOLLOUT edge.
+        Arm(tc.GetSocket().fd());
+        break;
+    }
+}
+
+bool EPollDispatcher::HasAsyncWrites() const {
+    if (net::Dispatcher::HasAsyncWrites()) return true;
+
+    for (const Watch& w : watch_) {
+        if (!w.write_cb.empty()) return true;
+    }
+    return false;
+}
+
+void EPollDispatcher::RunQueue(int fd, mem::deque<Callback> Watch::* queue) {
+    // the watch_ table may be regrown when callback handlers are called, hence
+    // the Watch object must be looked up again after each callback.
+    if ((watch_[fd].*queue).empty()) {
+        LOG << "EPollDispatcher: got event for fd " << fd
+            << " without a handler.";
+        // stop listening for this direction.
+        if (watch_[fd].events != 0) Arm(fd);
+        return;
+    }
+
+    while (!(watch_[fd].*queue).empty() &&
+           (watch_[fd].*queue).front()() == false) {
+        (watch_[fd].*queue).pop_front();
+    }
+}
+
+void EPollDispatcher::DispatchOne(const std::chrono::milliseconds& timeout) {
+
+    LOG << "Performing epoll_wait() on " << watch_.size() << " fds";
+
+    int r = epoll_wait(epoll_fd_, events_.data(),
+                       static_cast<int>(events_.size()),
+                       static_cast<int>(timeout.count()));
+
+    if (r < 0) {
+        // if we caught a signal, this is intended to interrupt epoll_wait().
+        if (errno == EINTR) {
+            LOG << "Dispatch(): epoll_wait() was interrupted due to a signal.";
+            return;
+        }
+
+        throw Exception("EPollDispatcher::DispatchOne() epoll_wait() failed!",
+                        errno);
+    }
+
+    for (int i = 0; i < r; ++i)
+    {
+        int fd = events_[i].data.fd;
+        uint32_t ev = events_[i].events;
+
+        if (fd == event_fd_) {
+            EventFdCallback();
+            continue;
+        }
+
+        if (static_cast<size_t>(fd) >= watch_.size() || watch_[fd].events == 0)
+            continue;
+
+        // hangups and errors are delivered to the callbacks, which detect
+        // them when calling recv() or send().
+        if (ev & (EPOLLIN | EPOLLRDHUP | EPOLLHUP | EPOLLERR))
+            RunQueue(fd, &Watch::read_cb);
+
+        if (ev & (EPOLLOUT | EPOLLHUP | EPOLLERR))
+            RunQueue(fd, &Watch::write_cb);
+    }
+
+    // if the event buffer was filled, enlarge it for the next round.
+    if (static_cast<size_t>(r) == events_.size())
+        events_.resize(2 * events_.size());
+}
+
+void EPollDispatcher::Interrupt() {
+    // add one to the eventfd counter to wake up epoll_wait().
+    uint64_t one = 1;
+    ssize_t wb;
+    while ((wb = write(event_fd_, &one, sizeof(one))) < 0 && errno == EINTR) {
+        LOG1 << "WakeUp: error sending to eventfd: " << errno;
+    }
+    die_unless(wb == sizeof(one));
+}
+
+void EPollDispatcher::EventFdCallback() {
+    uint64_t counter;
+    while (read(event_fd_, &counter, sizeof(counter)) > 0) {
+        /* repeat, until counter is reset */
+    }
+}
+
+} // namespace tcp
+} // namespace net
+} // namespace thrill
+
+#endif // THRILL_HAVE_NET_EPOLL
+
+/******************************************************************************/
@@ -0,0 +1,203 @@
+/*******************************************************************************
+ * thrill/net/tcp/epoll_dispatcher.hpp
+ *
+ * Asynchronous callback wrapper around edge-triggered epoll()
+ *
+ * Part of Project Thrill - http://project-thrill.org
+ *
+ * All rights reserved. Published under the BSD-2 license in the LICENSE file.
+ ******************************************************************************/
+
+#pragma once
+#ifndef THRILL_NET_TCP_EPOLL_DISPATCHER_HEADER
+#define THRILL_NET_TCP_EPOLL_DISPATCHER_HEADER
+
+#include <thrill/common/config.hpp>
+
+#if THRILL_HAVE_NET_EPOLL
+
+#include <thrill/common/delegate.hpp>
+#include <thrill/common/die.hpp>
+#include <thrill/common/logger.hpp>
+#include <thrill/mem/allocator.hpp>
+#include <thrill/net/connection.hpp>
+#include <thrill/net/dispatcher.hpp>
+#include <thrill/net/exception.hpp>
+#include <thrill/net/tcp/connection.hpp>
+#include <thrill/net/tcp/socket.hpp>
+
+#include <sys/epoll.h>
+
+#include <chrono>
+#include <deque>
+#include <vector>
+
+namespace thrill {
+namespace net {
+namespace tcp {
+
+//! \addtogroup net_tcp TCP Socket API
+//! \{
+
+/*!
+ * EPollDispatcher is a higher level wrapper for Linux's epoll() with the same
+ * interface as SelectDispatcher. Unlike select(), epoll() is not limited to
+ * FD_SETSIZE file descriptors and costs O(ready) instead of O(watched) per
+ * wakeup.
+ *
+ * File descriptors are registered edge-triggered. The asynchronous read and
+ * write callbacks of the Dispatcher return true only if the socket was
+ * drained (a short or failed recv()/send()), hence edge notifications are
+ * sufficient while callbacks are queued. When a direction's callback queue
+ * runs empty, readiness is unknown, and the next AddRead() or AddWrite()
+ * re-arms the fd with epoll_ctl(), which reports any pending readiness as a
+ * new edge. The Interrupt() wakeup is done via an eventfd.
+ *
+ * AsyncWrite()s go through the send queue of the tcp::Connection. If
+ * zerocopy_min_size is non-zero, sends of at least that many bytes use
+ * MSG_ZEROCOPY, whose completions arrive as EPOLLERR edges.
+ */
+class EPollDispatcher final : public net::Dispatcher
+{
+    static constexpr bool debug = false;
+
+public:
+    //! type for file descriptor readiness callbacks
+    using Callback = AsyncCallback;
+
+    //! constructor
+    explicit EPollDispatcher(mem::Manager& mem_manager,
+                             size_t zerocopy_min_size = 0);
+
+    //! destructor
+    ~EPollDispatcher();
+
+    //! non-copyable: delete copy-constructor
+    EPollDispatcher(const EPollDispatcher&) = delete;
+    //! non-copyable: delete assignment operator
+    EPollDispatcher& operator = (const EPollDispatcher&) = delete;
+
+    //! Grow table if needed
+    void CheckSize(int fd) {
+        assert(fd >= 0);
+        if (static_cast<size_t>(fd) >= watch_.size())
+            watch_.resize(fd + 1, Watch(mem_manager_));
+    }
+
+    //! Register a buffered read callback on a raw file descriptor.
+    void AddRead(int fd, const Callback& read_cb) {
+        CheckSize(fd);
+        Watch& w = watch_[fd];
+        bool rearm = w.read_cb.empty();
+        w.read_cb.emplace_back(read_cb);
+        if (rearm) Arm(fd);
+    }
+
+    //! Register a buffered write callback on a raw file descriptor.
+    void AddWrite(int fd, const Callback& write_cb) {
+        CheckSize(fd);
+        Watch& w = watch_[fd];
+        bool rearm = w.write_cb.empty();
+        w.write_cb.emplace_back(write_cb);
+        if (rearm) Arm(fd);
+    }
+
+    //! Register a buffered read callback and a default exception callback.
+    void AddRead(net::Connection& c, const Callback& read_cb) final {
+        assert(dynamic_cast<Connection*>(&c));
+        Connection& tc = static_cast<Connection&>(c);
+        return AddRead(tc.GetSocket().fd(), read_cb);
+    }
+
+    //! Register a buffered write callback and a default exception callback.
+    void AddWrite(net::Connection& c, const Callback& write_cb) final {
+        assert(dynamic_cast<Connection*>(&c));
+        Connection& tc = static_cast<Connection&>(c);
+        return AddWrite(tc.GetSocket().fd(), write_cb);
+    }
+
+    //! Cancel all callbacks on a given fd.
+    void Cancel(net::Connection& c) final;
+
+    //! asynchronously write a header Buffer and a Block via the send queue of
+    //! the tcp::Connection.
+    void AsyncWrite(
+        net::Connection& c, Buffer&& buffer, data::PinnedBlock&& block,
+        const AsyncWriteCallback& done_cb = AsyncWriteCallback()) final;
+
+    //! asynchronously write a Buffer via the send queue of the tcp::Connection.
+    void AsyncWrite(
+        net::Connection& c, Buffer&& buffer,
+        const AsyncWriteCallback& done_cb = AsyncWriteCallback()) final {
+        return AsyncWrite(c, std::move(buffer), data::PinnedBlock(), done_cb);
+    }
+
+    //! asynchronously write a Block via the send queue of the tcp::Connection.
+    void AsyncWrite(
+        net::Connection& c, data::PinnedBlock&& block,
+        const AsyncWriteCallback& done_cb = AsyncWriteCallback()) final {
+        return AsyncWrite(c, Buffer(), std::move(block), done_cb);
+    }
+
+    //! Check whether there are still AsyncWrite()s in the send queues.
+    bool HasAsyncWrites() const final;
+
+    //! Run one iteration of dispatching epoll_wait().
+    void DispatchOne(const std::chrono::milliseconds& timeout) final;
+
+    //! Interrupt the current epoll_wait() via eventfd
+    void Interrupt() final;
+
+private:
+    //! epoll file descriptor
+    int epoll_fd_;
+
+    //! eventfd to wake up epoll_wait().
+    int event_fd_;
+
+    //! minimum sendmsg() size for MSG_ZEROCOPY, zero if disabled
+    size_t zerocopy_min_size_;
+
+    //! callback queues per watched file descriptor
+    struct Watch {
+        //! epoll event mask currently registered in the kernel, zero if not
+        //! registered.
+        uint32_t             events = 0;
+        //! queue of callbacks for fd.
+        mem::deque<Callback> read_cb, write_cb;
+
+        explicit Watch(mem::Manager& mem_manager)
+            : read_cb(mem::Allocator<Callback>(mem_manager)),
+              write_cb(mem::Allocator<Callback>(mem_manager)) { }
+    };
+
+    //! handlers for all registered file descriptors, indexed by fd.
+    mem::vector<Watch> watch_ { mem::Allocator<Watch>(mem_manager_) };
+
+    //! buffer for events returned by epoll_wait()
+    mem::vector<struct epoll_event> events_ {
+        64, mem::Allocator<struct epoll_event>(mem_manager_)
+    };
+
+    //! (Re-)register fd with the event mask required by its callback queues.
+    void Arm(int fd);
+
+    //! Run callbacks of a queue until one returns true (in which case it wants
+    //! to be called again) or the queue is empty.
+    void RunQueue(int fd, mem::deque<Callback> Watch::* queue);
+
+    //! Drain the eventfd counter
+    void EventFdCallback();
+};
+
+//! \}
+
+} // namespace tcp
+} // namespace net
+} // namespace thrill
+
+#endif // THRILL_HAVE_NET_EPOLL
+
+#endif // !THRILL_NET_TCP_EPOLL_DISPATCHER_HEADER
+
+/******************************************************************************/
@@ -12,11 +12,16 @@
  * All rights reserved. Published under the BSD-2 license in the LICENSE file.
  ******************************************************************************/
 
+#include <thrill/common/die.hpp>
 #include <thrill/common/logger.hpp>
+#include <thrill/common/string.hpp>
 #include <thrill/net/tcp/construct.hpp>
+#include <thrill/net/tcp/epoll_dispatcher.hpp>
 #include <thrill/net/tcp/group.hpp>
 #include <thrill/net/tcp/select_dispatcher.hpp>
 
+#include <cstdlib>
+#include <cstring>
 #include <random>
 #include <string>
 #include <thread>
@@ -29,8 +34,57 @@ namespace tcp {
 
 std::unique_ptr<Dispatcher>
 Group::ConstructDispatcher(mem::Manager& mem_manager) const {
-    // construct tcp::SelectDispatcher
-    return std::make_unique<SelectDispatcher>(mem_manager);
+    // parse environment: THRILL_NET_ZEROCOPY
+    const char* env_zerocopy = getenv("THRILL_NET_ZEROCOPY");
+
+    uint64_t zerocopy_min_size = 0;
+    if (env_zerocopy && *env_zerocopy &&
+        !common::ParseSiIecUnits(env_zerocopy, zerocopy_min_size)) {
+        throw Exception("Group::ConstructDispatcher() invalid size "
+                        "THRILL_NET_ZEROCOPY=" + std::string(env_zerocopy));
+    }
+
+    // parse environment: THRILL_NET_DISPATCHER
+    const char* env_dispatcher = getenv("THRILL_NET_DISPATCHER");
+
+    if (!env_dispatcher || !*env_dispatcher ||
+        strcmp(env_dispatcher, "select") == 0) {
+        return ConstructDispatcher(
+            mem_manager, DispatcherType::Select, zerocopy_min_size);
+    }
+    else if (strcmp(env_dispatcher, "epoll") == 0) {
+        return ConstructDispatcher(
+            mem_manager, DispatcherType::EPoll, zerocopy_min_size);
+    }
+
+    throw Exception("Group::ConstructDispatcher() unknown dispatcher type "
+                    "THRILL_NET_DISPATCHER=" + std::string(env_dispatcher));
+}
+
+std::unique_ptr<Dispatcher>
+Group::ConstructDispatcher(mem::Manager& mem_manager, DispatcherType type,
+                           size_t zerocopy_min_size) {
+    switch (type) {
+    case DispatcherType::Select:
+        // completions of MSG_ZEROCOPY are signaled as errors on the socket,
+        // which select() would report continuously.
+        if (zerocopy_min_size != 0) {
+            throw Exception("Group::ConstructDispatcher() THRILL_NET_ZEROCOPY "
+                            "requires THRILL_NET_DISPATCHER=epoll");
+        }
+        // construct tcp::SelectDispatcher
+        return std::make_unique<SelectDispatcher>(mem_manager);
+    case DispatcherType::EPoll:
+#if THRILL_HAVE_NET_EPOLL
+        // construct tcp::EPollDispatcher
+        return std::make_unique<EPollDispatcher>(
+            mem_manager, zerocopy_min_size);
+#else
+        throw Exception("Group::ConstructDispatcher() epoll dispatcher "
+                        "is not supported on this platform.");
+#endif
+    }
+    die("Group::ConstructDispatcher() invalid DispatcherType");
 }
 
 std::vector<std::unique_ptr<Group> > Group::ConstructLoopbackMesh(
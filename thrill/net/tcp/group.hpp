@@ -99,9 +99,22 @@ public:
         return tcp_connection(id);
     }
 
+    //! Kernel-level readiness notification used by the Dispatcher.
+    enum class DispatcherType { Select, EPoll };
+
+    //! Construct a Dispatcher for tcp::Connections, the type can be selected
+    //! with the environment variable THRILL_NET_DISPATCHER=select|epoll. With
+    //! epoll, THRILL_NET_ZEROCOPY=<bytes> sends writes of at least that size
+    //! with MSG_ZEROCOPY.
     std::unique_ptr<Dispatcher> ConstructDispatcher(
         mem::Manager& mem_manager) const final;
 
+    //! Construct a Dispatcher of the given type for tcp::Connections.
+    //! zerocopy_min_size is only supported by the epoll Dispatcher.
+    static std::unique_ptr<Dispatcher> ConstructDispatcher(
+        mem::Manager& mem_manager, DispatcherType type,
+        size_t zerocopy_min_size = 0);
+
     /*!
      * Assigns a connection to this net group.  This method swaps the net
      * connection to memory managed by this group.  The reference given to that
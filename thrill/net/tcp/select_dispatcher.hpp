@@ -34,6 +34,7 @@
 #include <csignal>
 #include <deque>
 #include <functional>
+#include <string>
 #include <vector>
 
 namespace thrill {
@@ -86,6 +87,11 @@ public:
     void CheckSize(int fd) {
         assert(fd >= 0);
         assert(fd <= 32000); // this is an arbitrary limit to catch errors.
+        if (fd >= FD_SETSIZE) {
+            throw Exception(
+                "SelectDispatcher() fd " + std::to_string(fd) +
+                " exceeds FD_SETSIZE, use THRILL_NET_DISPATCHER=epoll");
+        }
         if (static_cast<size_t>(fd) >= watch_.size())
             watch_.resize(fd + 1, Watch(mem_manager_));
     }
@@ -157,6 +163,49 @@ public:
         w.write_cb.clear();
         w.except_cb = Callback();
         w.active = false;
+
+        tc.CancelSend();
+    }
+
+    //! asynchronously write a header Buffer and a Block via the send queue of
+    //! the tcp::Connection.
+    void AsyncWrite(
+        net::Connection& c, Buffer&& buffer, data::PinnedBlock&& block,
+        const AsyncWriteCallback& done_cb = AsyncWriteCallback()) final {
+        assert(dynamic_cast<Connection*>(&c));
+        Connection& tc = static_cast<Connection&>(c);
+
+        // select() is level-triggered, hence a registered SendQueued() needs
+        // no new notification.
+        if (tc.EnqueueWrite(std::move(buffer), std::move(block), done_cb) ==
+            Connection::SendAction::Register) {
+            AddWrite(c, Callback::make<
+                         Connection, & Connection::SendQueued>(&tc));
+        }
+    }
+
+    //! asynchronously write a Buffer via the send queue of the tcp::Connection.
+    void AsyncWrite(
+        net::Connection& c, Buffer&& buffer,
+        const AsyncWriteCallback& done_cb = AsyncWriteCallback()) final {
+        return AsyncWrite(c, std::move(buffer), data::PinnedBlock(), done_cb);
+    }
+
+    //! asynchronously write a Block via the send queue of the tcp::Connection.
+    void AsyncWrite(
+        net::Connection& c, data::PinnedBlock&& block,
+        const AsyncWriteCallback& done_cb = AsyncWriteCallback()) final {
+        return AsyncWrite(c, Buffer(), std::move(block), done_cb);
+    }
+
+    //! Check whether there are still AsyncWrite()s in the send queues.
+    bool HasAsyncWrites() const final {
+        if (net::Dispatcher::HasAsyncWrites()) return true;
+
+        for (const Watch& w : watch_) {
+            if (!w.write_cb.empty()) return true;
+        }
+        return false;
     }
 
     //! Run one iteration of dispatching select().
@@ -10,6 +10,7 @@
  * All rights reserved. Published under the BSD-2 license in the LICENSE file.
  ******************************************************************************/
 
+#include <thrill/common/defines.hpp>
 #include <thrill/net/tcp/socket.hpp>
 
 #include <arpa/inet.h>
@@ -128,6 +129,30 @@ void Socket::SetRcvBuf(size_t size) {
 #endif
 }
 
+bool Socket::SetZeroCopy(bool activate) {
+    assert(IsValid());
+
+#if __linux__ && defined(SO_ZEROCOPY)
+    int sockoptflag = (activate ? 1 : 0);
+
+    /* SO_ZEROCOPY If set, sendmsg() with the MSG_ZEROCOPY flag pins the pages
+       of the user's buffers instead of copying them into the socket buffer.
+       The buffers must not be modified until the kernel reports completion on
+       the socket's error queue. */
+    if (::setsockopt(fd_, SOL_SOCKET, SO_ZEROCOPY,
+                     &sockoptflag, sizeof(sockoptflag)) != 0)
+    {
+        LOG << "Cannot set SO_ZEROCOPY on socket fd " << fd_
+            << ": " << strerror(errno);
+        return false;
+    }
+    return true;
+#else
+    common::UNUSED(activate);
+    return false;
+#endif
+}
+
 } // namespace tcp
 } // namespace net
 } // namespace thrill
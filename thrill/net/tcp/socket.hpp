@@ -22,6 +22,7 @@
 #include <fcntl.h>
 #include <netinet/in.h>
 #include <sys/socket.h>
+#include <sys/uio.h>
 #include <unistd.h>
 
 #include <cassert>
@@ -369,6 +370,30 @@ public:
         return r;
     }
 
+    //! Send a vector of (data,size) pieces to socket with one sendmsg() call
+    //! (BSD socket API function wrapper).
+    ssize_t sendmsg_one(const struct iovec* iov, size_t iovcnt, int flags = 0) {
+        assert(IsValid());
+
+        struct msghdr msg;
+        memset(&msg, 0, sizeof(msg));
+        msg.msg_iov = const_cast<struct iovec*>(iov);
+        msg.msg_iovlen = iovcnt;
+
+        LOG << "Socket::sendmsg_one()"
+            << " fd_=" << fd_
+            << " iovcnt=" << iovcnt
+            << " flags=" << flags;
+
+        ssize_t r = ::sendmsg(fd_, &msg, flags);
+
+        LOG << "done Socket::sendmsg_one()"
+            << " fd_=" << fd_
+            << " return=" << r;
+
+        return r;
+    }
+
     //! Send (data,size) to socket, retry sends if short-sends occur.
     ssize_t send(const void* data, size_t size, int flags = 0) {
         assert(IsValid());
@@ -594,6 +619,10 @@ public:
     //! Set SO_RCVBUF socket option.
     void SetRcvBuf(size_t size);
 
+    //! Enable SO_ZEROCOPY, which allows sendmsg() with MSG_ZEROCOPY. Returns
+    //! false if the platform or kernel does not support it.
+    bool SetZeroCopy(bool activate = true);
+
     //! \}
 
 private:
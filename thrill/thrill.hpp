@@ -17,9 +17,12 @@
 print "#include <$_>\n" foreach sort glob("thrill/api/"."*.hpp");
 ]]]*/
 #include <thrill/api/action_node.hpp>
+#include <thrill/api/aggregate_by_key.hpp>
 #include <thrill/api/all_gather.hpp>
 #include <thrill/api/all_reduce.hpp>
+#include <thrill/api/approx_distinct.hpp>
 #include <thrill/api/bernoulli_sample.hpp>
+#include <thrill/api/broadcast_join.hpp>
 #include <thrill/api/cache.hpp>
 #include <thrill/api/collapse.hpp>
 #include <thrill/api/concat.hpp>
@@ -38,8 +41,10 @@ print "#include <$_>\n" foreach sort glob("thrill/api/"."*.hpp");
 #include <thrill/api/group_by_iterator.hpp>
 #include <thrill/api/group_by_key.hpp>
 #include <thrill/api/group_to_index.hpp>
+#include <thrill/api/inner_join.hpp>
 #include <thrill/api/max.hpp>
 #include <thrill/api/merge.hpp>
+#include <thrill/api/merge_join.hpp>
 #include <thrill/api/min.hpp>
 #include <thrill/api/prefixsum.hpp>
 #include <thrill/api/print.hpp>
@@ -53,6 +58,7 @@ print "#include <$_>\n" foreach sort glob("thrill/api/"."*.hpp");
 #include <thrill/api/sort.hpp>
 #include <thrill/api/source_node.hpp>
 #include <thrill/api/sum.hpp>
+#include <thrill/api/top_k_frequent.hpp>
 #include <thrill/api/union.hpp>
 #include <thrill/api/window.hpp>
 #include <thrill/api/write_binary.hpp>